@@ -0,0 +1,321 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeAsyncCapture.cpp											*/
+/*																			*/
+/* @brief	Callback / future based asynchronous frame delivery				*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeAsyncCapture.h"
+
+namespace CUBE_EYE
+{
+
+#define DELIVERY_WAIT_MS	50		//wait for a frame, then re-check the stop flag
+
+//subscriber whose callback runs on this thread(Unsubscribe / Stop from a callback)
+static thread_local const void *t_pCurrentSubscriber = NULL;
+
+CCubeEyeAsyncCapture::CCubeEyeAsyncCapture()
+	: m_bRunning(false), m_bStop(false), m_nNextID(0)
+{
+}
+
+CCubeEyeAsyncCapture::~CCubeEyeAsyncCapture()
+{
+	Stop();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (size_t i = 0; i < m_vSubscribers.size(); i++)
+		Close(*m_vSubscribers[i]);
+	m_vSubscribers.clear();
+}
+
+CCubeEyeAsyncCapture::Executor CCubeEyeAsyncCapture::PoolExecutor(CCubeEyeThreadPool &pool)
+{
+	CCubeEyeThreadPool *pPool = &pool;
+	return [pPool](std::function<void()> task) { pPool->Submit(std::move(task)); };
+}
+
+ceAsyncConfig CCubeEyeAsyncCapture::DefaultConfig()
+{
+	ceAsyncConfig stConfig;
+	stConfig.ePolicy = Async_DropOldest;
+	stConfig.nQueueFrames = 2;
+	return stConfig;
+}
+
+/*************************************************************************************
+* start / stop
+*/
+
+int CCubeEyeAsyncCapture::Start(CCubeEyeFrameRing::ReadFunc readFunc, int nWidth, int nHeight, int nSlotCount)
+{
+	if (m_bRunning.load())
+		return CE_FAILED;
+
+	int nResult = m_ring.Create(nWidth, nHeight, nSlotCount);
+	if (nResult != CE_SUCCESS)
+		return nResult;
+	nResult = m_ring.StartCapture(readFunc);
+	if (nResult != CE_SUCCESS)
+		return nResult;
+
+	m_bStop.store(false);
+	m_bRunning.store(true);
+	m_deliveryThread = std::thread(&CCubeEyeAsyncCapture::DeliveryThread, this);
+	return CE_SUCCESS;
+}
+
+int CCubeEyeAsyncCapture::Stop()
+{
+	if (!m_bRunning.load())
+		return CE_SUCCESS;
+	if (t_pCurrentSubscriber != NULL)
+		return CE_FAILED;
+
+	//wake the delivery thread if it is blocked on a full subscriber queue
+	m_bStop.store(true);
+	Vector<std::shared_ptr<Subscriber> > vSubscribers;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		vSubscribers = m_vSubscribers;
+	}
+	for (size_t i = 0; i < vSubscribers.size(); i++) {
+		std::lock_guard<std::mutex> lock(vSubscribers[i]->mutex);
+		vSubscribers[i]->cond.notify_all();
+	}
+
+	m_deliveryThread.join();
+	m_ring.StopCapture();
+
+	Vector<Waiter> vWaiters;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		vWaiters.swap(m_vWaiters);
+		vSubscribers = m_vSubscribers;
+	}
+	for (size_t i = 0; i < vWaiters.size(); i++)
+		vWaiters[i](CFrameRef());
+
+	//queued frames hold ring slots : drop them and let running callbacks finish
+	for (size_t i = 0; i < vSubscribers.size(); i++) {
+		Subscriber &sub = *vSubscribers[i];
+		std::unique_lock<std::mutex> lock(sub.mutex);
+		sub.qFrames.clear();
+		sub.cond.wait(lock, [&sub] { return !sub.bDraining; });
+	}
+
+	m_bRunning.store(false);
+	return CE_SUCCESS;
+}
+
+/*************************************************************************************
+* consumers
+*/
+
+int CCubeEyeAsyncCapture::Subscribe(FrameCallback callback, const ceAsyncConfig &stConfig, Executor executor)
+{
+	if (!callback || stConfig.nQueueFrames < 1)
+		return CE_INVALID_PARAM;
+
+	std::shared_ptr<Subscriber> pSub = std::make_shared<Subscriber>();
+	pSub->callback = callback;
+	pSub->executor = executor;
+	pSub->stConfig = stConfig;
+	pSub->bActive = true;
+	pSub->bDraining = false;
+	pSub->nDelivered = 0;
+	pSub->nDropped = 0;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	pSub->nID = ++m_nNextID;
+	m_vSubscribers.push_back(pSub);
+	return pSub->nID;
+}
+
+int CCubeEyeAsyncCapture::Unsubscribe(int nID)
+{
+	std::shared_ptr<Subscriber> pSub;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (size_t i = 0; i < m_vSubscribers.size(); i++) {
+			if (m_vSubscribers[i]->nID == nID) {
+				pSub = m_vSubscribers[i];
+				m_vSubscribers.erase(m_vSubscribers.begin() + i);
+				break;
+			}
+		}
+	}
+	if (!pSub)
+		return CE_INVALID_PARAM;
+
+	Close(*pSub);
+	return CE_SUCCESS;
+}
+
+void CCubeEyeAsyncCapture::Close(Subscriber &sub)
+{
+	std::unique_lock<std::mutex> lock(sub.mutex);
+	sub.bActive = false;
+	sub.qFrames.clear();
+	sub.cond.notify_all();
+	if (t_pCurrentSubscriber != &sub)
+		sub.cond.wait(lock, [&sub] { return !sub.bDraining; });
+}
+
+std::shared_ptr<CCubeEyeAsyncCapture::Subscriber> CCubeEyeAsyncCapture::Find(int nID)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (size_t i = 0; i < m_vSubscribers.size(); i++) {
+		if (m_vSubscribers[i]->nID == nID)
+			return m_vSubscribers[i];
+	}
+	return std::shared_ptr<Subscriber>();
+}
+
+uint64 CCubeEyeAsyncCapture::getDeliveredCount(int nID)
+{
+	std::shared_ptr<Subscriber> pSub = Find(nID);
+	if (!pSub)
+		return 0;
+	std::lock_guard<std::mutex> lock(pSub->mutex);
+	return pSub->nDelivered;
+}
+
+uint64 CCubeEyeAsyncCapture::getDroppedCount(int nID)
+{
+	std::shared_ptr<Subscriber> pSub = Find(nID);
+	if (!pSub)
+		return 0;
+	std::lock_guard<std::mutex> lock(pSub->mutex);
+	return pSub->nDropped;
+}
+
+bool CCubeEyeAsyncCapture::AddWaiter(Waiter waiter)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_bRunning.load() || m_bStop.load())
+		return false;
+	m_vWaiters.push_back(std::move(waiter));
+	return true;
+}
+
+std::future<CCubeEyeAsyncCapture::CFrameRef> CCubeEyeAsyncCapture::NextFrame()
+{
+	std::shared_ptr<std::promise<CFrameRef> > pPromise = std::make_shared<std::promise<CFrameRef> >();
+	std::future<CFrameRef> future = pPromise->get_future();
+	if (!AddWaiter([pPromise](CFrameRef &&frame) { pPromise->set_value(std::move(frame)); }))
+		pPromise->set_value(CFrameRef());
+	return future;
+}
+
+/*************************************************************************************
+* delivery
+*/
+
+void CCubeEyeAsyncCapture::DeliveryThread()
+{
+	//consumers get frames captured from now on
+	uint64 nSeq = m_ring.getPublishedCount();
+
+	while (!m_bStop.load()) {
+		CFrameRef frame;
+		if (m_ring.AcquireNext(frame, nSeq, DELIVERY_WAIT_MS) != CE_SUCCESS)
+			continue;
+		nSeq = frame.getSequence();
+		Deliver(frame);
+	}
+}
+
+void CCubeEyeAsyncCapture::Deliver(const CFrameRef &frame)
+{
+	Vector<Waiter> vWaiters;
+	Vector<std::shared_ptr<Subscriber> > vSubscribers;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		vWaiters.swap(m_vWaiters);
+		vSubscribers = m_vSubscribers;
+	}
+
+	for (size_t i = 0; i < vWaiters.size(); i++)
+		vWaiters[i](frame.Share());
+	for (size_t i = 0; i < vSubscribers.size(); i++)
+		Push(vSubscribers[i], frame);
+}
+
+void CCubeEyeAsyncCapture::Push(const std::shared_ptr<Subscriber> &pSub, const CFrameRef &frame)
+{
+	Subscriber &sub = *pSub;
+	std::unique_lock<std::mutex> lock(sub.mutex);
+	if (!sub.bActive)
+		return;
+
+	if ((int)sub.qFrames.size() >= sub.stConfig.nQueueFrames) {
+		switch (sub.stConfig.ePolicy) {
+		case Async_DropOldest:
+			sub.qFrames.pop_front();
+			sub.nDropped++;
+			break;
+		case Async_DropNewest:
+			sub.nDropped++;
+			return;
+		case Async_Block:
+			sub.cond.wait(lock, [this, &sub] {
+				return !sub.bActive || m_bStop.load() || (int)sub.qFrames.size() < sub.stConfig.nQueueFrames;
+			});
+			if (!sub.bActive || m_bStop.load())
+				return;
+			break;
+		}
+	}
+
+	sub.qFrames.push_back(frame.Share());
+	if (sub.bDraining)
+		return;
+	sub.bDraining = true;
+	lock.unlock();
+
+	if (sub.executor)
+		sub.executor([pSub]() { Drain(pSub); });
+	else
+		Drain(pSub);
+}
+
+void CCubeEyeAsyncCapture::Drain(std::shared_ptr<Subscriber> pSub)
+{
+	//one drain per subscriber at a time keeps its callbacks ordered and never concurrent
+	Subscriber &sub = *pSub;
+	const void *pPrevious = t_pCurrentSubscriber;
+	t_pCurrentSubscriber = &sub;
+
+	for (;;) {
+		CFrameRef frame;
+		{
+			std::lock_guard<std::mutex> lock(sub.mutex);
+			if (!sub.bActive || sub.qFrames.empty()) {
+				sub.bDraining = false;
+				sub.cond.notify_all();
+				break;
+			}
+			frame = std::move(sub.qFrames.front());
+			sub.qFrames.pop_front();
+			sub.nDelivered++;
+			sub.cond.notify_all();
+		}
+		sub.callback(std::move(frame));
+
+		//one frame per task on a shared executor, so a busy subscriber does not hold a worker
+		if (sub.executor) {
+			t_pCurrentSubscriber = pPrevious;
+			sub.executor([pSub]() { Drain(pSub); });
+			return;
+		}
+	}
+
+	t_pCurrentSubscriber = pPrevious;
+}
+
+}
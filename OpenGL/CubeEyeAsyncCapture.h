@@ -0,0 +1,256 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeAsyncCapture.h											*/
+/*																			*/
+/* @brief	Callback / future based asynchronous frame delivery				*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeFrameRing.h"
+#include "CubeEyeThreadPool.h"
+
+#include <deque>
+#include <future>
+#include <memory>
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#include <coroutine>
+#define CE_HAS_COROUTINE
+#endif
+
+namespace CUBE_EYE
+{
+
+///What a subscriber's full queue does with a new frame
+enum async_policy {
+	///Discard the oldest queued frame
+	Async_DropOldest = 0,
+	///Discard the new frame
+	Async_DropNewest,
+	///Hold the delivery thread until the subscriber catches up(the ring keeps capturing
+	///and overwrites frames nobody holds, so the device is never stalled)
+	Async_Block
+};
+
+///Subscriber configuration
+typedef struct _ceAsyncConfig
+{
+	async_policy ePolicy;
+	///Frames queued for the subscriber while its callback runs(each holds a ring slot)
+	int nQueueFrames;
+
+} ceAsyncConfig;
+
+/**
+*
+*@brief		Asynchronous frame delivery
+*@details	Captures into a CCubeEyeFrameRing and pushes every frame to the consumers, so no
+			consumer needs a polling thread :
+			- callbacks(Subscribe) : each subscriber gets the frames in order, one callback at a
+			  time, on its executor, through a bounded queue with its own backpressure policy,
+			- futures(NextFrame) : completed with the next frame,
+			- C++20 coroutines(co_await NextFrameAsync()) where the compiler supports them.
+			Frames are shared ring slots(CFrameRef), never copied; a consumer holding frames
+			holds slots, so nSlotCount must cover the queues.
+
+			An executor runs a task(std::function<void()>); empty means the delivery thread
+			itself, PoolExecutor runs on a CCubeEyeThreadPool.
+			A stopped capture completes pending futures and awaiters with an empty CFrameRef.
+*
+*/
+class CCubeEyeAsyncCapture {
+
+public:
+
+	typedef CCubeEyeFrameRing::CFrameRef CFrameRef;
+	typedef std::function<void(CFrameRef &&frame)> FrameCallback;
+	typedef std::function<void(std::function<void()> task)> Executor;
+
+	CCubeEyeAsyncCapture();
+	~CCubeEyeAsyncCapture();
+
+	///Executor running tasks on pool(the pool must outlive the capture)
+	static Executor PoolExecutor(CCubeEyeThreadPool &pool);
+
+	///Drop oldest, 2 queued frames
+	static ceAsyncConfig DefaultConfig();
+
+	/*************************************************************************************
+	* \defgroup Start/Stop
+	* @{
+	*/
+
+	/**
+	*
+	* @brief	Start
+	* @details	Creates the ring and starts the capture and delivery threads.
+	* @param	readFunc - frame source(same signature as ReadDepthIRFrame).
+	* @param	nWidth, nHeight - frame size.
+	* @param	nSlotCount - ring slots.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Start(CCubeEyeFrameRing::ReadFunc readFunc, int nWidth, int nHeight, int nSlotCount = 8);
+
+	/**
+	*
+	* @brief	Start with a device
+	* @details	Any connected and started device exposing pDevInfo and ReadDepthIRFrame; it must
+				outlive the capture.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	template <class TDevice>
+	int Start(TDevice &device, int nSlotCount = 8)
+	{
+		TDevice *pDevice = &device;
+		return Start([pDevice](uint16 *pDepth, uint16 *pIR, ceFrameInfo &pFrameInfo) {
+			return pDevice->ReadDepthIRFrame(pDepth, pIR, pFrameInfo);
+		}, device.pDevInfo.nWidth, device.pDevInfo.nHeight, nSlotCount);
+	}
+
+	/**
+	*
+	* @brief	Stop
+	* @details	Stops the threads, drops the queued frames, completes the pending futures /
+				awaiters empty and waits for running callbacks. Not from a callback.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Stop();
+
+	bool IsRunning() const { return m_bRunning.load(); }
+
+	///Ring being filled(statistics, telemetry); valid between Start and Stop
+	CCubeEyeFrameRing &getRing() { return m_ring; }
+
+	/**@}*/
+
+	/*************************************************************************************
+	* \defgroup Consumers
+	* @{
+	*/
+
+	/**
+	*
+	* @brief	Subscribe
+	* @details	callback receives every frame delivered after this call, in order and never
+				concurrently with itself. May be called before or after Start.
+	* @param	executor - runs the callbacks, empty : delivery thread.
+	* @return	subscriber id(> 0)|Error Code(< 0)
+	*
+	*/
+	int Subscribe(FrameCallback callback, const ceAsyncConfig &stConfig = DefaultConfig(), Executor executor = Executor());
+
+	/**
+	*
+	* @brief	Unsubscribe
+	* @details	Drops the queued frames and waits for a running callback(except when called
+				from that callback).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Unsubscribe(int nID);
+
+	///Frames delivered to / dropped for a subscriber(0 for an unknown id)
+	uint64 getDeliveredCount(int nID);
+	uint64 getDroppedCount(int nID);
+
+	/**
+	*
+	* @brief	Next frame as a future
+	* @details	Completed on the delivery thread; empty CFrameRef when the capture stops or
+				is not running.
+	* @return	future
+	*
+	*/
+	std::future<CFrameRef> NextFrame();
+
+#if defined(CE_HAS_COROUTINE)
+	/**
+	*
+	*@brief		co_await awaitable of the next frame
+	*@details	The coroutine resumes on executor(empty : delivery thread) with the frame,
+				or an empty CFrameRef when the capture stops or is not running.
+	*
+	*/
+	class FrameAwaiter {
+
+	public:
+
+		FrameAwaiter(CCubeEyeAsyncCapture *pOwner, Executor executor) : m_pOwner(pOwner), m_executor(executor) {}
+
+		bool await_ready() const { return false; }
+		bool await_suspend(std::coroutine_handle<> handle)
+		{
+			//this may be resumed on another thread as soon as the waiter is registered
+			Executor executor = m_executor;
+			CFrameRef *pFrame = &m_frame;
+			return m_pOwner->AddWaiter([executor, pFrame, handle](CFrameRef &&frame) {
+				*pFrame = std::move(frame);
+				if (executor)
+					executor([handle]() { handle.resume(); });
+				else
+					handle.resume();
+			});
+		}
+		CFrameRef await_resume() { return std::move(m_frame); }
+
+	private:
+
+		CCubeEyeAsyncCapture *m_pOwner;
+		Executor m_executor;
+		CFrameRef m_frame;
+	};
+
+	FrameAwaiter NextFrameAsync(Executor executor = Executor()) { return FrameAwaiter(this, executor); }
+#endif
+
+	/**@}*/
+
+private:
+
+	typedef std::function<void(CFrameRef &&frame)> Waiter;
+
+	struct Subscriber
+	{
+		int nID;
+		FrameCallback callback;
+		Executor executor;
+		ceAsyncConfig stConfig;
+
+		std::mutex mutex;
+		std::condition_variable cond;
+		std::deque<CFrameRef> qFrames;
+		bool bActive;
+		bool bDraining;				//a drain task is scheduled or running
+		uint64 nDelivered;
+		uint64 nDropped;
+	};
+
+	CCubeEyeAsyncCapture(const CCubeEyeAsyncCapture &);
+	CCubeEyeAsyncCapture &operator=(const CCubeEyeAsyncCapture &);
+
+	bool AddWaiter(Waiter waiter);
+	void DeliveryThread();
+	void Deliver(const CFrameRef &frame);
+	void Push(const std::shared_ptr<Subscriber> &pSub, const CFrameRef &frame);
+	static void Drain(std::shared_ptr<Subscriber> pSub);
+	static void Close(Subscriber &sub);
+	std::shared_ptr<Subscriber> Find(int nID);
+
+	CCubeEyeFrameRing m_ring;
+	std::thread m_deliveryThread;
+	std::atomic<bool> m_bRunning;
+	std::atomic<bool> m_bStop;
+
+	std::mutex m_mutex;				//subscriber list and waiters
+	Vector<std::shared_ptr<Subscriber> > m_vSubscribers;
+	Vector<Waiter> m_vWaiters;
+	int m_nNextID;
+};
+
+}
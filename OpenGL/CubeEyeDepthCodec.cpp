@@ -0,0 +1,364 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeDepthCodec.cpp											*/
+/*																			*/
+/* @brief	Lossless 16 bit Depth/IR frame codec							*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeDepthCodec.h"
+
+#include <string.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace CUBE_EYE
+{
+
+#define CODEC_HEADER_SIZE	8
+#define CODEC_RESET			64
+//residuals between Rice parameter updates(power of 2, divides CODEC_RESET / 2)
+#define CODEC_K_PERIOD		8
+#define CODEC_MAX_K			15
+//unary quotient limit, larger residuals are escaped to 16 raw bits
+#define CODEC_QMAX			24
+//worst case bytes per pixel : CODEC_QMAX + 1 + 16 bits
+#define CODEC_PIXEL_BOUND	6
+//worst case bytes per run length(LEB128 of a 32 bit value)
+#define CODEC_RUN_BOUND		5
+
+/*************************************************************************************
+* shared predictor / Rice parameter model : encoder and decoder must stay bit exact
+*/
+
+static inline uint32 BitScanReverse(uint32 v)
+{
+#if defined(_MSC_VER)
+	unsigned long nIndex;
+	_BitScanReverse(&nIndex, v | 1);
+	return nIndex;
+#else
+	return 31 - (uint32)__builtin_clz(v | 1);
+#endif
+}
+
+/**
+* running mean of |residual|(A / N) and the Rice parameter derived from it.
+* A single state : per gradient contexts(LOCO-I) cost a third of the speed for < 1% size on ToF depth.
+*/
+struct RiceState
+{
+	uint32 nA;
+	uint32 nN;
+	uint32 nK;
+
+	RiceState() : nA(8), nN(1), nK(3) {}
+
+	inline void Update(uint32 u)
+	{
+		nA += u >> 1;
+		if ((++nN & (CODEC_K_PERIOD - 1)) != 0)
+			return;
+
+		//smallest k with (N << k) >= A : floor log2 difference, then at most one step up
+		int t = (int)BitScanReverse(nA) - (int)BitScanReverse(nN);
+		uint32 k = t > 0 ? (uint32)t : 0;
+		k += (nN << k) < nA;
+		nK = k < CODEC_MAX_K ? k : CODEC_MAX_K;
+		if (nN == CODEC_RESET) {
+			nA >>= 1;
+			nN >>= 1;
+		}
+	}
+};
+
+/**
+* prediction from the valid(non zero) neighbours : a left, b up, c up-left, t previous frame
+*/
+static inline uint32 Predict(uint32 a, uint32 b, uint32 c, uint32 t, uint32 nLast)
+{
+	uint32 p;
+	bool bSpatial = true;
+
+	if (a && b && c) {
+		//MED(LOCO-I) : median(a, b, a + b - c), picks the edge side at depth discontinuities
+		int nMax = a > b ? a : b;
+		int nMin = a > b ? b : a;
+		int g = (int)(a + b) - (int)c;
+		g = g < nMin ? nMin : g;
+		p = (uint32)(g > nMax ? nMax : g);
+	}
+	else if (a && b) {
+		p = (a + b) >> 1;
+	}
+	else if (a || b) {
+		p = a ? a : b;
+	}
+	else {
+		p = nLast;
+		bSpatial = false;
+	}
+
+	if (t)
+		p = bSpatial ? (p + t + 1) >> 1 : t;
+
+	return p;
+}
+
+static inline uint32 CountTrailingZeros(uint64 v)
+{
+#if defined(_MSC_VER)
+	unsigned long nIndex;
+	_BitScanForward64(&nIndex, v);
+	return nIndex;
+#else
+	return (uint32)__builtin_ctzll(v);
+#endif
+}
+
+/*************************************************************************************
+* encoder
+*/
+
+static inline void PutRun(uint8 *&pDst, uint32 nRun)
+{
+	while (nRun >= 0x80) {
+		*pDst++ = (uint8)(nRun | 0x80);
+		nRun >>= 7;
+	}
+	*pDst++ = (uint8)nRun;
+}
+
+size_t ceDepthEncodeBound(size_t nPixelCount)
+{
+	//runs alternate, so there are at most nPixelCount + 1 of them; + 8 byte bit writer slack
+	return CODEC_HEADER_SIZE + CODEC_RUN_BOUND * (nPixelCount + 1) + CODEC_PIXEL_BOUND * nPixelCount + 8;
+}
+
+int64 ceDepthEncode(const uint16 *pSrc, const uint16 *pPrev, int nWidth, int nHeight, uint8 *pDst, size_t nDstSize)
+{
+	if (pSrc == NULL || pDst == NULL || nWidth <= 0 || nHeight <= 0)
+		return CE_INVALID_PARAM;
+	if (nDstSize < CODEC_HEADER_SIZE + 16)
+		return CE_OUTOFRANGE;
+
+	size_t nSize = (size_t)nWidth * nHeight;
+	uint8 *pEnd = pDst + nDstSize;
+
+	//run stream
+	uint8 *pRun = pDst + CODEC_HEADER_SIZE;
+	bool bValid = true;
+	uint32 nRun = 0;
+	for (size_t i = 0; i < nSize; i++) {
+		if ((pSrc[i] != 0) != bValid) {
+			if (pEnd - pRun < CODEC_RUN_BOUND * 2)
+				return CE_OUTOFRANGE;
+			PutRun(pRun, nRun);
+			bValid = !bValid;
+			nRun = 0;
+		}
+		nRun++;
+	}
+	if (pEnd - pRun < CODEC_RUN_BOUND)
+		return CE_OUTOFRANGE;
+	PutRun(pRun, nRun);
+
+	uint32 nFlags = pPrev ? CE_CODEC_TEMPORAL : 0;
+	uint32 nRunBytes = (uint32)(pRun - pDst - CODEC_HEADER_SIZE);
+	memcpy(pDst, &nFlags, 4);
+	memcpy(pDst + 4, &nRunBytes, 4);
+
+	//residual bit stream(LSB first) : q zero bits, a one bit, k remainder bits
+	RiceState stRice;
+	uint8 *pBit = pRun;
+	uint64 nAcc = 0;
+	uint32 nBits = 0;
+	uint32 nLast = 0;
+	size_t nRowBound = (size_t)nWidth * CODEC_PIXEL_BOUND + 16;
+
+	for (int y = 0; y < nHeight; y++) {
+		if ((size_t)(pEnd - pBit) < nRowBound)
+			return CE_OUTOFRANGE;
+
+		const uint16 *pRow = pSrc + (size_t)y * nWidth;
+		const uint16 *pUp = y > 0 ? pRow - nWidth : NULL;
+		const uint16 *pPrevRow = pPrev ? pPrev + (size_t)y * nWidth : NULL;
+
+		for (int x = 0; x < nWidth; x++) {
+			uint32 v = pRow[x];
+			if (v == 0)
+				continue;
+
+			uint32 a = x > 0 ? pRow[x - 1] : 0;
+			uint32 b = pUp ? pUp[x] : 0;
+			uint32 c = (pUp && x > 0) ? pUp[x - 1] : 0;
+			uint32 p = Predict(a, b, c, pPrevRow ? pPrevRow[x] : 0, nLast);
+			nLast = v;
+
+			//modular residual, zigzag
+			int32 r = (int16)(uint16)(v - p);
+			uint32 u = ((uint32)r << 1 ^ (uint32)(r >> 31)) & 0xFFFF;
+
+			uint32 k = stRice.nK;
+			uint32 q = u >> k;
+			uint64 nCode;
+			uint32 nLength;
+			if (q < CODEC_QMAX) {
+				nCode = ((uint64)1 << q) | ((uint64)(u & ((1U << k) - 1)) << (q + 1));
+				nLength = q + 1 + k;
+			}
+			else {
+				nCode = ((uint64)1 << CODEC_QMAX) | ((uint64)u << (CODEC_QMAX + 1));
+				nLength = CODEC_QMAX + 1 + 16;
+			}
+			stRice.Update(u);
+
+			nAcc |= nCode << nBits;
+			nBits += nLength;
+			memcpy(pBit, &nAcc, 8);
+			pBit += nBits >> 3;
+			nAcc >>= nBits & ~7U;
+			nBits &= 7;
+		}
+	}
+
+	if (nBits > 0)
+		*pBit++ = (uint8)nAcc;
+
+	return (int64)(pBit - pDst);
+}
+
+/*************************************************************************************
+* decoder
+*/
+
+static inline uint64 Peek(const uint8 *pData, size_t nSize, uint64 nBitPos)
+{
+	size_t nByte = (size_t)(nBitPos >> 3);
+	uint64 v = 0;
+	if (nByte + 8 <= nSize)
+		memcpy(&v, pData + nByte, 8);
+	else if (nByte < nSize)
+		memcpy(&v, pData + nByte, nSize - nByte);
+	return v >> (nBitPos & 7);
+}
+
+bool ceDepthIsTemporal(const uint8 *pSrc, size_t nSrcSize)
+{
+	if (pSrc == NULL || nSrcSize < CODEC_HEADER_SIZE)
+		return false;
+
+	uint32 nFlags;
+	memcpy(&nFlags, pSrc, 4);
+	return (nFlags & CE_CODEC_TEMPORAL) != 0;
+}
+
+int ceDepthDecode(const uint8 *pSrc, size_t nSrcSize, const uint16 *pPrev, int nWidth, int nHeight, uint16 *pDst)
+{
+	if (pSrc == NULL || pDst == NULL || nWidth <= 0 || nHeight <= 0 || nSrcSize < CODEC_HEADER_SIZE)
+		return CE_INVALID_PARAM;
+
+	uint32 nFlags, nRunBytes;
+	memcpy(&nFlags, pSrc, 4);
+	memcpy(&nRunBytes, pSrc + 4, 4);
+	if (nRunBytes > nSrcSize - CODEC_HEADER_SIZE)
+		return CE_READ_FAILED;
+	if (nFlags & CE_CODEC_TEMPORAL) {
+		if (pPrev == NULL)
+			return CE_INVALID_PARAM;
+	}
+	else {
+		pPrev = NULL;
+	}
+
+	const uint8 *pRun = pSrc + CODEC_HEADER_SIZE;
+	const uint8 *pRunEnd = pRun + nRunBytes;
+	const uint8 *pBits = pRunEnd;
+	size_t nBitBytes = nSrcSize - CODEC_HEADER_SIZE - nRunBytes;
+	uint64 nBitPos = 0;
+
+	RiceState stRice;
+	bool bValid = false;
+	uint32 nRemain = 0;
+	uint32 nLast = 0;
+
+	for (int y = 0; y < nHeight; y++) {
+		uint16 *pRow = pDst + (size_t)y * nWidth;
+		const uint16 *pUp = y > 0 ? pRow - nWidth : NULL;
+		const uint16 *pPrevRow = pPrev ? pPrev + (size_t)y * nWidth : NULL;
+
+		int x = 0;
+		while (x < nWidth) {
+			if (nRemain == 0) {
+				//next run length
+				uint32 nRun = 0;
+				int nShift = 0;
+				for (;;) {
+					if (pRun >= pRunEnd || nShift > 28)
+						return CE_READ_FAILED;
+					uint8 b = *pRun++;
+					nRun |= (uint32)(b & 0x7F) << nShift;
+					nShift += 7;
+					if ((b & 0x80) == 0)
+						break;
+				}
+				bValid = !bValid;
+				nRemain = nRun;
+				continue;
+			}
+
+			int nEnd = nRemain < (uint32)(nWidth - x) ? x + (int)nRemain : nWidth;
+			nRemain -= nEnd - x;
+
+			if (!bValid) {
+				memset(pRow + x, 0, (nEnd - x) * sizeof(uint16));
+				x = nEnd;
+				continue;
+			}
+
+			//left neighbour kept in a register, the output row may alias the up row for the compiler
+			uint32 a = x > 0 ? pRow[x - 1] : 0;
+			for (; x < nEnd; x++) {
+				uint32 b = pUp ? pUp[x] : 0;
+				uint32 c = (pUp && x > 0) ? pUp[x - 1] : 0;
+				uint32 p = Predict(a, b, c, pPrevRow ? pPrevRow[x] : 0, nLast);
+
+				uint32 k = stRice.nK;
+				uint64 w = Peek(pBits, nBitBytes, nBitPos);
+				if ((w & (((uint64)1 << (CODEC_QMAX + 1)) - 1)) == 0)
+					return CE_READ_FAILED;
+
+				uint32 q = CountTrailingZeros(w);
+				uint32 u;
+				if (q < CODEC_QMAX) {
+					u = (q << k) | (uint32)((w >> (q + 1)) & ((1U << k) - 1));
+					nBitPos += q + 1 + k;
+				}
+				else {
+					u = (uint32)(w >> (CODEC_QMAX + 1)) & 0xFFFF;
+					nBitPos += CODEC_QMAX + 1 + 16;
+				}
+				stRice.Update(u);
+
+				int32 r = (int32)(u >> 1) ^ -(int32)(u & 1);
+				uint32 v = (uint16)(p + r);
+				//a valid pixel never decodes to 0 in an intact stream
+				if (v == 0)
+					return CE_READ_FAILED;
+				pRow[x] = (uint16)v;
+				nLast = v;
+				a = v;
+			}
+		}
+	}
+
+	if (nRemain != 0 || pRun != pRunEnd || nBitPos > (uint64)nBitBytes * 8)
+		return CE_READ_FAILED;
+
+	return CE_SUCCESS;
+}
+
+}
@@ -0,0 +1,73 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeDepthCodec.h												*/
+/*																			*/
+/* @brief	Lossless 16 bit Depth/IR frame codec							*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeHostDef.h"
+
+namespace CUBE_EYE
+{
+/*
+*	Encoded frame :
+*
+*	uint32 nFlags					bit0 : temporal prediction(needs the previous frame to decode)
+*	uint32 nRunBytes
+*	run stream(nRunBytes)			alternating valid / zero run lengths in raster order(LEB128),
+*									starting with a valid run(possibly 0)
+*	residual bit stream				one adaptive Rice code per valid pixel
+*
+*	Valid pixels are predicted from their valid neighbours(MED predictor on left / up / up-left,
+*	falling back to whichever neighbour is valid), and in temporal mode blended with the same
+*	pixel of the previous frame. Zero pixels cost nothing beyond their run length.
+*/
+
+#define CE_CODEC_TEMPORAL	0x1U
+
+/**
+*
+* @brief	Encoded size bound
+* @details	Worst case output size of ceDepthEncode for nPixelCount pixels.
+* @return	byte
+*
+*/
+size_t ceDepthEncodeBound(size_t nPixelCount);
+
+/**
+*
+* @brief	Encode frame
+* @param	pSrc - nWidth x nHeight frame.
+* @param	pPrev - previous frame of the same stream for temporal prediction, NULL : spatial only.
+* @param	pDst - output buffer.
+* @param	nDstSize - output buffer size.
+* @return	encoded size(> 0)|Error Code(< 0, CE_OUTOFRANGE : did not fit in nDstSize)
+*
+*/
+int64 ceDepthEncode(const uint16 *pSrc, const uint16 *pPrev, int nWidth, int nHeight, uint8 *pDst, size_t nDstSize);
+
+/**
+*
+* @brief	Decode frame
+* @param	pSrc - encoded frame.
+* @param	nSrcSize - encoded size.
+* @param	pPrev - previous decoded frame(required when the frame was encoded with pPrev).
+* @param	pDst - nWidth x nHeight output frame.
+* @return	Success(0)|Error Code(< 0)
+*
+*/
+int ceDepthDecode(const uint8 *pSrc, size_t nSrcSize, const uint16 *pPrev, int nWidth, int nHeight, uint16 *pDst);
+
+/**
+*
+* @brief	Temporal frame check
+* @return	true : the encoded frame needs the previous frame to decode
+*
+*/
+bool ceDepthIsTemporal(const uint8 *pSrc, size_t nSrcSize);
+
+}
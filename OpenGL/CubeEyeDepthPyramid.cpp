@@ -0,0 +1,277 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeDepthPyramid.cpp											*/
+/*																			*/
+/* @brief	Depth / IR image pyramid for coarse-to-fine tracking			*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeDepthPyramid.h"
+
+namespace CUBE_EYE
+{
+
+#define BAND_ROWS			16		//level 0 rows per band at least
+
+/*************************************************************************************
+* 2 x 2 reduction of one output row
+*
+* Depth and IR of the block are averaged over the accepted pixels : valid(d > 0) and
+* d - nearest <= threshold. Averages are rounded as (float)sum / count + 0.5 in both the
+* vector and the scalar code, so every path gives the same pixels.
+*/
+
+static inline uint16 Average(uint32 nSum, uint32 nCount)
+{
+	return (uint16)((float)nSum / (float)(nCount > 0 ? nCount : 1) + 0.5f);
+}
+
+#if defined(CE_USE_AVX2)
+//8 output pixels from 16 pixels of each source row, in 32 bit lanes
+static inline void Reduce8(const uint16 *p0, const uint16 *p1, const uint16 *q0, const uint16 *q1,
+	__m256i vEdge1, __m256i vRatio, __m256i &vDepth, __m256i &vIR)
+{
+	const __m256i vLow = _mm256_set1_epi32(0xFFFF);
+	const __m256i vOne = _mm256_set1_epi32(1);
+	const __m256i vZero = _mm256_setzero_si256();
+
+	__m256i a = _mm256_loadu_si256((const __m256i *)p0);
+	__m256i b = _mm256_loadu_si256((const __m256i *)p1);
+	__m256i d[4] = { _mm256_and_si256(a, vLow), _mm256_srli_epi32(a, 16), _mm256_and_si256(b, vLow), _mm256_srli_epi32(b, 16) };
+
+	//nearest valid depth : 0 - 1 wraps to the largest value, so invalid pixels never win
+	__m256i vRef = _mm256_min_epu32(_mm256_min_epu32(_mm256_sub_epi32(d[0], vOne), _mm256_sub_epi32(d[1], vOne)),
+		_mm256_min_epu32(_mm256_sub_epi32(d[2], vOne), _mm256_sub_epi32(d[3], vOne)));
+	vRef = _mm256_add_epi32(vRef, vOne);
+	__m256i vTh1 = _mm256_add_epi32(vEdge1, _mm256_srli_epi32(_mm256_mullo_epi32(vRef, vRatio), 16));
+
+	__m256i vSum = vZero;
+	__m256i vCount = vZero;
+	__m256i vKeep[4];
+	for (int k = 0; k < 4; k++) {
+		vKeep[k] = _mm256_and_si256(_mm256_cmpgt_epi32(d[k], vZero), _mm256_cmpgt_epi32(vTh1, _mm256_sub_epi32(d[k], vRef)));
+		vSum = _mm256_add_epi32(vSum, _mm256_and_si256(d[k], vKeep[k]));
+		vCount = _mm256_sub_epi32(vCount, vKeep[k]);
+	}
+	__m256 fCount = _mm256_cvtepi32_ps(_mm256_max_epi32(vCount, vOne));
+	const __m256 fHalf = _mm256_set1_ps(0.5f);
+	vDepth = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_div_ps(_mm256_cvtepi32_ps(vSum), fCount), fHalf));
+
+	if (q0 == NULL)
+		return;
+
+	a = _mm256_loadu_si256((const __m256i *)q0);
+	b = _mm256_loadu_si256((const __m256i *)q1);
+	__m256i ir[4] = { _mm256_and_si256(a, vLow), _mm256_srli_epi32(a, 16), _mm256_and_si256(b, vLow), _mm256_srli_epi32(b, 16) };
+	__m256i vAll = _mm256_add_epi32(_mm256_add_epi32(ir[0], ir[1]), _mm256_add_epi32(ir[2], ir[3]));
+	__m256i vSumIR = vZero;
+	for (int k = 0; k < 4; k++)
+		vSumIR = _mm256_add_epi32(vSumIR, _mm256_and_si256(ir[k], vKeep[k]));
+
+	//no valid depth : all four IR pixels
+	__m256i vNone = _mm256_cmpeq_epi32(vCount, vZero);
+	vSumIR = _mm256_blendv_epi8(vSumIR, vAll, vNone);
+	fCount = _mm256_blendv_ps(fCount, _mm256_set1_ps(4.0f), _mm256_castsi256_ps(vNone));
+	vIR = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_div_ps(_mm256_cvtepi32_ps(vSumIR), fCount), fHalf));
+}
+
+static inline __m256i Pack16(__m256i vLow, __m256i vHigh)
+{
+	//packus interleaves the 128 bit lanes, the permute puts them back in order
+	return _mm256_permute4x64_epi64(_mm256_packus_epi32(vLow, vHigh), 0xD8);
+}
+#endif
+
+static void ReduceRow(const uint16 *p0, const uint16 *p1, const uint16 *q0, const uint16 *q1,
+	uint16 *pOut, uint16 *pOutIR, int nWidth, uint32 nEdge, uint32 nRatio)
+{
+	int x = 0;
+
+#if defined(CE_USE_AVX2)
+	const __m256i vEdge1 = _mm256_set1_epi32((int)nEdge + 1);
+	const __m256i vRatio = _mm256_set1_epi32((int)nRatio);
+	for (; x + 16 <= nWidth; x += 16) {
+		__m256i vDepth[2], vIR[2];
+		for (int h = 0; h < 2; h++) {
+			int s = 2 * x + 16 * h;
+			Reduce8(p0 + s, p1 + s, q0 != NULL ? q0 + s : NULL, q0 != NULL ? q1 + s : NULL, vEdge1, vRatio, vDepth[h], vIR[h]);
+		}
+		_mm256_storeu_si256((__m256i *)(pOut + x), Pack16(vDepth[0], vDepth[1]));
+		if (q0 != NULL)
+			_mm256_storeu_si256((__m256i *)(pOutIR + x), Pack16(vIR[0], vIR[1]));
+	}
+#endif
+
+	for (; x < nWidth; x++) {
+		uint32 d[4] = { p0[2 * x], p0[2 * x + 1], p1[2 * x], p1[2 * x + 1] };
+		uint32 nRef = 0xFFFFFFFF;
+		for (int k = 0; k < 4; k++)
+			nRef = d[k] - 1 < nRef ? d[k] - 1 : nRef;
+		nRef++;
+		uint32 nTh = nEdge + ((nRef * nRatio) >> 16);
+
+		uint32 nSum = 0, nCount = 0;
+		bool bKeep[4];
+		for (int k = 0; k < 4; k++) {
+			bKeep[k] = d[k] > 0 && d[k] - nRef <= nTh;
+			nSum += bKeep[k] ? d[k] : 0;
+			nCount += bKeep[k] ? 1 : 0;
+		}
+		pOut[x] = Average(nSum, nCount);
+
+		if (q0 == NULL)
+			continue;
+		uint32 ir[4] = { q0[2 * x], q0[2 * x + 1], q1[2 * x], q1[2 * x + 1] };
+		uint32 nSumIR = 0;
+		for (int k = 0; k < 4; k++)
+			nSumIR += (bKeep[k] || nCount == 0) ? ir[k] : 0;
+		pOutIR[x] = Average(nSumIR, nCount > 0 ? nCount : 4);
+	}
+}
+
+/*************************************************************************************
+* CCubeEyeDepthPyramid
+*/
+
+CCubeEyeDepthPyramid::CCubeEyeDepthPyramid()
+	: m_nWidth(0), m_nHeight(0), m_nLevels(0), m_pPool(&CCubeEyeThreadPool::Default()),
+	m_nEdgeMm(20), m_fEdgeRatio(0.02f), m_pInput(NULL), m_pInputIR(NULL), m_pBlock(NULL)
+{
+	memset(m_pDepth, 0, sizeof(m_pDepth));
+	memset(m_pIR, 0, sizeof(m_pIR));
+	SetEdgeThreshold(m_nEdgeMm, m_fEdgeRatio);
+}
+
+CCubeEyeDepthPyramid::~CCubeEyeDepthPyramid()
+{
+	Release();
+}
+
+void CCubeEyeDepthPyramid::Release()
+{
+	if (m_pBlock != NULL)
+		ceAlignedFree(m_pBlock);
+	m_pBlock = NULL;
+	memset(m_pDepth, 0, sizeof(m_pDepth));
+	memset(m_pIR, 0, sizeof(m_pIR));
+	m_nWidth = 0;
+	m_nHeight = 0;
+	m_nLevels = 0;
+	m_pInput = NULL;
+	m_pInputIR = NULL;
+}
+
+int CCubeEyeDepthPyramid::Init(int nWidth, int nHeight, int nLevels)
+{
+	if (nLevels < 2 || nLevels > CE_PYRAMID_MAX_LEVELS)
+		return CE_INVALID_PARAM;
+	if ((nWidth >> (nLevels - 1)) < 1 || (nHeight >> (nLevels - 1)) < 1)
+		return CE_INVALID_PARAM;
+
+	Release();
+
+	//levels 1~ : depth planes, then IR planes, each starting aligned
+	size_t nOffset[CE_PYRAMID_MAX_LEVELS];
+	size_t nTotal = 0;
+	for (int l = 1; l < nLevels; l++) {
+		nOffset[l] = nTotal;
+		nTotal += ((size_t)(nWidth >> l) * (nHeight >> l) + 15) & ~(size_t)15;
+	}
+
+	m_pBlock = (uint16 *)ceAlignedAlloc(2 * nTotal * sizeof(uint16));
+	if (m_pBlock == NULL)
+		return CE_FAILED;
+
+	for (int l = 1; l < nLevels; l++) {
+		m_pDepth[l] = m_pBlock + nOffset[l];
+		m_pIR[l] = m_pBlock + nTotal + nOffset[l];
+	}
+	m_nWidth = nWidth;
+	m_nHeight = nHeight;
+	m_nLevels = nLevels;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeDepthPyramid::SetEdgeThreshold(uint16 nEdgeMm, float fEdgeRatio)
+{
+	if (!(fEdgeRatio >= 0.0f && fEdgeRatio <= 0.5f))
+		return CE_INVALID_PARAM;
+
+	m_nEdgeMm = nEdgeMm;
+	m_fEdgeRatio = fEdgeRatio;
+	m_nEdge[0] = 0;
+	m_nEdgeRatio[0] = 0;
+	for (int l = 1; l < CE_PYRAMID_MAX_LEVELS; l++) {
+		float fRatio = fEdgeRatio * 65536.0f * (float)(1 << (l - 1));
+		m_nEdge[l] = (uint32)nEdgeMm << (l - 1);
+		m_nEdgeRatio[l] = fRatio < 65535.0f ? (uint32)(fRatio + 0.5f) : 65535;
+	}
+	return CE_SUCCESS;
+}
+
+ceIntrinsicParam CCubeEyeDepthPyramid::ScaleIntrinsic(const ceIntrinsicParam &stIntr, int nLevel)
+{
+	float fScale = 1.0f / (float)(1 << nLevel);
+	ceIntrinsicParam stLevel;
+	stLevel.fFx = stIntr.fFx * fScale;
+	stLevel.fFy = stIntr.fFy * fScale;
+	stLevel.fCx = (stIntr.fCx + 0.5f) * fScale - 0.5f;
+	stLevel.fCy = (stIntr.fCy + 0.5f) * fScale - 0.5f;
+	return stLevel;
+}
+
+int CCubeEyeDepthPyramid::Build(const uint16 *pDepth, const uint16 *pIR)
+{
+	if (m_pBlock == NULL)
+		return CE_NOT_OPENED;
+	if (pDepth == NULL)
+		return CE_INVALID_PARAM;
+
+	m_pInput = pDepth;
+	m_pInputIR = pIR;
+
+	//a band covers whole rows of every level : its level 0 rows are a multiple of 2^(levels - 1)
+	int nAlign = 1 << (m_nLevels - 1);
+	int nBandRows = (BAND_ROWS + nAlign - 1) & ~(nAlign - 1);
+	int nBands = (m_nHeight + nBandRows - 1) / nBandRows;
+	int nHeight = m_nHeight;
+
+	auto func = [this, nBandRows, nHeight](int nBandBegin, int nBandEnd) {
+		int nRowEnd = nBandEnd * nBandRows;
+		BuildBand(nBandBegin * nBandRows, nRowEnd < nHeight ? nRowEnd : nHeight);
+	};
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, nBands, 1, func);
+	else
+		func(0, nBands);
+
+	return CE_SUCCESS;
+}
+
+void CCubeEyeDepthPyramid::BuildBand(int nRowBegin, int nRowEnd)
+{
+	//level l rows [nRowBegin >> l, nRowEnd >> l) only read the band's rows of level l - 1
+	for (int l = 1; l < m_nLevels; l++) {
+		for (int r = nRowBegin >> l; r < (nRowEnd >> l); r++)
+			Reduce(l, r);
+	}
+}
+
+void CCubeEyeDepthPyramid::Reduce(int nLevel, int nRow)
+{
+	size_t nSrcWidth = (size_t)(m_nWidth >> (nLevel - 1));
+	int nWidth = m_nWidth >> nLevel;
+	size_t nSrc = 2 * nRow * nSrcWidth;
+	size_t nDst = (size_t)nRow * nWidth;
+
+	const uint16 *pSrc = getDepth(nLevel - 1) + nSrc;
+	const uint16 *pSrcIR = m_pInputIR != NULL ? getIR(nLevel - 1) + nSrc : NULL;
+
+	ReduceRow(pSrc, pSrc + nSrcWidth, pSrcIR, pSrcIR != NULL ? pSrcIR + nSrcWidth : NULL,
+		m_pDepth[nLevel] + nDst, m_pIR[nLevel] + nDst, nWidth,
+		m_nEdge[nLevel], m_nEdgeRatio[nLevel]);
+}
+
+}
@@ -0,0 +1,148 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeDepthPyramid.h											*/
+/*																			*/
+/* @brief	Depth / IR image pyramid for coarse-to-fine tracking			*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeThreadPool.h"
+
+namespace CUBE_EYE
+{
+
+///Levels of a CCubeEyeDepthPyramid at most(level 0 included)
+#define CE_PYRAMID_MAX_LEVELS	6
+
+/**
+*
+*@brief		Depth / IR image pyramid
+*@details	Level l + 1 halves level l(odd last rows / columns are dropped) : every pixel
+			averages the 2 x 2 block below it, but only over the block pixels that are valid
+			and on the same surface. The nearest valid depth of the block is the reference; a
+			pixel takes part if it lies within nEdgeMm + reference * fEdgeRatio of it, so the
+			foreground of a depth edge is kept and background or flying pixels are not blended
+			into it. The threshold doubles with every level, as the pixel spacing and with it
+			the depth step of a slanted surface does. A block without valid depth gives 0.
+			IR is averaged over the same pixels as depth; a block without valid depth averages
+			its four IR pixels.
+
+			All levels are built in one pass over bands of a multiple of 2^(levels - 1) rows, so the rows of
+			a band are still in cache when the next level reads them; the bands are split
+			over the thread pool and each level row is an AVX2 kernel when the build enables
+			it. Level 0 is the input frame itself, which must stay unchanged until the next
+			Build.
+*
+*/
+class CCubeEyeDepthPyramid {
+
+public:
+
+	CCubeEyeDepthPyramid();
+	~CCubeEyeDepthPyramid();
+
+	/**
+	*
+	* @brief	Initialize
+	* @param	nWidth, nHeight - level 0 size.
+	* @param	nLevels(2~CE_PYRAMID_MAX_LEVELS) - level count, level 0 included; the coarsest
+				level must be at least 1 x 1.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Init(int nWidth, int nHeight, int nLevels = 4);
+
+	template <class TDevice>
+	int Init(const TDevice &device, int nLevels = 4)
+	{
+		return Init(device.pDevInfo.nWidth, device.pDevInfo.nHeight, nLevels);
+	}
+
+	/**
+	*
+	* @brief	Set thread pool
+	* @details	NULL : single threaded. Default is CCubeEyeThreadPool::Default().
+	* @return	void
+	*
+	*/
+	void SetThreadPool(CCubeEyeThreadPool *pPool) { m_pPool = pPool; }
+
+	/**
+	*
+	* @brief	Depth discontinuity threshold
+	* @details	Block pixels farther than nEdgeMm + reference * fEdgeRatio from the nearest
+				block depth are left out of level 1; the threshold doubles per level.
+	* @param	nEdgeMm - constant part(unit; mm, default 20).
+	* @param	fEdgeRatio(0~0.5) - part proportional to the depth(default 0.02).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetEdgeThreshold(uint16 nEdgeMm, float fEdgeRatio);
+
+	/**
+	*
+	* @brief	Build pyramid
+	* @param	pDepth - depth frame(unit; mm), 0 : invalid.
+	* @param	pIR - IR frame, NULL : depth only.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Build(const uint16 *pDepth, const uint16 *pIR = NULL);
+
+	/*************************************************************************************
+	* \defgroup Levels of the last Build
+	* @{
+	*/
+
+	int getLevelCount() const { return m_nLevels; }
+	int getWidth(int nLevel) const { return m_nWidth >> nLevel; }
+	int getHeight(int nLevel) const { return m_nHeight >> nLevel; }
+
+	///Depth of nLevel, getWidth(nLevel) x getHeight(nLevel) packed rows(unit; mm)
+	const uint16 *getDepth(int nLevel) const { return nLevel == 0 ? m_pInput : m_pDepth[nLevel]; }
+
+	///IR of nLevel, NULL if the last Build had no IR
+	const uint16 *getIR(int nLevel) const { return m_pInputIR == NULL ? NULL : nLevel == 0 ? m_pInputIR : m_pIR[nLevel]; }
+
+	/**@}*/
+
+	/**
+	*
+	* @brief	Intrinsics of a level
+	* @details	Focal lengths halve per level; pixel centers move with the 2 x 2 blocks,
+				c' = (c + 0.5) / 2 - 0.5.
+	* @return	intrinsics of nLevel
+	*
+	*/
+	static ceIntrinsicParam ScaleIntrinsic(const ceIntrinsicParam &stIntr, int nLevel);
+
+private:
+
+	CCubeEyeDepthPyramid(const CCubeEyeDepthPyramid &);
+	CCubeEyeDepthPyramid &operator=(const CCubeEyeDepthPyramid &);
+
+	void Release();
+	void BuildBand(int nRowBegin, int nRowEnd);
+	void Reduce(int nLevel, int nRow);
+
+	int m_nWidth;
+	int m_nHeight;
+	int m_nLevels;
+	CCubeEyeThreadPool *m_pPool;
+
+	uint16 m_nEdgeMm;
+	float m_fEdgeRatio;
+	uint32 m_nEdge[CE_PYRAMID_MAX_LEVELS];			//constant threshold per level(unit; mm)
+	uint32 m_nEdgeRatio[CE_PYRAMID_MAX_LEVELS];		//depth ratio per level in Q16
+
+	const uint16 *m_pInput;							//level 0
+	const uint16 *m_pInputIR;
+	uint16 *m_pBlock;								//owned block : levels 1~ depth, then IR
+	uint16 *m_pDepth[CE_PYRAMID_MAX_LEVELS];
+	uint16 *m_pIR[CE_PYRAMID_MAX_LEVELS];
+};
+
+}
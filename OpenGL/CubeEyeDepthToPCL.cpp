@@ -0,0 +1,233 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeDepthToPCL.cpp											*/
+/*																			*/
+/* @brief	Host-side Depth to Point Cloud conversion with a ray table		*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeDepthToPCL.h"
+#include "CubeEyePointCloud.h"
+
+namespace CUBE_EYE
+{
+
+#define DEPTH_TO_M		0.001f
+#define ROW_GRAIN		16
+
+/*************************************************************************************
+* kernels : pixels [nBegin, nEnd) of the frame
+*/
+
+static void DepthToXYZI(const uint16 *pDepth, const uint16 *pIR, const float *pRayX, const float *pRayY,
+	cePointCloud *pOut, size_t nBegin, size_t nEnd)
+{
+	size_t i = nBegin;
+
+#if defined(CE_USE_AVX2)
+	const __m256 vScale = _mm256_set1_ps(DEPTH_TO_M);
+	for (; i + 8 <= nEnd; i += 8) {
+		__m256 z = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(pDepth + i)))), vScale);
+		__m256 x = _mm256_mul_ps(z, _mm256_loadu_ps(pRayX + i));
+		__m256 y = _mm256_mul_ps(z, _mm256_loadu_ps(pRayY + i));
+		__m256 ir = pIR ? _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(pIR + i)))) : _mm256_setzero_ps();
+
+		//8 x (x, y, z, i) transpose
+		__m256 xy0 = _mm256_unpacklo_ps(x, y);
+		__m256 xy1 = _mm256_unpackhi_ps(x, y);
+		__m256 zi0 = _mm256_unpacklo_ps(z, ir);
+		__m256 zi1 = _mm256_unpackhi_ps(z, ir);
+		__m256 p04 = _mm256_shuffle_ps(xy0, zi0, 0x44);
+		__m256 p15 = _mm256_shuffle_ps(xy0, zi0, 0xEE);
+		__m256 p26 = _mm256_shuffle_ps(xy1, zi1, 0x44);
+		__m256 p37 = _mm256_shuffle_ps(xy1, zi1, 0xEE);
+
+		float *pDst = (float *)(pOut + i);
+		_mm256_storeu_ps(pDst, _mm256_permute2f128_ps(p04, p15, 0x20));
+		_mm256_storeu_ps(pDst + 8, _mm256_permute2f128_ps(p26, p37, 0x20));
+		_mm256_storeu_ps(pDst + 16, _mm256_permute2f128_ps(p04, p15, 0x31));
+		_mm256_storeu_ps(pDst + 24, _mm256_permute2f128_ps(p26, p37, 0x31));
+	}
+#elif defined(CE_USE_NEON)
+	const float32x4_t vScale = vdupq_n_f32(DEPTH_TO_M);
+	for (; i + 4 <= nEnd; i += 4) {
+		float32x4x4_t p;
+		p.val[2] = vmulq_f32(vcvtq_f32_u32(vmovl_u16(vld1_u16(pDepth + i))), vScale);
+		p.val[0] = vmulq_f32(p.val[2], vld1q_f32(pRayX + i));
+		p.val[1] = vmulq_f32(p.val[2], vld1q_f32(pRayY + i));
+		p.val[3] = pIR ? vcvtq_f32_u32(vmovl_u16(vld1_u16(pIR + i))) : vdupq_n_f32(0.0f);
+		vst4q_f32((float *)(pOut + i), p);
+	}
+#endif
+
+	for (; i < nEnd; i++) {
+		float z = pDepth[i] * DEPTH_TO_M;
+		pOut[i].fX = z * pRayX[i];
+		pOut[i].fY = z * pRayY[i];
+		pOut[i].fZ = z;
+		pOut[i].fI = pIR ? (float)pIR[i] : 0.0f;
+	}
+}
+
+static void DepthToPlanes(const uint16 *pDepth, const uint16 *pIR, const float *pRayX, const float *pRayY,
+	float *pX, float *pY, float *pZ, float *pI, size_t nBegin, size_t nEnd)
+{
+	size_t i = nBegin;
+
+#if defined(CE_USE_AVX2)
+	const __m256 vScale = _mm256_set1_ps(DEPTH_TO_M);
+	for (; i + 8 <= nEnd; i += 8) {
+		__m256 z = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(pDepth + i)))), vScale);
+		_mm256_storeu_ps(pX + i, _mm256_mul_ps(z, _mm256_loadu_ps(pRayX + i)));
+		_mm256_storeu_ps(pY + i, _mm256_mul_ps(z, _mm256_loadu_ps(pRayY + i)));
+		_mm256_storeu_ps(pZ + i, z);
+		if (pI)
+			_mm256_storeu_ps(pI + i, pIR ? _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(pIR + i)))) : _mm256_setzero_ps());
+	}
+#elif defined(CE_USE_NEON)
+	const float32x4_t vScale = vdupq_n_f32(DEPTH_TO_M);
+	for (; i + 4 <= nEnd; i += 4) {
+		float32x4_t z = vmulq_f32(vcvtq_f32_u32(vmovl_u16(vld1_u16(pDepth + i))), vScale);
+		vst1q_f32(pX + i, vmulq_f32(z, vld1q_f32(pRayX + i)));
+		vst1q_f32(pY + i, vmulq_f32(z, vld1q_f32(pRayY + i)));
+		vst1q_f32(pZ + i, z);
+		if (pI)
+			vst1q_f32(pI + i, pIR ? vcvtq_f32_u32(vmovl_u16(vld1_u16(pIR + i))) : vdupq_n_f32(0.0f));
+	}
+#endif
+
+	for (; i < nEnd; i++) {
+		float z = pDepth[i] * DEPTH_TO_M;
+		pX[i] = z * pRayX[i];
+		pY[i] = z * pRayY[i];
+		pZ[i] = z;
+		if (pI)
+			pI[i] = pIR ? (float)pIR[i] : 0.0f;
+	}
+}
+
+/*************************************************************************************
+* CCubeEyeDepthToPCL
+*/
+
+CCubeEyeDepthToPCL::CCubeEyeDepthToPCL()
+	: m_nWidth(0), m_nHeight(0), m_pRayTable(NULL), m_pRayX(NULL), m_pRayY(NULL),
+	m_pPool(&CCubeEyeThreadPool::Default())
+{
+}
+
+CCubeEyeDepthToPCL::~CCubeEyeDepthToPCL()
+{
+	Release();
+}
+
+void CCubeEyeDepthToPCL::Release()
+{
+	if (m_pRayTable != NULL)
+		ceAlignedFree(m_pRayTable);
+	m_pRayTable = NULL;
+	m_pRayX = NULL;
+	m_pRayY = NULL;
+	m_nWidth = 0;
+	m_nHeight = 0;
+}
+
+int CCubeEyeDepthToPCL::Init(const ceIntrinsicParam &stIntrinsics, const ceDistortionParam &stDistortion, int nWidth, int nHeight)
+{
+	if (nWidth <= 0 || nHeight <= 0 || stIntrinsics.fFx <= 0.0f || stIntrinsics.fFy <= 0.0f)
+		return CE_INVALID_PARAM;
+
+	Release();
+
+	size_t nSize = (size_t)nWidth * nHeight;
+	m_pRayTable = (float *)ceAlignedAlloc(nSize * 2 * sizeof(float));
+	if (m_pRayTable == NULL)
+		return CE_FAILED;
+
+	ceBuildRayTable(stIntrinsics, stDistortion, nWidth, nHeight, m_pRayTable, m_pRayTable + nSize);
+
+	m_pRayX = m_pRayTable;
+	m_pRayY = m_pRayTable + nSize;
+	m_nWidth = nWidth;
+	m_nHeight = nHeight;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeDepthToPCL::InitFromTable(const float *pRayX, const float *pRayY, int nWidth, int nHeight)
+{
+	if (pRayX == NULL || pRayY == NULL || nWidth <= 0 || nHeight <= 0)
+		return CE_INVALID_PARAM;
+
+	Release();
+
+	m_pRayX = pRayX;
+	m_pRayY = pRayY;
+	m_nWidth = nWidth;
+	m_nHeight = nHeight;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeDepthToPCL::Convert(const uint16 *pDepth, const uint16 *pIR, cePointCloud *pPCLFrame) const
+{
+	if (m_pRayX == NULL)
+		return CE_NOT_OPENED;
+	if (pDepth == NULL || pPCLFrame == NULL)
+		return CE_INVALID_PARAM;
+
+	size_t nWidth = m_nWidth;
+	const float *pRayX = m_pRayX;
+	const float *pRayY = m_pRayY;
+	auto band = [=](int nRowBegin, int nRowEnd) {
+		DepthToXYZI(pDepth, pIR, pRayX, pRayY, pPCLFrame, nRowBegin * nWidth, nRowEnd * nWidth);
+	};
+
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, m_nHeight, ROW_GRAIN, band);
+	else
+		band(0, m_nHeight);
+
+	return CE_SUCCESS;
+}
+
+int CCubeEyeDepthToPCL::Convert(const uint16 *pDepth, const uint16 *pIR, float *pX, float *pY, float *pZ, float *pI) const
+{
+	if (m_pRayX == NULL)
+		return CE_NOT_OPENED;
+	if (pDepth == NULL || pX == NULL || pY == NULL || pZ == NULL)
+		return CE_INVALID_PARAM;
+
+	size_t nWidth = m_nWidth;
+	const float *pRayX = m_pRayX;
+	const float *pRayY = m_pRayY;
+	auto band = [=](int nRowBegin, int nRowEnd) {
+		DepthToPlanes(pDepth, pIR, pRayX, pRayY, pX, pY, pZ, pI, nRowBegin * nWidth, nRowEnd * nWidth);
+	};
+
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, m_nHeight, ROW_GRAIN, band);
+	else
+		band(0, m_nHeight);
+
+	return CE_SUCCESS;
+}
+
+int CCubeEyeDepthToPCL::Convert(const uint16 *pDepth, const uint16 *pIR, CCubeEyePointCloud &cloud) const
+{
+	if (m_pRayX == NULL)
+		return CE_NOT_OPENED;
+
+	if (cloud.getWidth() != m_nWidth || cloud.getHeight() != m_nHeight || !cloud.IsOrganized()) {
+		int nResult = cloud.Allocate(m_nWidth, m_nHeight, cloud.HasMask());
+		if (nResult != CE_SUCCESS)
+			return nResult;
+	}
+
+	int nResult = Convert(pDepth, pIR, cloud.getX(), cloud.getY(), cloud.getZ(), cloud.getI());
+	if (nResult == CE_SUCCESS && cloud.HasMask())
+		nResult = cloud.UpdateMask();
+	return nResult;
+}
+
+}
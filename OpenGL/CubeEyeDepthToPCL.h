@@ -0,0 +1,132 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeDepthToPCL.h												*/
+/*																			*/
+/* @brief	Host-side Depth to Point Cloud conversion with a ray table		*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeLens.h"
+#include "CubeEyeThreadPool.h"
+
+namespace CUBE_EYE
+{
+
+class CCubeEyePointCloud;
+
+/**
+*
+*@brief		Depth to Point Cloud converter
+*@details	Replaces the SDK side conversion(setDepthToPointCloud / ReadPCLFrame) so the camera
+			can stay in DEPTH_IR mode. Init() undistorts every pixel once into a table of
+			normalized rays(x/z, y/z); each frame is then Z = depth * 0.001, X = Z * rayX,
+			Y = Z * rayY, computed with AVX2 or NEON when the build enables them and split
+			over the thread pool in row bands. Depth 0(invalid) gives the point (0, 0, 0).
+*
+*/
+class CCubeEyeDepthToPCL {
+
+public:
+
+	CCubeEyeDepthToPCL();
+	~CCubeEyeDepthToPCL();
+
+	/**
+	*
+	* @brief	Initialize ray table
+	* @details	Undistorts every pixel of a nWidth x nHeight frame.
+	* @param	stIntrinsics - depth camera intrinsic parameter.
+	* @param	stDistortion - depth camera distortion parameter.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Init(const ceIntrinsicParam &stIntrinsics, const ceDistortionParam &stDistortion, int nWidth, int nHeight);
+
+	/**
+	*
+	* @brief	Initialize ray table from a connected device
+	* @details	Uses pIntrinsicParam / pDistortionParam / pDevInfo of CCubeEye(or CCubeEyeSim).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	template <class TDevice>
+	int Init(const TDevice &device)
+	{
+		return Init(device.pIntrinsicParam, device.pDistortionParam, device.pDevInfo.nWidth, device.pDevInfo.nHeight);
+	}
+
+	/**
+	*
+	* @brief	Use external ray table
+	* @details	Points the converter at a precomputed table, e.g. CCubeEyeLensTable getRayX / getRayY,
+				instead of building one. The table must outlive the converter.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int InitFromTable(const float *pRayX, const float *pRayY, int nWidth, int nHeight);
+
+	/**
+	*
+	* @brief	Set thread pool
+	* @details	NULL : single threaded. Default is CCubeEyeThreadPool::Default().
+	* @return	void
+	*
+	*/
+	void SetThreadPool(CCubeEyeThreadPool *pPool) { m_pPool = pPool; }
+
+	/**
+	*
+	* @brief	Convert to cePointCloud
+	* @details	Same layout as ReadPCLFrame output(X, Y, Z in m, I = IR value).
+	* @param	pDepth - depth frame(unit; mm).
+	* @param	pIR - IR frame, NULL : fI = 0.
+	* @param	pPCLFrame - nWidth x nHeight points.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Convert(const uint16 *pDepth, const uint16 *pIR, cePointCloud *pPCLFrame) const;
+
+	/**
+	*
+	* @brief	Convert to separate X/Y/Z/I planes
+	* @details	Planar output for SIMD consumers. pIR / pI may be NULL.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Convert(const uint16 *pDepth, const uint16 *pIR, float *pX, float *pY, float *pZ, float *pI) const;
+
+	/**
+	*
+	* @brief	Convert to SoA point cloud
+	* @details	(Re)allocates cloud as an organized nWidth x nHeight cloud. When the cloud has a
+				validity mask, it is set from depth > 0.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Convert(const uint16 *pDepth, const uint16 *pIR, CCubeEyePointCloud &cloud) const;
+
+	bool IsInitialized() const { return m_pRayX != NULL; }
+	int getWidth() const { return m_nWidth; }
+	int getHeight() const { return m_nHeight; }
+	const float *getRayX() const { return m_pRayX; }
+	const float *getRayY() const { return m_pRayY; }
+
+private:
+
+	CCubeEyeDepthToPCL(const CCubeEyeDepthToPCL &);
+	CCubeEyeDepthToPCL &operator=(const CCubeEyeDepthToPCL &);
+
+	void Release();
+
+	int m_nWidth;
+	int m_nHeight;
+	float *m_pRayTable;			//owned table : RayX plane followed by RayY plane
+	const float *m_pRayX;
+	const float *m_pRayY;
+	CCubeEyeThreadPool *m_pPool;
+};
+
+}
@@ -0,0 +1,162 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeDeviceBase.cpp											*/
+/*																			*/
+/* @brief	Parameter state shared by the host-side CCubeEye stand-ins		*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeDeviceBase.h"
+
+namespace CUBE_EYE
+{
+
+CCubeEyeDeviceBase::CCubeEyeDeviceBase()
+	: m_bConnected(false), m_bPointCloud(false), m_bIllumination(true), m_nDepthOffset(0),
+	m_nAmplitudeThreshold(5), m_nScatteringThreshold(100), m_nBlurCheckThreshold(0)
+{
+	memset(&pDevInfo, 0, sizeof(pDevInfo));
+	memset(&pIntrinsicParam, 0, sizeof(pIntrinsicParam));
+	memset(&pDistortionParam, 0, sizeof(pDistortionParam));
+}
+
+CCubeEyeDeviceBase::~CCubeEyeDeviceBase()
+{
+}
+
+int CCubeEyeDeviceBase::getColorCameraLensParameter(ceIntrinsicParam &pfIntrinsics, ceDistortionParam &pDistortionCoeff)
+{
+	(void)pfIntrinsics;
+	(void)pDistortionCoeff;
+	return CE_UNSUPPORTED;
+}
+
+int CCubeEyeDeviceBase::getDepthColorExtrinsicParameter(ceExtrinsicParam &pfExtrinsics)
+{
+	(void)pfExtrinsics;
+	return CE_UNSUPPORTED;
+}
+
+int CCubeEyeDeviceBase::setDepthOffset(int16 nDepthOfst)
+{
+	m_nDepthOffset = nDepthOfst;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeDeviceBase::getDepthOffset(int16 &nDepthOfst)
+{
+	nDepthOfst = m_nDepthOffset;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeDeviceBase::setAmplitudeCheckThreshold(uint16 nThreshold)
+{
+	if (nThreshold > 4095)
+		return CE_OUTOFRANGE;
+	m_nAmplitudeThreshold = nThreshold;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeDeviceBase::getAmplitudeCheckThreshold(uint16 &nThreshold)
+{
+	nThreshold = m_nAmplitudeThreshold;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeDeviceBase::setScatteringCheckThreshold(uint16 nThreshold)
+{
+	if (nThreshold > 4095)
+		return CE_OUTOFRANGE;
+	m_nScatteringThreshold = nThreshold;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeDeviceBase::getScatteringCheckThreshold(uint16 &nThreshold)
+{
+	nThreshold = m_nScatteringThreshold;
+	return CE_SUCCESS;
+}
+
+//device side filters are not reproduced; the switches are accepted so the call sequence stays the same
+
+int CCubeEyeDeviceBase::setGuidedFilter(uint16 nEpsilon) { (void)nEpsilon; return CE_SUCCESS; }
+int CCubeEyeDeviceBase::clearGuidedFilter() { return CE_SUCCESS; }
+int CCubeEyeDeviceBase::setMedianFilter() { return CE_SUCCESS; }
+int CCubeEyeDeviceBase::clearMedianFilter() { return CE_SUCCESS; }
+int CCubeEyeDeviceBase::setFlyPxlFilter(uint16 nEdgeChkTh) { (void)nEdgeChkTh; return CE_SUCCESS; }
+int CCubeEyeDeviceBase::clearFlyPxlFilter() { return CE_SUCCESS; }
+int CCubeEyeDeviceBase::setTNRFilter(float fRatio) { (void)fRatio; return CE_SUCCESS; }
+int CCubeEyeDeviceBase::clearTNRFilter() { return CE_SUCCESS; }
+int CCubeEyeDeviceBase::setAutoExposureOnOff(bool bEanble) { (void)bEanble; return CE_SUCCESS; }
+int CCubeEyeDeviceBase::setSleepMode(operation_mode mode) { (void)mode; return CE_SUCCESS; }
+int CCubeEyeDeviceBase::setIROutputMode(uint8 nIROutMode) { return nIROutMode > 1 ? CE_INVALID_PARAM : CE_SUCCESS; }
+
+int CCubeEyeDeviceBase::setIlluminationOnOff(bool bEnable)
+{
+	m_bIllumination = bEnable;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeDeviceBase::getIlluminationOnOff(bool &bEnable)
+{
+	bEnable = m_bIllumination;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeDeviceBase::setMotionBlurRemove(uint16 nBlurCheckThrs)
+{
+	if (nBlurCheckThrs > 255)
+		return CE_OUTOFRANGE;
+	m_nBlurCheckThreshold = nBlurCheckThrs;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeDeviceBase::getMotionBlurRemove(uint16 &nBlurCheckThrs)
+{
+	nBlurCheckThrs = m_nBlurCheckThreshold;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeDeviceBase::setDepthToPointCloud()
+{
+	m_bPointCloud = true;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeDeviceBase::clearDepthToPointCloud()
+{
+	m_bPointCloud = false;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeDeviceBase::getFWVersion(uint8 *unFWVersion)
+{
+	if (unFWVersion == NULL)
+		return CE_INVALID_PARAM;
+	memcpy(unFWVersion, pDevInfo.unFWVersion, sizeof(pDevInfo.unFWVersion));
+	return CE_SUCCESS;
+}
+
+int CCubeEyeDeviceBase::getSerialNumber(char *szSerialNumber)
+{
+	if (!m_bConnected)
+		return CE_NOT_OPENED;
+	if (szSerialNumber == NULL)
+		return CE_INVALID_PARAM;
+	memcpy(szSerialNumber, pDevInfo.szSerialNumber, sizeof(pDevInfo.szSerialNumber));
+	return CE_SUCCESS;
+}
+
+int CCubeEyeDeviceBase::getProductName(char *szProductName)
+{
+	if (!m_bConnected)
+		return CE_NOT_OPENED;
+	if (szProductName == NULL)
+		return CE_INVALID_PARAM;
+	memcpy(szProductName, pDevInfo.szProductName, sizeof(pDevInfo.szProductName));
+	return CE_SUCCESS;
+}
+
+}
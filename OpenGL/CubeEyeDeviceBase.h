@@ -0,0 +1,90 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeDeviceBase.h												*/
+/*																			*/
+/* @brief	Parameter state shared by the host-side CCubeEye stand-ins		*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeHostDef.h"
+
+namespace CUBE_EYE
+{
+
+/**
+*
+*@brief		Host-side device parameters
+*@details	The CCubeEye parameter setters / getters that CCubeEyeSim and CCubeEyePlayback
+			implement the same way. Device side filters and exposure are not reproduced on the
+			host; their switches are accepted and the values are kept so that code written
+			against CCubeEye keeps its call sequence and reads back what it set. Each device
+			implements the lens, depth range and frame rate calls itself.
+*
+*/
+class CCubeEyeDeviceBase {
+
+public:
+
+	ceDeviceInfo		pDevInfo;			//Device Infomation
+	ceIntrinsicParam	pIntrinsicParam;	//Depth Camera Intrinsic Param
+	ceDistortionParam	pDistortionParam;	//Depth Camera Distortion Param
+
+	/*************************************************************************************
+	* \defgroup Set/Get ToF Parameters
+	* @{
+	*/
+
+	int getColorCameraLensParameter(ceIntrinsicParam &pfIntrinsics, ceDistortionParam &pDistortionCoeff);
+	int getDepthColorExtrinsicParameter(ceExtrinsicParam &pfExtrinsics);
+	int setDepthOffset(int16 nDepthOfst);
+	int getDepthOffset(int16 &nDepthOfst);
+	int setAmplitudeCheckThreshold(uint16 nThreshold = 5);
+	int getAmplitudeCheckThreshold(uint16 &nThreshold);
+	int setScatteringCheckThreshold(uint16 nThreshold = 100);
+	int getScatteringCheckThreshold(uint16 &nThreshold);
+	int setGuidedFilter(uint16 nEpsilon = 0x8000);
+	int clearGuidedFilter();
+	int setMedianFilter();
+	int clearMedianFilter();
+	int setFlyPxlFilter(uint16 nEdgeChkTh = 300);
+	int clearFlyPxlFilter();
+	int setTNRFilter(float fRatio = 0.5f);
+	int clearTNRFilter();
+	int setAutoExposureOnOff(bool bEanble);
+	int setSleepMode(operation_mode mode);
+	int setIlluminationOnOff(bool bEnable);
+	int getIlluminationOnOff(bool &bEnable);
+	int setMotionBlurRemove(uint16 nBlurCheckThrs);
+	int getMotionBlurRemove(uint16 &nBlurCheckThrs);
+	int setDepthToPointCloud();
+	int clearDepthToPointCloud();
+	int setIROutputMode(uint8 nIROutMode);
+	int getFWVersion(uint8 *unFWVersion);
+	int getSerialNumber(char *szSerialNumber);
+	int getProductName(char *szProductName);
+
+	/**@}*/
+
+protected:
+
+	CCubeEyeDeviceBase();
+	~CCubeEyeDeviceBase();
+
+	bool m_bConnected;
+	bool m_bPointCloud;
+	bool m_bIllumination;
+	int16 m_nDepthOffset;
+	uint16 m_nAmplitudeThreshold;
+	uint16 m_nScatteringThreshold;
+	uint16 m_nBlurCheckThreshold;
+
+private:
+
+	CCubeEyeDeviceBase(const CCubeEyeDeviceBase &);
+	CCubeEyeDeviceBase &operator=(const CCubeEyeDeviceBase &);
+};
+
+}
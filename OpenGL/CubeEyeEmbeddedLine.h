@@ -0,0 +1,365 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeEmbeddedLine.h											*/
+/*																			*/
+/* @brief	Typed embedded line(ceFrameInfo::nEmbeddedLine) decoding		*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeRecord.h"
+#include "CubeEyeThreadPool.h"
+
+#include <string.h>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace CUBE_EYE
+{
+
+#define CE_EMBEDDED_LINE_SIZE	80		//sizeof(ceFrameInfo::nEmbeddedLine)
+
+///Byte order of an embedded line field
+enum embedded_endian {
+	Embedded_Big = 0,
+	Embedded_Little
+};
+
+/*************************************************************************************
+* \defgroup Field descriptions
+* @{
+*/
+
+///Unsigned integer of nSize bytes
+template <size_t nSize> struct ceEmbeddedWord;
+template <> struct ceEmbeddedWord<1> { typedef uint8 Type; };
+template <> struct ceEmbeddedWord<2> { typedef uint16 Type; };
+template <> struct ceEmbeddedWord<4> { typedef uint32 Type; };
+template <> struct ceEmbeddedWord<8> { typedef uint64 Type; };
+
+/**
+*
+*@brief		Embedded line field
+*@details	sizeof(T) bytes at nOffset in eEndian order; nShift / nBits select a bit field of
+			them(unsigned T only). Read decodes straight from the line, so a field costs a few
+			loads and shifts the compiler folds at the call site - nothing is copied or parsed
+			up front. Fields are described once in a layout struct, e.g.
+
+				struct myLayout {
+					typedef CCubeEyeEmbeddedField<uint32, 2> FrameCounter;
+					typedef CCubeEyeEmbeddedField<uint8, 13, Embedded_Big, 0, 1> Illumination;
+					static bool Check(const uint8 *pLine);
+				};
+*
+*/
+template <class T, uint32 nOffset, embedded_endian eEndian = Embedded_Big, uint32 nShift = 0, uint32 nBits = sizeof(T) * 8>
+struct CCubeEyeEmbeddedField
+{
+	static_assert(nOffset + sizeof(T) <= CE_EMBEDDED_LINE_SIZE, "field past the end of the embedded line");
+	static_assert(nBits >= 1 && nShift + nBits <= sizeof(T) * 8, "bit field past the end of the field");
+	static_assert(nBits == sizeof(T) * 8 || std::is_unsigned<T>::value, "bit fields must be unsigned");
+
+	typedef T Type;
+	typedef typename ceEmbeddedWord<sizeof(T)>::Type Word;
+
+	static Word Mask() { return (Word)(nBits == sizeof(T) * 8 ? ~(Word)0 : (((Word)1 << (nBits % (sizeof(T) * 8))) - 1)); }
+
+	static Word ReadWord(const uint8 *pLine)
+	{
+		Word n = 0;
+		for (uint32 i = 0; i < sizeof(T); i++) {
+			uint32 nByte = eEndian == Embedded_Big ? (uint32)sizeof(T) - 1 - i : i;
+			n |= (Word)((Word)pLine[nOffset + i] << (8 * nByte));
+		}
+		return n;
+	}
+
+	static void WriteWord(uint8 *pLine, Word n)
+	{
+		for (uint32 i = 0; i < sizeof(T); i++) {
+			uint32 nByte = eEndian == Embedded_Big ? (uint32)sizeof(T) - 1 - i : i;
+			pLine[nOffset + i] = (uint8)(n >> (8 * nByte));
+		}
+	}
+
+	static T Read(const uint8 *pLine)
+	{
+		Word n = (Word)((ReadWord(pLine) >> nShift) & Mask());
+		T value;
+		memcpy(&value, &n, sizeof(T));
+		return value;
+	}
+
+	///Other bits of the field are kept
+	static void Write(uint8 *pLine, T value)
+	{
+		Word n;
+		memcpy(&n, &value, sizeof(T));
+		Word nMask = (Word)(Mask() << nShift);
+		WriteWord(pLine, (Word)((ReadWord(pLine) & ~nMask) | ((Word)(n << nShift) & nMask)));
+	}
+};
+
+///Fixed point field : TField * nNum / nDen as float
+template <class TField, int nNum, int nDen>
+struct CCubeEyeEmbeddedScaled
+{
+	static_assert(nDen != 0, "zero denominator");
+
+	typedef float Type;
+
+	static float Read(const uint8 *pLine) { return (float)TField::Read(pLine) * ((float)nNum / (float)nDen); }
+
+	static void Write(uint8 *pLine, float fValue)
+	{
+		float fRaw = fValue * ((float)nDen / (float)nNum);
+		TField::Write(pLine, (typename TField::Type)(fRaw < 0.0f ? fRaw - 0.5f : fRaw + 0.5f));
+	}
+};
+
+///Modulo 256 sum of the first nBytes bytes
+inline uint8 ceEmbeddedChecksum(const uint8 *pLine, size_t nBytes)
+{
+	uint32 nSum = 0;
+	for (size_t i = 0; i < nBytes; i++)
+		nSum += pLine[i];
+	return (uint8)nSum;
+}
+
+/**
+*
+*@brief		Embedded line layout of CCubeEyeSim
+*@details	The CubeEye sensor's own layout is not published, so the decoders are exercised
+			with the simulator's(big endian) : a real layout is another struct of the same
+			shape.
+*
+*/
+struct ceSimEmbeddedLayout
+{
+	///0xCE51
+	typedef CCubeEyeEmbeddedField<uint16, 0> Magic;
+	typedef CCubeEyeEmbeddedField<uint32, 2> FrameCounter;
+	///ºC, 0.01 steps
+	typedef CCubeEyeEmbeddedScaled<CCubeEyeEmbeddedField<int16, 6>, 1, 100> SensorTemp;
+	typedef CCubeEyeEmbeddedScaled<CCubeEyeEmbeddedField<int16, 8>, 1, 100> LDTemp;
+	///us
+	typedef CCubeEyeEmbeddedField<uint16, 10> IntegrationTime;
+	///FPS_30, FPS_15, FPS_8
+	typedef CCubeEyeEmbeddedField<uint8, 12> FrameRate;
+	typedef CCubeEyeEmbeddedField<uint8, 13, Embedded_Big, 0, 1> Illumination;
+	typedef CCubeEyeEmbeddedField<uint8, 13, Embedded_Big, 1, 1> PointCloud;
+	///ceEmbeddedChecksum of bytes 0 ~ 78
+	typedef CCubeEyeEmbeddedField<uint8, 79> Checksum;
+
+	static const uint16 MAGIC = 0xCE51;
+
+	static bool Check(const uint8 *pLine)
+	{
+		return Magic::Read(pLine) == MAGIC && Checksum::Read(pLine) == ceEmbeddedChecksum(pLine, CE_EMBEDDED_LINE_SIZE - 1);
+	}
+};
+
+/**@}*/
+
+/**
+*
+*@brief		Embedded line view
+*@details	Wraps the bytes of one line(a ceFrameInfo, a recording chunk header in the mapping)
+			without copying; get<Field>() decodes the field on access.
+*
+*/
+template <class TLayout>
+class CCubeEyeEmbeddedView {
+
+public:
+
+	explicit CCubeEyeEmbeddedView(const uint8 *pLine) : m_pLine(pLine) {}
+	explicit CCubeEyeEmbeddedView(const ceFrameInfo &stInfo) : m_pLine(stInfo.nEmbeddedLine) {}
+	explicit CCubeEyeEmbeddedView(const ceRecFrameInfo &stInfo) : m_pLine(stInfo.nEmbeddedLine) {}
+
+	///Magic / checksum of the layout
+	bool IsValid() const { return TLayout::Check(m_pLine); }
+
+	template <class TField>
+	typename TField::Type get() const { return TField::Read(m_pLine); }
+
+	const uint8 *getLine() const { return m_pLine; }
+
+private:
+
+	const uint8 *m_pLine;
+};
+
+///Position of TField in TFields
+template <class TField, class... TFields> struct ceEmbeddedIndex;
+template <class TField, class... TRest>
+struct ceEmbeddedIndex<TField, TField, TRest...> { enum { value = 0 }; };
+template <class TField, class TFirst, class... TRest>
+struct ceEmbeddedIndex<TField, TFirst, TRest...> { enum { value = 1 + ceEmbeddedIndex<TField, TRest...>::value }; };
+
+/**
+*
+*@brief		Columnar embedded line extraction
+*@details	Decodes TFields of many frames into one array per field(plus a validity column from
+			TLayout::Check), so a filter over an hour long recording scans a few small arrays.
+			From a recording only the chunk headers in the mapping are read - no payload is
+			touched or decoded. Frames are extracted in parallel bands on the thread pool; the
+			columns are kept between extractions and only grow.
+*
+*/
+template <class TLayout, class... TFields>
+class CCubeEyeEmbeddedColumns {
+
+public:
+
+	CCubeEyeEmbeddedColumns() : m_pPool(&CCubeEyeThreadPool::Default()), m_nFirst(0), m_nRows(0) {}
+
+	/**
+	*
+	* @brief	Set thread pool
+	* @details	NULL : single threaded. Default is CCubeEyeThreadPool::Default().
+	* @return	void
+	*
+	*/
+	void SetThreadPool(CCubeEyeThreadPool *pPool) { m_pPool = pPool; }
+
+	/**
+	*
+	* @brief	Extract from a recording
+	* @param	nBegin, nEnd - frame indices [nBegin, nEnd) of the reader(append order).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Extract(const CCubeEyeRecordReader &reader, uint64 nBegin, uint64 nEnd)
+	{
+		if (nBegin > nEnd || nEnd > reader.getFrameCount())
+			return CE_OUTOFRANGE;
+
+		std::atomic<bool> bFailed(false);
+		const CCubeEyeRecordReader *pReader = &reader;
+		Run(nBegin, (size_t)(nEnd - nBegin), [pReader, &bFailed](uint64 nFrame) -> const uint8 * {
+			const ceRecChunkHeader *pChunk = pReader->getChunk(nFrame);
+			if (pChunk == NULL) {
+				bFailed.store(true, std::memory_order_relaxed);
+				return NULL;
+			}
+			return pChunk->stInfo.nEmbeddedLine;
+		});
+		return bFailed.load() ? CE_FAILED : CE_SUCCESS;
+	}
+
+	/**
+	*
+	* @brief	Extract from captured frame information
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Extract(const ceFrameInfo *pInfos, size_t nCount)
+	{
+		if (pInfos == NULL && nCount > 0)
+			return CE_INVALID_PARAM;
+
+		Run(0, nCount, [pInfos](uint64 nFrame) -> const uint8 * { return pInfos[nFrame].nEmbeddedLine; });
+		return CE_SUCCESS;
+	}
+
+	///Rows of the last extraction; row i is frame getFirst() + i
+	size_t getRows() const { return m_nRows; }
+	uint64 getFirst() const { return m_nFirst; }
+
+	template <class TField>
+	const typename TField::Type *get() const
+	{
+		return std::get<ceEmbeddedIndex<TField, TFields...>::value>(m_columns).data();
+	}
+
+	///1 : the line passed TLayout::Check
+	const uint8 *getValid() const { return m_vValid.data(); }
+
+	/**
+	*
+	* @brief	Select frames
+	* @details	Frame indices(getFirst() based) of the valid rows whose TField value satisfies
+				predicate.
+	* @return	void
+	*
+	*/
+	template <class TField, class TPredicate>
+	void Select(const TPredicate &predicate, Vector<uint64> &vFrames) const
+	{
+		const typename TField::Type *pColumn = get<TField>();
+		vFrames.clear();
+		for (size_t i = 0; i < m_nRows; i++) {
+			if (m_vValid[i] && predicate(pColumn[i]))
+				vFrames.push_back(m_nFirst + i);
+		}
+	}
+
+private:
+
+	CCubeEyeEmbeddedColumns(const CCubeEyeEmbeddedColumns &);
+	CCubeEyeEmbeddedColumns &operator=(const CCubeEyeEmbeddedColumns &);
+
+	template <size_t... nColumns>
+	void Resize(size_t nRows, std::index_sequence<nColumns...>)
+	{
+		int nDummy[] = { 0, (std::get<nColumns>(m_columns).resize(nRows), 0)... };
+		(void)nDummy;
+	}
+
+	template <size_t... nColumns>
+	void DecodeRow(size_t nRow, const uint8 *pLine, std::index_sequence<nColumns...>)
+	{
+		int nDummy[] = { 0, (std::get<nColumns>(m_columns)[nRow] = TFields::Read(pLine), 0)... };
+		(void)nDummy;
+	}
+
+	template <size_t... nColumns>
+	void ClearRow(size_t nRow, std::index_sequence<nColumns...>)
+	{
+		int nDummy[] = { 0, (std::get<nColumns>(m_columns)[nRow] = typename TFields::Type(), 0)... };
+		(void)nDummy;
+	}
+
+	template <class TLineAt>
+	void Run(uint64 nFirst, size_t nRows, const TLineAt &lineAt)
+	{
+		typedef std::index_sequence_for<TFields...> Columns;
+		m_nFirst = nFirst;
+		m_nRows = nRows;
+		Resize(nRows, Columns());
+		m_vValid.resize(nRows);
+
+		auto rows = [&](int nBandBegin, int nBandEnd) {
+			size_t nEnd = (size_t)nBandEnd * ROW_BAND < nRows ? (size_t)nBandEnd * ROW_BAND : nRows;
+			for (size_t i = (size_t)nBandBegin * ROW_BAND; i < nEnd; i++) {
+				const uint8 *pLine = lineAt(nFirst + i);
+				if (pLine == NULL) {
+					m_vValid[i] = 0;
+					ClearRow(i, Columns());
+					continue;
+				}
+				m_vValid[i] = TLayout::Check(pLine) ? 1 : 0;
+				DecodeRow(i, pLine, Columns());
+			}
+		};
+		int nBands = (int)((nRows + ROW_BAND - 1) / ROW_BAND);
+		if (m_pPool != NULL)
+			m_pPool->ParallelFor(0, nBands, 1, rows);
+		else
+			rows(0, nBands);
+	}
+
+	enum { ROW_BAND = 1024 };			//frames per task
+
+	CCubeEyeThreadPool *m_pPool;
+	uint64 m_nFirst;
+	size_t m_nRows;
+	std::tuple<Vector<typename TFields::Type>...> m_columns;
+	Vector<uint8> m_vValid;
+};
+
+}
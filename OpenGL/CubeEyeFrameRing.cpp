@@ -0,0 +1,324 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeFrameRing.cpp											*/
+/*																			*/
+/* @brief	Zero-copy Depth/IR frame ring for CCubeEye capture				*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeFrameRing.h"
+#include "CubeEyeTelemetry.h"
+
+#include <chrono>
+
+namespace CUBE_EYE
+{
+
+//slot state : bit31 = producer is writing, bit0~30 = number of borrowing consumers
+static const uint32 SLOT_WRITING = 0x80000000U;
+
+struct CCubeEyeFrameRing::Slot
+{
+	std::atomic<uint32> nState;
+	std::atomic<uint64> nSeq;
+	uint16 *pDepth;
+	uint16 *pIR;
+	ceFrameInfo stFrameInfo;
+	//keeps the state words of neighbouring slots on different cache lines
+	uint8 pPadding[CE_CACHE_LINE];
+};
+
+/*************************************************************************************
+* CFrameRef
+*/
+
+CCubeEyeFrameRing::CFrameRef &CCubeEyeFrameRing::CFrameRef::operator=(CFrameRef &&other)
+{
+	if (this != &other) {
+		Release();
+		m_pSlot = other.m_pSlot;
+		other.m_pSlot = NULL;
+	}
+	return *this;
+}
+
+void CCubeEyeFrameRing::CFrameRef::Release()
+{
+	if (m_pSlot != NULL) {
+		m_pSlot->nState.fetch_sub(1, std::memory_order_release);
+		m_pSlot = NULL;
+	}
+}
+
+CCubeEyeFrameRing::CFrameRef CCubeEyeFrameRing::CFrameRef::Share() const
+{
+	//the slot is held by this reference, so the producer can not be writing it
+	CFrameRef other;
+	if (m_pSlot != NULL) {
+		m_pSlot->nState.fetch_add(1, std::memory_order_relaxed);
+		other.m_pSlot = m_pSlot;
+	}
+	return other;
+}
+
+const uint16 *CCubeEyeFrameRing::CFrameRef::getDepth() const
+{
+	return m_pSlot->pDepth;
+}
+
+const uint16 *CCubeEyeFrameRing::CFrameRef::getIR() const
+{
+	return m_pSlot->pIR;
+}
+
+const ceFrameInfo &CCubeEyeFrameRing::CFrameRef::getFrameInfo() const
+{
+	return m_pSlot->stFrameInfo;
+}
+
+uint64 CCubeEyeFrameRing::CFrameRef::getSequence() const
+{
+	return m_pSlot->nSeq.load(std::memory_order_relaxed);
+}
+
+/*************************************************************************************
+* CCubeEyeFrameRing
+*/
+
+CCubeEyeFrameRing::CCubeEyeFrameRing()
+	: m_nWidth(0), m_nHeight(0), m_nSlotCount(0), m_nNextSlot(0),
+	m_pSlots(NULL), m_pSeqSlot(NULL), m_pFrameBuffer(NULL), m_pScratch(NULL), m_pTelemetry(NULL),
+	m_bCapturing(false), m_nPublished(0), m_nDropped(0), m_nReadErrors(0), m_nWaiters(0)
+{
+}
+
+CCubeEyeFrameRing::~CCubeEyeFrameRing()
+{
+	Destroy();
+}
+
+int CCubeEyeFrameRing::Create(int nWidth, int nHeight, int nSlotCount)
+{
+	if (nWidth <= 0 || nHeight <= 0 || nSlotCount < 2)
+		return CE_INVALID_PARAM;
+	if (m_bCapturing.load())
+		return CE_FAILED;
+
+	Destroy();
+
+	//plane size rounded up so that every plane stays SIMD aligned
+	size_t nPlane = ((size_t)nWidth * nHeight * sizeof(uint16) + CE_SIMD_ALIGN - 1) & ~(size_t)(CE_SIMD_ALIGN - 1);
+
+	m_pFrameBuffer = (uint8 *)ceAlignedAlloc(nPlane * 2 * (nSlotCount + 1));
+	if (m_pFrameBuffer == NULL)
+		return CE_FAILED;
+
+	m_pSlots = new Slot[nSlotCount];
+	m_pSeqSlot = new std::atomic<uint32>[nSlotCount];
+	for (int i = 0; i < nSlotCount; i++) {
+		m_pSlots[i].nState.store(0);
+		m_pSlots[i].nSeq.store(0);
+		m_pSlots[i].pDepth = (uint16 *)(m_pFrameBuffer + nPlane * (2 * i));
+		m_pSlots[i].pIR = (uint16 *)(m_pFrameBuffer + nPlane * (2 * i + 1));
+		memset(&m_pSlots[i].stFrameInfo, 0, sizeof(ceFrameInfo));
+		m_pSeqSlot[i].store(0);
+	}
+	//last pair is the drop target when every slot is borrowed
+	m_pScratch = (uint16 *)(m_pFrameBuffer + nPlane * (2 * nSlotCount));
+
+	m_nWidth = nWidth;
+	m_nHeight = nHeight;
+	m_nSlotCount = nSlotCount;
+	m_nNextSlot = 0;
+	m_nPublished.store(0);
+	m_nDropped.store(0);
+	m_nReadErrors.store(0);
+
+	return CE_SUCCESS;
+}
+
+void CCubeEyeFrameRing::Destroy()
+{
+	StopCapture();
+
+	delete[] m_pSlots;
+	delete[] m_pSeqSlot;
+	if (m_pFrameBuffer != NULL)
+		ceAlignedFree(m_pFrameBuffer);
+
+	m_pSlots = NULL;
+	m_pSeqSlot = NULL;
+	m_pFrameBuffer = NULL;
+	m_pScratch = NULL;
+	m_nSlotCount = 0;
+}
+
+int CCubeEyeFrameRing::StartCapture(ReadFunc readFunc)
+{
+	if (m_pSlots == NULL)
+		return CE_NOT_OPENED;
+	if (!readFunc)
+		return CE_INVALID_PARAM;
+	if (m_bCapturing.exchange(true))
+		return CE_FAILED;
+
+	m_readFunc = readFunc;
+	m_captureThread = std::thread(&CCubeEyeFrameRing::CaptureThread, this);
+
+	return CE_SUCCESS;
+}
+
+int CCubeEyeFrameRing::StopCapture()
+{
+	if (!m_bCapturing.exchange(false))
+		return CE_SUCCESS;
+
+	if (m_captureThread.joinable())
+		m_captureThread.join();
+	m_readFunc = nullptr;
+
+	//wake up consumers still waiting for a frame
+	std::lock_guard<std::mutex> lock(m_waitMutex);
+	m_waitCond.notify_all();
+
+	return CE_SUCCESS;
+}
+
+CCubeEyeFrameRing::Slot *CCubeEyeFrameRing::ClaimSlot()
+{
+	//round robin from the oldest slot, skipping slots borrowed by consumers
+	for (int i = 0; i < m_nSlotCount; i++) {
+		int nIndex = (m_nNextSlot + i) % m_nSlotCount;
+		uint32 nExpected = 0;
+		if (m_pSlots[nIndex].nState.compare_exchange_strong(nExpected, SLOT_WRITING, std::memory_order_acquire)) {
+			m_nNextSlot = (nIndex + 1) % m_nSlotCount;
+			return &m_pSlots[nIndex];
+		}
+	}
+	return NULL;
+}
+
+void CCubeEyeFrameRing::CaptureThread()
+{
+	ceFrameInfo stDropInfo;
+
+	while (m_bCapturing.load(std::memory_order_relaxed)) {
+		Slot *pSlot = ClaimSlot();
+		TimeStampType nReadStart = m_pTelemetry != NULL ? ceHostTimeStamp() : 0;
+
+		if (pSlot == NULL) {
+			//every slot is borrowed : keep draining the device so latency does not build up
+			if (m_readFunc(m_pScratch, m_pScratch + (size_t)m_nWidth * m_nHeight, stDropInfo) < 0) {
+				m_nReadErrors.fetch_add(1, std::memory_order_relaxed);
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			else {
+				m_nDropped.fetch_add(1, std::memory_order_relaxed);
+				if (m_pTelemetry != NULL)
+					m_pTelemetry->OnFrame(stDropInfo, nReadStart, ceHostTimeStamp());
+			}
+			continue;
+		}
+
+		if (m_readFunc(pSlot->pDepth, pSlot->pIR, pSlot->stFrameInfo) < 0) {
+			m_nReadErrors.fetch_add(1, std::memory_order_relaxed);
+			pSlot->nState.store(0, std::memory_order_release);
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+		if (m_pTelemetry != NULL)
+			m_pTelemetry->OnFrame(pSlot->stFrameInfo, nReadStart, ceHostTimeStamp());
+
+		uint64 nSeq = m_nPublished.load(std::memory_order_relaxed) + 1;
+		pSlot->nSeq.store(nSeq, std::memory_order_relaxed);
+		m_pSeqSlot[nSeq % m_nSlotCount].store((uint32)(pSlot - m_pSlots), std::memory_order_relaxed);
+		pSlot->nState.store(0, std::memory_order_release);
+		m_nPublished.store(nSeq, std::memory_order_release);
+
+		if (m_nWaiters.load(std::memory_order_acquire) > 0) {
+			std::lock_guard<std::mutex> lock(m_waitMutex);
+			m_waitCond.notify_all();
+		}
+	}
+}
+
+bool CCubeEyeFrameRing::TryAcquire(uint64 nSeq, CFrameRef &pFrame)
+{
+	Slot *pSlot = &m_pSlots[m_pSeqSlot[nSeq % m_nSlotCount].load(std::memory_order_acquire)];
+
+	uint32 nState = pSlot->nState.load(std::memory_order_relaxed);
+	do {
+		if (nState & SLOT_WRITING)
+			return false;
+	} while (!pSlot->nState.compare_exchange_weak(nState, nState + 1, std::memory_order_acquire));
+
+	//the slot may have been recycled between the table lookup and the borrow
+	if (pSlot->nSeq.load(std::memory_order_relaxed) != nSeq) {
+		pSlot->nState.fetch_sub(1, std::memory_order_release);
+		return false;
+	}
+
+	pFrame = CFrameRef();
+	pFrame.m_pSlot = pSlot;
+	return true;
+}
+
+bool CCubeEyeFrameRing::WaitPublished(uint64 nSeq, uint32 nTimeoutMs)
+{
+	if (m_nPublished.load(std::memory_order_acquire) >= nSeq)
+		return true;
+	if (nTimeoutMs == 0)
+		return false;
+
+	std::unique_lock<std::mutex> lock(m_waitMutex);
+	m_nWaiters.fetch_add(1, std::memory_order_acq_rel);
+	bool bReady = m_waitCond.wait_for(lock, std::chrono::milliseconds(nTimeoutMs), [this, nSeq] {
+		return m_nPublished.load(std::memory_order_acquire) >= nSeq || !m_bCapturing.load();
+	});
+	m_nWaiters.fetch_sub(1, std::memory_order_acq_rel);
+
+	return bReady && m_nPublished.load(std::memory_order_acquire) >= nSeq;
+}
+
+int CCubeEyeFrameRing::AcquireLatest(CFrameRef &pFrame, uint32 nTimeoutMs)
+{
+	if (m_pSlots == NULL)
+		return CE_NOT_OPENED;
+	if (!WaitPublished(1, nTimeoutMs))
+		return CE_GETFRAME_FAILED;
+
+	//the newest frame can only be lost to a full lap of the ring, so retry from the new head
+	for (;;) {
+		uint64 nSeq = m_nPublished.load(std::memory_order_acquire);
+		if (TryAcquire(nSeq, pFrame))
+			return CE_SUCCESS;
+		if (m_nPublished.load(std::memory_order_acquire) == nSeq)
+			return CE_GETFRAME_FAILED;
+	}
+}
+
+int CCubeEyeFrameRing::AcquireNext(CFrameRef &pFrame, uint64 nAfterSeq, uint32 nTimeoutMs)
+{
+	if (m_pSlots == NULL)
+		return CE_NOT_OPENED;
+	if (!WaitPublished(nAfterSeq + 1, nTimeoutMs))
+		return CE_GETFRAME_FAILED;
+
+	for (;;) {
+		uint64 nPublished = m_nPublished.load(std::memory_order_acquire);
+		uint64 nSeq = nAfterSeq + 1;
+		if (nPublished >= (uint64)m_nSlotCount && nSeq <= nPublished - m_nSlotCount)
+			nSeq = nPublished - m_nSlotCount + 1;
+
+		for (; nSeq <= nPublished; nSeq++) {
+			if (TryAcquire(nSeq, pFrame))
+				return CE_SUCCESS;
+		}
+		if (m_nPublished.load(std::memory_order_acquire) == nPublished)
+			return CE_GETFRAME_FAILED;
+	}
+}
+
+}
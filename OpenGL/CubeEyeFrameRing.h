@@ -0,0 +1,267 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeFrameRing.h												*/
+/*																			*/
+/* @brief	Zero-copy Depth/IR frame ring for CCubeEye capture				*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeHostDef.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace CUBE_EYE
+{
+
+class CCubeEyeTelemetry;
+
+/**
+*
+*@brief		Preallocated single-producer / multi-consumer Depth/IR ring
+*@details	A capture thread reads frames straight into ring slots(Depth + IR + ceFrameInfo).
+			Consumers borrow a slot by reference(CFrameRef) and release it when done,
+			so a frame is copied exactly once - by the SDK - and nothing is allocated
+			after Create(). A borrowed slot is never overwritten; the producer skips it,
+			and drops the frame when every slot is borrowed.
+*
+*/
+class CCubeEyeFrameRing {
+
+public:
+
+	///Frame source, same signature as CCubeEye::ReadDepthIRFrame
+	typedef std::function<int(uint16 *pDepth, uint16 *pIR, ceFrameInfo &pFrameInfo)> ReadFunc;
+
+private:
+
+	struct Slot;
+
+public:
+
+	/**
+	*
+	*@brief		Borrowed ring slot
+	*@details	Holds a read reference on one slot until Release() or destruction.
+				Move only.
+	*
+	*/
+	class CFrameRef {
+
+		friend class CCubeEyeFrameRing;
+
+	public:
+
+		CFrameRef() : m_pSlot(NULL) {}
+		CFrameRef(CFrameRef &&other) : m_pSlot(other.m_pSlot) { other.m_pSlot = NULL; }
+		CFrameRef &operator=(CFrameRef &&other);
+		~CFrameRef() { Release(); }
+
+		/**
+		*
+		* @brief	Release slot
+		* @details	Gives the slot back to the producer. Safe to call more than once.
+		* @return	void
+		*
+		*/
+		void Release();
+
+		bool IsValid() const { return m_pSlot != NULL; }
+
+		/**
+		*
+		* @brief	Share slot
+		* @details	Returns another reference to the same frame(one more reader on the slot),
+					for handing one frame to several consumers. Empty when this one is.
+		* @return	new reference
+		*
+		*/
+		CFrameRef Share() const;
+
+		const uint16 *getDepth() const;
+		const uint16 *getIR() const;
+		const ceFrameInfo &getFrameInfo() const;
+
+		///Ring sequence number(1, 2, ...) of the borrowed frame
+		uint64 getSequence() const;
+
+	private:
+
+		CFrameRef(const CFrameRef &);
+		CFrameRef &operator=(const CFrameRef &);
+
+		Slot *m_pSlot;
+	};
+
+	CCubeEyeFrameRing();
+	~CCubeEyeFrameRing();
+
+	/*************************************************************************************
+	* \defgroup Initialization
+	* @{
+	*/
+
+	/**
+	*
+	* @brief	Create ring
+	* @details	Allocates every slot up front. Must not be called while capturing.
+	* @param	nWidth, nHeight - frame size(ceDeviceInfo nWidth/nHeight).
+	* @param	nSlotCount(2~) - number of slots; bounds the memory used by the ring.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Create(int nWidth, int nHeight, int nSlotCount = 8);
+
+	/**
+	*
+	* @brief	Destroy ring
+	* @details	Stops capturing and frees the slots. Every CFrameRef must be released first.
+	* @return	void
+	*
+	*/
+	void Destroy();
+
+	/**
+	*
+	* @brief	Set telemetry
+	* @details	The capture thread reports every frame read(receipt latency, read duration,
+				nFrameID gaps, sensor values) to pTelemetry. NULL : none. Must not be called
+				while capturing; pTelemetry must outlive the capture.
+	* @return	void
+	*
+	*/
+	void SetTelemetry(CCubeEyeTelemetry *pTelemetry) { m_pTelemetry = pTelemetry; }
+
+	/**@}*/
+
+	/*************************************************************************************
+	* \defgroup Start/Stop Capture
+	* @{
+	*/
+
+	/**
+	*
+	* @brief	Start capture thread
+	* @details	Starts a thread that calls readFunc into the next free slot until StopCapture().
+	* @param	readFunc - frame source.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int StartCapture(ReadFunc readFunc);
+
+	/**
+	*
+	* @brief	Start capture thread
+	* @details	Captures from any device exposing ReadDepthIRFrame(CCubeEye, CCubeEyeSim, ...).
+				The device must already be started and must outlive the capture.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	template <class TDevice>
+	int StartCapture(TDevice &device)
+	{
+		TDevice *pDevice = &device;
+		return StartCapture([pDevice](uint16 *pDepth, uint16 *pIR, ceFrameInfo &pFrameInfo) {
+			return pDevice->ReadDepthIRFrame(pDepth, pIR, pFrameInfo);
+		});
+	}
+
+	/**
+	*
+	* @brief	Stop capture thread
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int StopCapture();
+
+	/**@}*/
+
+	/*************************************************************************************
+	* \defgroup Borrow Frame
+	* @{
+	*/
+
+	/**
+	*
+	* @brief	Borrow newest frame
+	* @details	Borrows the most recently published frame. Waits up to nTimeoutMs
+				when nothing has been published yet.
+	* @param	pFrame - receives the borrowed slot.
+	* @param	nTimeoutMs - wait time(unit; ms).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int AcquireLatest(CFrameRef &pFrame, uint32 nTimeoutMs = 100);
+
+	/**
+	*
+	* @brief	Borrow next frame
+	* @details	Borrows the oldest frame still in the ring whose sequence is greater than nAfterSeq.
+				Each consumer passes the sequence of the last frame it saw, so several consumers
+				can walk the same stream independently. Frames overwritten before the consumer
+				got to them are skipped.
+	* @param	pFrame - receives the borrowed slot.
+	* @param	nAfterSeq - last sequence seen by this consumer(0 : from the oldest frame).
+	* @param	nTimeoutMs - wait time(unit; ms).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int AcquireNext(CFrameRef &pFrame, uint64 nAfterSeq, uint32 nTimeoutMs = 100);
+
+	/**@}*/
+
+	int getWidth() const { return m_nWidth; }
+	int getHeight() const { return m_nHeight; }
+	int getSlotCount() const { return m_nSlotCount; }
+
+	///Number of frames published to consumers
+	uint64 getPublishedCount() const { return m_nPublished.load(std::memory_order_acquire); }
+	///Number of frames dropped because every slot was borrowed
+	uint64 getDroppedCount() const { return m_nDropped.load(std::memory_order_relaxed); }
+	///Number of failed ReadFunc calls
+	uint64 getReadErrorCount() const { return m_nReadErrors.load(std::memory_order_relaxed); }
+
+private:
+
+	CCubeEyeFrameRing(const CCubeEyeFrameRing &);
+	CCubeEyeFrameRing &operator=(const CCubeEyeFrameRing &);
+
+	void CaptureThread();
+	Slot *ClaimSlot();
+	bool TryAcquire(uint64 nSeq, CFrameRef &pFrame);
+	bool WaitPublished(uint64 nSeq, uint32 nTimeoutMs);
+
+	int m_nWidth;
+	int m_nHeight;
+	int m_nSlotCount;
+	int m_nNextSlot;
+
+	Slot *m_pSlots;
+	std::atomic<uint32> *m_pSeqSlot;
+	uint8 *m_pFrameBuffer;
+	uint16 *m_pScratch;
+
+	ReadFunc m_readFunc;
+	CCubeEyeTelemetry *m_pTelemetry;
+	std::thread m_captureThread;
+	std::atomic<bool> m_bCapturing;
+
+	//producer / consumer counters are padded apart to avoid false sharing
+	uint8 m_pPadding0[CE_CACHE_LINE];
+	std::atomic<uint64> m_nPublished;
+	std::atomic<uint64> m_nDropped;
+	std::atomic<uint64> m_nReadErrors;
+
+	uint8 m_pPadding1[CE_CACHE_LINE];
+	std::atomic<int> m_nWaiters;
+	std::mutex m_waitMutex;
+	std::condition_variable m_waitCond;
+};
+
+}
@@ -0,0 +1,96 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeHostDef.h												*/
+/*																			*/
+/* @brief	Common definitions for the host-side CubeEye processing code	*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#ifndef _CUBEEYEHOSTDEF_H_
+#define _CUBEEYEHOSTDEF_H_
+
+#include "CubeEye.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <new>
+#include <chrono>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+///Cache line size used to keep producer/consumer state apart
+#define CE_CACHE_LINE 64
+
+///Alignment of every host frame buffer(enough for AVX2 / NEON loads)
+#define CE_SIMD_ALIGN 32
+
+///SIMD kernels are selected at compile time(/arch:AVX2, -mavx2, ARM NEON); otherwise plain C++.
+///OpenGL.vcxproj sets /arch:AVX2 only on the files with AVX2 kernels, which need an AVX2 CPU.
+#if defined(__AVX2__)
+#define CE_USE_AVX2
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define CE_USE_NEON
+#include <arm_neon.h>
+#endif
+
+typedef int64_t int64;
+typedef uint64_t uint64;
+
+namespace CUBE_EYE
+{
+
+/**
+*
+* @brief	Aligned allocation
+* @details	Allocates nSize bytes aligned to nAlign(power of two).
+* @return	Pointer to the memory | NULL
+*
+*/
+inline void *ceAlignedAlloc(size_t nSize, size_t nAlign = CE_SIMD_ALIGN)
+{
+#ifdef _MSC_VER
+	return _aligned_malloc(nSize, nAlign);
+#else
+	void *p = NULL;
+	if (posix_memalign(&p, nAlign, nSize) != 0)
+		return NULL;
+	return p;
+#endif
+}
+
+/**
+*
+* @brief	Aligned free
+* @details	Frees memory returned by ceAlignedAlloc.
+*
+*/
+inline void ceAlignedFree(void *p)
+{
+#ifdef _MSC_VER
+	_aligned_free(p);
+#else
+	free(p);
+#endif
+}
+
+/**
+*
+* @brief	Host time stamp
+* @details	Monotonic host clock used to stamp frames produced on the host(unit; us).
+* @return	time stamp
+*
+*/
+inline TimeStampType ceHostTimeStamp()
+{
+	return (TimeStampType)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+
+#endif
@@ -0,0 +1,800 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeHostFilter.cpp											*/
+/*																			*/
+/* @brief	Host-side depth filters(SDK filter equivalents)					*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeHostFilter.h"
+
+namespace CUBE_EYE
+{
+
+#define ROW_GRAIN			16
+#define GUIDED_RADIUS		2
+#define GUIDED_PLANES		5		//vertical sums N / S / Q, coefficients A / B
+
+/*************************************************************************************
+* compare-exchange primitives : the median network is written once for every vector type
+*/
+
+static inline void Sort2(uint16 &a, uint16 &b)
+{
+	uint16 t = a < b ? a : b;
+	b = a < b ? b : a;
+	a = t;
+}
+
+#if defined(CE_USE_AVX2)
+static inline void Sort2(__m256i &a, __m256i &b)
+{
+	__m256i t = _mm256_min_epu16(a, b);
+	b = _mm256_max_epu16(a, b);
+	a = t;
+}
+#elif defined(CE_USE_NEON)
+static inline void Sort2(uint16x8_t &a, uint16x8_t &b)
+{
+	uint16x8_t t = vminq_u16(a, b);
+	b = vmaxq_u16(a, b);
+	a = t;
+}
+#endif
+
+/*************************************************************************************
+* invalid neighbours of a median window : every other 0 is turned into 0xFFFF, so as many
+* holes sort below the valid samples as above and the median of the 9 is the(lower) median
+* of the valid ones. p[4] is the centre and is left alone.
+*/
+
+static inline void SplitHoles(uint16 *p)
+{
+	uint16 t = 0;
+	for (int k = 0; k < 9; k++) {
+		if (k == 4)
+			continue;
+		uint16 z = p[k] == 0 ? 0xFFFF : 0;
+		p[k] |= z & t;
+		t ^= z;
+	}
+}
+
+//0 where the centre is 0
+static inline uint16 KeepHole(uint16 center, uint16 median)
+{
+	return center == 0 ? 0 : median;
+}
+
+#if defined(CE_USE_AVX2)
+static inline void SplitHoles(__m256i *p)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i t = zero;
+	for (int k = 0; k < 9; k++) {
+		if (k == 4)
+			continue;
+		__m256i z = _mm256_cmpeq_epi16(p[k], zero);
+		p[k] = _mm256_or_si256(p[k], _mm256_and_si256(z, t));
+		t = _mm256_xor_si256(t, z);
+	}
+}
+
+static inline __m256i KeepHole(__m256i center, __m256i median)
+{
+	return _mm256_andnot_si256(_mm256_cmpeq_epi16(center, _mm256_setzero_si256()), median);
+}
+#elif defined(CE_USE_NEON)
+static inline void SplitHoles(uint16x8_t *p)
+{
+	uint16x8_t t = vdupq_n_u16(0);
+	for (int k = 0; k < 9; k++) {
+		if (k == 4)
+			continue;
+		uint16x8_t z = vceqq_u16(p[k], vdupq_n_u16(0));
+		p[k] = vorrq_u16(p[k], vandq_u16(z, t));
+		t = veorq_u16(t, z);
+	}
+}
+
+static inline uint16x8_t KeepHole(uint16x8_t center, uint16x8_t median)
+{
+	return vbicq_u16(median, vceqq_u16(center, vdupq_n_u16(0)));
+}
+#endif
+
+template <class V>
+static inline V Median9(V *p)
+{
+	//19 exchange network(Paeth), median ends in p[4]
+	Sort2(p[1], p[2]); Sort2(p[4], p[5]); Sort2(p[7], p[8]);
+	Sort2(p[0], p[1]); Sort2(p[3], p[4]); Sort2(p[6], p[7]);
+	Sort2(p[1], p[2]); Sort2(p[4], p[5]); Sort2(p[7], p[8]);
+	Sort2(p[0], p[3]); Sort2(p[5], p[8]); Sort2(p[4], p[7]);
+	Sort2(p[3], p[6]); Sort2(p[1], p[4]); Sort2(p[2], p[5]);
+	Sort2(p[4], p[7]); Sort2(p[4], p[2]); Sort2(p[6], p[4]);
+	Sort2(p[4], p[2]);
+	return p[4];
+}
+
+static inline uint16 AbsDiff(uint16 a, uint16 b)
+{
+	return a > b ? a - b : b - a;
+}
+
+/*************************************************************************************
+* border pixels : windows clipped to the frame, scalar
+*/
+
+//jump to both neighbours of an axis, to the one inside the frame on the border
+static inline bool IsJump(uint16 c, const uint16 *pA, const uint16 *pB, uint16 nTh)
+{
+	if (pA == NULL && pB == NULL)
+		return false;
+	return (pA == NULL || AbsDiff(c, *pA) > nTh) && (pB == NULL || AbsDiff(c, *pB) > nTh);
+}
+
+static uint16 FlyingPixelAt(const uint16 *pSrc, int nWidth, int nHeight, int x, int y, uint16 nTh)
+{
+	const uint16 *pC = pSrc + (size_t)y * nWidth + x;
+	bool bJumpH = IsJump(*pC, x > 0 ? pC - 1 : NULL, x < nWidth - 1 ? pC + 1 : NULL, nTh);
+	bool bJumpV = IsJump(*pC, y > 0 ? pC - nWidth : NULL, y < nHeight - 1 ? pC + nWidth : NULL, nTh);
+	return (bJumpH || bJumpV) ? 0 : *pC;
+}
+
+//samples outside the frame are holes, so the median is the one of the valid samples inside
+static uint16 MedianAt(const uint16 *pSrc, int nWidth, int nHeight, int x, int y)
+{
+	uint16 p[9];
+	for (int j = 0; j < 3; j++) {
+		for (int i = 0; i < 3; i++) {
+			int xx = x - 1 + i, yy = y - 1 + j;
+			bool bInside = xx >= 0 && xx < nWidth && yy >= 0 && yy < nHeight;
+			p[j * 3 + i] = bInside ? pSrc[(size_t)yy * nWidth + xx] : 0;
+		}
+	}
+	uint16 center = p[4];
+	SplitHoles(p);
+	return KeepHole(center, Median9(p));
+}
+
+/*************************************************************************************
+* CCubeEyeHostFilter
+*/
+
+CCubeEyeHostFilter::CCubeEyeHostFilter()
+	: m_nWidth(0), m_nHeight(0), m_pPool(&CCubeEyeThreadPool::Default()),
+	m_nAmplitudeThreshold(0), m_nScatteringThreshold(0), m_bMedian(false), m_bFlyingPixel(false), m_nEdgeThreshold(300),
+	m_bGuided(false), m_fEpsilon(0x8000 / 256.0f), m_bTNR(false), m_nTNRWeight(0x4000), m_nMotionThreshold(100),
+	m_bTNRHistory(false), m_pScratch(NULL), m_pHistory(NULL), m_pGuided(NULL), m_nGuidedStride(0)
+{
+	ResetFilterTime();
+}
+
+CCubeEyeHostFilter::~CCubeEyeHostFilter()
+{
+	Release();
+}
+
+void CCubeEyeHostFilter::Release()
+{
+	if (m_pScratch != NULL)
+		ceAlignedFree(m_pScratch);
+	if (m_pHistory != NULL)
+		ceAlignedFree(m_pHistory);
+	if (m_pGuided != NULL)
+		ceAlignedFree(m_pGuided);
+	m_pScratch = NULL;
+	m_pHistory = NULL;
+	m_pGuided = NULL;
+	m_nWidth = 0;
+	m_nHeight = 0;
+}
+
+int CCubeEyeHostFilter::Init(int nWidth, int nHeight)
+{
+	if (nWidth < 3 || nHeight < 3)
+		return CE_INVALID_PARAM;
+
+	Release();
+
+	size_t nSize = (size_t)nWidth * nHeight;
+	m_nGuidedStride = (nWidth + 2 * GUIDED_RADIUS + 7) & ~(size_t)7;
+	size_t nGuidedSize = m_nGuidedStride * nHeight * GUIDED_PLANES * sizeof(float);
+
+	m_pScratch = (uint16 *)ceAlignedAlloc(nSize * sizeof(uint16));
+	m_pHistory = (uint16 *)ceAlignedAlloc(nSize * sizeof(uint16));
+	m_pGuided = (float *)ceAlignedAlloc(nGuidedSize);
+	if (m_pScratch == NULL || m_pHistory == NULL || m_pGuided == NULL) {
+		Release();
+		return CE_FAILED;
+	}
+	//the column padding of the guided planes is never written and must read as 0
+	memset(m_pGuided, 0, nGuidedSize);
+
+	m_nWidth = nWidth;
+	m_nHeight = nHeight;
+	m_bTNRHistory = false;
+	return CE_SUCCESS;
+}
+
+template <class TFunc>
+void CCubeEyeHostFilter::ForRows(int nGrain, const TFunc &func)
+{
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, m_nHeight, nGrain, func);
+	else
+		func(0, m_nHeight);
+}
+
+void CCubeEyeHostFilter::Measure(host_filter nFilter, TimeStampType nStart)
+{
+	ceFilterTime &stTime = m_stTime[nFilter];
+	stTime.fLastUs = (float)(ceHostTimeStamp() - nStart);
+	stTime.nFrames++;
+	stTime.fAverageUs += (stTime.fLastUs - stTime.fAverageUs) / (float)stTime.nFrames;
+}
+
+void CCubeEyeHostFilter::ResetFilterTime()
+{
+	memset(m_stTime, 0, sizeof(m_stTime));
+}
+
+bool CCubeEyeHostFilter::IsEnabled(host_filter nFilter) const
+{
+	switch (nFilter) {
+	case Filter_Amplitude:		return m_nAmplitudeThreshold != 0;
+	case Filter_Scattering:		return m_nScatteringThreshold != 0;
+	case Filter_FlyingPixel:	return m_bFlyingPixel;
+	case Filter_Median:			return m_bMedian;
+	case Filter_Guided:			return m_bGuided;
+	case Filter_TNR:			return m_bTNR;
+	default:					return false;
+	}
+}
+
+int CCubeEyeHostFilter::Process(uint16 *pDepth, const uint16 *pIR)
+{
+	if (m_pScratch == NULL)
+		return CE_NOT_OPENED;
+	if (pDepth == NULL)
+		return CE_INVALID_PARAM;
+
+	//stencil filters read pCurrent and write the other buffer
+	uint16 *pCurrent = pDepth;
+	uint16 *pOther = m_pScratch;
+	TimeStampType nStart;
+
+	if (pIR != NULL && m_nAmplitudeThreshold != 0) {
+		nStart = ceHostTimeStamp();
+		Threshold(pCurrent, pIR, m_nAmplitudeThreshold);
+		Measure(Filter_Amplitude, nStart);
+	}
+	if (pIR != NULL && m_nScatteringThreshold != 0) {
+		nStart = ceHostTimeStamp();
+		ScatteringCheck(pCurrent, pIR);
+		Measure(Filter_Scattering, nStart);
+	}
+	if (m_bFlyingPixel) {
+		nStart = ceHostTimeStamp();
+		FlyingPixel(pCurrent, pOther);
+		std::swap(pCurrent, pOther);
+		Measure(Filter_FlyingPixel, nStart);
+	}
+	if (m_bMedian) {
+		nStart = ceHostTimeStamp();
+		Median(pCurrent, pOther);
+		std::swap(pCurrent, pOther);
+		Measure(Filter_Median, nStart);
+	}
+	if (m_bGuided) {
+		nStart = ceHostTimeStamp();
+		Guided(pCurrent, pOther);
+		std::swap(pCurrent, pOther);
+		Measure(Filter_Guided, nStart);
+	}
+	if (m_bTNR) {
+		nStart = ceHostTimeStamp();
+		TNR(pCurrent);
+		Measure(Filter_TNR, nStart);
+	}
+
+	if (pCurrent != pDepth)
+		memcpy(pDepth, pCurrent, (size_t)m_nWidth * m_nHeight * sizeof(uint16));
+
+	return CE_SUCCESS;
+}
+
+/*************************************************************************************
+* amplitude / scattering check
+*/
+
+void CCubeEyeHostFilter::Threshold(uint16 *pDepth, const uint16 *pIR, uint16 nThreshold)
+{
+	size_t nWidth = m_nWidth;
+
+	ForRows(ROW_GRAIN, [=](int nRowBegin, int nRowEnd) {
+		size_t i = nRowBegin * nWidth;
+		size_t nEnd = nRowEnd * nWidth;
+
+#if defined(CE_USE_AVX2)
+		const __m256i vTh = _mm256_set1_epi16((short)nThreshold);
+		const __m256i vZero = _mm256_setzero_si256();
+		for (; i + 16 <= nEnd; i += 16) {
+			//IR >= threshold <=> saturated (threshold - IR) == 0
+			__m256i vIR = _mm256_loadu_si256((const __m256i *)(pIR + i));
+			__m256i vKeep = _mm256_cmpeq_epi16(_mm256_subs_epu16(vTh, vIR), vZero);
+			__m256i vDepth = _mm256_loadu_si256((const __m256i *)(pDepth + i));
+			_mm256_storeu_si256((__m256i *)(pDepth + i), _mm256_and_si256(vDepth, vKeep));
+		}
+#elif defined(CE_USE_NEON)
+		const uint16x8_t vTh = vdupq_n_u16(nThreshold);
+		for (; i + 8 <= nEnd; i += 8) {
+			uint16x8_t vKeep = vcgeq_u16(vld1q_u16(pIR + i), vTh);
+			vst1q_u16(pDepth + i, vandq_u16(vld1q_u16(pDepth + i), vKeep));
+		}
+#endif
+
+		for (; i < nEnd; i++) {
+			if (pIR[i] < nThreshold)
+				pDepth[i] = 0;
+		}
+	});
+}
+
+void CCubeEyeHostFilter::ScatteringCheck(uint16 *pDepth, const uint16 *pIR)
+{
+	size_t nWidth = m_nWidth;
+	std::atomic<uint32> nMaxIR(0);
+
+	ForRows(ROW_GRAIN, [=, &nMaxIR](int nRowBegin, int nRowEnd) {
+		size_t i = nRowBegin * nWidth;
+		size_t nEnd = nRowEnd * nWidth;
+		uint16 nMax = 0;
+
+#if defined(CE_USE_AVX2)
+		__m256i vMax = _mm256_setzero_si256();
+		for (; i + 16 <= nEnd; i += 16)
+			vMax = _mm256_max_epu16(vMax, _mm256_loadu_si256((const __m256i *)(pIR + i)));
+		__m128i v = _mm_max_epu16(_mm256_castsi256_si128(vMax), _mm256_extracti128_si256(vMax, 1));
+		//minpos on the complement gives the maximum
+		v = _mm_minpos_epu16(_mm_xor_si128(v, _mm_set1_epi16(-1)));
+		nMax = (uint16)~_mm_extract_epi16(v, 0);
+#elif defined(CE_USE_NEON)
+		uint16x8_t vMax = vdupq_n_u16(0);
+		for (; i + 8 <= nEnd; i += 8)
+			vMax = vmaxq_u16(vMax, vld1q_u16(pIR + i));
+		uint16x4_t v = vmax_u16(vget_low_u16(vMax), vget_high_u16(vMax));
+		v = vpmax_u16(v, v);
+		v = vpmax_u16(v, v);
+		nMax = vget_lane_u16(v, 0);
+#endif
+
+		for (; i < nEnd; i++)
+			nMax = pIR[i] > nMax ? pIR[i] : nMax;
+
+		uint32 nCurrent = nMaxIR.load(std::memory_order_relaxed);
+		while (nMax > nCurrent && !nMaxIR.compare_exchange_weak(nCurrent, nMax, std::memory_order_relaxed)) {
+		}
+	});
+
+	//pixels below max IR * threshold / 4096 are invalidated
+	uint32 nThreshold = (nMaxIR.load() * m_nScatteringThreshold + 4095) >> 12;
+	if (nThreshold > 0)
+		Threshold(pDepth, pIR, (uint16)(nThreshold > 0xFFFF ? 0xFFFF : nThreshold));
+}
+
+/*************************************************************************************
+* flying pixel
+*/
+
+void CCubeEyeHostFilter::FlyingPixel(const uint16 *pSrc, uint16 *pDst)
+{
+	int nWidth = m_nWidth;
+	int nHeight = m_nHeight;
+	uint16 nTh = m_nEdgeThreshold;
+
+	ForRows(ROW_GRAIN, [=](int nRowBegin, int nRowEnd) {
+		for (int y = nRowBegin; y < nRowEnd; y++) {
+			const uint16 *pRow = pSrc + (size_t)y * nWidth;
+			uint16 *pOut = pDst + (size_t)y * nWidth;
+
+			//border rows / columns have no opposite neighbour pair
+			if (y == 0 || y == nHeight - 1) {
+				for (int x = 0; x < nWidth; x++)
+					pOut[x] = FlyingPixelAt(pSrc, nWidth, nHeight, x, y, nTh);
+				continue;
+			}
+			const uint16 *pUp = pRow - nWidth;
+			const uint16 *pDown = pRow + nWidth;
+			pOut[0] = FlyingPixelAt(pSrc, nWidth, nHeight, 0, y, nTh);
+			pOut[nWidth - 1] = FlyingPixelAt(pSrc, nWidth, nHeight, nWidth - 1, y, nTh);
+
+			int x = 1;
+#if defined(CE_USE_AVX2)
+			const __m256i vTh = _mm256_set1_epi16((short)nTh);
+			const __m256i vZero = _mm256_setzero_si256();
+			for (; x + 16 <= nWidth - 1; x += 16) {
+				__m256i c = _mm256_loadu_si256((const __m256i *)(pRow + x));
+				__m256i l = _mm256_loadu_si256((const __m256i *)(pRow + x - 1));
+				__m256i r = _mm256_loadu_si256((const __m256i *)(pRow + x + 1));
+				__m256i u = _mm256_loadu_si256((const __m256i *)(pUp + x));
+				__m256i d = _mm256_loadu_si256((const __m256i *)(pDown + x));
+				//|c - n| <= th <=> saturated(|c - n| - th) == 0
+#define CE_NEAR(n)	_mm256_cmpeq_epi16(_mm256_subs_epu16(_mm256_or_si256(_mm256_subs_epu16(c, n), _mm256_subs_epu16(n, c)), vTh), vZero)
+				__m256i vKeep = _mm256_and_si256(_mm256_or_si256(CE_NEAR(l), CE_NEAR(r)), _mm256_or_si256(CE_NEAR(u), CE_NEAR(d)));
+#undef CE_NEAR
+				_mm256_storeu_si256((__m256i *)(pOut + x), _mm256_and_si256(c, vKeep));
+			}
+#elif defined(CE_USE_NEON)
+			const uint16x8_t vTh = vdupq_n_u16(nTh);
+			for (; x + 8 <= nWidth - 1; x += 8) {
+				uint16x8_t c = vld1q_u16(pRow + x);
+				uint16x8_t vKeepH = vorrq_u16(vcleq_u16(vabdq_u16(c, vld1q_u16(pRow + x - 1)), vTh),
+					vcleq_u16(vabdq_u16(c, vld1q_u16(pRow + x + 1)), vTh));
+				uint16x8_t vKeepV = vorrq_u16(vcleq_u16(vabdq_u16(c, vld1q_u16(pUp + x)), vTh),
+					vcleq_u16(vabdq_u16(c, vld1q_u16(pDown + x)), vTh));
+				vst1q_u16(pOut + x, vandq_u16(c, vandq_u16(vKeepH, vKeepV)));
+			}
+#endif
+
+			for (; x < nWidth - 1; x++) {
+				uint16 c = pRow[x];
+				bool bJumpH = AbsDiff(c, pRow[x - 1]) > nTh && AbsDiff(c, pRow[x + 1]) > nTh;
+				bool bJumpV = AbsDiff(c, pUp[x]) > nTh && AbsDiff(c, pDown[x]) > nTh;
+				pOut[x] = (bJumpH || bJumpV) ? 0 : c;
+			}
+		}
+	});
+}
+
+/*************************************************************************************
+* 3x3 median
+*/
+
+void CCubeEyeHostFilter::Median(const uint16 *pSrc, uint16 *pDst)
+{
+	int nWidth = m_nWidth;
+	int nHeight = m_nHeight;
+
+	ForRows(ROW_GRAIN, [=](int nRowBegin, int nRowEnd) {
+		for (int y = nRowBegin; y < nRowEnd; y++) {
+			const uint16 *pRow = pSrc + (size_t)y * nWidth;
+			uint16 *pOut = pDst + (size_t)y * nWidth;
+
+			if (y == 0 || y == nHeight - 1) {
+				for (int x = 0; x < nWidth; x++)
+					pOut[x] = MedianAt(pSrc, nWidth, nHeight, x, y);
+				continue;
+			}
+			const uint16 *pUp = pRow - nWidth;
+			const uint16 *pDown = pRow + nWidth;
+			pOut[0] = MedianAt(pSrc, nWidth, nHeight, 0, y);
+			pOut[nWidth - 1] = MedianAt(pSrc, nWidth, nHeight, nWidth - 1, y);
+
+			int x = 1;
+#if defined(CE_USE_AVX2)
+			for (; x + 16 <= nWidth - 1; x += 16) {
+				__m256i p[9];
+				for (int k = 0; k < 3; k++) {
+					p[k] = _mm256_loadu_si256((const __m256i *)(pUp + x - 1 + k));
+					p[3 + k] = _mm256_loadu_si256((const __m256i *)(pRow + x - 1 + k));
+					p[6 + k] = _mm256_loadu_si256((const __m256i *)(pDown + x - 1 + k));
+				}
+				__m256i center = p[4];
+				SplitHoles(p);
+				_mm256_storeu_si256((__m256i *)(pOut + x), KeepHole(center, Median9(p)));
+			}
+#elif defined(CE_USE_NEON)
+			for (; x + 8 <= nWidth - 1; x += 8) {
+				uint16x8_t p[9];
+				for (int k = 0; k < 3; k++) {
+					p[k] = vld1q_u16(pUp + x - 1 + k);
+					p[3 + k] = vld1q_u16(pRow + x - 1 + k);
+					p[6 + k] = vld1q_u16(pDown + x - 1 + k);
+				}
+				uint16x8_t center = p[4];
+				SplitHoles(p);
+				vst1q_u16(pOut + x, KeepHole(center, Median9(p)));
+			}
+#endif
+
+			for (; x < nWidth - 1; x++) {
+				uint16 p[9];
+				for (int k = 0; k < 3; k++) {
+					p[k] = pUp[x - 1 + k];
+					p[3 + k] = pRow[x - 1 + k];
+					p[6 + k] = pDown[x - 1 + k];
+				}
+				uint16 center = p[4];
+				SplitHoles(p);
+				pOut[x] = KeepHole(center, Median9(p));
+			}
+		}
+	});
+}
+
+/*************************************************************************************
+* guided filter
+*
+* Self guided(He et al.) over valid pixels only : for every window, a = var / (var + eps),
+* b = mean * (1 - a); output = mean(a) * I + mean(b), where the means count valid pixels.
+* Box sums are separable : vertical sums into padded planes, then horizontal sums. The
+* float loops are plain element-wise code for the compiler to vectorize.
+*/
+
+void CCubeEyeHostFilter::Guided(const uint16 *pSrc, uint16 *pDst)
+{
+	const int r = GUIDED_RADIUS;
+	int nWidth = m_nWidth;
+	int nHeight = m_nHeight;
+	size_t nStride = m_nGuidedStride;
+	size_t nPlane = nStride * nHeight;
+	float fEpsilon = m_fEpsilon;
+
+	//interior columns start at r, the padding on both sides stays 0
+	float *pVN = m_pGuided + r;
+	float *pVS = pVN + nPlane;
+	float *pVQ = pVS + nPlane;
+	float *pA = pVQ + nPlane;
+	float *pB = pA + nPlane;
+
+	//vertical sums of valid count, depth, depth^2(invalid depth is 0, so it adds nothing)
+	ForRows(ROW_GRAIN, [=](int nRowBegin, int nRowEnd) {
+		for (int y = nRowBegin; y < nRowEnd; y++) {
+			float *vn = pVN + y * nStride;
+			float *vs = pVS + y * nStride;
+			float *vq = pVQ + y * nStride;
+			for (int x = 0; x < nWidth; x++) {
+				vn[x] = 0.0f;
+				vs[x] = 0.0f;
+				vq[x] = 0.0f;
+			}
+			int y0 = y - r < 0 ? 0 : y - r;
+			int y1 = y + r >= nHeight ? nHeight - 1 : y + r;
+			for (int yy = y0; yy <= y1; yy++) {
+				const uint16 *pRow = pSrc + (size_t)yy * nWidth;
+				for (int x = 0; x < nWidth; x++) {
+					float d = (float)pRow[x];
+					vn[x] += d > 0.0f ? 1.0f : 0.0f;
+					vs[x] += d;
+					vq[x] += d * d;
+				}
+			}
+		}
+	});
+
+	//window statistics -> a, b per valid pixel
+	ForRows(ROW_GRAIN, [=](int nRowBegin, int nRowEnd) {
+		for (int y = nRowBegin; y < nRowEnd; y++) {
+			const float *vn = pVN + y * nStride;
+			const float *vs = pVS + y * nStride;
+			const float *vq = pVQ + y * nStride;
+			const uint16 *pRow = pSrc + (size_t)y * nWidth;
+			float *a = pA + y * nStride;
+			float *b = pB + y * nStride;
+			for (int x = 0; x < nWidth; x++) {
+				float n = 0.0f, s = 0.0f, q = 0.0f;
+				for (int k = -r; k <= r; k++) {
+					n += vn[x + k];
+					s += vs[x + k];
+					q += vq[x + k];
+				}
+				float fInvN = pRow[x] ? 1.0f / n : 0.0f;
+				float fMean = s * fInvN;
+				float fVar = q * fInvN - fMean * fMean;
+				fVar = fVar > 0.0f ? fVar : 0.0f;
+				float fA = fVar / (fVar + fEpsilon);
+				a[x] = pRow[x] ? fA : 0.0f;
+				b[x] = pRow[x] ? fMean - fA * fMean : 0.0f;
+			}
+		}
+	});
+
+	//vertical sums of a, b(reusing the S / Q planes)
+	ForRows(ROW_GRAIN, [=](int nRowBegin, int nRowEnd) {
+		for (int y = nRowBegin; y < nRowEnd; y++) {
+			float *va = pVS + y * nStride;
+			float *vb = pVQ + y * nStride;
+			for (int x = 0; x < nWidth; x++) {
+				va[x] = 0.0f;
+				vb[x] = 0.0f;
+			}
+			int y0 = y - r < 0 ? 0 : y - r;
+			int y1 = y + r >= nHeight ? nHeight - 1 : y + r;
+			for (int yy = y0; yy <= y1; yy++) {
+				const float *a = pA + yy * nStride;
+				const float *b = pB + yy * nStride;
+				for (int x = 0; x < nWidth; x++) {
+					va[x] += a[x];
+					vb[x] += b[x];
+				}
+			}
+		}
+	});
+
+	//output = mean(a) * I + mean(b)
+	ForRows(ROW_GRAIN, [=](int nRowBegin, int nRowEnd) {
+		for (int y = nRowBegin; y < nRowEnd; y++) {
+			const float *vn = pVN + y * nStride;
+			const float *va = pVS + y * nStride;
+			const float *vb = pVQ + y * nStride;
+			const uint16 *pRow = pSrc + (size_t)y * nWidth;
+			uint16 *pOut = pDst + (size_t)y * nWidth;
+			for (int x = 0; x < nWidth; x++) {
+				float n = 0.0f, sa = 0.0f, sb = 0.0f;
+				for (int k = -r; k <= r; k++) {
+					n += vn[x + k];
+					sa += va[x + k];
+					sb += vb[x + k];
+				}
+				float fInvN = pRow[x] ? 1.0f / n : 0.0f;
+				float fOut = (sa * (float)pRow[x] + sb) * fInvN + 0.5f;
+				fOut = fOut < 1.0f ? 1.0f : (fOut > 65535.0f ? 65535.0f : fOut);
+				pOut[x] = pRow[x] ? (uint16)fOut : 0;
+			}
+		}
+	});
+}
+
+/*************************************************************************************
+* temporal noise reduction
+*/
+
+void CCubeEyeHostFilter::TNR(uint16 *pDepth)
+{
+	size_t nWidth = m_nWidth;
+	uint16 *pHistory = m_pHistory;
+
+	if (!m_bTNRHistory) {
+		memcpy(pHistory, pDepth, nWidth * m_nHeight * sizeof(uint16));
+		m_bTNRHistory = true;
+		return;
+	}
+
+	int16 nWeight = m_nTNRWeight;
+	uint16 nMotion = m_nMotionThreshold;
+
+	ForRows(ROW_GRAIN, [=](int nRowBegin, int nRowEnd) {
+		size_t i = nRowBegin * nWidth;
+		size_t nEnd = nRowEnd * nWidth;
+
+		//out = cur + round((prev - cur) * w / 32768); |prev - cur| < nMotion(<= 32767) fits int16
+#if defined(CE_USE_AVX2)
+		const __m256i vW = _mm256_set1_epi16(nWeight);
+		const __m256i vMotion = _mm256_set1_epi16((short)(nMotion - 1));
+		const __m256i vZero = _mm256_setzero_si256();
+		for (; i + 16 <= nEnd; i += 16) {
+			__m256i c = _mm256_loadu_si256((const __m256i *)(pDepth + i));
+			__m256i p = _mm256_loadu_si256((const __m256i *)(pHistory + i));
+			__m256i vAbs = _mm256_or_si256(_mm256_subs_epu16(c, p), _mm256_subs_epu16(p, c));
+			__m256i vBlend = _mm256_cmpeq_epi16(_mm256_subs_epu16(vAbs, vMotion), vZero);
+			vBlend = _mm256_andnot_si256(_mm256_cmpeq_epi16(c, vZero), vBlend);
+			vBlend = _mm256_andnot_si256(_mm256_cmpeq_epi16(p, vZero), vBlend);
+			__m256i vDelta = _mm256_mulhrs_epi16(_mm256_sub_epi16(p, c), vW);
+			__m256i vOut = _mm256_add_epi16(c, _mm256_and_si256(vDelta, vBlend));
+			_mm256_storeu_si256((__m256i *)(pDepth + i), vOut);
+			_mm256_storeu_si256((__m256i *)(pHistory + i), vOut);
+		}
+#elif defined(CE_USE_NEON)
+		const int16x8_t vW = vdupq_n_s16(nWeight);
+		const uint16x8_t vMotion = vdupq_n_u16(nMotion);
+		const uint16x8_t vZero = vdupq_n_u16(0);
+		for (; i + 8 <= nEnd; i += 8) {
+			uint16x8_t c = vld1q_u16(pDepth + i);
+			uint16x8_t p = vld1q_u16(pHistory + i);
+			uint16x8_t vBlend = vcltq_u16(vabdq_u16(c, p), vMotion);
+			vBlend = vandq_u16(vBlend, vmvnq_u16(vceqq_u16(c, vZero)));
+			vBlend = vandq_u16(vBlend, vmvnq_u16(vceqq_u16(p, vZero)));
+			int16x8_t vDelta = vqrdmulhq_s16(vreinterpretq_s16_u16(vsubq_u16(p, c)), vW);
+			uint16x8_t vOut = vaddq_u16(c, vandq_u16(vreinterpretq_u16_s16(vDelta), vBlend));
+			vst1q_u16(pDepth + i, vOut);
+			vst1q_u16(pHistory + i, vOut);
+		}
+#endif
+
+		for (; i < nEnd; i++) {
+			uint16 c = pDepth[i];
+			uint16 p = pHistory[i];
+			if (c != 0 && p != 0 && AbsDiff(c, p) < nMotion)
+				c = (uint16)(c + (((int32)(int16)(p - c) * nWeight + 0x4000) >> 15));
+			pDepth[i] = c;
+			pHistory[i] = c;
+		}
+	});
+}
+
+/*************************************************************************************
+* switches
+*/
+
+int CCubeEyeHostFilter::setAmplitudeCheckThreshold(uint16 nThreshold)
+{
+	if (nThreshold > 4095)
+		return CE_OUTOFRANGE;
+	m_nAmplitudeThreshold = nThreshold;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeHostFilter::getAmplitudeCheckThreshold(uint16 &nThreshold)
+{
+	nThreshold = m_nAmplitudeThreshold;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeHostFilter::setScatteringCheckThreshold(uint16 nThreshold)
+{
+	if (nThreshold > 4095)
+		return CE_OUTOFRANGE;
+	m_nScatteringThreshold = nThreshold;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeHostFilter::getScatteringCheckThreshold(uint16 &nThreshold)
+{
+	nThreshold = m_nScatteringThreshold;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeHostFilter::setGuidedFilter(uint16 nEpsilon)
+{
+	if (nEpsilon == 0)
+		return CE_INVALID_PARAM;
+	m_fEpsilon = nEpsilon / 256.0f;
+	m_bGuided = true;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeHostFilter::clearGuidedFilter()
+{
+	m_bGuided = false;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeHostFilter::setMedianFilter()
+{
+	m_bMedian = true;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeHostFilter::clearMedianFilter()
+{
+	m_bMedian = false;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeHostFilter::setFlyPxlFilter(uint16 nEdgeChkTh)
+{
+	m_nEdgeThreshold = nEdgeChkTh;
+	m_bFlyingPixel = true;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeHostFilter::clearFlyPxlFilter()
+{
+	m_bFlyingPixel = false;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeHostFilter::setTNRFilter(float fRatio, uint16 nMotionTh)
+{
+	if (fRatio < 0.0f || fRatio > 0.99f || nMotionTh == 0 || nMotionTh > 0x7FFF)
+		return CE_INVALID_PARAM;
+	m_nTNRWeight = (int16)(fRatio * 32768.0f + 0.5f);
+	m_nMotionThreshold = nMotionTh;
+	if (!m_bTNR)
+		m_bTNRHistory = false;
+	m_bTNR = true;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeHostFilter::clearTNRFilter()
+{
+	m_bTNR = false;
+	m_bTNRHistory = false;
+	return CE_SUCCESS;
+}
+
+}
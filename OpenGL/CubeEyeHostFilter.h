@@ -0,0 +1,229 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeHostFilter.h												*/
+/*																			*/
+/* @brief	Host-side depth filters(SDK filter equivalents)					*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeThreadPool.h"
+
+namespace CUBE_EYE
+{
+
+///Host filter stages, in processing order
+enum host_filter {
+	///depth = 0 where IR < threshold
+	Filter_Amplitude = 0,
+	///depth = 0 where IR is low against the brightest pixel of the frame
+	Filter_Scattering,
+	///depth = 0 where the depth jumps on both sides of the pixel
+	Filter_FlyingPixel,
+	///3x3 median
+	Filter_Median,
+	///edge preserving smoothing(self guided filter)
+	Filter_Guided,
+	///temporal noise reduction
+	Filter_TNR,
+	Filter_Count,
+};
+
+///Filter cost
+typedef struct _ceFilterTime
+{
+	///Last frame(unit; us)
+	float fLastUs;
+	///Mean over nFrames(unit; us)
+	float fAverageUs;
+	///Frames processed with the filter enabled
+	uint64 nFrames;
+
+} ceFilterTime;
+
+/**
+*
+*@brief		Host-side depth filters
+*@details	The same switches as the SDK/firmware filters, computed on the host so that they can
+			run on any stream(device with its filters off, playback, merged frames) and their
+			cost can be measured one by one. Filters run in host_filter order; each one is
+			split over the thread pool in row bands, with AVX2 / NEON kernels when the build
+			enables them. Invalid pixels(depth 0) stay 0 through every filter.
+			Every filter is off after Init.
+*
+*/
+class CCubeEyeHostFilter {
+
+public:
+
+	CCubeEyeHostFilter();
+	~CCubeEyeHostFilter();
+
+	/**
+	*
+	* @brief	Initialize
+	* @details	Allocates the working planes for nWidth x nHeight frames(3 x 3 and larger).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Init(int nWidth, int nHeight);
+
+	template <class TDevice>
+	int Init(const TDevice &device)
+	{
+		return Init(device.pDevInfo.nWidth, device.pDevInfo.nHeight);
+	}
+
+	/**
+	*
+	* @brief	Set thread pool
+	* @details	NULL : single threaded. Default is CCubeEyeThreadPool::Default().
+	* @return	void
+	*
+	*/
+	void SetThreadPool(CCubeEyeThreadPool *pPool) { m_pPool = pPool; }
+
+	/**
+	*
+	* @brief	Filter frame
+	* @details	Filters pDepth in place.
+	* @param	pDepth - depth frame(unit; mm).
+	* @param	pIR - IR frame, NULL : amplitude / scattering checks are skipped.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Process(uint16 *pDepth, const uint16 *pIR);
+
+	/*************************************************************************************
+	* \defgroup Filter switches(same names and defaults as CCubeEye)
+	* @{
+	*/
+
+	/**
+	*
+	* @brief	Amplitude check
+	* @param	nThreshold(0~4095) - 0 : off.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int setAmplitudeCheckThreshold(uint16 nThreshold = 5);
+	int getAmplitudeCheckThreshold(uint16 &nThreshold);
+
+	/**
+	*
+	* @brief	Scattering check
+	* @details	Invalidates pixels with IR < max IR of the frame * nThreshold / 4096, whose
+				depth is dominated by light scattered from bright objects.
+	* @param	nThreshold(0~4095) - 0 : off.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int setScatteringCheckThreshold(uint16 nThreshold = 100);
+	int getScatteringCheckThreshold(uint16 &nThreshold);
+
+	/**
+	*
+	* @brief	Guided filter
+	* @details	Self guided filter over a 5 x 5 window, regularization epsilon = nEpsilon / 256(unit; mm^2).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int setGuidedFilter(uint16 nEpsilon = 0x8000);
+	int clearGuidedFilter();
+
+	/**
+	*
+	* @brief	Median filter
+	* @details	3 x 3 median of the valid(non 0) samples, the lower one of an even
+				count; a pixel that is 0 stays 0. On the frame border the window is
+				clipped to the frame.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int setMedianFilter();
+	int clearMedianFilter();
+
+	/**
+	*
+	* @brief	Flying pixel filter
+	* @details	Invalidates a pixel whose depth differs by more than nEdgeChkTh from both its left
+				and right, or both its up and down neighbours(an invalid neighbour counts as a jump).
+				On the frame border the one neighbour inside the frame decides for its axis.
+	* @param	nEdgeChkTh - threshold(unit; mm).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int setFlyPxlFilter(uint16 nEdgeChkTh = 300);
+	int clearFlyPxlFilter();
+
+	/**
+	*
+	* @brief	TNR filter
+	* @details	output = current + (previous output - current) * fRatio where both are valid and
+				differ by less than nMotionTh; moving or newly valid pixels pass unchanged.
+	* @param	fRatio(0~0.99) - weight of the previous output.
+	* @param	nMotionTh - motion threshold(unit; mm).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int setTNRFilter(float fRatio = 0.5f, uint16 nMotionTh = 100);
+	int clearTNRFilter();
+
+	/**@}*/
+
+	/**
+	*
+	* @brief	Filter cost
+	* @return	cost of nFilter
+	*
+	*/
+	const ceFilterTime &getFilterTime(host_filter nFilter) const { return m_stTime[nFilter]; }
+
+	void ResetFilterTime();
+
+	bool IsEnabled(host_filter nFilter) const;
+
+private:
+
+	CCubeEyeHostFilter(const CCubeEyeHostFilter &);
+	CCubeEyeHostFilter &operator=(const CCubeEyeHostFilter &);
+
+	void Release();
+	template <class TFunc>
+	void ForRows(int nGrain, const TFunc &func);
+	void Measure(host_filter nFilter, TimeStampType nStart);
+
+	void Threshold(uint16 *pDepth, const uint16 *pIR, uint16 nThreshold);
+	void ScatteringCheck(uint16 *pDepth, const uint16 *pIR);
+	void FlyingPixel(const uint16 *pSrc, uint16 *pDst);
+	void Median(const uint16 *pSrc, uint16 *pDst);
+	void Guided(const uint16 *pSrc, uint16 *pDst);
+	void TNR(uint16 *pDepth);
+
+	int m_nWidth;
+	int m_nHeight;
+	CCubeEyeThreadPool *m_pPool;
+
+	uint16 m_nAmplitudeThreshold;
+	uint16 m_nScatteringThreshold;
+	bool m_bMedian;
+	bool m_bFlyingPixel;
+	uint16 m_nEdgeThreshold;
+	bool m_bGuided;
+	float m_fEpsilon;
+	bool m_bTNR;
+	int16 m_nTNRWeight;				//fRatio in Q15
+	uint16 m_nMotionThreshold;
+	bool m_bTNRHistory;				//m_pHistory holds the previous output
+
+	uint16 *m_pScratch;				//stencil filter output
+	uint16 *m_pHistory;				//TNR previous output
+	float *m_pGuided;				//guided filter planes
+	size_t m_nGuidedStride;
+
+	ceFilterTime m_stTime[Filter_Count];
+};
+
+}
@@ -0,0 +1,665 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeICP.cpp													*/
+/*																			*/
+/* @brief	Point to plane ICP odometry										*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeICP.h"
+
+#include <math.h>
+
+namespace CUBE_EYE
+{
+
+#define CHUNK_ROWS			8		//rows per normal equation chunk
+#define MIN_LEVEL_SIZE		8		//levels narrower or lower than this get no tables
+#define GRID_MARGIN			1		//pinhole pixels around the ray bounds of a level
+
+/*************************************************************************************
+* rigid motion helpers(row-major 3 x 3 rotation, translation)
+*/
+
+static void Rodrigues(const double *pW, double *pR)
+{
+	double fAngle = sqrt(pW[0] * pW[0] + pW[1] * pW[1] + pW[2] * pW[2]);
+	double fA = 1.0, fB = 0.5;
+	if (fAngle > 1e-12) {
+		fA = sin(fAngle) / fAngle;
+		fB = (1.0 - cos(fAngle)) / (fAngle * fAngle);
+	}
+	//R = I + sin / a * [w]x + (1 - cos) / a^2 * [w]x^2
+	double K[9] = { 0.0, -pW[2], pW[1], pW[2], 0.0, -pW[0], -pW[1], pW[0], 0.0 };
+	for (int r = 0; r < 3; r++) {
+		for (int c = 0; c < 3; c++) {
+			double fK2 = K[r * 3] * K[c] + K[r * 3 + 1] * K[3 + c] + K[r * 3 + 2] * K[6 + c];
+			pR[r * 3 + c] = (r == c ? 1.0 : 0.0) + fA * K[r * 3 + c] + fB * fK2;
+		}
+	}
+}
+
+static void ToMatrix(const double *pR, const double *pT, glh::matrix4f &m)
+{
+	m.make_identity();
+	for (int r = 0; r < 3; r++) {
+		for (int c = 0; c < 3; c++)
+			m(r, c) = (float)pR[r * 3 + c];
+		m(r, 3) = (float)pT[r];
+	}
+}
+
+//glh::quaternion(matrix4) reads the matrix transposed, so the rotation is converted here(Shepperd)
+static glh::quaternionf ToQuaternion(const double *R)
+{
+	double q[4];
+	double fTrace = R[0] + R[4] + R[8];
+	if (fTrace > 0.0) {
+		double s = 0.5 / sqrt(fTrace + 1.0);
+		q[3] = 0.25 / s;
+		q[0] = (R[7] - R[5]) * s;
+		q[1] = (R[2] - R[6]) * s;
+		q[2] = (R[3] - R[1]) * s;
+	}
+	else {
+		int i = (R[4] > R[0]) ? 1 : 0;
+		i = (R[8] > R[i * 4]) ? 2 : i;
+		int j = (i + 1) % 3, k = (i + 2) % 3;
+		double s = 2.0 * sqrt(1.0 + R[i * 4] - R[j * 4] - R[k * 4]);
+		q[i] = 0.25 * s;
+		q[3] = (R[k * 3 + j] - R[j * 3 + k]) / s;
+		q[j] = (R[j * 3 + i] + R[i * 3 + j]) / s;
+		q[k] = (R[k * 3 + i] + R[i * 3 + k]) / s;
+	}
+	return glh::quaternionf((float)q[0], (float)q[1], (float)q[2], (float)q[3]);
+}
+
+#if defined(CE_USE_AVX2)
+static double HorizontalSum(__m256 v)
+{
+	float f[8];
+	_mm256_storeu_ps(f, v);
+	double fSum = 0.0;
+	for (int k = 0; k < 8; k++)
+		fSum += f[k];
+	return fSum;
+}
+#endif
+
+/*************************************************************************************
+* CCubeEyeICP
+*/
+
+CCubeEyeICP::CCubeEyeICP()
+	: m_stConfig(DefaultConfig()), m_pPool(&CCubeEyeThreadPool::Default()), m_bCamera(false),
+	m_nTableLevels(0), m_nReference(0), m_bReference(false)
+{
+	m_stResult.translation = glh::vec3f(0.0f, 0.0f, 0.0f);
+	m_stResult.fRmse = 0.0f;
+	m_stResult.nCorrespondences = 0;
+	m_stResult.nIterations = 0;
+	SetThreadPool(m_pPool);
+}
+
+CCubeEyeICP::~CCubeEyeICP()
+{
+}
+
+ceICPConfig CCubeEyeICP::DefaultConfig()
+{
+	ceICPConfig stConfig;
+	memset(&stConfig, 0, sizeof(stConfig));
+	stConfig.nLevels = 3;
+	stConfig.nIterations[0] = 4;
+	stConfig.nIterations[1] = 5;
+	stConfig.nIterations[2] = 10;
+	stConfig.fMaxDistance = 0.1f;
+	stConfig.fMaxAngle = 30.0f;
+	stConfig.fMinDepth = 0.1f;
+	stConfig.fMaxDepth = 4.0f;
+	stConfig.fStopRotation = 1e-4f;
+	stConfig.fStopTranslation = 1e-4f;
+	stConfig.nMinCorrespondences = 100;
+	return stConfig;
+}
+
+int CCubeEyeICP::SetConfig(const ceICPConfig &stConfig)
+{
+	if (stConfig.nLevels < 1 || stConfig.nLevels > CE_PYRAMID_MAX_LEVELS)
+		return CE_INVALID_PARAM;
+	for (int l = 0; l < stConfig.nLevels; l++) {
+		if (stConfig.nIterations[l] < 0)
+			return CE_INVALID_PARAM;
+	}
+	if (!(stConfig.fMaxDistance > 0.0f) || !(stConfig.fMaxAngle > 0.0f && stConfig.fMaxAngle <= 90.0f))
+		return CE_INVALID_PARAM;
+	if (!(stConfig.fMinDepth >= 0.0f && stConfig.fMaxDepth > stConfig.fMinDepth) || stConfig.nMinCorrespondences < 6)
+		return CE_INVALID_PARAM;
+	if (m_bCamera && stConfig.nLevels > m_nTableLevels)
+		return CE_OUTOFRANGE;
+
+	if (m_bCamera && stConfig.nLevels != m_stConfig.nLevels) {
+		int nResult = m_pyramid.Init(m_level[0].nWidth, m_level[0].nHeight, stConfig.nLevels > 1 ? stConfig.nLevels : 2);
+		if (nResult != CE_SUCCESS)
+			return nResult;
+		m_bReference = false;
+	}
+	m_stConfig = stConfig;
+	return CE_SUCCESS;
+}
+
+void CCubeEyeICP::SetThreadPool(CCubeEyeThreadPool *pPool)
+{
+	m_pPool = pPool;
+	m_pyramid.SetThreadPool(pPool);
+	for (int l = 0; l < CE_PYRAMID_MAX_LEVELS; l++)
+		m_level[l].normals.SetThreadPool(pPool);
+}
+
+int CCubeEyeICP::SetCamera(const ceIntrinsicParam &stIntr, const ceDistortionParam &stDist, int nWidth, int nHeight)
+{
+	if (nWidth < MIN_LEVEL_SIZE || nHeight < MIN_LEVEL_SIZE || !(stIntr.fFx > 0.0f) || !(stIntr.fFy > 0.0f))
+		return CE_INVALID_PARAM;
+
+	int nLevels = 1;
+	while (nLevels < CE_PYRAMID_MAX_LEVELS && (nWidth >> nLevels) >= MIN_LEVEL_SIZE && (nHeight >> nLevels) >= MIN_LEVEL_SIZE)
+		nLevels++;
+	if (m_stConfig.nLevels > nLevels)
+		return CE_OUTOFRANGE;
+
+	m_bCamera = false;
+	m_bReference = false;
+	int nResult = m_pyramid.Init(nWidth, nHeight, m_stConfig.nLevels > 1 ? m_stConfig.nLevels : 2);
+	if (nResult != CE_SUCCESS)
+		return nResult;
+
+	m_level[0].nWidth = nWidth;
+	m_level[0].nHeight = nHeight;
+	for (int l = 0; l < nLevels; l++) {
+		BuildLevel(l, stIntr, stDist);
+		for (int s = 0; s < 2; s++) {
+			nResult = m_level[l].vertex[s].Allocate(m_level[l].nWidth, m_level[l].nHeight);
+			if (nResult != CE_SUCCESS)
+				return nResult;
+		}
+	}
+	m_nTableLevels = nLevels;
+	m_bCamera = true;
+	return CE_SUCCESS;
+}
+
+void CCubeEyeICP::BuildLevel(int nLevel, const ceIntrinsicParam &stIntr, const ceDistortionParam &stDist)
+{
+	Level &level = m_level[nLevel];
+	int w = m_level[0].nWidth >> nLevel;
+	int h = m_level[0].nHeight >> nLevel;
+	size_t nCount = (size_t)w * h;
+
+	//pixel (u, v) of level l is level 0 position (u + 0.5) * 2^l - 0.5 : the scaled intrinsics with the same distortion
+	ceIntrinsicParam stLevel = CCubeEyeDepthPyramid::ScaleIntrinsic(stIntr, nLevel);
+	level.nWidth = w;
+	level.nHeight = h;
+	level.stIntr = stLevel;
+	level.vRayX.resize(nCount);
+	level.vRayY.resize(nCount);
+	ceBuildRayTable(stLevel, stDist, w, h, level.vRayX.data(), level.vRayY.data());
+
+	//the grid covers the pinhole projection of every ray of the level
+	float fMinX = 0.0f, fMaxX = 0.0f, fMinY = 0.0f, fMaxY = 0.0f;
+	for (size_t i = 0; i < nCount; i++) {
+		fMinX = level.vRayX[i] < fMinX ? level.vRayX[i] : fMinX;
+		fMaxX = level.vRayX[i] > fMaxX ? level.vRayX[i] : fMaxX;
+		fMinY = level.vRayY[i] < fMinY ? level.vRayY[i] : fMinY;
+		fMaxY = level.vRayY[i] > fMaxY ? level.vRayY[i] : fMaxY;
+	}
+	int nX0 = (int)floorf(stLevel.fFx * fMinX + stLevel.fCx) - GRID_MARGIN;
+	int nX1 = (int)ceilf(stLevel.fFx * fMaxX + stLevel.fCx) + GRID_MARGIN;
+	int nY0 = (int)floorf(stLevel.fFy * fMinY + stLevel.fCy) - GRID_MARGIN;
+	int nY1 = (int)ceilf(stLevel.fFy * fMaxY + stLevel.fCy) + GRID_MARGIN;
+	//strongly distorted lenses : keep the grid within three frame sizes
+	nX0 = nX0 < -w ? -w : nX0;
+	nY0 = nY0 < -h ? -h : nY0;
+	nX1 = nX1 >= 2 * w ? 2 * w - 1 : nX1;
+	nY1 = nY1 >= 2 * h ? 2 * h - 1 : nY1;
+
+	level.nGridX = nX0;
+	level.nGridY = nY0;
+	level.nGridWidth = nX1 - nX0 + 1;
+	level.nGridHeight = nY1 - nY0 + 1;
+	level.vGrid.resize((size_t)level.nGridWidth * level.nGridHeight);
+
+	//the distorted pixel of a cell must undistort back into the cell, which rejects the fold-over of the lens polynomial
+	float fToleranceX = 2.0f / stLevel.fFx;
+	float fToleranceY = 2.0f / stLevel.fFy;
+	for (int gy = 0; gy < level.nGridHeight; gy++) {
+		for (int gx = 0; gx < level.nGridWidth; gx++) {
+			float x = (nX0 + gx - stLevel.fCx) / stLevel.fFx;
+			float y = (nY0 + gy - stLevel.fCy) / stLevel.fFy;
+			float u, v;
+			ceProjectPoint(stLevel, stDist, x, y, u, v);
+			int iu = (int)floorf(u + 0.5f);
+			int iv = (int)floorf(v + 0.5f);
+			int32 nPixel = -1;
+			if (iu >= 0 && iu < w && iv >= 0 && iv < h) {
+				size_t i = (size_t)iv * w + iu;
+				if (fabsf(level.vRayX[i] - x) <= fToleranceX && fabsf(level.vRayY[i] - y) <= fToleranceY)
+					nPixel = (int32)i;
+			}
+			level.vGrid[(size_t)gy * level.nGridWidth + gx] = nPixel;
+		}
+	}
+
+	//normals over the same physical distance on every level
+	level.normals.SetRadius(nLevel == 0 ? 2 : 1);
+	level.normals.SetMaxDepthChange(0.02f * (float)(1 << nLevel));
+}
+
+template <class TFunc>
+void CCubeEyeICP::ForChunks(int nRows, const TFunc &func)
+{
+	int nChunks = (nRows + CHUNK_ROWS - 1) / CHUNK_ROWS;
+	auto chunks = [&](int nChunkBegin, int nChunkEnd) {
+		for (int c = nChunkBegin; c < nChunkEnd; c++) {
+			int nBegin = c * CHUNK_ROWS;
+			func(c, nBegin, nBegin + CHUNK_ROWS < nRows ? nBegin + CHUNK_ROWS : nRows);
+		}
+	};
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, nChunks, 1, chunks);
+	else
+		chunks(0, nChunks);
+}
+
+/*************************************************************************************
+* frame preparation
+*/
+
+void CCubeEyeICP::Vertices(int nLevel, int nSlot)
+{
+	Level &level = m_level[nLevel];
+	const uint16 *pDepth = m_pyramid.getDepth(nLevel);
+	const float *pRayX = level.vRayX.data();
+	const float *pRayY = level.vRayY.data();
+	float *pX = level.vertex[nSlot].getX();
+	float *pY = level.vertex[nSlot].getY();
+	float *pZ = level.vertex[nSlot].getZ();
+	int nWidth = level.nWidth;
+	float fMin = m_stConfig.fMinDepth;
+	float fMax = m_stConfig.fMaxDepth;
+
+	//plain element-wise loops for the compiler to vectorize
+	ForChunks(level.nHeight, [=](int, int nRowBegin, int nRowEnd) {
+		for (size_t i = (size_t)nRowBegin * nWidth; i < (size_t)nRowEnd * nWidth; i++) {
+			float z = (float)pDepth[i] * 0.001f;
+			z = (z >= fMin && z <= fMax) ? z : 0.0f;
+			pX[i] = pRayX[i] * z;
+			pY[i] = pRayY[i] * z;
+			pZ[i] = z;
+		}
+	});
+}
+
+int CCubeEyeICP::Prepare(const uint16 *pDepth, int nSlot)
+{
+	int nResult = m_pyramid.Build(pDepth);
+	for (int l = 0; l < m_stConfig.nLevels && nResult == CE_SUCCESS; l++) {
+		Vertices(l, nSlot);
+		nResult = m_level[l].normals.Compute(m_level[l].vertex[nSlot], m_level[l].normal[nSlot]);
+	}
+	return nResult;
+}
+
+int CCubeEyeICP::SetReference(const uint16 *pDepth, const glh::matrix4f &pose)
+{
+	if (!m_bCamera)
+		return CE_NOT_OPENED;
+	if (pDepth == NULL)
+		return CE_INVALID_PARAM;
+
+	m_bReference = false;
+	int nResult = Prepare(pDepth, m_nReference);
+	if (nResult != CE_SUCCESS)
+		return nResult;
+	m_referencePose = pose;
+	m_bReference = true;
+	return CE_SUCCESS;
+}
+
+/*************************************************************************************
+* normal equations
+*
+* The current vertex s(camera coordinates) moves to q = R s + t in the reference camera and is
+* projected into the grid of the level, which gives the reference pixel p with normal n. A pair
+* counts when |q - p| <= fMaxDistance and n . (R ns) >= cos(fMaxAngle). For the update
+* q' = q + w x q + v the residual n . (q' - p) has the Jacobian (q x n, n).
+*/
+
+void CCubeEyeICP::AccumulateRow(const Level &level, int y, const float *M, System &stSystem) const
+{
+	int nCurrent = 1 - m_nReference;
+	size_t nRow = (size_t)y * level.nWidth;
+	const float *pSX = level.vertex[nCurrent].getX() + nRow;
+	const float *pSY = level.vertex[nCurrent].getY() + nRow;
+	const float *pSZ = level.vertex[nCurrent].getZ() + nRow;
+	const float *pSNX = level.normal[nCurrent].getX() + nRow;
+	const float *pSNY = level.normal[nCurrent].getY() + nRow;
+	const float *pSNZ = level.normal[nCurrent].getZ() + nRow;
+	const float *pRX = level.vertex[m_nReference].getX();
+	const float *pRY = level.vertex[m_nReference].getY();
+	const float *pRZ = level.vertex[m_nReference].getZ();
+	const float *pRNX = level.normal[m_nReference].getX();
+	const float *pRNY = level.normal[m_nReference].getY();
+	const float *pRNZ = level.normal[m_nReference].getZ();
+	const int32 *pGrid = level.vGrid.data();
+
+	float fMaxDistance2 = m_stConfig.fMaxDistance * m_stConfig.fMaxDistance;
+	float fMinCos = cosf(m_stConfig.fMaxAngle * 3.14159265f / 180.0f);
+	//grid position = f * q / qz + c - grid origin
+	float fFx = level.stIntr.fFx, fFy = level.stIntr.fFy;
+	float fCx = level.stIntr.fCx - (float)level.nGridX;
+	float fCy = level.stIntr.fCy - (float)level.nGridY;
+	int nGridWidth = level.nGridWidth, nGridHeight = level.nGridHeight;
+	int x = 0;
+
+#if defined(CE_USE_AVX2)
+	__m256 vA[21], vB[6], vE, vN;
+	for (int k = 0; k < 21; k++)
+		vA[k] = _mm256_setzero_ps();
+	for (int k = 0; k < 6; k++)
+		vB[k] = _mm256_setzero_ps();
+	vE = _mm256_setzero_ps();
+	vN = _mm256_setzero_ps();
+
+	const __m256 vZero = _mm256_setzero_ps();
+	const __m256 vHalf = _mm256_set1_ps(0.5f);
+	const __m256i vGridW = _mm256_set1_epi32(nGridWidth);
+	const __m256i vGridH = _mm256_set1_epi32(nGridHeight);
+	const __m256i vMinus1 = _mm256_set1_epi32(-1);
+
+	for (; x + 8 <= level.nWidth; x += 8) {
+		__m256 sx = _mm256_loadu_ps(pSX + x), sy = _mm256_loadu_ps(pSY + x), sz = _mm256_loadu_ps(pSZ + x);
+		__m256 qx = _mm256_fmadd_ps(_mm256_set1_ps(M[0]), sx, _mm256_fmadd_ps(_mm256_set1_ps(M[1]), sy, _mm256_fmadd_ps(_mm256_set1_ps(M[2]), sz, _mm256_set1_ps(M[3]))));
+		__m256 qy = _mm256_fmadd_ps(_mm256_set1_ps(M[4]), sx, _mm256_fmadd_ps(_mm256_set1_ps(M[5]), sy, _mm256_fmadd_ps(_mm256_set1_ps(M[6]), sz, _mm256_set1_ps(M[7]))));
+		__m256 qz = _mm256_fmadd_ps(_mm256_set1_ps(M[8]), sx, _mm256_fmadd_ps(_mm256_set1_ps(M[9]), sy, _mm256_fmadd_ps(_mm256_set1_ps(M[10]), sz, _mm256_set1_ps(M[11]))));
+		__m256 vValid = _mm256_and_ps(_mm256_cmp_ps(sz, vZero, _CMP_GT_OQ), _mm256_cmp_ps(qz, vZero, _CMP_GT_OQ));
+		if (_mm256_movemask_ps(vValid) == 0)
+			continue;
+
+		//projective association
+		__m256 iz = _mm256_div_ps(_mm256_set1_ps(1.0f), qz);
+		__m256 gu = _mm256_fmadd_ps(_mm256_mul_ps(qx, iz), _mm256_set1_ps(fFx), _mm256_set1_ps(fCx));
+		__m256 gv = _mm256_fmadd_ps(_mm256_mul_ps(qy, iz), _mm256_set1_ps(fFy), _mm256_set1_ps(fCy));
+		//out of range lanes convert to INT_MIN and fail the bounds test
+		__m256i iu = _mm256_cvttps_epi32(_mm256_floor_ps(_mm256_add_ps(gu, vHalf)));
+		__m256i iv = _mm256_cvttps_epi32(_mm256_floor_ps(_mm256_add_ps(gv, vHalf)));
+		__m256i vIn = _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi32(iu, vMinus1), _mm256_cmpgt_epi32(vGridW, iu)),
+			_mm256_and_si256(_mm256_cmpgt_epi32(iv, vMinus1), _mm256_cmpgt_epi32(vGridH, iv)));
+		vIn = _mm256_and_si256(vIn, _mm256_castps_si256(vValid));
+		__m256i vCell = _mm256_and_si256(_mm256_add_epi32(_mm256_mullo_epi32(iv, vGridW), iu), vIn);
+		__m256i vPixel = _mm256_mask_i32gather_epi32(vMinus1, pGrid, vCell, vIn, 4);
+		__m256i vHit = _mm256_cmpgt_epi32(vPixel, vMinus1);
+		if (_mm256_movemask_epi8(vHit) == 0)
+			continue;
+		vPixel = _mm256_and_si256(vPixel, vHit);
+		__m256 vHitPs = _mm256_castsi256_ps(vHit);
+
+		__m256 px = _mm256_mask_i32gather_ps(vZero, pRX, vPixel, vHitPs, 4);
+		__m256 py = _mm256_mask_i32gather_ps(vZero, pRY, vPixel, vHitPs, 4);
+		__m256 pz = _mm256_mask_i32gather_ps(vZero, pRZ, vPixel, vHitPs, 4);
+		__m256 nx = _mm256_mask_i32gather_ps(vZero, pRNX, vPixel, vHitPs, 4);
+		__m256 ny = _mm256_mask_i32gather_ps(vZero, pRNY, vPixel, vHitPs, 4);
+		__m256 nz = _mm256_mask_i32gather_ps(vZero, pRNZ, vPixel, vHitPs, 4);
+
+		//rejection : distance and normal agreement(a missing normal on either side gives cos 0)
+		__m256 dx = _mm256_sub_ps(qx, px), dy = _mm256_sub_ps(qy, py), dz = _mm256_sub_ps(qz, pz);
+		__m256 d2 = _mm256_fmadd_ps(dx, dx, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dz, dz)));
+		__m256 snx = _mm256_loadu_ps(pSNX + x), sny = _mm256_loadu_ps(pSNY + x), snz = _mm256_loadu_ps(pSNZ + x);
+		__m256 rnx = _mm256_fmadd_ps(_mm256_set1_ps(M[0]), snx, _mm256_fmadd_ps(_mm256_set1_ps(M[1]), sny, _mm256_mul_ps(_mm256_set1_ps(M[2]), snz)));
+		__m256 rny = _mm256_fmadd_ps(_mm256_set1_ps(M[4]), snx, _mm256_fmadd_ps(_mm256_set1_ps(M[5]), sny, _mm256_mul_ps(_mm256_set1_ps(M[6]), snz)));
+		__m256 rnz = _mm256_fmadd_ps(_mm256_set1_ps(M[8]), snx, _mm256_fmadd_ps(_mm256_set1_ps(M[9]), sny, _mm256_mul_ps(_mm256_set1_ps(M[10]), snz)));
+		__m256 vCos = _mm256_fmadd_ps(nx, rnx, _mm256_fmadd_ps(ny, rny, _mm256_mul_ps(nz, rnz)));
+		__m256 vKeep = _mm256_and_ps(vHitPs, _mm256_and_ps(_mm256_cmp_ps(pz, vZero, _CMP_GT_OQ),
+			_mm256_and_ps(_mm256_cmp_ps(d2, _mm256_set1_ps(fMaxDistance2), _CMP_LE_OQ), _mm256_cmp_ps(vCos, _mm256_set1_ps(fMinCos), _CMP_GE_OQ))));
+		if (_mm256_movemask_ps(vKeep) == 0)
+			continue;
+
+		__m256 J[6];
+		J[0] = _mm256_and_ps(_mm256_fmsub_ps(qy, nz, _mm256_mul_ps(qz, ny)), vKeep);
+		J[1] = _mm256_and_ps(_mm256_fmsub_ps(qz, nx, _mm256_mul_ps(qx, nz)), vKeep);
+		J[2] = _mm256_and_ps(_mm256_fmsub_ps(qx, ny, _mm256_mul_ps(qy, nx)), vKeep);
+		J[3] = _mm256_and_ps(nx, vKeep);
+		J[4] = _mm256_and_ps(ny, vKeep);
+		J[5] = _mm256_and_ps(nz, vKeep);
+		__m256 r = _mm256_and_ps(_mm256_fmadd_ps(nx, dx, _mm256_fmadd_ps(ny, dy, _mm256_mul_ps(nz, dz))), vKeep);
+
+		int k = 0;
+		for (int i = 0; i < 6; i++) {
+			for (int j = i; j < 6; j++, k++)
+				vA[k] = _mm256_fmadd_ps(J[i], J[j], vA[k]);
+			vB[i] = _mm256_fmadd_ps(J[i], r, vB[i]);
+		}
+		vE = _mm256_fmadd_ps(r, r, vE);
+		vN = _mm256_add_ps(vN, _mm256_and_ps(_mm256_set1_ps(1.0f), vKeep));
+	}
+
+	for (int k = 0; k < 21; k++)
+		stSystem.fA[k] += HorizontalSum(vA[k]);
+	for (int k = 0; k < 6; k++)
+		stSystem.fB[k] += HorizontalSum(vB[k]);
+	stSystem.fError += HorizontalSum(vE);
+	stSystem.nCount += (uint64)HorizontalSum(vN);
+#endif
+
+	for (; x < level.nWidth; x++) {
+		float sz = pSZ[x];
+		if (sz <= 0.0f)
+			continue;
+		float sx = pSX[x], sy = pSY[x];
+		float qx = M[0] * sx + M[1] * sy + M[2] * sz + M[3];
+		float qy = M[4] * sx + M[5] * sy + M[6] * sz + M[7];
+		float qz = M[8] * sx + M[9] * sy + M[10] * sz + M[11];
+		if (qz <= 0.0f)
+			continue;
+
+		float gu = qx / qz * fFx + fCx;
+		float gv = qy / qz * fFy + fCy;
+		if (!(gu > -0.5f && gu < nGridWidth - 0.5f && gv > -0.5f && gv < nGridHeight - 0.5f))
+			continue;
+		int32 nPixel = pGrid[(size_t)floorf(gv + 0.5f) * nGridWidth + (size_t)floorf(gu + 0.5f)];
+		if (nPixel < 0 || pRZ[nPixel] <= 0.0f)
+			continue;
+
+		float nx = pRNX[nPixel], ny = pRNY[nPixel], nz = pRNZ[nPixel];
+		float dx = qx - pRX[nPixel], dy = qy - pRY[nPixel], dz = qz - pRZ[nPixel];
+		float snx = pSNX[x], sny = pSNY[x], snz = pSNZ[x];
+		float fCos = nx * (M[0] * snx + M[1] * sny + M[2] * snz) + ny * (M[4] * snx + M[5] * sny + M[6] * snz)
+			+ nz * (M[8] * snx + M[9] * sny + M[10] * snz);
+		if (dx * dx + dy * dy + dz * dz > fMaxDistance2 || fCos < fMinCos)
+			continue;
+
+		float J[6] = { qy * nz - qz * ny, qz * nx - qx * nz, qx * ny - qy * nx, nx, ny, nz };
+		float r = nx * dx + ny * dy + nz * dz;
+		int k = 0;
+		for (int i = 0; i < 6; i++) {
+			for (int j = i; j < 6; j++, k++)
+				stSystem.fA[k] += J[i] * J[j];
+			stSystem.fB[i] += J[i] * r;
+		}
+		stSystem.fError += r * r;
+		stSystem.nCount++;
+	}
+}
+
+void CCubeEyeICP::Accumulate(int nLevel, const float *pMotion, System &stSystem)
+{
+	const Level &level = m_level[nLevel];
+	int nChunks = (level.nHeight + CHUNK_ROWS - 1) / CHUNK_ROWS;
+	m_vChunkSystems.resize(nChunks);
+	System *pChunks = m_vChunkSystems.data();
+
+	ForChunks(level.nHeight, [&](int nChunk, int nRowBegin, int nRowEnd) {
+		System &stChunk = pChunks[nChunk];
+		memset(&stChunk, 0, sizeof(stChunk));
+		for (int y = nRowBegin; y < nRowEnd; y++)
+			AccumulateRow(level, y, pMotion, stChunk);
+	});
+
+	//chunk order keeps the sums independent of the thread count
+	memset(&stSystem, 0, sizeof(stSystem));
+	for (int c = 0; c < nChunks; c++) {
+		for (int k = 0; k < 21; k++)
+			stSystem.fA[k] += pChunks[c].fA[k];
+		for (int k = 0; k < 6; k++)
+			stSystem.fB[k] += pChunks[c].fB[k];
+		stSystem.fError += pChunks[c].fError;
+		stSystem.nCount += pChunks[c].nCount;
+	}
+}
+
+bool CCubeEyeICP::Solve(const System &stSystem, double *pX)
+{
+	//Cholesky of J^T J, then J^T J x = -J^T r
+	double L[6][6];
+	int k = 0;
+	for (int i = 0; i < 6; i++) {
+		for (int j = i; j < 6; j++, k++)
+			L[j][i] = stSystem.fA[k];
+	}
+	double fTrace = 0.0;
+	for (int i = 0; i < 6; i++)
+		fTrace += L[i][i];
+
+	for (int j = 0; j < 6; j++) {
+		double fDiag = L[j][j];
+		for (int m = 0; m < j; m++)
+			fDiag -= L[j][m] * L[j][m];
+		//numerically singular : a direction the correspondences do not constrain
+		if (!(fDiag > 1e-12 * fTrace))
+			return false;
+		L[j][j] = sqrt(fDiag);
+		for (int i = j + 1; i < 6; i++) {
+			double fSum = L[i][j];
+			for (int m = 0; m < j; m++)
+				fSum -= L[i][m] * L[j][m];
+			L[i][j] = fSum / L[j][j];
+		}
+	}
+
+	double y[6];
+	for (int i = 0; i < 6; i++) {
+		double fSum = -stSystem.fB[i];
+		for (int m = 0; m < i; m++)
+			fSum -= L[i][m] * y[m];
+		y[i] = fSum / L[i][i];
+	}
+	for (int i = 5; i >= 0; i--) {
+		double fSum = y[i];
+		for (int m = i + 1; m < 6; m++)
+			fSum -= L[m][i] * pX[m];
+		pX[i] = fSum / L[i][i];
+	}
+	return true;
+}
+
+/*************************************************************************************
+* alignment
+*/
+
+int CCubeEyeICP::Align(const uint16 *pDepth, glh::matrix4f &pose)
+{
+	if (!m_bCamera || !m_bReference)
+		return CE_NOT_OPENED;
+	if (pDepth == NULL)
+		return CE_INVALID_PARAM;
+
+	int nResult = Prepare(pDepth, 1 - m_nReference);
+	if (nResult != CE_SUCCESS)
+		return nResult;
+
+	//current to reference camera : T = reference^-1 * pose
+	glh::matrix4f motion = m_referencePose.inverse() * pose;
+	double R[9], t[3];
+	for (int r = 0; r < 3; r++) {
+		for (int c = 0; c < 3; c++)
+			R[r * 3 + c] = motion(r, c);
+		t[r] = motion(r, 3);
+	}
+
+	m_stResult.fRmse = 0.0f;
+	m_stResult.nCorrespondences = 0;
+	m_stResult.nIterations = 0;
+	bool bUpdated = false;
+
+	for (int l = m_stConfig.nLevels - 1; l >= 0; l--) {
+		for (int nIteration = 0; nIteration < m_stConfig.nIterations[l]; nIteration++) {
+			float M[12];
+			for (int r = 0; r < 3; r++) {
+				for (int c = 0; c < 3; c++)
+					M[r * 4 + c] = (float)R[r * 3 + c];
+				M[r * 4 + 3] = (float)t[r];
+			}
+
+			System stSystem;
+			Accumulate(l, M, stSystem);
+			m_stResult.nIterations++;
+			m_stResult.nCorrespondences = (uint32)stSystem.nCount;
+			m_stResult.fRmse = stSystem.nCount > 0 ? (float)sqrt(stSystem.fError / (double)stSystem.nCount) : 0.0f;
+
+			double x[6];
+			if (stSystem.nCount < (uint64)m_stConfig.nMinCorrespondences || !Solve(stSystem, x))
+				break;
+
+			//T <- dT * T
+			double dR[9], R2[9], t2[3];
+			Rodrigues(x, dR);
+			for (int r = 0; r < 3; r++) {
+				for (int c = 0; c < 3; c++)
+					R2[r * 3 + c] = dR[r * 3] * R[c] + dR[r * 3 + 1] * R[3 + c] + dR[r * 3 + 2] * R[6 + c];
+				t2[r] = dR[r * 3] * t[0] + dR[r * 3 + 1] * t[1] + dR[r * 3 + 2] * t[2] + x[3 + r];
+			}
+			memcpy(R, R2, sizeof(R));
+			memcpy(t, t2, sizeof(t));
+			bUpdated = true;
+
+			double fRotation = sqrt(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]);
+			double fTranslation = sqrt(x[3] * x[3] + x[4] * x[4] + x[5] * x[5]);
+			if (fRotation < m_stConfig.fStopRotation && fTranslation < m_stConfig.fStopTranslation)
+				break;
+		}
+	}
+
+	if (!bUpdated)
+		return CE_FAILED;
+
+	ToMatrix(R, t, motion);
+	m_stResult.rotation = ToQuaternion(R);
+	m_stResult.translation = glh::vec3f((float)t[0], (float)t[1], (float)t[2]);
+	pose = m_referencePose * motion;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeICP::Track(const uint16 *pDepth, glh::matrix4f &pose)
+{
+	if (!m_bReference) {
+		int nResult = SetReference(pDepth, pose);
+		m_stResult.rotation = glh::quaternionf();
+		m_stResult.translation = glh::vec3f(0.0f, 0.0f, 0.0f);
+		m_stResult.fRmse = 0.0f;
+		m_stResult.nCorrespondences = 0;
+		m_stResult.nIterations = 0;
+		return nResult;
+	}
+
+	int nResult = Align(pDepth, pose);
+	if (nResult != CE_SUCCESS && nResult != CE_FAILED)
+		return nResult;
+
+	//the current maps become the reference, with the unchanged guess when the alignment failed
+	m_nReference = 1 - m_nReference;
+	m_referencePose = pose;
+	return nResult;
+}
+
+}
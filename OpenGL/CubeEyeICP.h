@@ -0,0 +1,228 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeICP.h													*/
+/*																			*/
+/* @brief	Point to plane ICP odometry										*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeDepthPyramid.h"
+#include "CubeEyeNormals.h"
+#include "CubeEyeLens.h"
+
+#include <GL/glh_linear.h>
+
+namespace CUBE_EYE
+{
+
+///ICP configuration
+typedef struct _ceICPConfig
+{
+	///Pyramid levels used(1~CE_PYRAMID_MAX_LEVELS)
+	int nLevels;
+	///Iterations per level at most, level 0(full resolution) first
+	int nIterations[CE_PYRAMID_MAX_LEVELS];
+	///Distance between corresponding points at most(unit; m)
+	float fMaxDistance;
+	///Angle between corresponding normals at most(unit; degree)
+	float fMaxAngle;
+	///Depth range used(unit; m)
+	float fMinDepth;
+	float fMaxDepth;
+	///A level stops once an update turns less than fStopRotation(unit; rad) and moves less than fStopTranslation(unit; m)
+	float fStopRotation;
+	float fStopTranslation;
+	///Correspondences an update needs at least
+	int nMinCorrespondences;
+
+} ceICPConfig;
+
+///Result of the last alignment
+typedef struct _ceICPResult
+{
+	///Current camera to reference camera motion
+	glh::quaternionf rotation;
+	glh::vec3f translation;
+	///RMS point to plane distance of the last iteration(unit; m)
+	float fRmse;
+	///Correspondences of the last iteration
+	uint32 nCorrespondences;
+	///Iterations run over all levels
+	int nIterations;
+
+} ceICPResult;
+
+/**
+*
+*@brief		Point to plane ICP odometry
+*@details	Aligns a depth frame to a reference depth frame : frame-to-frame with Track, which
+			keeps the previous frame as the reference, or frame-to-model by giving SetReference a
+			depth frame rendered from the model at a known pose. Poses are camera to world
+			transforms(column vectors, unit; m) as in CCubeEyeTSDF.
+
+			Both frames go through a CCubeEyeDepthPyramid; every level is turned into vertices
+			with the undistorted rays of its pixels and gets organized normals. The solve runs
+			coarse to fine : each Gauss-Newton iteration transforms the current vertices into the
+			reference camera, associates them projectively(pinhole projection into a per-level
+			lookup grid that holds the distorted reference pixel of every cell, so the lens
+			model costs one gather), rejects pairs that are too far apart or whose normals
+			disagree, and accumulates the 6 x 6 normal equations of the residual
+			n . (q - p). Rows run in fixed chunks on the thread pool, 8 pixels per AVX2 step
+			with float sums per row folded into double sums per chunk; the chunks are added in
+			order, so the result does not depend on the thread count. A scene that leaves a
+			motion unconstrained(a single plane) only fails once the system is numerically
+			singular; otherwise the solve drifts along the free directions.
+*
+*/
+class CCubeEyeICP {
+
+public:
+
+	CCubeEyeICP();
+	~CCubeEyeICP();
+
+	/**
+	*
+	* @brief	Default configuration
+	* @details	3 levels with 4 / 5 / 10 iterations, 10 cm distance, 30 degree normal angle,
+				0.1 ~ 4 m depth, stop below 1e-4 rad / 0.1 mm, 100 correspondences.
+	* @return	configuration
+	*
+	*/
+	static ceICPConfig DefaultConfig();
+
+	/**
+	*
+	* @brief	Set configuration
+	* @details	A different level count drops the reference.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetConfig(const ceICPConfig &stConfig);
+	const ceICPConfig &GetConfig() const { return m_stConfig; }
+
+	/**
+	*
+	* @brief	Set depth camera
+	* @details	Builds the ray and association tables of every level and drops the reference.
+	* @param	stIntr, stDist - lens parameters(pIntrinsicParam / pDistortionParam).
+	* @param	nWidth, nHeight - depth frame size.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetCamera(const ceIntrinsicParam &stIntr, const ceDistortionParam &stDist, int nWidth, int nHeight);
+
+	template <class TDevice>
+	int SetCamera(const TDevice &device)
+	{
+		return SetCamera(device.pIntrinsicParam, device.pDistortionParam, device.pDevInfo.nWidth, device.pDevInfo.nHeight);
+	}
+
+	/**
+	*
+	* @brief	Set thread pool
+	* @details	NULL : single threaded. Default is CCubeEyeThreadPool::Default().
+	* @return	void
+	*
+	*/
+	void SetThreadPool(CCubeEyeThreadPool *pPool);
+
+	/**
+	*
+	* @brief	Set reference frame
+	* @param	pDepth - depth frame(unit; mm, 0 : invalid), a camera frame or a model rendering.
+	* @param	pose - camera to world transform pDepth was seen / rendered from.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetReference(const uint16 *pDepth, const glh::matrix4f &pose);
+
+	bool HasReference() const { return m_bReference; }
+	void ResetReference() { m_bReference = false; }
+
+	/**
+	*
+	* @brief	Align frame to the reference
+	* @param	pDepth - depth frame(unit; mm, 0 : invalid).
+	* @param	pose - in : initial guess(e.g. the reference pose), out : camera to world
+				transform of pDepth; unchanged on failure.
+	* @return	Success(0)|Error Code(< 0) - CE_FAILED if no level had enough correspondences
+				or a well-posed system.
+	*
+	*/
+	int Align(const uint16 *pDepth, glh::matrix4f &pose);
+
+	/**
+	*
+	* @brief	Frame-to-frame tracking
+	* @details	Aligns pDepth to the reference, then makes it the reference with the resulting
+				pose. The first frame only becomes the reference and keeps pose.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Track(const uint16 *pDepth, glh::matrix4f &pose);
+
+	///Result of the last Align / Track
+	const ceICPResult &getResult() const { return m_stResult; }
+
+private:
+
+	CCubeEyeICP(const CCubeEyeICP &);
+	CCubeEyeICP &operator=(const CCubeEyeICP &);
+
+	//normal equations : upper triangle of J^T J, J^T r, r^2, count
+	struct System
+	{
+		double fA[21];
+		double fB[6];
+		double fError;
+		uint64 nCount;
+	};
+
+	//pyramid level tables and maps, slot m_nReference holds the reference
+	struct Level
+	{
+		int nWidth;
+		int nHeight;
+		ceIntrinsicParam stIntr;			//pinhole projection into the grid
+		Vector<float> vRayX;				//undistorted ray of every pixel
+		Vector<float> vRayY;
+		int nGridX;							//grid cell (0, 0) is pinhole pixel (nGridX, nGridY)
+		int nGridY;
+		int nGridWidth;
+		int nGridHeight;
+		Vector<int32> vGrid;				//pixel of every cell, -1 : outside the frame
+		CCubeEyeNormals normals;
+		CCubeEyePointCloud vertex[2];
+		CCubeEyePointCloud normal[2];
+	};
+
+	template <class TFunc>
+	void ForChunks(int nRows, const TFunc &func);
+
+	int Prepare(const uint16 *pDepth, int nSlot);
+	void BuildLevel(int nLevel, const ceIntrinsicParam &stIntr, const ceDistortionParam &stDist);
+	void Vertices(int nLevel, int nSlot);
+	void Accumulate(int nLevel, const float *pMotion, System &stSystem);
+	void AccumulateRow(const Level &level, int y, const float *pMotion, System &stSystem) const;
+	static bool Solve(const System &stSystem, double *pX);
+
+	ceICPConfig m_stConfig;
+	CCubeEyeThreadPool *m_pPool;
+	bool m_bCamera;
+
+	CCubeEyeDepthPyramid m_pyramid;
+	Level m_level[CE_PYRAMID_MAX_LEVELS];
+	int m_nTableLevels;					//levels with tables(SetCamera)
+	Vector<System> m_vChunkSystems;
+
+	int m_nReference;					//slot of the reference maps
+	bool m_bReference;
+	glh::matrix4f m_referencePose;
+	ceICPResult m_stResult;
+};
+
+}
@@ -0,0 +1,119 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeLens.h													*/
+/*																			*/
+/* @brief	Lens model helpers for ceIntrinsicParam / ceDistortionParam		*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeHostDef.h"
+
+namespace CUBE_EYE
+{
+/*
+*	Brown-Conrady model on normalized image coordinates(x = X/Z, y = Y/Z) :
+*
+*		r2 = x*x + y*y
+*		xd = x*(1 + K1*r2 + K2*r2^2 + K3*r2^3) + 2*P1*x*y + P2*(r2 + 2*x*x)
+*		yd = y*(1 + K1*r2 + K2*r2^2 + K3*r2^3) + P1*(r2 + 2*y*y) + 2*P2*x*y
+*		u  = Fx*(xd + Skew*yd) + Cx
+*		v  = Fy*yd + Cy
+*/
+
+/**
+*
+* @brief	Distort normalized point
+* @details	Applies K1/K2/K3 radial and P1/P2 tangential distortion.
+* @return	void
+*
+*/
+inline void ceDistortPoint(const ceDistortionParam &stDist, float x, float y, float &xd, float &yd)
+{
+	float r2 = x * x + y * y;
+	float fRadial = 1.0f + r2 * (stDist.fK1 + r2 * (stDist.fK2 + r2 * stDist.fK3));
+	xd = x * fRadial + 2.0f * stDist.fP1 * x * y + stDist.fP2 * (r2 + 2.0f * x * x);
+	yd = y * fRadial + stDist.fP1 * (r2 + 2.0f * y * y) + 2.0f * stDist.fP2 * x * y;
+}
+
+/**
+*
+* @brief	Project normalized point to pixel
+* @return	void
+*
+*/
+inline void ceProjectPoint(const ceIntrinsicParam &stIntr, const ceDistortionParam &stDist, float x, float y, float &u, float &v)
+{
+	float xd, yd;
+	ceDistortPoint(stDist, x, y, xd, yd);
+	u = stIntr.fFx * (xd + stDist.fSkew * yd) + stIntr.fCx;
+	v = stIntr.fFy * yd + stIntr.fCy;
+}
+
+/**
+*
+* @brief	Undistort pixel
+* @details	Returns the normalized ray(x, y, 1) of pixel(u, v) by fixed point iteration.
+* @param	nIteration - number of iterations(5 ~ 10 is enough for ToF lenses).
+* @return	void
+*
+*/
+inline void ceUndistortPixel(const ceIntrinsicParam &stIntr, const ceDistortionParam &stDist, float u, float v, float &x, float &y, int nIteration = 8)
+{
+	float yd = (v - stIntr.fCy) / stIntr.fFy;
+	float xd = (u - stIntr.fCx) / stIntr.fFx - stDist.fSkew * yd;
+
+	x = xd;
+	y = yd;
+	for (int i = 0; i < nIteration; i++) {
+		float r2 = x * x + y * y;
+		float fRadial = 1.0f + r2 * (stDist.fK1 + r2 * (stDist.fK2 + r2 * stDist.fK3));
+		float dx = 2.0f * stDist.fP1 * x * y + stDist.fP2 * (r2 + 2.0f * x * x);
+		float dy = stDist.fP1 * (r2 + 2.0f * y * y) + 2.0f * stDist.fP2 * x * y;
+		x = (xd - dx) / fRadial;
+		y = (yd - dy) / fRadial;
+	}
+}
+
+/**
+*
+* @brief	Build ray table
+* @details	Undistorts every pixel of a nWidth x nHeight frame into its normalized ray(x/z, y/z).
+* @param	pRayX, pRayY - nWidth x nHeight output planes.
+* @return	void
+*
+*/
+inline void ceBuildRayTable(const ceIntrinsicParam &stIntr, const ceDistortionParam &stDist, int nWidth, int nHeight, float *pRayX, float *pRayY)
+{
+	for (int v = 0; v < nHeight; v++) {
+		for (int u = 0; u < nWidth; u++) {
+			size_t i = (size_t)v * nWidth + u;
+			ceUndistortPixel(stIntr, stDist, (float)u, (float)v, pRayX[i], pRayY[i]);
+		}
+	}
+}
+
+/**
+*
+* @brief	Build remap table
+* @details	For every pixel of the undistorted image(same intrinsics, no distortion), the position
+			of the same ray in the distorted image.
+* @param	pMapX, pMapY - nWidth x nHeight output planes.
+* @return	void
+*
+*/
+inline void ceBuildRemapTable(const ceIntrinsicParam &stIntr, const ceDistortionParam &stDist, int nWidth, int nHeight, float *pMapX, float *pMapY)
+{
+	for (int v = 0; v < nHeight; v++) {
+		for (int u = 0; u < nWidth; u++) {
+			size_t i = (size_t)v * nWidth + u;
+			float x = (u - stIntr.fCx) / stIntr.fFx;
+			float y = (v - stIntr.fCy) / stIntr.fFy;
+			ceProjectPoint(stIntr, stDist, x, y, pMapX[i], pMapY[i]);
+		}
+	}
+}
+
+}
@@ -0,0 +1,161 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeLensCache.cpp											*/
+/*																			*/
+/* @brief	Persistent ray / remap table cache keyed by camera serial		*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeLensCache.h"
+
+namespace CUBE_EYE
+{
+
+static const char s_szLensMagic[8] = { 'C', 'E', 'L', 'E', 'N', 'S', 0, 0 };
+
+#define LENS_PLANE_COUNT	4
+#define LENS_PLANE_ALIGN	64
+
+static uint32 LensChecksum(const ceLensCacheHeader &stHeader)
+{
+	//FNV-1a
+	const uint8 *p = (const uint8 *)&stHeader;
+	size_t nSize = offsetof(ceLensCacheHeader, nChecksum);
+	uint32 nHash = 2166136261U;
+	for (size_t i = 0; i < nSize; i++) {
+		nHash ^= p[i];
+		nHash *= 16777619U;
+	}
+	return nHash;
+}
+
+static void LensHeader(ceLensCacheHeader &stHeader, const char *szSerialNumber, const ceIntrinsicParam &stIntrinsics,
+	const ceDistortionParam &stDistortion, int nWidth, int nHeight)
+{
+	//zero first so that padding and unused serial bytes compare equal
+	memset(&stHeader, 0, sizeof(stHeader));
+	memcpy(stHeader.szMagic, s_szLensMagic, sizeof(stHeader.szMagic));
+	stHeader.nVersion = CE_LENS_CACHE_VERSION;
+	stHeader.nHeaderSize = sizeof(ceLensCacheHeader);
+	stHeader.nWidth = nWidth;
+	stHeader.nHeight = nHeight;
+	for (size_t i = 0; i < sizeof(stHeader.szSerialNumber) && szSerialNumber[i] != 0; i++)
+		stHeader.szSerialNumber[i] = szSerialNumber[i];
+	stHeader.stIntrinsics = stIntrinsics;
+	stHeader.stDistortion = stDistortion;
+
+	uint64 nPlaneSize = ((uint64)nWidth * nHeight * sizeof(float) + LENS_PLANE_ALIGN - 1) & ~(uint64)(LENS_PLANE_ALIGN - 1);
+	uint64 nOffset = (sizeof(ceLensCacheHeader) + LENS_PLANE_ALIGN - 1) & ~(uint64)(LENS_PLANE_ALIGN - 1);
+	for (int i = 0; i < LENS_PLANE_COUNT; i++) {
+		stHeader.nPlaneOffset[i] = nOffset;
+		nOffset += nPlaneSize;
+	}
+	stHeader.nFileSize = nOffset;
+	stHeader.nChecksum = LensChecksum(stHeader);
+}
+
+CCubeEyeLensCache::CCubeEyeLensCache()
+	: m_strDirectory(".")
+{
+}
+
+int CCubeEyeLensCache::SetDirectory(const char *szDirectory)
+{
+	if (szDirectory == NULL || szDirectory[0] == 0)
+		return CE_INVALID_PARAM;
+
+	m_strDirectory = szDirectory;
+	return CE_SUCCESS;
+}
+
+std::string CCubeEyeLensCache::getEntryPath(const char *szSerialNumber, int nWidth, int nHeight) const
+{
+	//keep only characters that are safe in a file name
+	std::string strSerial;
+	for (int i = 0; i < 16 && szSerialNumber[i] != 0; i++) {
+		char c = szSerialNumber[i];
+		bool bSafe = (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '-' || c == '_';
+		strSerial += bSafe ? c : '_';
+	}
+	if (strSerial.empty())
+		strSerial = "unknown";
+
+	std::ostringstream oss;
+	oss << m_strDirectory << "/" << strSerial << "_" << nWidth << "x" << nHeight << ".celens";
+	return oss.str();
+}
+
+int CCubeEyeLensCache::Build(const std::string &strPath, const char *szSerialNumber, const ceIntrinsicParam &stIntrinsics,
+	const ceDistortionParam &stDistortion, int nWidth, int nHeight)
+{
+	ceLensCacheHeader stHeader;
+	LensHeader(stHeader, szSerialNumber, stIntrinsics, stDistortion, nWidth, nHeight);
+
+	Vector<uint8> vFile((size_t)stHeader.nFileSize, 0);
+	memcpy(&vFile[0], &stHeader, sizeof(stHeader));
+
+	float *pPlane[LENS_PLANE_COUNT];
+	for (int i = 0; i < LENS_PLANE_COUNT; i++)
+		pPlane[i] = (float *)&vFile[(size_t)stHeader.nPlaneOffset[i]];
+
+	ceBuildRayTable(stIntrinsics, stDistortion, nWidth, nHeight, pPlane[0], pPlane[1]);
+	ceBuildRemapTable(stIntrinsics, stDistortion, nWidth, nHeight, pPlane[2], pPlane[3]);
+
+	//write aside and swap in, so another process never maps a half written entry
+	std::ostringstream oss;
+	oss << strPath << "." << ceHostTimeStamp() << ".tmp";
+	std::string strTemp = oss.str();
+
+	FILE *pFile = fopen(strTemp.c_str(), "wb");
+	if (pFile == NULL)
+		return CE_WRITE_FAILED;
+	size_t nWritten = fwrite(&vFile[0], 1, vFile.size(), pFile);
+	int nClose = fclose(pFile);
+	if (nWritten != vFile.size() || nClose != 0) {
+		remove(strTemp.c_str());
+		return CE_WRITE_FAILED;
+	}
+
+	if (ceReplaceFile(strTemp.c_str(), strPath.c_str()) != CE_SUCCESS) {
+		remove(strTemp.c_str());
+		return CE_WRITE_FAILED;
+	}
+
+	return CE_SUCCESS;
+}
+
+int CCubeEyeLensCache::Load(const char *szSerialNumber, const ceIntrinsicParam &stIntrinsics, const ceDistortionParam &stDistortion,
+	int nWidth, int nHeight, CCubeEyeLensTable &pTable)
+{
+	if (szSerialNumber == NULL || nWidth <= 0 || nHeight <= 0 || stIntrinsics.fFx <= 0.0f || stIntrinsics.fFy <= 0.0f)
+		return CE_INVALID_PARAM;
+
+	pTable.Close();
+
+	ceLensCacheHeader stExpected;
+	LensHeader(stExpected, szSerialNumber, stIntrinsics, stDistortion, nWidth, nHeight);
+	std::string strPath = getEntryPath(szSerialNumber, nWidth, nHeight);
+
+	for (int nTry = 0; nTry < 2; nTry++) {
+		//whole header compare : any calibration, size or format change makes the entry stale
+		if (pTable.m_file.Open(strPath.c_str()) == CE_SUCCESS
+			&& pTable.m_file.getSize() == stExpected.nFileSize
+			&& memcmp(pTable.m_file.getData(), &stExpected, sizeof(stExpected)) == 0) {
+			pTable.m_pHeader = (const ceLensCacheHeader *)pTable.m_file.getData();
+			return nTry == 0 ? CE_SUCCESS : CE_WARNING;
+		}
+		pTable.m_file.Close();
+
+		if (nTry == 0) {
+			int nResult = Build(strPath, szSerialNumber, stIntrinsics, stDistortion, nWidth, nHeight);
+			if (nResult != CE_SUCCESS)
+				return nResult;
+		}
+	}
+
+	return CE_READ_FAILED;
+}
+
+}
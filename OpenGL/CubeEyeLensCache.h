@@ -0,0 +1,150 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeLensCache.h												*/
+/*																			*/
+/* @brief	Persistent ray / remap table cache keyed by camera serial		*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeLens.h"
+#include "CubeEyeMappedFile.h"
+
+#include <string>
+
+namespace CUBE_EYE
+{
+
+///Lens cache file header(little endian, followed by the table planes)
+typedef struct _ceLensCacheHeader
+{
+	///"CELENS\0\0"
+	char szMagic[8];
+	///CE_LENS_CACHE_VERSION
+	uint32 nVersion;
+	///sizeof(ceLensCacheHeader)
+	uint32 nHeaderSize;
+	///Frame Width
+	int32 nWidth;
+	///Frame Height
+	int32 nHeight;
+	///Camera serial number(getSerialNumber)
+	char szSerialNumber[16];
+	///Calibration the tables were built from
+	ceIntrinsicParam stIntrinsics;
+	ceDistortionParam stDistortion;
+	///File offset of RayX, RayY, RemapX, RemapY planes(float, nWidth x nHeight)
+	uint64 nPlaneOffset[4];
+	///Total file size
+	uint64 nFileSize;
+	///FNV-1a of the header up to this field
+	uint32 nChecksum;
+	uint32 nReserved;
+
+} ceLensCacheHeader;
+
+#define CE_LENS_CACHE_VERSION	1
+
+/**
+*
+*@brief		Mapped lens table
+*@details	Read-only view of one cache entry :
+			- RayX / RayY : normalized ray(x/z, y/z) of every distorted pixel(CCubeEyeDepthToPCL)
+			- RemapX / RemapY : for every pixel of the undistorted image(same intrinsics, no distortion),
+			  the source position in the distorted image
+*
+*/
+class CCubeEyeLensTable {
+
+	friend class CCubeEyeLensCache;
+
+public:
+
+	CCubeEyeLensTable() : m_pHeader(NULL) {}
+
+	bool IsValid() const { return m_pHeader != NULL; }
+	int getWidth() const { return m_pHeader->nWidth; }
+	int getHeight() const { return m_pHeader->nHeight; }
+	const float *getRayX() const { return getPlane(0); }
+	const float *getRayY() const { return getPlane(1); }
+	const float *getRemapX() const { return getPlane(2); }
+	const float *getRemapY() const { return getPlane(3); }
+
+	void Close() { m_pHeader = NULL; m_file.Close(); }
+
+private:
+
+	const float *getPlane(int nPlane) const { return (const float *)(m_file.getData() + m_pHeader->nPlaneOffset[nPlane]); }
+
+	CCubeEyeMappedFile m_file;
+	const ceLensCacheHeader *m_pHeader;
+};
+
+/**
+*
+*@brief		Lens table cache
+*@details	One file per camera and resolution(<serial>_<width>x<height>.celens) in a cache directory.
+			Load() maps the file when it matches the camera's current calibration; otherwise(missing,
+			corrupt or calibration changed) it rebuilds the tables, writes them to a temporary file,
+			swaps it in and maps the result.
+*
+*/
+class CCubeEyeLensCache {
+
+public:
+
+	CCubeEyeLensCache();
+
+	/**
+	*
+	* @brief	Set cache directory
+	* @details	The directory must exist. Default is the current directory.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetDirectory(const char *szDirectory);
+
+	/**
+	*
+	* @brief	Load lens table
+	* @param	szSerialNumber - camera serial number(up to 16 byte).
+	* @param	stIntrinsics, stDistortion - current depth camera calibration.
+	* @param	nWidth, nHeight - frame size.
+	* @param	pTable - receives the mapped table.
+	* @return	Success(0)|CE_WARNING(rebuilt)|Error Code(< 0)
+	*
+	*/
+	int Load(const char *szSerialNumber, const ceIntrinsicParam &stIntrinsics, const ceDistortionParam &stDistortion,
+		int nWidth, int nHeight, CCubeEyeLensTable &pTable);
+
+	/**
+	*
+	* @brief	Load lens table of a connected device
+	* @details	Uses getSerialNumber, pIntrinsicParam, pDistortionParam and pDevInfo of CCubeEye(or CCubeEyeSim).
+	* @return	Success(0)|CE_WARNING(rebuilt)|Error Code(< 0)
+	*
+	*/
+	template <class TDevice>
+	int Load(TDevice &device, CCubeEyeLensTable &pTable)
+	{
+		char szSerialNumber[17] = { 0 };
+		int nResult = device.getSerialNumber(szSerialNumber);
+		if (nResult < 0)
+			return nResult;
+		return Load(szSerialNumber, device.pIntrinsicParam, device.pDistortionParam, device.pDevInfo.nWidth, device.pDevInfo.nHeight, pTable);
+	}
+
+	///Cache file path of an entry
+	std::string getEntryPath(const char *szSerialNumber, int nWidth, int nHeight) const;
+
+private:
+
+	int Build(const std::string &strPath, const char *szSerialNumber, const ceIntrinsicParam &stIntrinsics,
+		const ceDistortionParam &stDistortion, int nWidth, int nHeight);
+
+	std::string m_strDirectory;
+};
+
+}
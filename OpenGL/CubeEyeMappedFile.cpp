@@ -0,0 +1,130 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeMappedFile.cpp											*/
+/*																			*/
+/* @brief	Read-only memory mapped file									*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeMappedFile.h"
+
+#ifdef Linux
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace CUBE_EYE
+{
+
+CCubeEyeMappedFile::CCubeEyeMappedFile()
+	: m_pData(NULL), m_nSize(0)
+#ifndef Linux
+	, m_hFile(INVALID_HANDLE_VALUE), m_hMapping(NULL)
+#endif
+{
+}
+
+CCubeEyeMappedFile::~CCubeEyeMappedFile()
+{
+	Close();
+}
+
+#ifndef Linux
+
+int CCubeEyeMappedFile::Open(const char *szPath)
+{
+	Close();
+
+	m_hFile = CreateFileA(szPath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (m_hFile == INVALID_HANDLE_VALUE)
+		return CE_NOT_FOUND;
+
+	LARGE_INTEGER nSize;
+	if (!GetFileSizeEx(m_hFile, &nSize) || nSize.QuadPart == 0) {
+		Close();
+		return CE_READ_FAILED;
+	}
+
+	m_hMapping = CreateFileMappingA(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m_hMapping == NULL) {
+		Close();
+		return CE_OPEN_FAILED;
+	}
+
+	m_pData = (const uint8 *)MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (m_pData == NULL) {
+		Close();
+		return CE_OPEN_FAILED;
+	}
+
+	m_nSize = (size_t)nSize.QuadPart;
+	return CE_SUCCESS;
+}
+
+void CCubeEyeMappedFile::Close()
+{
+	if (m_pData != NULL)
+		UnmapViewOfFile(m_pData);
+	if (m_hMapping != NULL)
+		CloseHandle(m_hMapping);
+	if (m_hFile != INVALID_HANDLE_VALUE)
+		CloseHandle(m_hFile);
+
+	m_pData = NULL;
+	m_nSize = 0;
+	m_hMapping = NULL;
+	m_hFile = INVALID_HANDLE_VALUE;
+}
+
+int ceReplaceFile(const char *szFrom, const char *szTo)
+{
+	return MoveFileExA(szFrom, szTo, MOVEFILE_REPLACE_EXISTING) ? CE_SUCCESS : CE_WRITE_FAILED;
+}
+
+#else
+
+int CCubeEyeMappedFile::Open(const char *szPath)
+{
+	Close();
+
+	int nFd = open(szPath, O_RDONLY);
+	if (nFd < 0)
+		return CE_NOT_FOUND;
+
+	struct stat stStat;
+	if (fstat(nFd, &stStat) != 0 || stStat.st_size == 0) {
+		close(nFd);
+		return CE_READ_FAILED;
+	}
+
+	void *pData = mmap(NULL, (size_t)stStat.st_size, PROT_READ, MAP_SHARED, nFd, 0);
+	close(nFd);
+	if (pData == MAP_FAILED)
+		return CE_OPEN_FAILED;
+
+	m_pData = (const uint8 *)pData;
+	m_nSize = (size_t)stStat.st_size;
+	return CE_SUCCESS;
+}
+
+void CCubeEyeMappedFile::Close()
+{
+	if (m_pData != NULL)
+		munmap((void *)m_pData, m_nSize);
+
+	m_pData = NULL;
+	m_nSize = 0;
+}
+
+int ceReplaceFile(const char *szFrom, const char *szTo)
+{
+	return rename(szFrom, szTo) == 0 ? CE_SUCCESS : CE_WRITE_FAILED;
+}
+
+#endif
+
+}
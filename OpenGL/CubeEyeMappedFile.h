@@ -0,0 +1,73 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeMappedFile.h												*/
+/*																			*/
+/* @brief	Read-only memory mapped file									*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeHostDef.h"
+
+namespace CUBE_EYE
+{
+/**
+*
+*@brief		Read-only memory mapped file
+*@details	Maps a whole file(MapViewOfFile on Windows, mmap on Linux). The mapping stays
+			valid until Close() or destruction.
+*
+*/
+class CCubeEyeMappedFile {
+
+public:
+
+	CCubeEyeMappedFile();
+	~CCubeEyeMappedFile();
+
+	/**
+	*
+	* @brief	Map file
+	* @param	szPath - file path.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Open(const char *szPath);
+
+	/**
+	*
+	* @brief	Unmap file
+	* @return	void
+	*
+	*/
+	void Close();
+
+	bool IsOpened() const { return m_pData != NULL; }
+	const uint8 *getData() const { return m_pData; }
+	size_t getSize() const { return m_nSize; }
+
+private:
+
+	CCubeEyeMappedFile(const CCubeEyeMappedFile &);
+	CCubeEyeMappedFile &operator=(const CCubeEyeMappedFile &);
+
+	const uint8 *m_pData;
+	size_t m_nSize;
+#ifndef Linux
+	HANDLE m_hFile;
+	HANDLE m_hMapping;
+#endif
+};
+
+/**
+*
+* @brief	Replace file
+* @details	Renames szFrom to szTo, replacing szTo if it exists.
+* @return	Success(0)|Error Code(< 0)
+*
+*/
+int ceReplaceFile(const char *szFrom, const char *szTo);
+
+}
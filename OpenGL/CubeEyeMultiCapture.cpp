@@ -0,0 +1,345 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeMultiCapture.cpp											*/
+/*																			*/
+/* @brief	Multi-camera synchronized capture								*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeMultiCapture.h"
+
+namespace CUBE_EYE
+{
+
+#define SYNC_WAIT_MS		5		//wait for a missing head frame, then re-check the stop flag
+
+/*************************************************************************************
+* CFrameSet
+*/
+
+CCubeEyeMultiCapture::CFrameSet::CFrameSet(CFrameSet &&other)
+	: m_vFrames(std::move(other.m_vFrames)), m_nSetID(other.m_nSetID), m_nTimeStamp(other.m_nTimeStamp)
+{
+	other.m_vFrames.clear();
+}
+
+CCubeEyeMultiCapture::CFrameSet &CCubeEyeMultiCapture::CFrameSet::operator=(CFrameSet &&other)
+{
+	if (this != &other) {
+		Release();
+		m_vFrames = std::move(other.m_vFrames);
+		m_nSetID = other.m_nSetID;
+		m_nTimeStamp = other.m_nTimeStamp;
+		other.m_vFrames.clear();
+	}
+	return *this;
+}
+
+void CCubeEyeMultiCapture::CFrameSet::Release()
+{
+	//CFrameRef destruction gives the slots back
+	m_vFrames.clear();
+}
+
+/*************************************************************************************
+* CCubeEyeMultiCapture
+*/
+
+CCubeEyeMultiCapture::CCubeEyeMultiCapture()
+	: m_stConfig(DefaultConfig()), m_bStarted(false), m_bStop(false), m_nNextSetID(0), m_nSetCount(0), m_nDroppedSets(0)
+{
+}
+
+CCubeEyeMultiCapture::~CCubeEyeMultiCapture()
+{
+	Stop();
+}
+
+ceMultiCaptureConfig CCubeEyeMultiCapture::DefaultConfig()
+{
+	ceMultiCaptureConfig stConfig;
+	stConfig.nToleranceUs = 10000;
+	stConfig.nRingSlots = 8;
+	stConfig.nQueueSets = 2;
+	return stConfig;
+}
+
+int CCubeEyeMultiCapture::SetConfig(const ceMultiCaptureConfig &stConfig)
+{
+	//every queued set, the sync thread head and one consumer set may hold a slot of each ring
+	if (stConfig.nQueueSets < 1 || stConfig.nRingSlots < stConfig.nQueueSets + 3)
+		return CE_INVALID_PARAM;
+	if (!m_vDevices.empty())
+		return CE_FAILED;
+
+	m_stConfig = stConfig;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeMultiCapture::AddSource(CCubeEyeFrameRing::ReadFunc readFunc, int nWidth, int nHeight)
+{
+	if (!readFunc)
+		return CE_INVALID_PARAM;
+	if (m_bStarted)
+		return CE_FAILED;
+
+	std::unique_ptr<Device> pDevice(new Device);
+	int nResult = pDevice->ring.Create(nWidth, nHeight, m_stConfig.nRingSlots);
+	if (nResult != CE_SUCCESS)
+		return nResult;
+
+	pDevice->readFunc = readFunc;
+	pDevice->nOffsetUs = 0;
+	pDevice->nLastSeq = 0;
+	pDevice->nHeadTime = 0;
+	pDevice->nOverrun = 0;
+	pDevice->nUnmatched = 0;
+	pDevice->nMatched = 0;
+	pDevice->fSkewSumUs = 0.0;
+	pDevice->fSkewMaxUs = 0.0f;
+	pDevice->nLastTimeStamp = 0;
+	pDevice->nBaseCaptured = 0;
+	pDevice->nBaseDropped = 0;
+	pDevice->nBaseReadErrors = 0;
+
+	m_vDevices.push_back(std::move(pDevice));
+	return (int)m_vDevices.size() - 1;
+}
+
+int CCubeEyeMultiCapture::SetTimeOffset(int nDevice, int64 nOffsetUs)
+{
+	if (nDevice < 0 || nDevice >= (int)m_vDevices.size())
+		return CE_INVALID_PARAM;
+	if (m_bStarted)
+		return CE_FAILED;
+
+	m_vDevices[nDevice]->nOffsetUs = nOffsetUs;
+	return CE_SUCCESS;
+}
+
+void CCubeEyeMultiCapture::Clear()
+{
+	Stop();
+	m_vDevices.clear();
+}
+
+/*************************************************************************************
+* start / stop
+*/
+
+int CCubeEyeMultiCapture::Start()
+{
+	if (m_vDevices.empty())
+		return CE_NOT_OPENED;
+	if (m_bStarted)
+		return CE_SUCCESS;
+
+	for (size_t d = 0; d < m_vDevices.size(); d++) {
+		int nResult = m_vDevices[d]->ring.StartCapture(m_vDevices[d]->readFunc);
+		if (nResult != CE_SUCCESS) {
+			while (d-- > 0)
+				m_vDevices[d]->ring.StopCapture();
+			return nResult;
+		}
+	}
+
+	m_bStop.store(false);
+	m_syncThread = std::thread(&CCubeEyeMultiCapture::SyncThread, this);
+	m_bStarted = true;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeMultiCapture::Stop()
+{
+	if (!m_bStarted)
+		return CE_SUCCESS;
+
+	m_bStop.store(true);
+	m_syncThread.join();
+
+	for (size_t d = 0; d < m_vDevices.size(); d++)
+		m_vDevices[d]->ring.StopCapture();
+
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		m_qSets.clear();
+	}
+	m_queueCond.notify_all();
+
+	m_bStarted = false;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeMultiCapture::WaitSet(CFrameSet &frameSet, uint32 nTimeoutMs)
+{
+	if (!m_bStarted)
+		return CE_NOT_OPENED;
+
+	std::unique_lock<std::mutex> lock(m_queueMutex);
+	if (!m_queueCond.wait_for(lock, std::chrono::milliseconds(nTimeoutMs), [this] { return !m_qSets.empty(); }))
+		return CE_GETFRAME_FAILED;
+
+	frameSet = std::move(m_qSets.front());
+	m_qSets.pop_front();
+	return CE_SUCCESS;
+}
+
+/*************************************************************************************
+* sync thread
+*/
+
+bool CCubeEyeMultiCapture::FillHeads()
+{
+	for (size_t d = 0; d < m_vDevices.size(); d++) {
+		Device &device = *m_vDevices[d];
+		if (device.head.IsValid())
+			continue;
+
+		//block on the first missing device only; the others keep capturing meanwhile
+		if (device.ring.AcquireNext(device.head, device.nLastSeq, SYNC_WAIT_MS) != CE_SUCCESS)
+			return false;
+
+		uint64 nSeq = device.head.getSequence();
+		device.nHeadTime = (TimeStampType)((int64)device.head.getFrameInfo().nTimeStamp + device.nOffsetUs);
+
+		std::lock_guard<std::mutex> lock(m_statsMutex);
+		device.nOverrun += nSeq - device.nLastSeq - 1;
+		device.nLastSeq = nSeq;
+		device.nLastTimeStamp = device.nHeadTime;
+	}
+	return true;
+}
+
+bool CCubeEyeMultiCapture::DiscardStale()
+{
+	int64 nNewest = (int64)m_vDevices[0]->nHeadTime;
+	for (size_t d = 1; d < m_vDevices.size(); d++) {
+		if ((int64)m_vDevices[d]->nHeadTime > nNewest)
+			nNewest = (int64)m_vDevices[d]->nHeadTime;
+	}
+
+	//a head older than the window of the newest head can not meet a frame of that device any more
+	bool bDiscarded = false;
+	for (size_t d = 0; d < m_vDevices.size(); d++) {
+		Device &device = *m_vDevices[d];
+		if (nNewest - (int64)device.nHeadTime > (int64)m_stConfig.nToleranceUs) {
+			device.head.Release();
+			bDiscarded = true;
+
+			std::lock_guard<std::mutex> lock(m_statsMutex);
+			device.nUnmatched++;
+		}
+	}
+	return bDiscarded;
+}
+
+void CCubeEyeMultiCapture::EmitSet()
+{
+	size_t nDevices = m_vDevices.size();
+	int64 nSum = 0;
+	for (size_t d = 0; d < nDevices; d++)
+		nSum += (int64)m_vDevices[d]->nHeadTime;
+	int64 nMean = nSum / (int64)nDevices;
+
+	CFrameSet frameSet;
+	frameSet.m_vFrames.resize(nDevices);
+	frameSet.m_nTimeStamp = (TimeStampType)nMean;
+	{
+		std::lock_guard<std::mutex> lock(m_statsMutex);
+		for (size_t d = 0; d < nDevices; d++) {
+			Device &device = *m_vDevices[d];
+			float fSkew = (float)llabs((int64)device.nHeadTime - nMean);
+			device.nMatched++;
+			device.fSkewSumUs += fSkew;
+			if (fSkew > device.fSkewMaxUs)
+				device.fSkewMaxUs = fSkew;
+			frameSet.m_vFrames[d] = std::move(device.head);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		frameSet.m_nSetID = ++m_nNextSetID;
+		m_nSetCount++;
+		if ((int)m_qSets.size() >= m_stConfig.nQueueSets) {
+			m_qSets.pop_front();
+			m_nDroppedSets++;
+		}
+		m_qSets.push_back(std::move(frameSet));
+	}
+	m_queueCond.notify_one();
+}
+
+void CCubeEyeMultiCapture::SyncThread()
+{
+	while (!m_bStop.load()) {
+		if (!FillHeads())
+			continue;
+		if (DiscardStale())
+			continue;
+		EmitSet();
+	}
+
+	for (size_t d = 0; d < m_vDevices.size(); d++)
+		m_vDevices[d]->head.Release();
+}
+
+/*************************************************************************************
+* statistics
+*/
+
+int CCubeEyeMultiCapture::getStats(int nDevice, ceCaptureStats &stStats)
+{
+	if (nDevice < 0 || nDevice >= (int)m_vDevices.size())
+		return CE_INVALID_PARAM;
+
+	Device &device = *m_vDevices[nDevice];
+	std::lock_guard<std::mutex> lock(m_statsMutex);
+	stStats.nCaptured = device.ring.getPublishedCount() - device.nBaseCaptured;
+	stStats.nDropped = device.ring.getDroppedCount() - device.nBaseDropped + device.nOverrun;
+	stStats.nUnmatched = device.nUnmatched;
+	stStats.nMatched = device.nMatched;
+	stStats.nReadErrors = device.ring.getReadErrorCount() - device.nBaseReadErrors;
+	stStats.fSkewMeanUs = device.nMatched ? (float)(device.fSkewSumUs / device.nMatched) : 0.0f;
+	stStats.fSkewMaxUs = device.fSkewMaxUs;
+	stStats.nLastTimeStamp = device.nLastTimeStamp;
+	return CE_SUCCESS;
+}
+
+uint64 CCubeEyeMultiCapture::getSetCount()
+{
+	std::lock_guard<std::mutex> lock(m_queueMutex);
+	return m_nSetCount;
+}
+
+uint64 CCubeEyeMultiCapture::getDroppedSetCount()
+{
+	std::lock_guard<std::mutex> lock(m_queueMutex);
+	return m_nDroppedSets;
+}
+
+void CCubeEyeMultiCapture::ResetStats()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_statsMutex);
+		for (size_t d = 0; d < m_vDevices.size(); d++) {
+			Device &device = *m_vDevices[d];
+			device.nBaseCaptured = device.ring.getPublishedCount();
+			device.nBaseDropped = device.ring.getDroppedCount();
+			device.nBaseReadErrors = device.ring.getReadErrorCount();
+			device.nOverrun = 0;
+			device.nUnmatched = 0;
+			device.nMatched = 0;
+			device.fSkewSumUs = 0.0;
+			device.fSkewMaxUs = 0.0f;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(m_queueMutex);
+	m_nSetCount = 0;
+	m_nDroppedSets = 0;
+}
+
+}
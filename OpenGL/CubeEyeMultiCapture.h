@@ -0,0 +1,282 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeMultiCapture.h											*/
+/*																			*/
+/* @brief	Multi-camera synchronized capture								*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeFrameRing.h"
+
+#include <deque>
+#include <memory>
+
+namespace CUBE_EYE
+{
+
+///Multi capture configuration
+typedef struct _ceMultiCaptureConfig
+{
+	///Frames whose time stamps are at most nToleranceUs apart form a set(unit; us)
+	uint32 nToleranceUs;
+	///Ring slots per device(held sets and the sync thread borrow from them)
+	int nRingSlots;
+	///Complete sets kept for consumers, the oldest is dropped when full
+	int nQueueSets;
+
+} ceMultiCaptureConfig;
+
+///Per-device capture statistics
+typedef struct _ceCaptureStats
+{
+	///Frames read from the device
+	uint64 nCaptured;
+	///Frames lost in the device ring(every slot held by sets) or overwritten before matching
+	uint64 nDropped;
+	///Frames discarded by the sync thread : no frame of another device within tolerance
+	uint64 nUnmatched;
+	///Frames delivered in sets
+	uint64 nMatched;
+	///Failed ReadDepthIRFrame calls
+	uint64 nReadErrors;
+	///Mean / max |frame time stamp - set time stamp|(unit; us)
+	float fSkewMeanUs;
+	float fSkewMaxUs;
+	///Time stamp of the last frame seen by the sync thread(offset applied)
+	TimeStampType nLastTimeStamp;
+
+} ceCaptureStats;
+
+/**
+*
+*@brief		Multi-camera synchronized capture
+*@details	Every device gets its own CCubeEyeFrameRing and capture thread, so a slow device
+			never stalls the others and capture scales with the number of cameras. A sync
+			thread walks the rings and groups one frame per device into a set when all their
+			nTimeStamp(plus the device offset) lie within nToleranceUs; a frame older than the
+			tolerance window of the newest head frame can not be matched any more and is
+			discarded. Sets hold the ring slots by reference, nothing is copied.
+
+			Usage : connect and Start every device, AddDevice each, Start, then WaitSet in
+			the consumer loop.
+*
+*/
+class CCubeEyeMultiCapture {
+
+public:
+
+	/**
+	*
+	*@brief		Synchronized frame set
+	*@details	One borrowed frame per device, in AddDevice order. Move only; the slots go back
+				to the rings on Release or destruction.
+	*
+	*/
+	class CFrameSet {
+
+		friend class CCubeEyeMultiCapture;
+
+	public:
+
+		CFrameSet() : m_nSetID(0), m_nTimeStamp(0) {}
+		CFrameSet(CFrameSet &&other);
+		CFrameSet &operator=(CFrameSet &&other);
+
+		void Release();
+
+		bool IsValid() const { return !m_vFrames.empty(); }
+		int getCount() const { return (int)m_vFrames.size(); }
+		const CCubeEyeFrameRing::CFrameRef &getFrame(int nDevice) const { return m_vFrames[nDevice]; }
+
+		///Set number(1, 2, ...)
+		uint64 getSetID() const { return m_nSetID; }
+		///Mean time stamp of the frames(offsets applied)
+		TimeStampType getTimeStamp() const { return m_nTimeStamp; }
+
+	private:
+
+		CFrameSet(const CFrameSet &);
+		CFrameSet &operator=(const CFrameSet &);
+
+		Vector<CCubeEyeFrameRing::CFrameRef> m_vFrames;
+		uint64 m_nSetID;
+		TimeStampType m_nTimeStamp;
+	};
+
+	CCubeEyeMultiCapture();
+	~CCubeEyeMultiCapture();
+
+	/*************************************************************************************
+	* \defgroup Initialization
+	* @{
+	*/
+
+	/**
+	*
+	* @brief	Default configuration
+	* @details	10 ms tolerance, 8 ring slots, 2 queued sets.
+	* @return	configuration
+	*
+	*/
+	static ceMultiCaptureConfig DefaultConfig();
+
+	/**
+	*
+	* @brief	Set configuration
+	* @details	Must be called before AddDevice.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetConfig(const ceMultiCaptureConfig &stConfig);
+
+	const ceMultiCaptureConfig &GetConfig() const { return m_stConfig; }
+
+	/**
+	*
+	* @brief	Add frame source
+	* @details	Must be called before Start.
+	* @param	readFunc - same signature as ReadDepthIRFrame.
+	* @param	nWidth, nHeight - frame size.
+	* @return	device index(>= 0)|Error Code(< 0)
+	*
+	*/
+	int AddSource(CCubeEyeFrameRing::ReadFunc readFunc, int nWidth, int nHeight);
+
+	/**
+	*
+	* @brief	Add device
+	* @details	Any connected and started device exposing pDevInfo and ReadDepthIRFrame
+				(CCubeEye, CCubeEyeSim, CCubeEyePlayback). It must outlive the capture.
+	* @return	device index(>= 0)|Error Code(< 0)
+	*
+	*/
+	template <class TDevice>
+	int AddDevice(TDevice &device)
+	{
+		TDevice *pDevice = &device;
+		return AddSource([pDevice](uint16 *pDepth, uint16 *pIR, ceFrameInfo &pFrameInfo) {
+			return pDevice->ReadDepthIRFrame(pDepth, pIR, pFrameInfo);
+		}, device.pDevInfo.nWidth, device.pDevInfo.nHeight);
+	}
+
+	/**
+	*
+	* @brief	Time stamp offset
+	* @details	Added to the nTimeStamp of nDevice before matching, for devices whose clocks
+				differ by a known amount(unit; us).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetTimeOffset(int nDevice, int64 nOffsetUs);
+
+	/**
+	*
+	* @brief	Remove every device
+	* @details	Capture must be stopped and every CFrameSet released.
+	* @return	void
+	*
+	*/
+	void Clear();
+
+	int getDeviceCount() const { return (int)m_vDevices.size(); }
+
+	/**@}*/
+
+	/*************************************************************************************
+	* \defgroup Start/Stop Capture
+	* @{
+	*/
+
+	int Start();
+
+	/**
+	*
+	* @brief	Stop
+	* @details	Stops the capture and sync threads and drops the queued sets.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Stop();
+
+	/**
+	*
+	* @brief	Wait for the next complete set
+	* @param	frameSet - receives the oldest queued set.
+	* @param	nTimeoutMs - wait time(unit; ms).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int WaitSet(CFrameSet &frameSet, uint32 nTimeoutMs = 100);
+
+	/**@}*/
+
+	/*************************************************************************************
+	* \defgroup Statistics
+	* @{
+	*/
+
+	int getStats(int nDevice, ceCaptureStats &stStats);
+
+	///Sets delivered to the queue
+	uint64 getSetCount();
+	///Sets dropped because the queue was full
+	uint64 getDroppedSetCount();
+
+	void ResetStats();
+
+	/**@}*/
+
+private:
+
+	struct Device
+	{
+		CCubeEyeFrameRing ring;
+		CCubeEyeFrameRing::ReadFunc readFunc;
+		int64 nOffsetUs;
+		uint64 nLastSeq;			//last ring sequence taken by the sync thread
+		CCubeEyeFrameRing::CFrameRef head;
+		TimeStampType nHeadTime;
+
+		//sync thread counters(m_statsMutex)
+		uint64 nOverrun;
+		uint64 nUnmatched;
+		uint64 nMatched;
+		double fSkewSumUs;
+		float fSkewMaxUs;
+		TimeStampType nLastTimeStamp;
+
+		//ring counters at ResetStats
+		uint64 nBaseCaptured;
+		uint64 nBaseDropped;
+		uint64 nBaseReadErrors;
+	};
+
+	CCubeEyeMultiCapture(const CCubeEyeMultiCapture &);
+	CCubeEyeMultiCapture &operator=(const CCubeEyeMultiCapture &);
+
+	void SyncThread();
+	bool FillHeads();
+	bool DiscardStale();
+	void EmitSet();
+
+	ceMultiCaptureConfig m_stConfig;
+	Vector<std::unique_ptr<Device> > m_vDevices;
+	bool m_bStarted;
+
+	std::thread m_syncThread;
+	std::atomic<bool> m_bStop;
+
+	std::mutex m_queueMutex;
+	std::condition_variable m_queueCond;
+	std::deque<CFrameSet> m_qSets;
+	uint64 m_nNextSetID;
+	uint64 m_nSetCount;
+	uint64 m_nDroppedSets;
+
+	std::mutex m_statsMutex;
+};
+
+}
@@ -0,0 +1,649 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeNeighborIndex.cpp										*/
+/*																			*/
+/* @brief	Radius / k nearest neighbour search on point clouds				*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeNeighborIndex.h"
+
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+namespace CUBE_EYE
+{
+
+#define ROW_GRAIN		16
+#define QUERY_GRAIN		256			//queries per band
+#define LEAF_SIZE		16			//tree points per leaf at most
+#define PARALLEL_DEPTH	4			//tree levels split serially before the subtrees go parallel
+#define STACK_SIZE		64			//tree traversal stack(depth <= 28 for 2^32 points)
+#define WINDOW_MARGIN	1			//pixels added to the grid bounds(lens distortion)
+
+CCubeEyeNeighborIndex::CCubeEyeNeighborIndex()
+	: m_pPool(&CCubeEyeThreadPool::Default()), m_nMaxWindow(16), m_eMode(Neighbor_Grid),
+	m_nWidth(0), m_nHeight(0), m_nCount(0), m_pX(NULL), m_pY(NULL), m_pZ(NULL),
+	m_pMaskedZ(NULL), m_nMaskedZSize(0), m_fPitchX(0.0f), m_fPitchY(0.0f), m_fRayScale(1.0f),
+	m_nLeafDepth(0)
+{
+}
+
+CCubeEyeNeighborIndex::~CCubeEyeNeighborIndex()
+{
+	if (m_pMaskedZ != NULL)
+		ceAlignedFree(m_pMaskedZ);
+}
+
+int CCubeEyeNeighborIndex::SetMaxWindow(int nMaxWindow)
+{
+	if (nMaxWindow < 1)
+		return CE_INVALID_PARAM;
+
+	m_nMaxWindow = nMaxWindow;
+	return CE_SUCCESS;
+}
+
+void CCubeEyeNeighborIndex::KBest::Insert(uint32 nIndex, float fDistance2)
+{
+	int n;
+	if (nCount < k)
+		n = nCount++;
+	else if (fDistance2 < pDistances2[k - 1])
+		n = k - 1;
+	else
+		return;
+
+	for (; n > 0 && pDistances2[n - 1] > fDistance2; n--) {
+		pDistances2[n] = pDistances2[n - 1];
+		pIndices[n] = pIndices[n - 1];
+	}
+	pDistances2[n] = fDistance2;
+	pIndices[n] = nIndex;
+}
+
+/*************************************************************************************
+* build
+*/
+
+int CCubeEyeNeighborIndex::Build(const CCubeEyePointCloud &cloud)
+{
+	return Build(cloud, cloud.IsOrganized() ? Neighbor_Grid : Neighbor_Tree);
+}
+
+int CCubeEyeNeighborIndex::Build(const CCubeEyePointCloud &cloud, neighbor_mode eMode)
+{
+	m_pZ = NULL;
+	if (cloud.getZ() == NULL)
+		return CE_NOT_OPENED;
+	if (eMode == Neighbor_Grid && !cloud.IsOrganized())
+		return CE_UNSUPPORTED;
+	if (cloud.getCount() > (size_t)0xFFFFFFFF)
+		return CE_OUTOFRANGE;
+
+	m_eMode = eMode;
+	m_nWidth = cloud.getWidth();
+	m_nHeight = cloud.getHeight();
+	m_nCount = cloud.getCount();
+	m_pX = cloud.getX();
+	m_pY = cloud.getY();
+
+	//the searches only look at Z : fold the mask into it
+	const float *pZ = cloud.getZ();
+	if (cloud.HasMask()) {
+		if (m_pMaskedZ == NULL || m_nCount > m_nMaskedZSize) {
+			float *pMaskedZ = (float *)ceAlignedAlloc(m_nCount * sizeof(float));
+			if (pMaskedZ == NULL)
+				return CE_FAILED;
+			if (m_pMaskedZ != NULL)
+				ceAlignedFree(m_pMaskedZ);
+			m_pMaskedZ = pMaskedZ;
+			m_nMaskedZSize = m_nCount;
+		}
+
+		float *pMaskedZ = m_pMaskedZ;
+		const CCubeEyePointCloud *pCloud = &cloud;
+		size_t nCount = m_nCount;
+		auto fold = [=](int nBegin, int nEnd) {
+			size_t nLast = (size_t)nEnd * QUERY_GRAIN < nCount ? (size_t)nEnd * QUERY_GRAIN : nCount;
+			for (size_t i = (size_t)nBegin * QUERY_GRAIN; i < nLast; i++)
+				pMaskedZ[i] = pCloud->IsValid(i) ? pZ[i] : 0.0f;
+		};
+		int nBlocks = (int)((nCount + QUERY_GRAIN - 1) / QUERY_GRAIN);
+		if (m_pPool != NULL)
+			m_pPool->ParallelFor(0, nBlocks, ROW_GRAIN, fold);
+		else
+			fold(0, nBlocks);
+		pZ = m_pMaskedZ;
+	}
+	m_pZ = pZ;
+
+	if (eMode == Neighbor_Grid)
+		BuildGrid();
+	else
+		BuildTree();
+	return CE_SUCCESS;
+}
+
+void CCubeEyeNeighborIndex::BuildGrid()
+{
+	//per row : smallest ray step to the right and down neighbours, widest ray
+	const int nWidth = m_nWidth, nHeight = m_nHeight;
+	const float *pX = m_pX, *pY = m_pY, *pZ = m_pZ;
+	m_vRowStats.resize((size_t)nHeight * 3);
+	float *pStats = m_vRowStats.data();
+	auto rows = [=](int nRowBegin, int nRowEnd) {
+		for (int y = nRowBegin; y < nRowEnd; y++) {
+			float fPitchX = FLT_MAX, fPitchY = FLT_MAX, fTan2 = 0.0f;
+			for (int x = 0; x < nWidth; x++) {
+				size_t i = (size_t)y * nWidth + x;
+				if (!(pZ[i] > 0.0f))
+					continue;
+
+				float a = pX[i] / pZ[i], b = pY[i] / pZ[i];
+				fTan2 = std::max(fTan2, a * a + b * b);
+				if (x + 1 < nWidth && pZ[i + 1] > 0.0f) {
+					float fStep = fabsf(pX[i + 1] / pZ[i + 1] - a);
+					if (fStep > 0.0f)
+						fPitchX = std::min(fPitchX, fStep);
+				}
+				if (y + 1 < nHeight && pZ[i + nWidth] > 0.0f) {
+					float fStep = fabsf(pY[i + nWidth] / pZ[i + nWidth] - b);
+					if (fStep > 0.0f)
+						fPitchY = std::min(fPitchY, fStep);
+				}
+			}
+			pStats[y * 3] = fPitchX;
+			pStats[y * 3 + 1] = fPitchY;
+			pStats[y * 3 + 2] = fTan2;
+		}
+	};
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, nHeight, ROW_GRAIN, rows);
+	else
+		rows(0, nHeight);
+
+	float fPitchX = FLT_MAX, fPitchY = FLT_MAX, fTan2 = 0.0f;
+	for (int y = 0; y < nHeight; y++) {
+		fPitchX = std::min(fPitchX, pStats[y * 3]);
+		fPitchY = std::min(fPitchY, pStats[y * 3 + 1]);
+		fTan2 = std::max(fTan2, pStats[y * 3 + 2]);
+	}
+
+	//no valid neighbours : no bound, the windows stay at nMaxWindow
+	m_fPitchX = fPitchX == FLT_MAX ? 0.0f : fPitchX;
+	m_fPitchY = fPitchY == FLT_MAX ? 0.0f : fPitchY;
+	m_fRayScale = sqrtf(1.0f + fTan2);
+}
+
+uint32 CCubeEyeNeighborIndex::SplitNode(uint32 nNode, uint32 nBegin, uint32 nEnd)
+{
+	//median of the widest axis
+	uint32 *pIndex = m_vTreeIndex.data();
+	const float *pAxes[3] = { m_pX, m_pY, m_pZ };
+	float fMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, fMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (uint32 i = nBegin; i < nEnd; i++) {
+		for (int a = 0; a < 3; a++) {
+			float f = pAxes[a][pIndex[i]];
+			fMin[a] = std::min(fMin[a], f);
+			fMax[a] = std::max(fMax[a], f);
+		}
+	}
+	int nAxis = 0;
+	for (int a = 1; a < 3; a++) {
+		if (fMax[a] - fMin[a] > fMax[nAxis] - fMin[nAxis])
+			nAxis = a;
+	}
+
+	uint32 nMid = (nBegin + nEnd) / 2;
+	const float *pAxis = pAxes[nAxis];
+	if (nEnd > nBegin) {
+		std::nth_element(pIndex + nBegin, pIndex + nMid, pIndex + nEnd,
+			[pAxis](uint32 a, uint32 b) { return pAxis[a] < pAxis[b]; });
+	}
+	m_vAxis[nNode] = (uint8)nAxis;
+	m_vSplit[nNode] = nMid < nEnd ? pAxis[pIndex[nMid]] : 0.0f;
+	return nMid;
+}
+
+void CCubeEyeNeighborIndex::BuildSubtree(uint32 nNode, uint32 nBegin, uint32 nEnd)
+{
+	if (nNode >= m_vSplit.size())
+		return;
+
+	uint32 nMid = SplitNode(nNode, nBegin, nEnd);
+	BuildSubtree(nNode * 2 + 1, nBegin, nMid);
+	BuildSubtree(nNode * 2 + 2, nMid, nEnd);
+}
+
+void CCubeEyeNeighborIndex::BuildTree()
+{
+	m_vTreeIndex.clear();
+	for (size_t i = 0; i < m_nCount; i++) {
+		if (m_pZ[i] > 0.0f)
+			m_vTreeIndex.push_back((uint32)i);
+	}
+
+	//every leaf at the same depth : node ranges follow from the point count
+	uint32 nPoints = (uint32)m_vTreeIndex.size();
+	m_nLeafDepth = 0;
+	while (((uint64)nPoints + ((uint64)1 << m_nLeafDepth) - 1) >> m_nLeafDepth > LEAF_SIZE)
+		m_nLeafDepth++;
+	size_t nInner = ((size_t)1 << m_nLeafDepth) - 1;
+	m_vSplit.resize(nInner);
+	m_vAxis.resize(nInner);
+
+	//top levels serially, then the subtrees in parallel
+	m_vSubtrees.clear();
+	m_vSubtrees.push_back(0);
+	m_vSubtrees.push_back(0);
+	m_vSubtrees.push_back(nPoints);
+	for (uint32 nLevel = 0; nLevel < PARALLEL_DEPTH && nLevel < m_nLeafDepth; nLevel++) {
+		size_t nLevelCount = m_vSubtrees.size() / 3;
+		for (size_t s = 0; s < nLevelCount; s++) {
+			uint32 nNode = m_vSubtrees[s * 3], nBegin = m_vSubtrees[s * 3 + 1], nEnd = m_vSubtrees[s * 3 + 2];
+			uint32 nMid = SplitNode(nNode, nBegin, nEnd);
+			m_vSubtrees.push_back(nNode * 2 + 1);
+			m_vSubtrees.push_back(nBegin);
+			m_vSubtrees.push_back(nMid);
+			m_vSubtrees.push_back(nNode * 2 + 2);
+			m_vSubtrees.push_back(nMid);
+			m_vSubtrees.push_back(nEnd);
+		}
+		m_vSubtrees.erase(m_vSubtrees.begin(), m_vSubtrees.begin() + nLevelCount * 3);
+	}
+
+	const uint32 *pSubtrees = m_vSubtrees.data();
+	auto subtrees = [this, pSubtrees](int nBegin, int nEnd) {
+		for (int s = nBegin; s < nEnd; s++)
+			BuildSubtree(pSubtrees[s * 3], pSubtrees[s * 3 + 1], pSubtrees[s * 3 + 2]);
+	};
+	int nSubtrees = (int)(m_vSubtrees.size() / 3);
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, nSubtrees, 1, subtrees);
+	else
+		subtrees(0, nSubtrees);
+
+	//leaf order SoA copy : leaves scan contiguous memory
+	m_vTreePoints.resize((size_t)nPoints * 3);
+	float *pTX = m_vTreePoints.data(), *pTY = pTX + nPoints, *pTZ = pTY + nPoints;
+	const uint32 *pIndex = m_vTreeIndex.data();
+	const float *pX = m_pX, *pY = m_pY, *pZ = m_pZ;
+	auto copy = [=](int nBegin, int nEnd) {
+		uint32 nLast = (uint32)nEnd * QUERY_GRAIN < nPoints ? (uint32)nEnd * QUERY_GRAIN : nPoints;
+		for (uint32 i = (uint32)nBegin * QUERY_GRAIN; i < nLast; i++) {
+			pTX[i] = pX[pIndex[i]];
+			pTY[i] = pY[pIndex[i]];
+			pTZ[i] = pZ[pIndex[i]];
+		}
+	};
+	int nBlocks = (int)((nPoints + QUERY_GRAIN - 1) / QUERY_GRAIN);
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, nBlocks, ROW_GRAIN, copy);
+	else
+		copy(0, nBlocks);
+}
+
+/*************************************************************************************
+* batches
+*/
+
+template <class TQuery>
+void CCubeEyeNeighborIndex::Run(int nQueries, ceNeighborList &result, const TQuery &query)
+{
+	//bands fill their own buffers, then are copied in order behind the prefix sum
+	int nBands = (nQueries + QUERY_GRAIN - 1) / QUERY_GRAIN;
+	if ((int)m_vBands.size() < nBands)
+		m_vBands.resize(nBands);
+	result.vOffsets.resize((size_t)nQueries + 1);
+	result.vOffsets[0] = 0;
+
+	Band *pBands = m_vBands.data();
+	uint32 *pOffsets = result.vOffsets.data();
+	auto bands = [&](int nBandBegin, int nBandEnd) {
+		for (int b = nBandBegin; b < nBandEnd; b++) {
+			Band &band = pBands[b];
+			band.vIndices.clear();
+			band.vDistances2.clear();
+			int nEnd = (b + 1) * QUERY_GRAIN < nQueries ? (b + 1) * QUERY_GRAIN : nQueries;
+			for (int q = b * QUERY_GRAIN; q < nEnd; q++) {
+				query(q, band);
+				pOffsets[q + 1] = (uint32)band.vIndices.size();
+			}
+		}
+	};
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, nBands, 1, bands);
+	else
+		bands(0, nBands);
+
+	uint32 nTotal = 0;
+	for (int b = 0; b < nBands; b++) {
+		int nEnd = (b + 1) * QUERY_GRAIN < nQueries ? (b + 1) * QUERY_GRAIN : nQueries;
+		for (int q = b * QUERY_GRAIN; q < nEnd; q++)
+			pOffsets[q + 1] += nTotal;
+		nTotal += (uint32)pBands[b].vIndices.size();
+	}
+	result.vIndices.resize(nTotal);
+	result.vDistances2.resize(nTotal);
+
+	uint32 *pIndices = result.vIndices.data();
+	float *pDistances2 = result.vDistances2.data();
+	auto copy = [=](int nBandBegin, int nBandEnd) {
+		for (int b = nBandBegin; b < nBandEnd; b++) {
+			size_t nSize = pBands[b].vIndices.size();
+			if (nSize == 0)
+				continue;
+			uint32 nBase = pOffsets[b * QUERY_GRAIN];
+			memcpy(pIndices + nBase, pBands[b].vIndices.data(), nSize * sizeof(uint32));
+			memcpy(pDistances2 + nBase, pBands[b].vDistances2.data(), nSize * sizeof(float));
+		}
+	};
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, nBands, 1, copy);
+	else
+		copy(0, nBands);
+}
+
+template <class TSearch>
+void CCubeEyeNeighborIndex::Knn(Band &band, int k, const TSearch &search) const
+{
+	//the k best are kept in place at the end of the band
+	size_t nBase = band.vIndices.size();
+	band.vIndices.resize(nBase + k);
+	band.vDistances2.resize(nBase + k);
+	KBest best = { band.vIndices.data() + nBase, band.vDistances2.data() + nBase, 0, k };
+	search(best);
+	band.vIndices.resize(nBase + best.nCount);
+	band.vDistances2.resize(nBase + best.nCount);
+}
+
+int CCubeEyeNeighborIndex::CheckQueries(const uint32 *pQueries, int nQueries) const
+{
+	if (m_pZ == NULL)
+		return CE_NOT_OPENED;
+	if (pQueries == NULL)
+		return m_nCount > (size_t)0x7FFFFFFF ? CE_OUTOFRANGE : CE_SUCCESS;
+	if (nQueries < 0)
+		return CE_INVALID_PARAM;
+
+	for (int q = 0; q < nQueries; q++) {
+		if (pQueries[q] >= m_nCount)
+			return CE_OUTOFRANGE;
+	}
+	return CE_SUCCESS;
+}
+
+int CCubeEyeNeighborIndex::RadiusSearch(const uint32 *pQueries, int nQueries, float fRadius, ceNeighborList &result)
+{
+	int nResult = CheckQueries(pQueries, nQueries);
+	if (nResult != CE_SUCCESS)
+		return nResult;
+	if (!(fRadius > 0.0f))
+		return CE_INVALID_PARAM;
+	if (pQueries == NULL)
+		nQueries = (int)m_nCount;
+
+	Run(nQueries, result, [&](int q, Band &band) {
+		uint32 n = pQueries != NULL ? pQueries[q] : (uint32)q;
+		if (!(m_pZ[n] > 0.0f))
+			return;
+		if (m_eMode == Neighbor_Grid) {
+			GridRadius(n, fRadius, band);
+		} else {
+			float fQuery[3] = { m_pX[n], m_pY[n], m_pZ[n] };
+			TreeRadius(fQuery, fRadius, band);
+		}
+	});
+	return CE_SUCCESS;
+}
+
+int CCubeEyeNeighborIndex::RadiusSearch(const cePointCloud *pPoints, int nQueries, float fRadius, ceNeighborList &result)
+{
+	if (m_pZ == NULL)
+		return CE_NOT_OPENED;
+	if (m_eMode != Neighbor_Tree)
+		return CE_UNSUPPORTED;
+	if (pPoints == NULL || nQueries < 0 || !(fRadius > 0.0f))
+		return CE_INVALID_PARAM;
+
+	Run(nQueries, result, [&](int q, Band &band) {
+		float fQuery[3] = { pPoints[q].fX, pPoints[q].fY, pPoints[q].fZ };
+		TreeRadius(fQuery, fRadius, band);
+	});
+	return CE_SUCCESS;
+}
+
+int CCubeEyeNeighborIndex::KnnSearch(const uint32 *pQueries, int nQueries, int k, ceNeighborList &result)
+{
+	int nResult = CheckQueries(pQueries, nQueries);
+	if (nResult != CE_SUCCESS)
+		return nResult;
+	if (k < 1)
+		return CE_INVALID_PARAM;
+	if (pQueries == NULL)
+		nQueries = (int)m_nCount;
+
+	Run(nQueries, result, [&](int q, Band &band) {
+		uint32 n = pQueries != NULL ? pQueries[q] : (uint32)q;
+		if (!(m_pZ[n] > 0.0f))
+			return;
+		Knn(band, k, [&](KBest &best) {
+			if (m_eMode == Neighbor_Grid) {
+				GridKnn(n, best);
+			} else {
+				float fQuery[3] = { m_pX[n], m_pY[n], m_pZ[n] };
+				TreeKnn(fQuery, best);
+			}
+		});
+	});
+	return CE_SUCCESS;
+}
+
+int CCubeEyeNeighborIndex::KnnSearch(const cePointCloud *pPoints, int nQueries, int k, ceNeighborList &result)
+{
+	if (m_pZ == NULL)
+		return CE_NOT_OPENED;
+	if (m_eMode != Neighbor_Tree)
+		return CE_UNSUPPORTED;
+	if (pPoints == NULL || nQueries < 0 || k < 1)
+		return CE_INVALID_PARAM;
+
+	Run(nQueries, result, [&](int q, Band &band) {
+		float fQuery[3] = { pPoints[q].fX, pPoints[q].fY, pPoints[q].fZ };
+		Knn(band, k, [&](KBest &best) { TreeKnn(fQuery, best); });
+	});
+	return CE_SUCCESS;
+}
+
+/*************************************************************************************
+* grid
+*/
+
+int CCubeEyeNeighborIndex::Window(float fRadius, float fZ, float fPitch) const
+{
+	//a point s pixels away is at least fZ * s * fPitch / m_fRayScale away
+	if (!(fPitch > 0.0f))
+		return m_nMaxWindow;
+	float fWindow = fRadius * m_fRayScale / (fZ * fPitch) + WINDOW_MARGIN;
+	return fWindow >= (float)m_nMaxWindow ? m_nMaxWindow : (int)fWindow;
+}
+
+void CCubeEyeNeighborIndex::GridRadius(uint32 nQuery, float fRadius, Band &band) const
+{
+	const int nWidth = m_nWidth;
+	const int u = (int)(nQuery % nWidth), v = (int)(nQuery / nWidth);
+	const float qX = m_pX[nQuery], qY = m_pY[nQuery], qZ = m_pZ[nQuery], fRadius2 = fRadius * fRadius;
+	const int wx = Window(fRadius, qZ, m_fPitchX), wy = Window(fRadius, qZ, m_fPitchY);
+	const int x0 = std::max(u - wx, 0), x1 = std::min(u + wx + 1, nWidth);
+	const int y0 = std::max(v - wy, 0), y1 = std::min(v + wy + 1, m_nHeight);
+
+	for (int y = y0; y < y1; y++) {
+		const size_t nRow = (size_t)y * nWidth;
+		int x = x0;
+#if defined(CE_USE_AVX2)
+		const __m256 vQX = _mm256_set1_ps(qX), vQY = _mm256_set1_ps(qY), vQZ = _mm256_set1_ps(qZ);
+		const __m256 vRadius2 = _mm256_set1_ps(fRadius2), vZero = _mm256_setzero_ps();
+		for (; x + 8 <= x1; x += 8) {
+			size_t i = nRow + x;
+			__m256 z = _mm256_loadu_ps(m_pZ + i);
+			__m256 dx = _mm256_sub_ps(_mm256_loadu_ps(m_pX + i), vQX);
+			__m256 dy = _mm256_sub_ps(_mm256_loadu_ps(m_pY + i), vQY);
+			__m256 dz = _mm256_sub_ps(z, vQZ);
+			__m256 fDistance2 = _mm256_fmadd_ps(dx, dx, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dz, dz)));
+			int nMask = _mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(z, vZero, _CMP_GT_OQ),
+				_mm256_cmp_ps(fDistance2, vRadius2, _CMP_LE_OQ)));
+			if (nMask == 0)
+				continue;
+
+			float fDistances2[8];
+			_mm256_storeu_ps(fDistances2, fDistance2);
+			for (int l = 0; l < 8; l++) {
+				if ((nMask >> l) & 1) {
+					band.vIndices.push_back((uint32)(i + l));
+					band.vDistances2.push_back(fDistances2[l]);
+				}
+			}
+		}
+#endif
+		for (; x < x1; x++) {
+			size_t i = nRow + x;
+			float fZ = m_pZ[i];
+			if (!(fZ > 0.0f))
+				continue;
+			float dx = m_pX[i] - qX, dy = m_pY[i] - qY, dz = fZ - qZ;
+			float fDistance2 = dx * dx + dy * dy + dz * dz;
+			if (fDistance2 <= fRadius2) {
+				band.vIndices.push_back((uint32)i);
+				band.vDistances2.push_back(fDistance2);
+			}
+		}
+	}
+}
+
+void CCubeEyeNeighborIndex::GridKnn(uint32 nQuery, KBest &best) const
+{
+	const int nWidth = m_nWidth, nHeight = m_nHeight;
+	const int u = (int)(nQuery % nWidth), v = (int)(nQuery / nWidth);
+	const float qX = m_pX[nQuery], qY = m_pY[nQuery], qZ = m_pZ[nQuery];
+	const float fRingStep = qZ * std::min(m_fPitchX, m_fPitchY) / m_fRayScale;
+
+	//pixels [x0, x1) of row y
+	auto span = [&](int y, int x0, int x1) {
+		const size_t nRow = (size_t)y * nWidth;
+		for (int x = std::max(x0, 0); x < std::min(x1, nWidth); x++) {
+			size_t i = nRow + x;
+			float fZ = m_pZ[i];
+			if (!(fZ > 0.0f))
+				continue;
+			float dx = m_pX[i] - qX, dy = m_pY[i] - qY, dz = fZ - qZ;
+			best.Insert((uint32)i, dx * dx + dy * dy + dz * dz);
+		}
+	};
+
+	span(v, u, u + 1);
+	for (int s = 1; s <= m_nMaxWindow; s++) {
+		//ring s can not hold anything nearer than the k-th
+		float fRing = (float)(s - WINDOW_MARGIN) * fRingStep;
+		if (fRing > 0.0f && fRing * fRing > best.Bound())
+			break;
+		if (u - s < 0 && u + s >= nWidth && v - s < 0 && v + s >= nHeight)
+			break;
+
+		if (v - s >= 0)
+			span(v - s, u - s, u + s + 1);
+		if (v + s < nHeight)
+			span(v + s, u - s, u + s + 1);
+		for (int y = std::max(v - s + 1, 0); y < std::min(v + s, nHeight); y++) {
+			if (u - s >= 0)
+				span(y, u - s, u - s + 1);
+			if (u + s < nWidth)
+				span(y, u + s, u + s + 1);
+		}
+	}
+}
+
+/*************************************************************************************
+* tree
+*/
+
+void CCubeEyeNeighborIndex::TreeRadius(const float *pQuery, float fRadius, Band &band) const
+{
+	struct Entry { uint32 nNode, nBegin, nEnd; };
+	Entry stack[STACK_SIZE];
+	int nTop = 0;
+	const uint32 nInner = (uint32)m_vSplit.size(), nPoints = (uint32)m_vTreeIndex.size();
+	const float *pTX = m_vTreePoints.data(), *pTY = pTX + nPoints, *pTZ = pTY + nPoints;
+	const float fRadius2 = fRadius * fRadius;
+
+	stack[nTop++] = { 0, 0, nPoints };
+	while (nTop > 0) {
+		Entry e = stack[--nTop];
+		if (e.nNode >= nInner) {
+			for (uint32 i = e.nBegin; i < e.nEnd; i++) {
+				float dx = pTX[i] - pQuery[0], dy = pTY[i] - pQuery[1], dz = pTZ[i] - pQuery[2];
+				float fDistance2 = dx * dx + dy * dy + dz * dz;
+				if (fDistance2 <= fRadius2) {
+					band.vIndices.push_back(m_vTreeIndex[i]);
+					band.vDistances2.push_back(fDistance2);
+				}
+			}
+			continue;
+		}
+
+		//left holds coordinates <= split, right >= split
+		float fDiff = pQuery[m_vAxis[e.nNode]] - m_vSplit[e.nNode];
+		uint32 nMid = (e.nBegin + e.nEnd) / 2;
+		if (fDiff >= -fRadius)
+			stack[nTop++] = { e.nNode * 2 + 2, nMid, e.nEnd };
+		if (fDiff <= fRadius)
+			stack[nTop++] = { e.nNode * 2 + 1, e.nBegin, nMid };
+	}
+}
+
+void CCubeEyeNeighborIndex::TreeKnn(const float *pQuery, KBest &best) const
+{
+	struct Entry { uint32 nNode, nBegin, nEnd; float fMin2; };
+	Entry stack[STACK_SIZE];
+	int nTop = 0;
+	const uint32 nInner = (uint32)m_vSplit.size(), nPoints = (uint32)m_vTreeIndex.size();
+	const float *pTX = m_vTreePoints.data(), *pTY = pTX + nPoints, *pTZ = pTY + nPoints;
+
+	stack[nTop++] = { 0, 0, nPoints, 0.0f };
+	while (nTop > 0) {
+		Entry e = stack[--nTop];
+		if (e.fMin2 > best.Bound())
+			continue;
+
+		if (e.nNode >= nInner) {
+			for (uint32 i = e.nBegin; i < e.nEnd; i++) {
+				float dx = pTX[i] - pQuery[0], dy = pTY[i] - pQuery[1], dz = pTZ[i] - pQuery[2];
+				best.Insert(m_vTreeIndex[i], dx * dx + dy * dy + dz * dz);
+			}
+			continue;
+		}
+
+		//far side first on the stack, near side searched first
+		float fDiff = pQuery[m_vAxis[e.nNode]] - m_vSplit[e.nNode];
+		uint32 nMid = (e.nBegin + e.nEnd) / 2;
+		Entry left = { e.nNode * 2 + 1, e.nBegin, nMid, 0.0f }, right = { e.nNode * 2 + 2, nMid, e.nEnd, 0.0f };
+		float fFar2 = std::max(e.fMin2, fDiff * fDiff);
+		if (fDiff < 0.0f) {
+			right.fMin2 = fFar2;
+			left.fMin2 = e.fMin2;
+			stack[nTop++] = right;
+			stack[nTop++] = left;
+		} else {
+			left.fMin2 = fFar2;
+			right.fMin2 = e.fMin2;
+			stack[nTop++] = left;
+			stack[nTop++] = right;
+		}
+	}
+}
+
+}
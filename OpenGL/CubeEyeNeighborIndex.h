@@ -0,0 +1,210 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeNeighborIndex.h											*/
+/*																			*/
+/* @brief	Radius / k nearest neighbour search on point clouds				*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyePointCloud.h"
+
+namespace CUBE_EYE
+{
+
+///Search structure of a CCubeEyeNeighborIndex
+enum neighbor_mode {
+	///Pixel windows of an organized cloud in camera coordinates
+	Neighbor_Grid = 0,
+	///k-d tree(any cloud)
+	Neighbor_Tree
+};
+
+///Batched query result : the neighbours of query q are entries [vOffsets[q], vOffsets[q + 1])
+typedef struct _ceNeighborList
+{
+	///Query count + 1 offsets
+	Vector<uint32> vOffsets;
+	///Point indices in the indexed cloud
+	Vector<uint32> vIndices;
+	///Squared distances to the query(unit; m^2)
+	Vector<float> vDistances2;
+
+} ceNeighborList;
+
+/**
+*
+*@brief		Neighbour search index
+*@details	Grid mode(organized clouds from CCubeEyeDepthToPCL) needs no search structure : the
+			neighbours of pixel (u, v) can only lie in a window around it. The window comes
+			from the ray pitch and the field of view, both measured on the cloud at Build(the
+			smallest X / Z, Y / Z step between valid neighbours and the longest ray
+			(X / Z, Y / Z, 1)) : a point s pixels away lies at least Zq * s * pitch / |ray| from
+			query q. The bound holds for a pinhole camera; a one pixel margin absorbs the
+			remaining lens distortion. A radius query scans that window, a k nearest query
+			scans rings around the pixel until the ring bound exceeds the k-th distance; both
+			stop at nMaxWindow pixels, beyond which the results are not complete.
+
+			Tree mode(unorganized or merged clouds) is a balanced k-d tree in implicit layout
+			(node i has children 2i + 1 and 2i + 2, median splits, <= 16 points per leaf);
+			subtrees are built in parallel and the points are reordered into SoA leaves.
+
+			Queries come in batches, by point index of the indexed cloud(both modes) or by
+			arbitrary points(tree mode), and run on the thread pool. Radius results are in
+			scan order, k nearest results ascending; a query point of the cloud is its own
+			neighbour at distance 0. The index refers to the cloud, which must stay unchanged
+			until the next Build. Every buffer, including ceNeighborList, is kept between
+			frames and only grows.
+*
+*/
+class CCubeEyeNeighborIndex {
+
+public:
+
+	CCubeEyeNeighborIndex();
+	~CCubeEyeNeighborIndex();
+
+	/**
+	*
+	* @brief	Set thread pool
+	* @details	NULL : single threaded. Default is CCubeEyeThreadPool::Default().
+	* @return	void
+	*
+	*/
+	void SetThreadPool(CCubeEyeThreadPool *pPool) { m_pPool = pPool; }
+
+	/**
+	*
+	* @brief	Set grid window limit
+	* @param	nMaxWindow(1~) - largest distance in pixels the grid queries look at(default 16).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetMaxWindow(int nMaxWindow);
+	int getMaxWindow() const { return m_nMaxWindow; }
+
+	/**
+	*
+	* @brief	Build
+	* @details	Grid mode for organized clouds, tree mode otherwise. Valid points are Z > 0 with
+				their mask bit set.
+	* @param	cloud - cloud to index(unit; m); grid mode expects camera coordinates.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Build(const CCubeEyePointCloud &cloud);
+	int Build(const CCubeEyePointCloud &cloud, neighbor_mode eMode);
+
+	neighbor_mode getMode() const { return m_eMode; }
+
+	/**
+	*
+	* @brief	Radius search by point index
+	* @param	pQueries - point indices, NULL : every point(nQueries is then ignored).
+	* @param	fRadius - search radius(unit; m).
+	* @param	result - receives the neighbours of every query; invalid points have none.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int RadiusSearch(const uint32 *pQueries, int nQueries, float fRadius, ceNeighborList &result);
+
+	/**
+	*
+	* @brief	Radius search by point(tree mode)
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int RadiusSearch(const cePointCloud *pPoints, int nQueries, float fRadius, ceNeighborList &result);
+
+	/**
+	*
+	* @brief	k nearest search by point index
+	* @details	Up to k neighbours per query, nearest first.
+	* @param	pQueries - point indices, NULL : every point(nQueries is then ignored).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int KnnSearch(const uint32 *pQueries, int nQueries, int k, ceNeighborList &result);
+
+	/**
+	*
+	* @brief	k nearest search by point(tree mode)
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int KnnSearch(const cePointCloud *pPoints, int nQueries, int k, ceNeighborList &result);
+
+private:
+
+	CCubeEyeNeighborIndex(const CCubeEyeNeighborIndex &);
+	CCubeEyeNeighborIndex &operator=(const CCubeEyeNeighborIndex &);
+
+	//query results of a band of queries, copied into the ceNeighborList afterwards
+	struct Band
+	{
+		Vector<uint32> vIndices;
+		Vector<float> vDistances2;
+	};
+
+	//k best of a query, ascending
+	struct KBest
+	{
+		uint32 *pIndices;
+		float *pDistances2;
+		int nCount;
+		int k;
+
+		void Insert(uint32 nIndex, float fDistance2);
+		float Bound() const { return nCount < k ? 3.4e38f : pDistances2[k - 1]; }
+	};
+
+	template <class TQuery>
+	void Run(int nQueries, ceNeighborList &result, const TQuery &query);
+	template <class TSearch>
+	void Knn(Band &band, int k, const TSearch &search) const;
+	int CheckQueries(const uint32 *pQueries, int nQueries) const;
+
+	void BuildGrid();
+	void BuildTree();
+	uint32 SplitNode(uint32 nNode, uint32 nBegin, uint32 nEnd);
+	void BuildSubtree(uint32 nNode, uint32 nBegin, uint32 nEnd);
+	int Window(float fRadius, float fZ, float fPitch) const;
+
+	void GridRadius(uint32 nQuery, float fRadius, Band &band) const;
+	void GridKnn(uint32 nQuery, KBest &best) const;
+	void TreeRadius(const float *pQuery, float fRadius, Band &band) const;
+	void TreeKnn(const float *pQuery, KBest &best) const;
+
+	CCubeEyeThreadPool *m_pPool;
+	int m_nMaxWindow;
+	neighbor_mode m_eMode;
+
+	int m_nWidth;
+	int m_nHeight;
+	size_t m_nCount;
+	const float *m_pX;
+	const float *m_pY;
+	const float *m_pZ;
+	float *m_pMaskedZ;				//Z with the masked out points cleared(clouds with a mask)
+	size_t m_nMaskedZSize;
+
+	//grid
+	float m_fPitchX;				//smallest X / Z step between horizontal neighbours
+	float m_fPitchY;
+	float m_fRayScale;				//largest |(X / Z, Y / Z, 1)|
+	Vector<float> m_vRowStats;		//pitch X, pitch Y, ray scale per row
+
+	//tree
+	uint32 m_nLeafDepth;			//nodes >= 2^m_nLeafDepth - 1 are leaves
+	Vector<uint32> m_vTreeIndex;	//cloud index of every tree point, leaf order
+	Vector<float> m_vTreePoints;	//X, Y, Z planes of the tree points
+	Vector<float> m_vSplit;			//split value per inner node
+	Vector<uint8> m_vAxis;			//split axis per inner node
+	Vector<uint32> m_vSubtrees;		//node, begin, end of the subtrees built in parallel
+
+	Vector<Band> m_vBands;
+};
+
+}
@@ -0,0 +1,244 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeNormals.cpp												*/
+/*																			*/
+/* @brief	Surface normals of organized point clouds						*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeNormals.h"
+
+#include <math.h>
+
+namespace CUBE_EYE
+{
+
+#define ROW_GRAIN		16
+#define MASK_GRAIN		128			//mask words per band
+#define MIN_LENGTH2		1e-20f		//squared cross product length below which there is no normal
+
+CCubeEyeNormals::CCubeEyeNormals()
+	: m_pPool(&CCubeEyeThreadPool::Default()), m_nRadius(2), m_fMaxDepthChange(0.02f),
+	m_nWidth(0), m_nHeight(0), m_pMaskedZ(NULL), m_nMaskedZSize(0), m_nValid(0)
+{
+}
+
+CCubeEyeNormals::~CCubeEyeNormals()
+{
+	if (m_pMaskedZ != NULL)
+		ceAlignedFree(m_pMaskedZ);
+}
+
+int CCubeEyeNormals::SetRadius(int nRadius)
+{
+	if (nRadius < 1)
+		return CE_INVALID_PARAM;
+
+	m_nRadius = nRadius;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeNormals::SetMaxDepthChange(float fMaxDepthChange)
+{
+	if (!(fMaxDepthChange > 0.0f))
+		return CE_INVALID_PARAM;
+
+	m_fMaxDepthChange = fMaxDepthChange;
+	return CE_SUCCESS;
+}
+
+template <class TFunc>
+void CCubeEyeNormals::ForRows(int nRows, const TFunc &func)
+{
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, nRows, ROW_GRAIN, func);
+	else
+		func(0, nRows);
+}
+
+int CCubeEyeNormals::Compute(const CCubeEyePointCloud &cloud, CCubeEyePointCloud &normals)
+{
+	if (&cloud == &normals)
+		return CE_INVALID_PARAM;
+	if (cloud.getZ() == NULL)
+		return CE_NOT_OPENED;
+	if (!cloud.IsOrganized())
+		return CE_UNSUPPORTED;
+
+	int nWidth = cloud.getWidth(), nHeight = cloud.getHeight();
+	int nResult = normals.Allocate(nWidth, nHeight, true);
+	if (nResult != CE_SUCCESS)
+		return nResult;
+	m_nWidth = nWidth;
+	m_nHeight = nHeight;
+
+	//the kernels only look at Z : fold the mask into it
+	const float *pZ = cloud.getZ();
+	size_t nCount = cloud.getCount();
+	if (cloud.HasMask()) {
+		if (m_pMaskedZ == NULL || nCount > m_nMaskedZSize) {
+			float *pMaskedZ = (float *)ceAlignedAlloc(nCount * sizeof(float));
+			if (pMaskedZ == NULL)
+				return CE_FAILED;
+			if (m_pMaskedZ != NULL)
+				ceAlignedFree(m_pMaskedZ);
+			m_pMaskedZ = pMaskedZ;
+			m_nMaskedZSize = nCount;
+		}
+
+		float *pMaskedZ = m_pMaskedZ;
+		const CCubeEyePointCloud *pCloud = &cloud;
+		ForRows(nHeight, [=](int nRowBegin, int nRowEnd) {
+			for (size_t i = (size_t)nRowBegin * nWidth; i < (size_t)nRowEnd * nWidth; i++)
+				pMaskedZ[i] = pCloud->IsValid(i) ? pZ[i] : 0.0f;
+		});
+		pZ = m_pMaskedZ;
+	}
+
+	const float *pX = cloud.getX(), *pY = cloud.getY();
+	float *pNX = normals.getX(), *pNY = normals.getY(), *pNZ = normals.getZ();
+	ForRows(nHeight, [=](int nRowBegin, int nRowEnd) {
+		for (int y = nRowBegin; y < nRowEnd; y++)
+			NormalRow(pX, pY, pZ, pNX, pNY, pNZ, y);
+	});
+
+	//mask from the rows afterwards : a mask word can span two row bands
+	uint64 *pMask = normals.getMask();
+	int nWords = (int)((nCount + CE_CLOUD_MASK_BITS - 1) / CE_CLOUD_MASK_BITS);
+	std::atomic<size_t> nValid(0);
+	auto words = [=, &nValid](int nWordBegin, int nWordEnd) {
+		size_t nBandValid = 0;
+		for (int w = nWordBegin; w < nWordEnd; w++) {
+			size_t nBegin = (size_t)w * CE_CLOUD_MASK_BITS;
+			size_t nEnd = nBegin + CE_CLOUD_MASK_BITS < nCount ? nBegin + CE_CLOUD_MASK_BITS : nCount;
+			uint64 nWord = 0;
+			for (size_t i = nBegin; i < nEnd; i++) {
+				if (pNX[i] != 0.0f || pNY[i] != 0.0f || pNZ[i] != 0.0f) {
+					nWord |= (uint64)1 << (i - nBegin);
+					nBandValid++;
+				}
+			}
+			pMask[w] = nWord;
+		}
+		nValid.fetch_add(nBandValid, std::memory_order_relaxed);
+	};
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, nWords, MASK_GRAIN, words);
+	else
+		words(0, nWords);
+
+	m_nValid = nValid.load();
+	return CE_SUCCESS;
+}
+
+/*************************************************************************************
+* row kernel
+*/
+
+#if defined(CE_USE_AVX2)
+//8 neighbours at offset n : the neighbour where usable(Z > 0, |Z - Zc| <= fMax), else the center
+static inline void Neighbour(const float *pX, const float *pY, const float *pZ, size_t n, __m256 cX, __m256 cY, __m256 cZ,
+	__m256 vMax, __m256 &nX, __m256 &nY, __m256 &nZ)
+{
+	const __m256 vAbs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+	__m256 z = _mm256_loadu_ps(pZ + n);
+	__m256 vUse = _mm256_and_ps(_mm256_cmp_ps(z, _mm256_setzero_ps(), _CMP_GT_OQ),
+		_mm256_cmp_ps(_mm256_and_ps(_mm256_sub_ps(z, cZ), vAbs), vMax, _CMP_LE_OQ));
+	nX = _mm256_blendv_ps(cX, _mm256_loadu_ps(pX + n), vUse);
+	nY = _mm256_blendv_ps(cY, _mm256_loadu_ps(pY + n), vUse);
+	nZ = _mm256_blendv_ps(cZ, z, vUse);
+}
+#endif
+
+void CCubeEyeNormals::NormalRow(const float *pX, const float *pY, const float *pZ, float *pNX, float *pNY, float *pNZ, int y) const
+{
+	const int nWidth = m_nWidth, r = m_nRadius;
+	const float fChange = m_fMaxDepthChange * r;
+	const size_t nRow = (size_t)y * nWidth;
+	const size_t nUp = (size_t)r * nWidth;
+	const bool bUp = y - r >= 0, bDown = y + r < m_nHeight;
+	int x = 0;
+
+	//scalar : neighbours outside the frame are invalid
+	auto normal = [&](int px) {
+		size_t c = nRow + px;
+		float fZ = pZ[c];
+		pNX[c] = pNY[c] = pNZ[c] = 0.0f;
+		if (!(fZ > 0.0f))
+			return;
+
+		float fMax = fChange * fZ;
+		auto usable = [&](size_t n) { return pZ[n] > 0.0f && fabsf(pZ[n] - fZ) <= fMax; };
+		bool bR = px + r < nWidth && usable(c + r);
+		bool bL = px - r >= 0 && usable(c - r);
+		bool bD = bDown && usable(c + nUp);
+		bool bU = bUp && usable(c - nUp);
+
+		//both sides : central difference, one side : one-sided, none : zero
+		size_t nR = bR ? c + r : c, nL = bL ? c - r : c, nD = bD ? c + nUp : c, nU = bU ? c - nUp : c;
+		float dxX = pX[nR] - pX[nL], dxY = pY[nR] - pY[nL], dxZ = pZ[nR] - pZ[nL];
+		float dyX = pX[nD] - pX[nU], dyY = pY[nD] - pY[nU], dyZ = pZ[nD] - pZ[nU];
+
+		float nX = dxY * dyZ - dxZ * dyY;
+		float nY = dxZ * dyX - dxX * dyZ;
+		float nZ = dxX * dyY - dxY * dyX;
+		float fLength2 = nX * nX + nY * nY + nZ * nZ;
+		if (!(fLength2 > MIN_LENGTH2))
+			return;
+
+		//towards the camera
+		float fScale = 1.0f / sqrtf(fLength2);
+		if (nX * pX[c] + nY * pY[c] + nZ * fZ > 0.0f)
+			fScale = -fScale;
+		pNX[c] = nX * fScale;
+		pNY[c] = nY * fScale;
+		pNZ[c] = nZ * fScale;
+	};
+
+	for (; x < r && x < nWidth; x++)
+		normal(x);
+
+#if defined(CE_USE_AVX2)
+	if (bUp && bDown) {
+		const __m256 vZero = _mm256_setzero_ps(), vChange = _mm256_set1_ps(fChange);
+		const __m256 vMinLength2 = _mm256_set1_ps(MIN_LENGTH2), vOne = _mm256_set1_ps(1.0f);
+		const __m256 vSign = _mm256_castsi256_ps(_mm256_set1_epi32((int)0x80000000));
+
+		for (; x + r + 8 <= nWidth; x += 8) {
+			size_t c = nRow + x;
+			__m256 cX = _mm256_loadu_ps(pX + c), cY = _mm256_loadu_ps(pY + c), cZ = _mm256_loadu_ps(pZ + c);
+			__m256 vMax = _mm256_mul_ps(vChange, cZ);
+
+			__m256 RX, RY, RZ, LX, LY, LZ, DX, DY, DZ, UX, UY, UZ;
+			Neighbour(pX, pY, pZ, c + r, cX, cY, cZ, vMax, RX, RY, RZ);
+			Neighbour(pX, pY, pZ, c - r, cX, cY, cZ, vMax, LX, LY, LZ);
+			Neighbour(pX, pY, pZ, c + nUp, cX, cY, cZ, vMax, DX, DY, DZ);
+			Neighbour(pX, pY, pZ, c - nUp, cX, cY, cZ, vMax, UX, UY, UZ);
+
+			__m256 dxX = _mm256_sub_ps(RX, LX), dxY = _mm256_sub_ps(RY, LY), dxZ = _mm256_sub_ps(RZ, LZ);
+			__m256 dyX = _mm256_sub_ps(DX, UX), dyY = _mm256_sub_ps(DY, UY), dyZ = _mm256_sub_ps(DZ, UZ);
+			__m256 nX = _mm256_fmsub_ps(dxY, dyZ, _mm256_mul_ps(dxZ, dyY));
+			__m256 nY = _mm256_fmsub_ps(dxZ, dyX, _mm256_mul_ps(dxX, dyZ));
+			__m256 nZ = _mm256_fmsub_ps(dxX, dyY, _mm256_mul_ps(dxY, dyX));
+			__m256 fLength2 = _mm256_fmadd_ps(nX, nX, _mm256_fmadd_ps(nY, nY, _mm256_mul_ps(nZ, nZ)));
+			__m256 vValid = _mm256_and_ps(_mm256_cmp_ps(cZ, vZero, _CMP_GT_OQ), _mm256_cmp_ps(fLength2, vMinLength2, _CMP_GT_OQ));
+
+			__m256 fDot = _mm256_fmadd_ps(nX, cX, _mm256_fmadd_ps(nY, cY, _mm256_mul_ps(nZ, cZ)));
+			__m256 fScale = _mm256_div_ps(vOne, _mm256_sqrt_ps(_mm256_max_ps(fLength2, vMinLength2)));
+			fScale = _mm256_xor_ps(fScale, _mm256_and_ps(_mm256_cmp_ps(fDot, vZero, _CMP_GT_OQ), vSign));
+			fScale = _mm256_and_ps(fScale, vValid);
+
+			_mm256_storeu_ps(pNX + c, _mm256_mul_ps(nX, fScale));
+			_mm256_storeu_ps(pNY + c, _mm256_mul_ps(nY, fScale));
+			_mm256_storeu_ps(pNZ + c, _mm256_mul_ps(nZ, fScale));
+		}
+	}
+#endif
+
+	for (; x < nWidth; x++)
+		normal(x);
+}
+
+}
@@ -0,0 +1,102 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeNormals.h												*/
+/*																			*/
+/* @brief	Surface normals of organized point clouds						*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyePointCloud.h"
+
+namespace CUBE_EYE
+{
+/**
+*
+*@brief		Organized normal estimation
+*@details	Uses the frame grid instead of a neighbour search : the normal of pixel (x, y) is
+			the cross product of the horizontal and vertical differences of its neighbours
+			nRadius pixels away, oriented towards the camera and normalized.
+			A neighbour is used only when it is valid(Z > 0, mask bit set) and its depth is
+			within fMaxDepthChange * nRadius * Z of the center, so normals do not bridge depth
+			edges; with one side missing the difference is taken one-sided, with both sides
+			missing(or an invalid center) the pixel gets no normal.
+
+			The output is an organized cloud of the same size with the normal in X / Y / Z
+			(I is not used) and its validity mask set, so normal i belongs to point i.
+			Rows run on the thread pool with AVX2 on the interior pixels.
+*
+*/
+class CCubeEyeNormals {
+
+public:
+
+	CCubeEyeNormals();
+	~CCubeEyeNormals();
+
+	/**
+	*
+	* @brief	Set thread pool
+	* @details	NULL : single threaded. Default is CCubeEyeThreadPool::Default().
+	* @return	void
+	*
+	*/
+	void SetThreadPool(CCubeEyeThreadPool *pPool) { m_pPool = pPool; }
+
+	/**
+	*
+	* @brief	Set neighbour distance
+	* @param	nRadius(1~) - pixels between the center and its neighbours(default 2).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetRadius(int nRadius);
+	int getRadius() const { return m_nRadius; }
+
+	/**
+	*
+	* @brief	Set depth continuity threshold
+	* @param	fMaxDepthChange - relative depth change allowed per pixel of radius(default 0.02).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetMaxDepthChange(float fMaxDepthChange);
+	float getMaxDepthChange() const { return m_fMaxDepthChange; }
+
+	/**
+	*
+	* @brief	Compute normals
+	* @param	cloud - organized cloud(CCubeEyeDepthToPCL output, unit; m).
+	* @param	normals - receives the normals, allocated to the size of cloud with a mask.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Compute(const CCubeEyePointCloud &cloud, CCubeEyePointCloud &normals);
+
+	///Valid normals of the last Compute
+	size_t getValidCount() const { return m_nValid; }
+
+private:
+
+	CCubeEyeNormals(const CCubeEyeNormals &);
+	CCubeEyeNormals &operator=(const CCubeEyeNormals &);
+
+	template <class TFunc>
+	void ForRows(int nRows, const TFunc &func);
+
+	void NormalRow(const float *pX, const float *pY, const float *pZ, float *pNX, float *pNY, float *pNZ, int y) const;
+
+	CCubeEyeThreadPool *m_pPool;
+	int m_nRadius;
+	float m_fMaxDepthChange;
+
+	int m_nWidth;
+	int m_nHeight;
+	float *m_pMaskedZ;				//Z with the masked out points cleared(clouds with a mask)
+	size_t m_nMaskedZSize;
+	size_t m_nValid;
+};
+
+}
@@ -0,0 +1,407 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyePhaseDecoder.cpp											*/
+/*																			*/
+/* @brief	Host-side raw phase to depth / amplitude decoding				*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyePhaseDecoder.h"
+
+#include <math.h>
+
+namespace CUBE_EYE
+{
+
+#define ROW_GRAIN			8
+#define SPEED_OF_LIGHT		299792458.0
+#define MAX_WRAPS			16		//wrap counts of the first frequency searched at most
+#define MAX_WIGGLING_BINS	4096
+
+#define CE_PI				3.14159265f
+#define CE_2PI				6.28318531f
+
+/*************************************************************************************
+* atan2
+*
+* atan(a) on [0, 1] by the odd polynomial of Abramowitz & Stegun 4.4.49(about 1e-5 rad in float),
+* then the octant is restored. The scalar and vector versions do the same operations.
+*/
+
+#define ATAN_C1		0.9998660f
+#define ATAN_C3		-0.3302995f
+#define ATAN_C5		0.1801410f
+#define ATAN_C7		-0.0851330f
+#define ATAN_C9		0.0208351f
+
+//phase of (x, y) in [0, 2 pi)
+static inline float Phase(float x, float y)
+{
+	float ax = fabsf(x), ay = fabsf(y);
+	float mx = ax > ay ? ax : ay;
+	float mn = ax > ay ? ay : ax;
+	float a = mx > 0.0f ? mn / mx : 0.0f;
+	float s = a * a;
+	float r = a * (ATAN_C1 + s * (ATAN_C3 + s * (ATAN_C5 + s * (ATAN_C7 + s * ATAN_C9))));
+	r = ay > ax ? 0.5f * CE_PI - r : r;
+	r = x < 0.0f ? CE_PI - r : r;
+	return y < 0.0f ? CE_2PI - r : r;
+}
+
+static inline float Wrap(float fPhase)
+{
+	return fPhase - CE_2PI * floorf(fPhase * (1.0f / CE_2PI));
+}
+
+static inline float Wiggling(const float *pTable, int nBins, float fPhase)
+{
+	float p = fPhase * ((float)nBins / CE_2PI);
+	float f = floorf(p);
+	int i0 = (int)f;
+	i0 = i0 >= nBins ? i0 - nBins : i0;
+	int i1 = i0 + 1 >= nBins ? 0 : i0 + 1;
+	return pTable[i0] + (p - f) * (pTable[i1] - pTable[i0]);
+}
+
+#if defined(CE_USE_AVX2)
+static inline __m256 Phase(__m256 x, __m256 y)
+{
+	const __m256 vSign = _mm256_set1_ps(-0.0f);
+	const __m256 vZero = _mm256_setzero_ps();
+	__m256 ax = _mm256_andnot_ps(vSign, x), ay = _mm256_andnot_ps(vSign, y);
+	__m256 mx = _mm256_max_ps(ax, ay);
+	__m256 mn = _mm256_min_ps(ax, ay);
+	__m256 a = _mm256_and_ps(_mm256_div_ps(mn, mx), _mm256_cmp_ps(mx, vZero, _CMP_GT_OQ));
+	__m256 s = _mm256_mul_ps(a, a);
+	__m256 r = _mm256_fmadd_ps(s, _mm256_set1_ps(ATAN_C9), _mm256_set1_ps(ATAN_C7));
+	r = _mm256_fmadd_ps(s, r, _mm256_set1_ps(ATAN_C5));
+	r = _mm256_fmadd_ps(s, r, _mm256_set1_ps(ATAN_C3));
+	r = _mm256_fmadd_ps(s, r, _mm256_set1_ps(ATAN_C1));
+	r = _mm256_mul_ps(a, r);
+	r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(0.5f * CE_PI), r), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+	r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(CE_PI), r), _mm256_cmp_ps(x, vZero, _CMP_LT_OQ));
+	return _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(CE_2PI), r), _mm256_cmp_ps(y, vZero, _CMP_LT_OQ));
+}
+
+static inline __m256 Wrap(__m256 vPhase)
+{
+	__m256 n = _mm256_floor_ps(_mm256_mul_ps(vPhase, _mm256_set1_ps(1.0f / CE_2PI)));
+	return _mm256_fnmadd_ps(n, _mm256_set1_ps(CE_2PI), vPhase);
+}
+
+static inline __m256 Wiggling(const float *pTable, int nBins, __m256 vPhase)
+{
+	__m256 p = _mm256_mul_ps(vPhase, _mm256_set1_ps((float)nBins / CE_2PI));
+	__m256 f = _mm256_floor_ps(p);
+	__m256i i0 = _mm256_cvttps_epi32(f);
+	const __m256i vBins = _mm256_set1_epi32(nBins);
+	const __m256i vLast = _mm256_set1_epi32(nBins - 1);
+	i0 = _mm256_sub_epi32(i0, _mm256_and_si256(_mm256_cmpgt_epi32(i0, vLast), vBins));
+	__m256i i1 = _mm256_add_epi32(i0, _mm256_set1_epi32(1));
+	i1 = _mm256_andnot_si256(_mm256_cmpgt_epi32(i1, vLast), i1);
+	__m256 t0 = _mm256_i32gather_ps(pTable, i0, 4);
+	__m256 t1 = _mm256_i32gather_ps(pTable, i1, 4);
+	return _mm256_fmadd_ps(_mm256_sub_ps(p, f), _mm256_sub_ps(t1, t0), t0);
+}
+#endif
+
+static uint64 GreatestCommonDivisor(uint64 a, uint64 b)
+{
+	while (b != 0) {
+		uint64 t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+/*************************************************************************************
+* CCubeEyePhaseDecoder
+*/
+
+CCubeEyePhaseDecoder::CCubeEyePhaseDecoder()
+	: m_stConfig(DefaultConfig()), m_pPool(&CCubeEyeThreadPool::Default()), m_nWidth(0), m_nHeight(0),
+	m_pZScale(NULL), m_nWraps(1), m_fMaxRange(0.0f)
+{
+	memset(m_pOffset, 0, sizeof(m_pOffset));
+	UpdateRange();
+}
+
+CCubeEyePhaseDecoder::~CCubeEyePhaseDecoder()
+{
+	Release();
+}
+
+void CCubeEyePhaseDecoder::Release()
+{
+	//the offset planes share the block of the Z scale plane
+	if (m_pZScale != NULL)
+		ceAlignedFree(m_pZScale);
+	m_pZScale = NULL;
+	memset(m_pOffset, 0, sizeof(m_pOffset));
+	for (int f = 0; f < CE_PHASE_MAX_FREQUENCIES; f++)
+		m_vWiggling[f].clear();
+	m_nWidth = 0;
+	m_nHeight = 0;
+}
+
+ceRawPhaseConfig CCubeEyePhaseDecoder::DefaultConfig()
+{
+	ceRawPhaseConfig stConfig;
+	memset(&stConfig, 0, sizeof(stConfig));
+	stConfig.nFrequencies = 2;
+	stConfig.fFrequencyMHz[0] = 80.0f;
+	stConfig.fFrequencyMHz[1] = 60.0f;
+	stConfig.fMinAmplitude = 5.0f;
+	stConfig.nSaturation = 4095;
+	stConfig.fUnwrapTolerance = 0.05f;
+	return stConfig;
+}
+
+int CCubeEyePhaseDecoder::SetConfig(const ceRawPhaseConfig &stConfig)
+{
+	if (stConfig.nFrequencies < 1 || stConfig.nFrequencies > CE_PHASE_MAX_FREQUENCIES)
+		return CE_INVALID_PARAM;
+	for (int f = 0; f < stConfig.nFrequencies; f++) {
+		if (!(stConfig.fFrequencyMHz[f] >= 1.0f && stConfig.fFrequencyMHz[f] <= 1000.0f))
+			return CE_INVALID_PARAM;
+	}
+	if (!(stConfig.fMinAmplitude >= 0.0f) || !(stConfig.fUnwrapTolerance > 0.0f))
+		return CE_INVALID_PARAM;
+
+	m_stConfig = stConfig;
+	UpdateRange();
+	return CE_SUCCESS;
+}
+
+void CCubeEyePhaseDecoder::UpdateRange()
+{
+	for (int f = 0; f < m_stConfig.nFrequencies; f++)
+		m_fRange[f] = (float)(SPEED_OF_LIGHT / (2.0e6 * m_stConfig.fFrequencyMHz[f]));
+
+	m_nWraps = 1;
+	m_fMaxRange = m_fRange[0];
+	if (m_stConfig.nFrequencies == 2) {
+		//common unambiguous range c / 2 gcd(f1, f2), frequencies taken in kHz
+		uint64 f1 = (uint64)(m_stConfig.fFrequencyMHz[0] * 1000.0f + 0.5f);
+		uint64 f2 = (uint64)(m_stConfig.fFrequencyMHz[1] * 1000.0f + 0.5f);
+		uint64 nWraps = f1 / GreatestCommonDivisor(f1, f2);
+		m_nWraps = nWraps < MAX_WRAPS ? (int)nWraps : MAX_WRAPS;
+		m_fMaxRange = m_fRange[0] * (float)m_nWraps;
+	}
+}
+
+int CCubeEyePhaseDecoder::SetCamera(const ceIntrinsicParam &stIntr, const ceDistortionParam &stDist, int nWidth, int nHeight)
+{
+	if (nWidth <= 0 || nHeight <= 0)
+		return CE_INVALID_PARAM;
+
+	Release();
+
+	size_t nCount = (size_t)nWidth * nHeight;
+	size_t nStride = (nCount + 7) & ~(size_t)7;
+	float *pBlock = (float *)ceAlignedAlloc(nStride * (1 + CE_PHASE_MAX_FREQUENCIES) * sizeof(float));
+	if (pBlock == NULL)
+		return CE_FAILED;
+
+	//Z = distance / |(x / z, y / z, 1)|; the offset planes hold the rays until they are cleared
+	m_pZScale = pBlock;
+	float *pRayX = pBlock + nStride;
+	float *pRayY = pRayX + nStride;
+	ceBuildRayTable(stIntr, stDist, nWidth, nHeight, pRayX, pRayY);
+	for (size_t i = 0; i < nCount; i++)
+		m_pZScale[i] = 1.0f / sqrtf(1.0f + pRayX[i] * pRayX[i] + pRayY[i] * pRayY[i]);
+
+	for (int f = 0; f < CE_PHASE_MAX_FREQUENCIES; f++) {
+		m_pOffset[f] = pBlock + (1 + f) * nStride;
+		memset(m_pOffset[f], 0, nCount * sizeof(float));
+	}
+	m_nWidth = nWidth;
+	m_nHeight = nHeight;
+	return CE_SUCCESS;
+}
+
+int CCubeEyePhaseDecoder::SetPhaseOffset(int nFrequency, const float *pOffset)
+{
+	if (m_pZScale == NULL)
+		return CE_NOT_OPENED;
+	if (nFrequency < 0 || nFrequency >= CE_PHASE_MAX_FREQUENCIES)
+		return CE_INVALID_PARAM;
+
+	size_t nSize = (size_t)m_nWidth * m_nHeight * sizeof(float);
+	if (pOffset != NULL)
+		memcpy(m_pOffset[nFrequency], pOffset, nSize);
+	else
+		memset(m_pOffset[nFrequency], 0, nSize);
+	return CE_SUCCESS;
+}
+
+int CCubeEyePhaseDecoder::SetWiggling(int nFrequency, const float *pTable, int nBins)
+{
+	if (nFrequency < 0 || nFrequency >= CE_PHASE_MAX_FREQUENCIES)
+		return CE_INVALID_PARAM;
+	if (pTable == NULL) {
+		m_vWiggling[nFrequency].clear();
+		return CE_SUCCESS;
+	}
+	if (nBins < 2 || nBins > MAX_WIGGLING_BINS)
+		return CE_INVALID_PARAM;
+
+	m_vWiggling[nFrequency].assign(pTable, pTable + nBins);
+	return CE_SUCCESS;
+}
+
+int CCubeEyePhaseDecoder::Decode(const uint16 *pRaw, uint16 *pDepth, uint16 *pAmplitude) const
+{
+	if (m_pZScale == NULL)
+		return CE_NOT_OPENED;
+	if (pRaw == NULL || pDepth == NULL)
+		return CE_INVALID_PARAM;
+
+	auto rows = [=](int nRowBegin, int nRowEnd) {
+		DecodeRows(pRaw, pDepth, pAmplitude, nRowBegin, nRowEnd);
+	};
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, m_nHeight, ROW_GRAIN, rows);
+	else
+		rows(0, m_nHeight);
+	return CE_SUCCESS;
+}
+
+/*************************************************************************************
+* decoding kernel
+*/
+
+void CCubeEyePhaseDecoder::DecodeRows(const uint16 *pRaw, uint16 *pDepth, uint16 *pAmplitude, int nRowBegin, int nRowEnd) const
+{
+	const int nFrequencies = m_stConfig.nFrequencies;
+	const size_t nPlane = (size_t)m_nWidth * m_nHeight;
+	const float fMinAmplitude = m_stConfig.fMinAmplitude;
+	const float fTolerance = m_stConfig.fUnwrapTolerance;
+	const uint16 nSaturation = m_stConfig.nSaturation;
+	//frequency f scales the phase to distance, its noise weight is (amplitude * f)^2
+	float fScale[CE_PHASE_MAX_FREQUENCIES], fWeight[CE_PHASE_MAX_FREQUENCIES];
+	for (int f = 0; f < nFrequencies; f++) {
+		fScale[f] = m_fRange[f] / CE_2PI;
+		fWeight[f] = m_stConfig.fFrequencyMHz[f] * m_stConfig.fFrequencyMHz[f];
+	}
+
+	size_t i = (size_t)nRowBegin * m_nWidth;
+	size_t nEnd = (size_t)nRowEnd * m_nWidth;
+
+#if defined(CE_USE_AVX2)
+	const __m256 vZero = _mm256_setzero_ps();
+	const __m256 vHalf = _mm256_set1_ps(0.5f);
+	const __m256i vSaturation = _mm256_set1_epi32(nSaturation);
+	for (; i + 8 <= nEnd; i += 8) {
+		__m256 vDistance[CE_PHASE_MAX_FREQUENCIES] = {}, vAmp[CE_PHASE_MAX_FREQUENCIES] = {};
+		__m256 vValid = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int f = 0; f < nFrequencies; f++) {
+			__m256i a[CE_PHASE_TAPS];
+			for (int t = 0; t < CE_PHASE_TAPS; t++) {
+				a[t] = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(pRaw + (f * CE_PHASE_TAPS + t) * nPlane + i)));
+				vValid = _mm256_andnot_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(a[t], _mm256_sub_epi32(vSaturation, _mm256_set1_epi32(1)))), vValid);
+			}
+			__m256 vI = _mm256_cvtepi32_ps(_mm256_sub_epi32(a[0], a[2]));
+			__m256 vQ = _mm256_cvtepi32_ps(_mm256_sub_epi32(a[1], a[3]));
+			vAmp[f] = _mm256_mul_ps(vHalf, _mm256_sqrt_ps(_mm256_fmadd_ps(vI, vI, _mm256_mul_ps(vQ, vQ))));
+			vValid = _mm256_and_ps(vValid, _mm256_cmp_ps(vAmp[f], _mm256_set1_ps(fMinAmplitude), _CMP_GE_OQ));
+
+			__m256 vPhase = Wrap(_mm256_sub_ps(Phase(vI, vQ), _mm256_loadu_ps(m_pOffset[f] + i)));
+			vDistance[f] = _mm256_mul_ps(vPhase, _mm256_set1_ps(fScale[f]));
+			if (!m_vWiggling[f].empty())
+				vDistance[f] = _mm256_sub_ps(vDistance[f], Wiggling(m_vWiggling[f].data(), (int)m_vWiggling[f].size(), vPhase));
+		}
+
+		__m256 vRadial = vDistance[0];
+		if (nFrequencies == 2) {
+			//wrap count n1 of the first frequency, the nearest one of the second
+			const __m256 vRange0 = _mm256_set1_ps(m_fRange[0]), vRange1 = _mm256_set1_ps(m_fRange[1]);
+			const __m256 vInvRange1 = _mm256_set1_ps(1.0f / m_fRange[1]);
+			__m256 vBest = _mm256_set1_ps(3.4e38f), vD0 = vZero, vD1 = vZero;
+			for (int n = 0; n < m_nWraps; n++) {
+				__m256 d0 = _mm256_fmadd_ps(_mm256_set1_ps((float)n), vRange0, vDistance[0]);
+				__m256 k = _mm256_max_ps(_mm256_floor_ps(_mm256_fmadd_ps(_mm256_sub_ps(d0, vDistance[1]), vInvRange1, vHalf)), vZero);
+				__m256 d1 = _mm256_fmadd_ps(k, vRange1, vDistance[1]);
+				__m256 e = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), _mm256_sub_ps(d0, d1));
+				__m256 vBetter = _mm256_cmp_ps(e, vBest, _CMP_LT_OQ);
+				vBest = _mm256_blendv_ps(vBest, e, vBetter);
+				vD0 = _mm256_blendv_ps(vD0, d0, vBetter);
+				vD1 = _mm256_blendv_ps(vD1, d1, vBetter);
+			}
+			vValid = _mm256_and_ps(vValid, _mm256_cmp_ps(vBest, _mm256_set1_ps(fTolerance), _CMP_LE_OQ));
+			__m256 w0 = _mm256_mul_ps(_mm256_mul_ps(vAmp[0], vAmp[0]), _mm256_set1_ps(fWeight[0]));
+			__m256 w1 = _mm256_mul_ps(_mm256_mul_ps(vAmp[1], vAmp[1]), _mm256_set1_ps(fWeight[1]));
+			__m256 vSum = _mm256_add_ps(w0, w1);
+			vRadial = _mm256_div_ps(_mm256_fmadd_ps(w0, vD0, _mm256_mul_ps(w1, vD1)), _mm256_max_ps(vSum, _mm256_set1_ps(1e-30f)));
+		}
+
+		//Z(unit; mm), clamped to 0 ~ 65535 before the conversion
+		__m256 vZ = _mm256_mul_ps(_mm256_mul_ps(vRadial, _mm256_loadu_ps(m_pZScale + i)), _mm256_set1_ps(1000.0f));
+		vZ = _mm256_and_ps(_mm256_min_ps(_mm256_max_ps(_mm256_add_ps(vZ, vHalf), vZero), _mm256_set1_ps(65535.0f)), vValid);
+		__m256i vZi = _mm256_cvttps_epi32(vZ);
+		__m128i vZ16 = _mm_packus_epi32(_mm256_castsi256_si128(vZi), _mm256_extracti128_si256(vZi, 1));
+		_mm_storeu_si128((__m128i *)(pDepth + i), vZ16);
+
+		if (pAmplitude != NULL) {
+			__m256i vA = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_add_ps(vAmp[0], vHalf), _mm256_set1_ps(65535.0f)));
+			_mm_storeu_si128((__m128i *)(pAmplitude + i), _mm_packus_epi32(_mm256_castsi256_si128(vA), _mm256_extracti128_si256(vA, 1)));
+		}
+	}
+#endif
+
+	for (; i < nEnd; i++) {
+		float fDistance[CE_PHASE_MAX_FREQUENCIES] = {}, fAmp[CE_PHASE_MAX_FREQUENCIES] = {};
+		bool bValid = true;
+		for (int f = 0; f < nFrequencies; f++) {
+			int a[CE_PHASE_TAPS];
+			for (int t = 0; t < CE_PHASE_TAPS; t++) {
+				a[t] = pRaw[(f * CE_PHASE_TAPS + t) * nPlane + i];
+				bValid = bValid && a[t] < nSaturation;
+			}
+			float fI = (float)(a[0] - a[2]);
+			float fQ = (float)(a[1] - a[3]);
+			fAmp[f] = 0.5f * sqrtf(fI * fI + fQ * fQ);
+			bValid = bValid && fAmp[f] >= fMinAmplitude;
+
+			float fPhase = Wrap(Phase(fI, fQ) - m_pOffset[f][i]);
+			fDistance[f] = fPhase * fScale[f];
+			if (!m_vWiggling[f].empty())
+				fDistance[f] -= Wiggling(m_vWiggling[f].data(), (int)m_vWiggling[f].size(), fPhase);
+		}
+
+		float fRadial = fDistance[0];
+		if (nFrequencies == 2) {
+			float fBest = 3.4e38f, fD0 = 0.0f, fD1 = 0.0f;
+			for (int n = 0; n < m_nWraps; n++) {
+				float d0 = fDistance[0] + (float)n * m_fRange[0];
+				float k = floorf((d0 - fDistance[1]) / m_fRange[1] + 0.5f);
+				k = k > 0.0f ? k : 0.0f;
+				float d1 = fDistance[1] + k * m_fRange[1];
+				float e = fabsf(d0 - d1);
+				if (e < fBest) {
+					fBest = e;
+					fD0 = d0;
+					fD1 = d1;
+				}
+			}
+			bValid = bValid && fBest <= fTolerance;
+			float w0 = fAmp[0] * fAmp[0] * fWeight[0];
+			float w1 = fAmp[1] * fAmp[1] * fWeight[1];
+			float fSum = w0 + w1;
+			fRadial = (w0 * fD0 + w1 * fD1) / (fSum > 1e-30f ? fSum : 1e-30f);
+		}
+
+		float fZ = fRadial * m_pZScale[i] * 1000.0f + 0.5f;
+		fZ = fZ < 0.0f ? 0.0f : fZ > 65535.0f ? 65535.0f : fZ;
+		pDepth[i] = bValid ? (uint16)fZ : 0;
+		if (pAmplitude != NULL) {
+			float fA = fAmp[0] + 0.5f;
+			pAmplitude[i] = (uint16)(fA < 65535.0f ? fA : 65535.0f);
+		}
+	}
+}
+
+}
@@ -0,0 +1,169 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyePhaseDecoder.h											*/
+/*																			*/
+/* @brief	Host-side raw phase to depth / amplitude decoding				*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeLens.h"
+#include "CubeEyeThreadPool.h"
+
+namespace CUBE_EYE
+{
+
+///Correlation samples per modulation frequency(0, 90, 180, 270 degree)
+#define CE_PHASE_TAPS				4
+///Modulation frequencies of a raw capture at most
+#define CE_PHASE_MAX_FREQUENCIES	2
+
+///Raw phase decoding configuration
+typedef struct _ceRawPhaseConfig
+{
+	///Modulation frequencies in the capture(1 ~ CE_PHASE_MAX_FREQUENCIES)
+	int nFrequencies;
+	///Modulation frequency(unit; MHz), in capture order
+	float fFrequencyMHz[CE_PHASE_MAX_FREQUENCIES];
+	///Smallest amplitude with a valid depth
+	float fMinAmplitude;
+	///Tap value from which a sample counts as saturated(depth 0)
+	uint16 nSaturation;
+	///Largest disagreement of the unwrapped frequencies(unit; m)
+	float fUnwrapTolerance;
+
+} ceRawPhaseConfig;
+
+/**
+*
+*@brief		Raw phase decoder
+*@details	Turns RAW_PHASE captures into the DEPTH_IR outputs on the host, so archived raw
+			captures can be decoded again with other calibration or algorithms.
+			A capture holds nFrequencies x CE_PHASE_TAPS planes of nWidth x nHeight samples, in
+			frequency then tap order. For every frequency :
+				I = A0 - A180, Q = A90 - A270, amplitude = sqrt(I^2 + Q^2) / 2,
+				phase = atan2(Q, I) - offset(x, y) in [0, 2 pi),
+				distance = phase / 2 pi * c / 2f - wiggling(phase).
+			With two frequencies the wrap counts are searched up to the common unambiguous
+			range c / 2 gcd(f1, f2); the pair closest to each other wins and the distances
+			are averaged with weights (amplitude * f)^2. The radial distance is turned into
+			Z along the optical axis with the lens rays.
+
+			Calibration tables : per-pixel phase offset(fixed pattern phase noise) and a
+			wiggling table per frequency; both are zero after SetCamera. Rows run on the
+			thread pool, 8 pixels per AVX2 step with a polynomial atan2(about 1e-5 rad
+			error). Decode is const, so several captures may be decoded at the same time, e.g.
+			by the consumers of a CCubeEyeAsyncCapture, away from the capture thread.
+*
+*/
+class CCubeEyePhaseDecoder {
+
+public:
+
+	CCubeEyePhaseDecoder();
+	~CCubeEyePhaseDecoder();
+
+	/**
+	*
+	* @brief	Default configuration
+	* @details	80 / 60 MHz(7.5 m range), amplitude 5, saturation 4095, 5 cm unwrap tolerance.
+	* @return	configuration
+	*
+	*/
+	static ceRawPhaseConfig DefaultConfig();
+
+	int SetConfig(const ceRawPhaseConfig &stConfig);
+	const ceRawPhaseConfig &GetConfig() const { return m_stConfig; }
+
+	/**
+	*
+	* @brief	Set depth camera
+	* @details	Builds the radial distance to Z table and clears the calibration tables.
+	* @param	stIntr, stDist - lens parameters(pIntrinsicParam / pDistortionParam).
+	* @param	nWidth, nHeight - frame size.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetCamera(const ceIntrinsicParam &stIntr, const ceDistortionParam &stDist, int nWidth, int nHeight);
+
+	template <class TDevice>
+	int SetCamera(const TDevice &device)
+	{
+		return SetCamera(device.pIntrinsicParam, device.pDistortionParam, device.pDevInfo.nWidth, device.pDevInfo.nHeight);
+	}
+
+	/**
+	*
+	* @brief	Set thread pool
+	* @details	NULL : single threaded. Default is CCubeEyeThreadPool::Default().
+	* @return	void
+	*
+	*/
+	void SetThreadPool(CCubeEyeThreadPool *pPool) { m_pPool = pPool; }
+
+	/**
+	*
+	* @brief	Set phase offset table
+	* @param	nFrequency - frequency index.
+	* @param	pOffset - nWidth x nHeight phase offsets(unit; rad), NULL : zero.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetPhaseOffset(int nFrequency, const float *pOffset);
+
+	/**
+	*
+	* @brief	Set wiggling table
+	* @details	Distance error of nBins equal phase bins over [0, 2 pi), the first bin centered
+				on phase 0; linearly interpolated and cyclic.
+	* @param	nFrequency - frequency index.
+	* @param	pTable - nBins errors(unit; m), NULL : none.
+	* @param	nBins(2~4096) - table size.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetWiggling(int nFrequency, const float *pTable, int nBins);
+
+	/**
+	*
+	* @brief	Decode capture
+	* @param	pRaw - nFrequencies x CE_PHASE_TAPS planes of nWidth x nHeight samples.
+	* @param	pDepth - Z depth(unit; mm), 0 : invalid.
+	* @param	pAmplitude - amplitude of the first frequency, NULL : not needed.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Decode(const uint16 *pRaw, uint16 *pDepth, uint16 *pAmplitude) const;
+
+	int getWidth() const { return m_nWidth; }
+	int getHeight() const { return m_nHeight; }
+
+	///Unambiguous range of the configured frequencies(unit; m)
+	float getMaxRange() const { return m_fMaxRange; }
+
+private:
+
+	CCubeEyePhaseDecoder(const CCubeEyePhaseDecoder &);
+	CCubeEyePhaseDecoder &operator=(const CCubeEyePhaseDecoder &);
+
+	void Release();
+	void UpdateRange();
+	void DecodeRows(const uint16 *pRaw, uint16 *pDepth, uint16 *pAmplitude, int nRowBegin, int nRowEnd) const;
+
+	ceRawPhaseConfig m_stConfig;
+	CCubeEyeThreadPool *m_pPool;
+
+	int m_nWidth;
+	int m_nHeight;
+	float *m_pZScale;				//Z / radial distance of every pixel
+	float *m_pOffset[CE_PHASE_MAX_FREQUENCIES];
+	Vector<float> m_vWiggling[CE_PHASE_MAX_FREQUENCIES];
+
+	float m_fRange[CE_PHASE_MAX_FREQUENCIES];		//c / 2f(unit; m)
+	int m_nWraps;					//wrap counts of the first frequency searched
+	float m_fMaxRange;
+};
+
+}
@@ -0,0 +1,464 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyePipeline.cpp												*/
+/*																			*/
+/* @brief	Depth processing graph with stage fusion						*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyePipeline.h"
+
+#include <algorithm>
+
+namespace CUBE_EYE
+{
+
+#define ROW_GRAIN		16
+#define PIXEL_TILE		4096		//pixels per fused tile : a few planes of it stay in L1 / L2
+
+static size_t FormatSize(pipe_format nFormat)
+{
+	return nFormat == Pipe_F32 ? sizeof(float) : sizeof(uint16);
+}
+
+CCubeEyePipeline::CCubeEyePipeline()
+	: m_nWidth(0), m_nHeight(0), m_pPool(&CCubeEyeThreadPool::Default()), m_bCompiled(false),
+	m_nGroupsDone(0), m_fRunUs(0.0f)
+{
+}
+
+CCubeEyePipeline::~CCubeEyePipeline()
+{
+	Release();
+}
+
+void CCubeEyePipeline::Release()
+{
+	for (size_t i = 0; i < m_vBuffers.size(); i++) {
+		if (m_vBuffers[i].pData != NULL)
+			ceAlignedFree(m_vBuffers[i].pData);
+	}
+	m_vBuffers.clear();
+	m_vStages.clear();
+	m_vGroups.clear();
+	m_bCompiled = false;
+}
+
+int CCubeEyePipeline::Init(int nWidth, int nHeight)
+{
+	if (nWidth <= 0 || nHeight <= 0)
+		return CE_INVALID_PARAM;
+
+	Release();
+	m_nWidth = nWidth;
+	m_nHeight = nHeight;
+	return CE_SUCCESS;
+}
+
+/*************************************************************************************
+* graph construction
+*/
+
+int CCubeEyePipeline::AddBufferEntry(pipe_format nFormat, bool bInput)
+{
+	if (m_nWidth == 0)
+		return CE_NOT_OPENED;
+	if (m_bCompiled || (nFormat != Pipe_U16 && nFormat != Pipe_F32))
+		return CE_INVALID_PARAM;
+
+	Buffer stBuffer;
+	stBuffer.nFormat = nFormat;
+	stBuffer.bInput = bInput;
+	stBuffer.nProducer = -1;
+	stBuffer.pInput = NULL;
+	stBuffer.pData = NULL;
+	m_vBuffers.push_back(stBuffer);
+	return (int)m_vBuffers.size() - 1;
+}
+
+int CCubeEyePipeline::AddInput(pipe_format nFormat)
+{
+	return AddBufferEntry(nFormat, true);
+}
+
+int CCubeEyePipeline::AddBuffer(pipe_format nFormat)
+{
+	return AddBufferEntry(nFormat, false);
+}
+
+int CCubeEyePipeline::AddStage(const char *szName, bool bPixel, std::initializer_list<int> lstIn, std::initializer_list<int> lstOut,
+	PixelKernel pixelKernel, FrameKernel frameKernel)
+{
+	if (m_nWidth == 0)
+		return CE_NOT_OPENED;
+	if (m_bCompiled || lstIn.size() > CE_PIPE_MAX_IO || lstOut.size() == 0 || lstOut.size() > CE_PIPE_MAX_IO)
+		return CE_INVALID_PARAM;
+	if (bPixel ? !pixelKernel : !frameKernel)
+		return CE_INVALID_PARAM;
+
+	int nBufferCount = (int)m_vBuffers.size();
+	for (int nIn : lstIn) {
+		if (nIn < 0 || nIn >= nBufferCount)
+			return CE_INVALID_PARAM;
+		//read before written : the stage would run ahead of its producer
+		if (!m_vBuffers[nIn].bInput && m_vBuffers[nIn].nProducer < 0)
+			return CE_INVALID_PARAM;
+	}
+	for (auto it = lstOut.begin(); it != lstOut.end(); ++it) {
+		int nOut = *it;
+		if (nOut < 0 || nOut >= nBufferCount || m_vBuffers[nOut].bInput || m_vBuffers[nOut].nProducer >= 0)
+			return CE_INVALID_PARAM;
+		if (std::find(lstIn.begin(), lstIn.end(), nOut) != lstIn.end() || std::find(lstOut.begin(), it, nOut) != it)
+			return CE_INVALID_PARAM;
+	}
+
+	std::unique_ptr<Stage> pStage(new Stage);
+	pStage->strName = szName != NULL ? szName : "";
+	pStage->bPixel = bPixel;
+	pStage->vIn.assign(lstIn.begin(), lstIn.end());
+	pStage->vOut.assign(lstOut.begin(), lstOut.end());
+	pStage->pixelKernel = pixelKernel;
+	pStage->frameKernel = frameKernel;
+	pStage->nGroup = -1;
+	memset(&pStage->stIO, 0, sizeof(pStage->stIO));
+	pStage->nAccumNs.store(0);
+	memset(&pStage->stTime, 0, sizeof(pStage->stTime));
+
+	int nStage = (int)m_vStages.size();
+	for (int nOut : lstOut)
+		m_vBuffers[nOut].nProducer = nStage;
+	m_vStages.push_back(std::move(pStage));
+	return nStage;
+}
+
+int CCubeEyePipeline::AddPixelStage(const char *szName, std::initializer_list<int> lstIn, std::initializer_list<int> lstOut, PixelKernel kernel)
+{
+	return AddStage(szName, true, lstIn, lstOut, kernel, FrameKernel());
+}
+
+int CCubeEyePipeline::AddFrameStage(const char *szName, std::initializer_list<int> lstIn, std::initializer_list<int> lstOut, FrameKernel kernel)
+{
+	return AddStage(szName, false, lstIn, lstOut, PixelKernel(), kernel);
+}
+
+/*************************************************************************************
+* common stages
+*/
+
+int CCubeEyePipeline::AddAmplitudeCheck(int nDepth, int nIR, uint16 nThreshold, int nOut)
+{
+	const int vBuffers[] = { nDepth, nIR, nOut };
+	for (int nBuffer : vBuffers) {
+		if (nBuffer < 0 || nBuffer >= (int)m_vBuffers.size() || m_vBuffers[nBuffer].nFormat != Pipe_U16)
+			return CE_INVALID_PARAM;
+	}
+
+	return AddPixelStage("AmplitudeCheck", { nDepth, nIR }, { nOut }, [nThreshold](const cePipeIO &io, size_t nBegin, size_t nEnd) {
+		const uint16 *pDepth = (const uint16 *)io.pIn[0];
+		const uint16 *pIR = (const uint16 *)io.pIn[1];
+		uint16 *pOut = (uint16 *)io.pOut[0];
+		for (size_t i = nBegin; i < nEnd; i++)
+			pOut[i] = pIR[i] >= nThreshold ? pDepth[i] : 0;
+	});
+}
+
+int CCubeEyePipeline::AddDepthToPlanes(int nDepth, const CCubeEyeDepthToPCL &toPCL, int nX, int nY, int nZ)
+{
+	if (!toPCL.IsInitialized())
+		return CE_NOT_OPENED;
+	if (toPCL.getWidth() != m_nWidth || toPCL.getHeight() != m_nHeight)
+		return CE_INVALID_PARAM;
+
+	const int vBuffers[] = { nDepth, nX, nY, nZ };
+	for (int i = 0; i < 4; i++) {
+		if (vBuffers[i] < 0 || vBuffers[i] >= (int)m_vBuffers.size() || m_vBuffers[vBuffers[i]].nFormat != (i == 0 ? Pipe_U16 : Pipe_F32))
+			return CE_INVALID_PARAM;
+	}
+
+	const float *pRayX = toPCL.getRayX();
+	const float *pRayY = toPCL.getRayY();
+	return AddPixelStage("DepthToPlanes", { nDepth }, { nX, nY, nZ }, [pRayX, pRayY](const cePipeIO &io, size_t nBegin, size_t nEnd) {
+		const uint16 *pDepth = (const uint16 *)io.pIn[0];
+		float *pX = (float *)io.pOut[0];
+		float *pY = (float *)io.pOut[1];
+		float *pZ = (float *)io.pOut[2];
+		for (size_t i = nBegin; i < nEnd; i++) {
+			float z = pDepth[i] * 0.001f;
+			pX[i] = z * pRayX[i];
+			pY[i] = z * pRayY[i];
+			pZ[i] = z;
+		}
+	});
+}
+
+int CCubeEyePipeline::AddHostFilter(int nDepth, int nIR, CCubeEyeHostFilter &filter, int nOut)
+{
+	const int vBuffers[] = { nDepth, nOut };
+	for (int nBuffer : vBuffers) {
+		if (nBuffer < 0 || nBuffer >= (int)m_vBuffers.size() || m_vBuffers[nBuffer].nFormat != Pipe_U16)
+			return CE_INVALID_PARAM;
+	}
+
+	CCubeEyeHostFilter *pFilter = &filter;
+	size_t nSize = (size_t)m_nWidth * m_nHeight * sizeof(uint16);
+	auto kernel = [pFilter, nSize](const cePipeIO &io) {
+		memcpy(io.pOut[0], io.pIn[0], nSize);
+		pFilter->Process((uint16 *)io.pOut[0], (const uint16 *)io.pIn[1]);
+	};
+
+	if (nIR < 0)
+		return AddFrameStage("HostFilter", { nDepth }, { nOut }, kernel);
+
+	if (nIR >= (int)m_vBuffers.size() || m_vBuffers[nIR].nFormat != Pipe_U16)
+		return CE_INVALID_PARAM;
+	return AddFrameStage("HostFilter", { nDepth, nIR }, { nOut }, kernel);
+}
+
+/*************************************************************************************
+* compile
+*/
+
+bool CCubeEyePipeline::IsAncestor(int nGroup, int nAncestor) const
+{
+	const Vector<int> &vDeps = m_vGroups[nGroup].vDeps;
+	for (size_t i = 0; i < vDeps.size(); i++) {
+		if (vDeps[i] == nAncestor || IsAncestor(vDeps[i], nAncestor))
+			return true;
+	}
+	return false;
+}
+
+int CCubeEyePipeline::Compile()
+{
+	if (m_nWidth == 0)
+		return CE_NOT_OPENED;
+	if (m_bCompiled)
+		return CE_SUCCESS;
+	if (m_vStages.empty())
+		return CE_INVALID_PARAM;
+
+	m_vGroups.clear();
+	for (size_t s = 0; s < m_vStages.size(); s++) {
+		Stage &stage = *m_vStages[s];
+
+		//groups producing the inputs
+		Vector<int> vProducers;
+		for (size_t i = 0; i < stage.vIn.size(); i++) {
+			int nProducer = m_vBuffers[stage.vIn[i]].nProducer;
+			if (nProducer < 0)
+				continue;
+			int nGroup = m_vStages[nProducer]->nGroup;
+			if (std::find(vProducers.begin(), vProducers.end(), nGroup) == vProducers.end())
+				vProducers.push_back(nGroup);
+		}
+
+		//a pixel stage joins the latest pixel group it reads from, if that group already
+		//waits for every other group it reads from(joining must not add a dependency)
+		if (stage.bPixel && !vProducers.empty()) {
+			int nTarget = *std::max_element(vProducers.begin(), vProducers.end());
+			bool bFuse = m_vGroups[nTarget].bPixel;
+			for (size_t i = 0; bFuse && i < vProducers.size(); i++)
+				bFuse = vProducers[i] == nTarget || IsAncestor(nTarget, vProducers[i]);
+			if (bFuse) {
+				stage.nGroup = nTarget;
+				m_vGroups[nTarget].vStages.push_back((int)s);
+				continue;
+			}
+		}
+
+		Group group;
+		group.bPixel = stage.bPixel;
+		group.vStages.push_back((int)s);
+		group.vDeps = vProducers;
+		group.nPending = 0;
+		stage.nGroup = (int)m_vGroups.size();
+		m_vGroups.push_back(group);
+	}
+
+	for (size_t g = 0; g < m_vGroups.size(); g++) {
+		for (size_t i = 0; i < m_vGroups[g].vDeps.size(); i++)
+			m_vGroups[m_vGroups[g].vDeps[i]].vDependents.push_back((int)g);
+	}
+
+	size_t nPixels = (size_t)m_nWidth * m_nHeight;
+	for (size_t b = 0; b < m_vBuffers.size(); b++) {
+		Buffer &buffer = m_vBuffers[b];
+		if (buffer.bInput || buffer.pData != NULL)
+			continue;
+		buffer.pData = ceAlignedAlloc(nPixels * FormatSize(buffer.nFormat));
+		if (buffer.pData == NULL)
+			return CE_FAILED;
+	}
+
+	m_bCompiled = true;
+	return CE_SUCCESS;
+}
+
+/*************************************************************************************
+* execution
+*/
+
+int CCubeEyePipeline::SetInput(int nBuffer, const void *pData)
+{
+	if (nBuffer < 0 || nBuffer >= (int)m_vBuffers.size() || !m_vBuffers[nBuffer].bInput)
+		return CE_INVALID_PARAM;
+	m_vBuffers[nBuffer].pInput = pData;
+	return CE_SUCCESS;
+}
+
+const void *CCubeEyePipeline::GetBuffer(int nBuffer) const
+{
+	if (nBuffer < 0 || nBuffer >= (int)m_vBuffers.size())
+		return NULL;
+	const Buffer &buffer = m_vBuffers[nBuffer];
+	return buffer.bInput ? buffer.pInput : buffer.pData;
+}
+
+const char *CCubeEyePipeline::getStageName(int nStage) const
+{
+	if (nStage < 0 || nStage >= (int)m_vStages.size())
+		return NULL;
+	return m_vStages[nStage]->strName.c_str();
+}
+
+void CCubeEyePipeline::ResetStageTime()
+{
+	for (size_t s = 0; s < m_vStages.size(); s++)
+		memset(&m_vStages[s]->stTime, 0, sizeof(ceStageTime));
+}
+
+void CCubeEyePipeline::RunGroup(int nGroup)
+{
+	const Group &group = m_vGroups[nGroup];
+
+	if (!group.bPixel) {
+		Stage &stage = *m_vStages[group.vStages[0]];
+		auto tStart = std::chrono::steady_clock::now();
+		stage.frameKernel(stage.stIO);
+		stage.nAccumNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tStart).count();
+		return;
+	}
+
+	size_t nWidth = m_nWidth;
+	auto band = [this, &group, nWidth](int nRowBegin, int nRowEnd) {
+		size_t nEnd = nRowEnd * nWidth;
+
+		for (size_t nTile = nRowBegin * nWidth; nTile < nEnd; nTile += PIXEL_TILE) {
+			size_t nTileEnd = nTile + PIXEL_TILE < nEnd ? nTile + PIXEL_TILE : nEnd;
+			for (size_t s = 0; s < group.vStages.size(); s++) {
+				Stage &stage = *m_vStages[group.vStages[s]];
+				auto tStart = std::chrono::steady_clock::now();
+				stage.pixelKernel(stage.stIO, nTile, nTileEnd);
+				stage.nAccumNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tStart).count(),
+					std::memory_order_relaxed);
+			}
+		}
+	};
+
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, m_nHeight, ROW_GRAIN, band);
+	else
+		band(0, m_nHeight);
+}
+
+void CCubeEyePipeline::RunSerial()
+{
+	//group index order is a topological order
+	for (size_t g = 0; g < m_vGroups.size(); g++)
+		RunGroup((int)g);
+}
+
+void CCubeEyePipeline::OnGroupDone(int nGroup)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_nGroupsDone++;
+	const Vector<int> &vDependents = m_vGroups[nGroup].vDependents;
+	for (size_t i = 0; i < vDependents.size(); i++) {
+		if (--m_vGroups[vDependents[i]].nPending == 0)
+			m_vReady.push_back(vDependents[i]);
+	}
+	m_doneCond.notify_all();
+}
+
+void CCubeEyePipeline::RunConcurrent()
+{
+	int nGroups = (int)m_vGroups.size();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_vReady.clear();
+	m_nGroupsDone = 0;
+	for (int g = 0; g < nGroups; g++) {
+		m_vGroups[g].nPending = (int)m_vGroups[g].vDeps.size();
+		if (m_vGroups[g].nPending == 0)
+			m_vReady.push_back(g);
+	}
+
+	//the calling thread dispatches : ready groups but one go to the pool, it runs the last one
+	while (m_nGroupsDone < nGroups) {
+		if (m_vReady.empty()) {
+			m_doneCond.wait(lock);
+			continue;
+		}
+
+		Vector<int> vRun;
+		vRun.swap(m_vReady);
+		lock.unlock();
+
+		for (size_t i = 1; i < vRun.size(); i++) {
+			int nGroup = vRun[i];
+			m_pPool->Submit([this, nGroup] {
+				RunGroup(nGroup);
+				OnGroupDone(nGroup);
+			});
+		}
+		RunGroup(vRun[0]);
+		OnGroupDone(vRun[0]);
+
+		lock.lock();
+	}
+}
+
+int CCubeEyePipeline::Run()
+{
+	if (!m_bCompiled)
+		return CE_NOT_OPENED;
+
+	for (size_t b = 0; b < m_vBuffers.size(); b++) {
+		if (m_vBuffers[b].bInput && m_vBuffers[b].pInput == NULL)
+			return CE_INVALID_PARAM;
+	}
+
+	for (size_t s = 0; s < m_vStages.size(); s++) {
+		Stage &stage = *m_vStages[s];
+		for (size_t i = 0; i < stage.vIn.size(); i++)
+			stage.stIO.pIn[i] = GetBuffer(stage.vIn[i]);
+		for (size_t i = 0; i < stage.vOut.size(); i++)
+			stage.stIO.pOut[i] = m_vBuffers[stage.vOut[i]].pData;
+		stage.stIO.nWidth = m_nWidth;
+		stage.stIO.nHeight = m_nHeight;
+		stage.nAccumNs.store(0);
+	}
+
+	TimeStampType nStart = ceHostTimeStamp();
+
+	//a dispatcher on a worker could wait on tasks queued behind itself
+	if (m_pPool == NULL || m_pPool->getThreadCount() <= 1 || m_pPool->IsWorkerThread() || m_vGroups.size() == 1)
+		RunSerial();
+	else
+		RunConcurrent();
+
+	m_fRunUs = (float)(ceHostTimeStamp() - nStart);
+
+	for (size_t s = 0; s < m_vStages.size(); s++) {
+		ceStageTime &stTime = m_vStages[s]->stTime;
+		stTime.fLastUs = m_vStages[s]->nAccumNs.load() * 0.001f;
+		stTime.nRuns++;
+		stTime.fAverageUs += (stTime.fLastUs - stTime.fAverageUs) / (float)stTime.nRuns;
+	}
+
+	return CE_SUCCESS;
+}
+
+}
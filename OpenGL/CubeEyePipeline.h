@@ -0,0 +1,290 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyePipeline.h												*/
+/*																			*/
+/* @brief	Depth processing graph with stage fusion						*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeThreadPool.h"
+#include "CubeEyeDepthToPCL.h"
+#include "CubeEyeHostFilter.h"
+
+#include <initializer_list>
+#include <memory>
+#include <string>
+
+namespace CUBE_EYE
+{
+
+///Maximum inputs / outputs of one stage
+#define CE_PIPE_MAX_IO		8
+
+///Plane element type
+enum pipe_format {
+	Pipe_U16 = 0,
+	Pipe_F32,
+};
+
+///Buffers bound to one stage call, in the order given to AddPixelStage / AddFrameStage
+typedef struct _cePipeIO
+{
+	const void *pIn[CE_PIPE_MAX_IO];
+	void *pOut[CE_PIPE_MAX_IO];
+	int nWidth;
+	int nHeight;
+
+} cePipeIO;
+
+///Stage cost
+typedef struct _ceStageTime
+{
+	///Last run(unit; us), summed over the threads for pixel stages
+	float fLastUs;
+	///Mean over nRuns(unit; us)
+	float fAverageUs;
+	uint64 nRuns;
+
+} ceStageTime;
+
+/**
+*
+*@brief		Depth processing graph
+*@details	Stages read and write whole nWidth x nHeight planes(buffers). Every buffer is either
+			a graph input, bound to caller memory with SetInput before Run, or written by
+			exactly one stage; a stage can only read buffers declared before it, so the order
+			of the Add calls is a valid execution order and the graph has no cycle.
+
+			Pixel stages compute output pixel i from input pixel i only. Compile fuses a pixel
+			stage into the group of the stages it reads from, and a group runs as one pass over
+			the frame : row bands on the thread pool, and inside a band every stage of the
+			group over a tile that stays in cache, instead of one frame walk per stage.
+			Frame stages(stencils, whole frame reductions) form a group of their own.
+			Groups that do not depend on each other run concurrently.
+*
+*/
+class CCubeEyePipeline {
+
+public:
+
+	///kernel over pixels [nBegin, nEnd)
+	typedef std::function<void(const cePipeIO &io, size_t nBegin, size_t nEnd)> PixelKernel;
+	///kernel over the whole frame
+	typedef std::function<void(const cePipeIO &io)> FrameKernel;
+
+	CCubeEyePipeline();
+	~CCubeEyePipeline();
+
+	/**
+	*
+	* @brief	Initialize
+	* @details	Clears the graph for nWidth x nHeight frames.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Init(int nWidth, int nHeight);
+
+	template <class TDevice>
+	int Init(const TDevice &device)
+	{
+		return Init(device.pDevInfo.nWidth, device.pDevInfo.nHeight);
+	}
+
+	/**
+	*
+	* @brief	Set thread pool
+	* @details	NULL : single threaded. Default is CCubeEyeThreadPool::Default().
+	* @return	void
+	*
+	*/
+	void SetThreadPool(CCubeEyeThreadPool *pPool) { m_pPool = pPool; }
+
+	/*************************************************************************************
+	* \defgroup Graph construction(before Compile)
+	* @{
+	*/
+
+	/**
+	*
+	* @brief	Add graph input
+	* @return	buffer id(>= 0)|Error Code(< 0)
+	*
+	*/
+	int AddInput(pipe_format nFormat);
+
+	/**
+	*
+	* @brief	Add buffer
+	* @details	Plane owned by the graph, written by one stage.
+	* @return	buffer id(>= 0)|Error Code(< 0)
+	*
+	*/
+	int AddBuffer(pipe_format nFormat);
+
+	/**
+	*
+	* @brief	Add pixel stage
+	* @param	szName - stage name.
+	* @param	lstIn - buffers read(graph inputs or written by earlier stages).
+	* @param	lstOut - buffers written(not yet written by another stage).
+	* @param	kernel - output pixel i depends on input pixel i only.
+	* @return	stage id(>= 0)|Error Code(< 0)
+	*
+	*/
+	int AddPixelStage(const char *szName, std::initializer_list<int> lstIn, std::initializer_list<int> lstOut, PixelKernel kernel);
+
+	/**
+	*
+	* @brief	Add frame stage
+	* @details	The kernel gets the whole frame and may use the thread pool itself.
+	* @return	stage id(>= 0)|Error Code(< 0)
+	*
+	*/
+	int AddFrameStage(const char *szName, std::initializer_list<int> lstIn, std::initializer_list<int> lstOut, FrameKernel kernel);
+
+	/**
+	*
+	* @brief	Common stages
+	* @details	AddAmplitudeCheck : nOut = nDepth where nIR >= nThreshold, else 0.
+				AddDepthToPlanes : X / Y / Z planes(unit; m) with the ray table of toPCL.
+				AddHostFilter : nOut = nDepth filtered by filter(nIR may be -1).
+				toPCL and filter must outlive the graph.
+	* @return	stage id(>= 0)|Error Code(< 0)
+	*
+	*/
+	int AddAmplitudeCheck(int nDepth, int nIR, uint16 nThreshold, int nOut);
+	int AddDepthToPlanes(int nDepth, const CCubeEyeDepthToPCL &toPCL, int nX, int nY, int nZ);
+	int AddHostFilter(int nDepth, int nIR, CCubeEyeHostFilter &filter, int nOut);
+
+	/**
+	*
+	* @brief	Compile
+	* @details	Checks that every read buffer is written, groups the stages and allocates the
+				buffers. The graph can not be changed afterwards.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Compile();
+
+	/**@}*/
+
+	/*************************************************************************************
+	* \defgroup Execution
+	* @{
+	*/
+
+	/**
+	*
+	* @brief	Bind graph input
+	* @details	pData must stay valid during Run. It is only read.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetInput(int nBuffer, const void *pData);
+
+	/**
+	*
+	* @brief	Run
+	* @details	Runs every stage once over the bound inputs. Not reentrant.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Run();
+
+	///Buffer plane(graph input : the bound pointer), NULL for an invalid id
+	const void *GetBuffer(int nBuffer) const;
+
+	template <class T>
+	const T *GetPlane(int nBuffer) const { return (const T *)GetBuffer(nBuffer); }
+
+	/**@}*/
+
+	/*************************************************************************************
+	* \defgroup Information
+	* @{
+	*/
+
+	int getStageCount() const { return (int)m_vStages.size(); }
+	const char *getStageName(int nStage) const;
+	const ceStageTime &getStageTime(int nStage) const { return m_vStages[nStage]->stTime; }
+
+	///Number of fused groups after Compile
+	int getGroupCount() const { return (int)m_vGroups.size(); }
+	///Group of nStage after Compile
+	int getStageGroup(int nStage) const { return m_vStages[nStage]->nGroup; }
+
+	///Last Run wall time(unit; us)
+	float getRunTime() const { return m_fRunUs; }
+
+	void ResetStageTime();
+
+	/**@}*/
+
+private:
+
+	struct Buffer
+	{
+		pipe_format nFormat;
+		bool bInput;
+		int nProducer;				//stage writing it, -1 : none
+		const void *pInput;
+		void *pData;
+	};
+
+	struct Stage
+	{
+		std::string strName;
+		bool bPixel;
+		Vector<int> vIn;
+		Vector<int> vOut;
+		PixelKernel pixelKernel;
+		FrameKernel frameKernel;
+		int nGroup;
+		cePipeIO stIO;
+		std::atomic<int64> nAccumNs;
+		ceStageTime stTime;
+	};
+
+	struct Group
+	{
+		bool bPixel;
+		Vector<int> vStages;
+		Vector<int> vDeps;			//groups that must finish first
+		Vector<int> vDependents;
+		int nPending;				//deps not finished in the current Run
+	};
+
+	CCubeEyePipeline(const CCubeEyePipeline &);
+	CCubeEyePipeline &operator=(const CCubeEyePipeline &);
+
+	void Release();
+	int AddBufferEntry(pipe_format nFormat, bool bInput);
+	int AddStage(const char *szName, bool bPixel, std::initializer_list<int> lstIn, std::initializer_list<int> lstOut,
+		PixelKernel pixelKernel, FrameKernel frameKernel);
+	bool IsAncestor(int nGroup, int nAncestor) const;
+	void RunGroup(int nGroup);
+	void OnGroupDone(int nGroup);
+	void RunSerial();
+	void RunConcurrent();
+
+	int m_nWidth;
+	int m_nHeight;
+	CCubeEyeThreadPool *m_pPool;
+	bool m_bCompiled;
+
+	Vector<Buffer> m_vBuffers;
+	Vector<std::unique_ptr<Stage> > m_vStages;
+	Vector<Group> m_vGroups;
+
+	//Run dispatch
+	std::mutex m_mutex;
+	std::condition_variable m_doneCond;
+	Vector<int> m_vReady;
+	int m_nGroupsDone;
+	float m_fRunUs;
+};
+
+}
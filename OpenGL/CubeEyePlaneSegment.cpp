@@ -0,0 +1,544 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyePlaneSegment.cpp											*/
+/*																			*/
+/* @brief	RANSAC plane segmentation										*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyePlaneSegment.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace CUBE_EYE
+{
+
+#define SAMPLE_ALIGN		8			//score sample planes are padded to whole AVX2 registers
+#define SCORE_BLOCK			256			//samples between the "can it still win" checks
+#define ROUND_HYPOTHESES	64			//hypotheses scored per round between the confidence checks
+#define HYPOTHESIS_GRAIN	8			//hypotheses per task
+#define CHUNK_POINTS		8192		//points per task of the whole cloud passes
+#define STRATUM_TRIES		8			//draws for a remaining point in a stratum
+#define TRIPLE_TRIES		8			//draws for three distinct samples
+#define HYPOTHESIS_STREAM	0x80000000u	//seed bit separating the hypothesis streams from the sample draw
+#define MIN_NORMAL			0.5f		//glh::plane leaves a degenerate normal unnormalized(~0)
+
+static inline uint64 Mix(uint64 n)
+{
+	//splitmix64 finalizer
+	n += 0x9E3779B97F4A7C15ull;
+	n = (n ^ (n >> 30)) * 0xBF58476D1CE4E5B9ull;
+	n = (n ^ (n >> 27)) * 0x94D049BB133111EBull;
+	return n ^ (n >> 31);
+}
+
+static inline uint32 Random(uint64 &nState, uint32 nRange)
+{
+	nState = Mix(nState);
+	return (uint32)(((nState >> 32) * nRange) >> 32);
+}
+
+//normal towards the camera(origin on the positive side : d <= 0)
+static inline void Orient(float *pPlane)
+{
+	if (pPlane[3] > 0.0f) {
+		for (int i = 0; i < 4; i++)
+			pPlane[i] = -pPlane[i];
+	}
+}
+
+//eigenvector of the smallest eigenvalue of a symmetric 3x3 matrix(xx, xy, xz, yy, yz, zz), cyclic Jacobi
+static void SmallestEigenvector(const double *pMatrix, double *pVector)
+{
+	double a[3][3] = {
+		{ pMatrix[0], pMatrix[1], pMatrix[2] },
+		{ pMatrix[1], pMatrix[3], pMatrix[4] },
+		{ pMatrix[2], pMatrix[4], pMatrix[5] } };
+	double v[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+
+	for (int nSweep = 0; nSweep < 16; nSweep++) {
+		if (a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2] < 1e-30)
+			break;
+
+		for (int p = 0; p < 2; p++) {
+			for (int q = p + 1; q < 3; q++) {
+				if (a[p][q] == 0.0)
+					continue;
+
+				double fTheta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+				double t = (fTheta >= 0.0 ? 1.0 : -1.0) / (fabs(fTheta) + sqrt(fTheta * fTheta + 1.0));
+				double c = 1.0 / sqrt(t * t + 1.0), s = t * c;
+				for (int k = 0; k < 3; k++) {
+					double fP = a[k][p], fQ = a[k][q];
+					a[k][p] = c * fP - s * fQ;
+					a[k][q] = s * fP + c * fQ;
+				}
+				for (int k = 0; k < 3; k++) {
+					double fP = a[p][k], fQ = a[q][k];
+					a[p][k] = c * fP - s * fQ;
+					a[q][k] = s * fP + c * fQ;
+				}
+				for (int k = 0; k < 3; k++) {
+					double fP = v[k][p], fQ = v[k][q];
+					v[k][p] = c * fP - s * fQ;
+					v[k][q] = s * fP + c * fQ;
+				}
+			}
+		}
+	}
+
+	int nMin = 0;
+	for (int i = 1; i < 3; i++) {
+		if (a[i][i] < a[nMin][nMin])
+			nMin = i;
+	}
+	for (int k = 0; k < 3; k++)
+		pVector[k] = v[k][nMin];
+}
+
+CCubeEyePlaneSegment::CCubeEyePlaneSegment()
+	: m_stConfig(DefaultConfig()), m_pPool(&CCubeEyeThreadPool::Default()),
+	m_pX(NULL), m_pY(NULL), m_pZ(NULL), m_nCount(0),
+	m_pSamples(NULL), m_nSampleStride(0), m_nSamples(0)
+{
+}
+
+CCubeEyePlaneSegment::~CCubeEyePlaneSegment()
+{
+	if (m_pSamples != NULL)
+		ceAlignedFree(m_pSamples);
+}
+
+ceRansacConfig CCubeEyePlaneSegment::DefaultConfig()
+{
+	ceRansacConfig stConfig;
+	stConfig.fDistance = 0.02f;
+	stConfig.nMaxIterations = 256;
+	stConfig.fConfidence = 0.99f;
+	stConfig.nScoreSamples = 4096;
+	stConfig.nMinInliers = 5000;
+	stConfig.nMaxPlanes = 4;
+	stConfig.nSeed = 0;
+	return stConfig;
+}
+
+int CCubeEyePlaneSegment::SetConfig(const ceRansacConfig &stConfig)
+{
+	if (!(stConfig.fDistance > 0.0f) || stConfig.nMaxIterations < 1
+		|| !(stConfig.fConfidence > 0.0f && stConfig.fConfidence < 1.0f)
+		|| stConfig.nScoreSamples < 3 || stConfig.nMinInliers < 3
+		|| stConfig.nMaxPlanes < 1 || stConfig.nMaxPlanes > 127)
+		return CE_INVALID_PARAM;
+
+	m_stConfig = stConfig;
+	return CE_SUCCESS;
+}
+
+template <class TFunc>
+void CCubeEyePlaneSegment::ForChunks(size_t nCount, const TFunc &func)
+{
+	int nChunks = (int)((nCount + CHUNK_POINTS - 1) / CHUNK_POINTS);
+	auto chunks = [&](int nChunkBegin, int nChunkEnd) {
+		for (int c = nChunkBegin; c < nChunkEnd; c++) {
+			size_t nBegin = (size_t)c * CHUNK_POINTS;
+			func(c, nBegin, nBegin + CHUNK_POINTS < nCount ? nBegin + CHUNK_POINTS : nCount);
+		}
+	};
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, nChunks, 1, chunks);
+	else
+		chunks(0, nChunks);
+}
+
+int CCubeEyePlaneSegment::Segment(const CCubeEyePointCloud &cloud)
+{
+	m_vPlanes.clear();
+	if (cloud.getZ() == NULL)
+		return CE_NOT_OPENED;
+
+	m_pX = cloud.getX();
+	m_pY = cloud.getY();
+	m_pZ = cloud.getZ();
+	m_nCount = cloud.getCount();
+
+	size_t nStride = ((size_t)m_stConfig.nScoreSamples + SAMPLE_ALIGN - 1) / SAMPLE_ALIGN * SAMPLE_ALIGN;
+	if (m_pSamples == NULL || nStride != m_nSampleStride) {
+		float *pSamples = (float *)ceAlignedAlloc(nStride * 3 * sizeof(float));
+		if (pSamples == NULL)
+			return CE_FAILED;
+		if (m_pSamples != NULL)
+			ceAlignedFree(m_pSamples);
+		m_pSamples = pSamples;
+		m_nSampleStride = nStride;
+	}
+
+	m_vLabels.resize(m_nCount);
+	int8 *pLabels = m_vLabels.data();
+	const float *pZ = m_pZ;
+	const CCubeEyePointCloud *pCloud = &cloud;
+	std::atomic<size_t> nValid(0);
+	ForChunks(m_nCount, [=, &nValid](int, size_t nBegin, size_t nEnd) {
+		size_t nChunkValid = 0;
+		for (size_t i = nBegin; i < nEnd; i++) {
+			bool bValid = pZ[i] > 0.0f && pCloud->IsValid(i);
+			pLabels[i] = bValid ? CE_PLANE_NONE : CE_PLANE_INVALID;
+			nChunkValid += bValid;
+		}
+		nValid.fetch_add(nChunkValid, std::memory_order_relaxed);
+	});
+
+	size_t nFree = nValid.load();
+	for (uint32 nPlane = 0; nPlane < (uint32)m_stConfig.nMaxPlanes; nPlane++) {
+		if (nFree < (size_t)m_stConfig.nMinInliers)
+			break;
+		DrawSamples(nPlane);
+
+		float fPlane[4];
+		int nIterations = 0;
+		if (Search(nPlane, fPlane, nIterations) < 3)
+			break;
+
+		//whole cloud inliers of the hypothesis, least squares refit, final inliers
+		Moments stMoments;
+		Gather(fPlane, CE_PLANE_NONE, stMoments);
+		if (stMoments.nCount < (uint64)m_stConfig.nMinInliers)
+			break;
+		Refine(stMoments, fPlane);
+		Gather(fPlane, (int8)nPlane, stMoments);
+		nFree -= (size_t)stMoments.nCount;
+
+		ceRansacPlane stPlane;
+		stPlane.plane = glh::planef(glh::vec3f(fPlane[0], fPlane[1], fPlane[2]), fPlane[3]);
+		stPlane.nInliers = (uint32)stMoments.nCount;
+		stPlane.fRmse = stMoments.nCount > 0 ? (float)sqrt(stMoments.fError / (double)stMoments.nCount) : 0.0f;
+		stPlane.nIterations = nIterations;
+		m_vPlanes.push_back(stPlane);
+	}
+
+	return CE_SUCCESS;
+}
+
+/*************************************************************************************
+* hypotheses
+*/
+
+void CCubeEyePlaneSegment::DrawSamples(uint32 nPlane)
+{
+	float *pX = m_pSamples, *pY = pX + m_nSampleStride, *pZ = pY + m_nSampleStride;
+	const int8 *pLabels = m_vLabels.data();
+
+	//one random remaining point per stratum of the cloud : memory is read in order, and a
+	//stratum without a remaining point after a few draws gives no sample
+	uint64 nState = Mix(((uint64)m_stConfig.nSeed << 32) | nPlane);
+	size_t nStrata = (size_t)m_stConfig.nScoreSamples;
+	m_nSamples = 0;
+	for (size_t k = 0; k < nStrata; k++) {
+		size_t nBegin = m_nCount * k / nStrata, nEnd = m_nCount * (k + 1) / nStrata;
+		if (nEnd == nBegin)
+			continue;
+
+		for (int nTry = 0; nTry < STRATUM_TRIES; nTry++) {
+			size_t n = nBegin + Random(nState, (uint32)(nEnd - nBegin));
+			if (pLabels[n] == CE_PLANE_NONE) {
+				pX[m_nSamples] = m_pX[n];
+				pY[m_nSamples] = m_pY[n];
+				pZ[m_nSamples] = m_pZ[n];
+				m_nSamples++;
+				break;
+			}
+		}
+	}
+
+	//padding never counts as an inlier
+	for (size_t i = m_nSamples; i < m_nSampleStride; i++)
+		pX[i] = pY[i] = pZ[i] = NAN;
+}
+
+bool CCubeEyePlaneSegment::Hypothesis(uint32 nPlane, int nIteration, float *pPlane) const
+{
+	//own stream per hypothesis : the same hypotheses whatever thread scores them
+	uint64 nState = Mix(Mix(((uint64)m_stConfig.nSeed << 32) | HYPOTHESIS_STREAM | nPlane) + (uint64)nIteration);
+	uint32 nRange = (uint32)m_nSamples, n0 = 0, n1 = 0, n2 = 0;
+	int nTry = 0;
+	for (; nTry < TRIPLE_TRIES; nTry++) {
+		n0 = Random(nState, nRange);
+		n1 = Random(nState, nRange);
+		n2 = Random(nState, nRange);
+		if (n0 != n1 && n0 != n2 && n1 != n2)
+			break;
+	}
+	if (nTry == TRIPLE_TRIES)
+		return false;
+
+	const float *pX = m_pSamples, *pY = pX + m_nSampleStride, *pZ = pY + m_nSampleStride;
+	glh::planef plane(glh::vec3f(pX[n0], pY[n0], pZ[n0]), glh::vec3f(pX[n1], pY[n1], pZ[n1]),
+		glh::vec3f(pX[n2], pY[n2], pZ[n2]));
+	const glh::vec3f &normal = plane.planenormal;
+	if (!(normal.length() > MIN_NORMAL))
+		return false;
+
+	pPlane[0] = normal[0];
+	pPlane[1] = normal[1];
+	pPlane[2] = normal[2];
+	pPlane[3] = plane.planedistance;
+	Orient(pPlane);
+	return true;
+}
+
+uint32 CCubeEyePlaneSegment::Search(uint32 nPlane, float *pPlane, int &nIterations)
+{
+	const double fLogFail = log(1.0 - (double)m_stConfig.fConfidence);
+	std::atomic<uint32> nShared(0);
+	uint32 nBest = 0;
+	int nRequired = m_stConfig.nMaxIterations, nDone = 0;
+
+	m_vScores.resize(ROUND_HYPOTHESES);
+	m_vHypotheses.resize(ROUND_HYPOTHESES * 4);
+	uint32 *pScores = m_vScores.data();
+	float *pHypotheses = m_vHypotheses.data();
+
+	//rounds until the best inlier ratio says enough hypotheses were drawn
+	while (nDone < nRequired) {
+		int nRound = nRequired - nDone < ROUND_HYPOTHESES ? nRequired - nDone : ROUND_HYPOTHESES;
+		auto hypotheses = [&](int nBegin, int nEnd) {
+			for (int h = nBegin; h < nEnd; h++) {
+				float *pHypothesis = pHypotheses + h * 4;
+				pScores[h] = 0;
+				if (!Hypothesis(nPlane, nDone + h, pHypothesis))
+					continue;
+
+				//a hypothesis that can no longer reach the best stops early
+				uint32 nScore = Score(pHypothesis, nShared.load(std::memory_order_relaxed));
+				pScores[h] = nScore;
+				uint32 nOld = nShared.load(std::memory_order_relaxed);
+				while (nScore > nOld && !nShared.compare_exchange_weak(nOld, nScore, std::memory_order_relaxed)) {}
+			}
+		};
+		if (m_pPool != NULL)
+			m_pPool->ParallelFor(0, nRound, HYPOTHESIS_GRAIN, hypotheses);
+		else
+			hypotheses(0, nRound);
+
+		//strictly better and lowest index first : the winner does not depend on the scheduling
+		for (int h = 0; h < nRound; h++) {
+			if (pScores[h] > nBest) {
+				nBest = pScores[h];
+				memcpy(pPlane, pHypotheses + h * 4, 4 * sizeof(float));
+			}
+		}
+		nDone += nRound;
+
+		if (nBest > 0) {
+			double fInlier = (double)nBest / m_nSamples;
+			double fAllInlier = fInlier * fInlier * fInlier;
+			if (fAllInlier >= 1.0)
+				break;
+			double fNeeded = ceil(fLogFail / log(1.0 - fAllInlier));
+			if (fNeeded < nRequired)
+				nRequired = fNeeded > nDone ? (int)fNeeded : nDone;
+		}
+	}
+
+	nIterations = nDone;
+	return nBest;
+}
+
+uint32 CCubeEyePlaneSegment::Score(const float *pPlane, uint32 nBest) const
+{
+	const float *pX = m_pSamples, *pY = pX + m_nSampleStride, *pZ = pY + m_nSampleStride;
+	const int nSamples = m_nSamples;
+	const float fNX = pPlane[0], fNY = pPlane[1], fNZ = pPlane[2], fD = pPlane[3], fDistance = m_stConfig.fDistance;
+	uint32 nCount = 0;
+
+#if defined(CE_USE_AVX2)
+	const __m256 vNX = _mm256_set1_ps(fNX), vNY = _mm256_set1_ps(fNY), vNZ = _mm256_set1_ps(fNZ);
+	const __m256 vD = _mm256_set1_ps(fD), vDistance = _mm256_set1_ps(fDistance);
+	const __m256 vAbs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+#endif
+
+	for (int nBlock = 0; nBlock < nSamples; nBlock += SCORE_BLOCK) {
+		if (nCount + (uint32)(nSamples - nBlock) < nBest)
+			break;
+
+		int nEnd = nBlock + SCORE_BLOCK < nSamples ? nBlock + SCORE_BLOCK : nSamples;
+		int i = nBlock;
+#if defined(CE_USE_AVX2)
+		//the padding(NaN) lets the last register run past nSamples
+		for (; i < nEnd; i += 8) {
+			__m256 fDot = _mm256_fmadd_ps(vNX, _mm256_load_ps(pX + i),
+				_mm256_fmadd_ps(vNY, _mm256_load_ps(pY + i), _mm256_mul_ps(vNZ, _mm256_load_ps(pZ + i))));
+			__m256 vInlier = _mm256_cmp_ps(_mm256_and_ps(_mm256_sub_ps(fDot, vD), vAbs), vDistance, _CMP_LT_OQ);
+			for (int nMask = _mm256_movemask_ps(vInlier); nMask != 0; nMask &= nMask - 1)
+				nCount++;
+		}
+#endif
+		for (; i < nEnd; i++) {
+			if (fabsf(fNX * pX[i] + fNY * pY[i] + fNZ * pZ[i] - fD) < fDistance)
+				nCount++;
+		}
+	}
+
+	return nCount;
+}
+
+/*************************************************************************************
+* whole cloud
+*/
+
+void CCubeEyePlaneSegment::Gather(const float *pPlane, int8 nLabel, Moments &stTotal)
+{
+	//moments about the plane point closest to the origin keep the double sums well conditioned
+	const float fNX = pPlane[0], fNY = pPlane[1], fNZ = pPlane[2], fD = pPlane[3], fDistance = m_stConfig.fDistance;
+	const double fOrigin[3] = { (double)fNX * fD, (double)fNY * fD, (double)fNZ * fD };
+	const float *pX = m_pX, *pY = m_pY, *pZ = m_pZ;
+	int8 *pLabels = m_vLabels.data();
+
+	m_vChunkMoments.resize((m_nCount + CHUNK_POINTS - 1) / CHUNK_POINTS);
+	Moments *pChunks = m_vChunkMoments.data();
+	ForChunks(m_nCount, [=](int nChunk, size_t nBegin, size_t nEnd) {
+		Moments &stMoments = pChunks[nChunk];
+		memset(&stMoments, 0, sizeof(Moments));
+
+		auto inlier = [&](size_t i, float fDist) {
+			if (pLabels[i] != CE_PLANE_NONE)
+				return;
+			if (nLabel != CE_PLANE_NONE)
+				pLabels[i] = nLabel;
+
+			double x = pX[i] - fOrigin[0], y = pY[i] - fOrigin[1], z = pZ[i] - fOrigin[2];
+			stMoments.fSum[0] += x;
+			stMoments.fSum[1] += y;
+			stMoments.fSum[2] += z;
+			stMoments.fSum2[0] += x * x;
+			stMoments.fSum2[1] += x * y;
+			stMoments.fSum2[2] += x * z;
+			stMoments.fSum2[3] += y * y;
+			stMoments.fSum2[4] += y * z;
+			stMoments.fSum2[5] += z * z;
+			stMoments.fError += (double)fDist * fDist;
+			stMoments.nCount++;
+		};
+
+		size_t i = nBegin;
+#if defined(CE_USE_AVX2)
+		//float sums per chunk about the origin, then double
+		const __m256 vNX = _mm256_set1_ps(fNX), vNY = _mm256_set1_ps(fNY), vNZ = _mm256_set1_ps(fNZ);
+		const __m256 vD = _mm256_set1_ps(fD), vDistance = _mm256_set1_ps(fDistance);
+		const __m256 vAbs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+		const __m256 vOX = _mm256_set1_ps((float)fOrigin[0]), vOY = _mm256_set1_ps((float)fOrigin[1]);
+		const __m256 vOZ = _mm256_set1_ps((float)fOrigin[2]);
+		const __m256i vNone = _mm256_set1_epi32(CE_PLANE_NONE);
+		__m256 sX = _mm256_setzero_ps(), sY = sX, sZ = sX, sXX = sX, sXY = sX, sXZ = sX, sYY = sX, sYZ = sX, sZZ = sX, sE = sX;
+		__m256i sCount = _mm256_setzero_si256();
+		for (; i + 8 <= nEnd; i += 8) {
+			__m256 x = _mm256_loadu_ps(pX + i), y = _mm256_loadu_ps(pY + i), z = _mm256_loadu_ps(pZ + i);
+			__m256 fDist = _mm256_and_ps(_mm256_sub_ps(_mm256_fmadd_ps(vNX, x, _mm256_fmadd_ps(vNY, y, _mm256_mul_ps(vNZ, z))), vD), vAbs);
+			__m256i vLabel = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)(pLabels + i)));
+			__m256 vInlier = _mm256_and_ps(_mm256_cmp_ps(fDist, vDistance, _CMP_LT_OQ),
+				_mm256_castsi256_ps(_mm256_cmpeq_epi32(vLabel, vNone)));
+			int nMask = _mm256_movemask_ps(vInlier);
+			if (nMask == 0)
+				continue;
+
+			if (nLabel != CE_PLANE_NONE) {
+				for (; nMask != 0; nMask &= nMask - 1) {
+					int nLane = 0;
+					while (((nMask >> nLane) & 1) == 0)
+						nLane++;
+					pLabels[i + nLane] = nLabel;
+				}
+			}
+
+			x = _mm256_and_ps(_mm256_sub_ps(x, vOX), vInlier);
+			y = _mm256_and_ps(_mm256_sub_ps(y, vOY), vInlier);
+			z = _mm256_and_ps(_mm256_sub_ps(z, vOZ), vInlier);
+			fDist = _mm256_and_ps(fDist, vInlier);
+			sX = _mm256_add_ps(sX, x);
+			sY = _mm256_add_ps(sY, y);
+			sZ = _mm256_add_ps(sZ, z);
+			sXX = _mm256_fmadd_ps(x, x, sXX);
+			sXY = _mm256_fmadd_ps(x, y, sXY);
+			sXZ = _mm256_fmadd_ps(x, z, sXZ);
+			sYY = _mm256_fmadd_ps(y, y, sYY);
+			sYZ = _mm256_fmadd_ps(y, z, sYZ);
+			sZZ = _mm256_fmadd_ps(z, z, sZZ);
+			sE = _mm256_fmadd_ps(fDist, fDist, sE);
+			sCount = _mm256_sub_epi32(sCount, _mm256_castps_si256(vInlier));
+		}
+
+		const __m256 vSums[10] = { sX, sY, sZ, sXX, sXY, sXZ, sYY, sYZ, sZZ, sE };
+		double fSums[10];
+		for (int k = 0; k < 10; k++) {
+			float fLanes[8];
+			_mm256_storeu_ps(fLanes, vSums[k]);
+			fSums[k] = 0.0;
+			for (int l = 0; l < 8; l++)
+				fSums[k] += fLanes[l];
+		}
+		for (int k = 0; k < 3; k++)
+			stMoments.fSum[k] = fSums[k];
+		for (int k = 0; k < 6; k++)
+			stMoments.fSum2[k] = fSums[3 + k];
+		stMoments.fError = fSums[9];
+
+		int32 nCounts[8];
+		_mm256_storeu_si256((__m256i *)nCounts, sCount);
+		for (int l = 0; l < 8; l++)
+			stMoments.nCount += (uint32)nCounts[l];
+#endif
+		for (; i < nEnd; i++) {
+			float fDist = fabsf(fNX * pX[i] + fNY * pY[i] + fNZ * pZ[i] - fD);
+			if (fDist < fDistance)
+				inlier(i, fDist);
+		}
+	});
+
+	memset(&stTotal, 0, sizeof(Moments));
+	for (size_t c = 0; c < m_vChunkMoments.size(); c++) {
+		for (int k = 0; k < 3; k++)
+			stTotal.fSum[k] += pChunks[c].fSum[k];
+		for (int k = 0; k < 6; k++)
+			stTotal.fSum2[k] += pChunks[c].fSum2[k];
+		stTotal.fError += pChunks[c].fError;
+		stTotal.nCount += pChunks[c].nCount;
+	}
+	for (int k = 0; k < 3; k++)
+		stTotal.fOrigin[k] = fOrigin[k];
+}
+
+bool CCubeEyePlaneSegment::Refine(const Moments &stMoments, float *pPlane) const
+{
+	if (stMoments.nCount < 3)
+		return false;
+
+	//normal : direction of least spread of the inliers, through their centroid
+	double fInv = 1.0 / (double)stMoments.nCount;
+	double m[3] = { stMoments.fSum[0] * fInv, stMoments.fSum[1] * fInv, stMoments.fSum[2] * fInv };
+	double fCovariance[6] = {
+		stMoments.fSum2[0] * fInv - m[0] * m[0], stMoments.fSum2[1] * fInv - m[0] * m[1],
+		stMoments.fSum2[2] * fInv - m[0] * m[2], stMoments.fSum2[3] * fInv - m[1] * m[1],
+		stMoments.fSum2[4] * fInv - m[1] * m[2], stMoments.fSum2[5] * fInv - m[2] * m[2] };
+	double n[3];
+	SmallestEigenvector(fCovariance, n);
+
+	double fLength = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+	if (!(fLength > 0.5))
+		return false;
+
+	double fD = 0.0;
+	for (int k = 0; k < 3; k++) {
+		n[k] /= fLength;
+		fD += n[k] * (m[k] + stMoments.fOrigin[k]);
+	}
+	pPlane[0] = (float)n[0];
+	pPlane[1] = (float)n[1];
+	pPlane[2] = (float)n[2];
+	pPlane[3] = (float)fD;
+	Orient(pPlane);
+	return true;
+}
+
+}
@@ -0,0 +1,170 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyePlaneSegment.h											*/
+/*																			*/
+/* @brief	RANSAC plane segmentation										*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyePointCloud.h"
+
+#include <GL/glh_linear.h>
+
+namespace CUBE_EYE
+{
+
+///Point label : not on any plane
+#define CE_PLANE_NONE		(-1)
+///Point label : invalid point
+#define CE_PLANE_INVALID	(-2)
+
+///Plane segmentation configuration
+typedef struct _ceRansacConfig
+{
+	///Inlier distance to the plane(unit; m)
+	float fDistance;
+	///Hypotheses per plane at most
+	int nMaxIterations;
+	///Probability of drawing at least one all-inlier sample, stops the search early
+	float fConfidence;
+	///Points the hypotheses are scored on(random subset of the remaining points)
+	int nScoreSamples;
+	///Smallest plane accepted(inliers in the whole cloud)
+	int nMinInliers;
+	///Planes extracted at most(1 ~ 127)
+	int nMaxPlanes;
+	///Random seed - same seed, same planes
+	uint32 nSeed;
+
+} ceRansacConfig;
+
+///Extracted plane
+typedef struct _ceRansacPlane
+{
+	///n . p = d, normal towards the camera
+	glh::planef plane;
+	///Inliers in the whole cloud
+	uint32 nInliers;
+	///RMS inlier distance(unit; m)
+	float fRmse;
+	///Hypotheses evaluated
+	int nIterations;
+
+} ceRansacPlane;
+
+/**
+*
+*@brief		RANSAC plane segmentation
+*@details	Extracts up to nMaxPlanes planes one after the other(best supported first); the inliers of
+			a plane are labelled and take no part in the next search.
+			For each plane :
+			1. up to nScoreSamples remaining points(one per stratum of the cloud) are drawn
+			   into packed SoA arrays,
+			2. hypotheses glh::planef(p0, p1, p2) of random sample triples are scored in rounds
+			   on the thread pool, 8 points per AVX2 step; a hypothesis stops as soon as it can
+			   no longer beat the best one, and the rounds stop once fConfidence is reached,
+			3. the best plane is scored on the whole cloud, refined by least squares on its
+			   inliers and the final inliers are labelled.
+			Hypotheses draw from their own random streams, so the result does not depend on
+			the thread count.
+*
+*/
+class CCubeEyePlaneSegment {
+
+public:
+
+	CCubeEyePlaneSegment();
+	~CCubeEyePlaneSegment();
+
+	/**
+	*
+	* @brief	Default configuration
+	* @details	2 cm inlier distance, 256 hypotheses, 0.99 confidence, 4096 score samples,
+				5000 minimum inliers, 4 planes.
+	* @return	configuration
+	*
+	*/
+	static ceRansacConfig DefaultConfig();
+
+	int SetConfig(const ceRansacConfig &stConfig);
+	const ceRansacConfig &GetConfig() const { return m_stConfig; }
+
+	/**
+	*
+	* @brief	Set thread pool
+	* @details	NULL : single threaded. Default is CCubeEyeThreadPool::Default().
+	* @return	void
+	*
+	*/
+	void SetThreadPool(CCubeEyeThreadPool *pPool) { m_pPool = pPool; }
+
+	/**
+	*
+	* @brief	Segment planes
+	* @details	Valid points are Z > 0 with their mask bit set.
+	* @param	cloud - organized or unorganized cloud(unit; m).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Segment(const CCubeEyePointCloud &cloud);
+
+	/*************************************************************************************
+	* \defgroup Results of the last Segment
+	* @{
+	*/
+
+	int getPlaneCount() const { return (int)m_vPlanes.size(); }
+	const ceRansacPlane &getPlane(int nPlane) const { return m_vPlanes[nPlane]; }
+
+	///Plane index of every point, CE_PLANE_NONE or CE_PLANE_INVALID
+	const int8 *getLabels() const { return m_vLabels.data(); }
+
+	/**@}*/
+
+private:
+
+	CCubeEyePlaneSegment(const CCubeEyePlaneSegment &);
+	CCubeEyePlaneSegment &operator=(const CCubeEyePlaneSegment &);
+
+	//inlier sums about fOrigin
+	struct Moments
+	{
+		double fOrigin[3];
+		double fSum[3];
+		double fSum2[6];			//xx, xy, xz, yy, yz, zz
+		double fError;				//squared distances to the plane
+		uint64 nCount;
+	};
+
+	template <class TFunc>
+	void ForChunks(size_t nCount, const TFunc &func);
+
+	void DrawSamples(uint32 nPlane);
+	bool Hypothesis(uint32 nPlane, int nIteration, float *pPlane) const;
+	uint32 Search(uint32 nPlane, float *pPlane, int &nIterations);
+	uint32 Score(const float *pPlane, uint32 nBest) const;
+	void Gather(const float *pPlane, int8 nLabel, Moments &stTotal);
+	bool Refine(const Moments &stMoments, float *pPlane) const;
+
+	ceRansacConfig m_stConfig;
+	CCubeEyeThreadPool *m_pPool;
+
+	const float *m_pX;
+	const float *m_pY;
+	const float *m_pZ;
+	size_t m_nCount;
+
+	Vector<int8> m_vLabels;
+	float *m_pSamples;				//X, Y, Z planes of m_nSampleStride floats
+	size_t m_nSampleStride;
+	int m_nSamples;
+	Vector<uint32> m_vScores;
+	Vector<float> m_vHypotheses;	//4 floats(nx, ny, nz, d) per hypothesis of a round
+	Vector<Moments> m_vChunkMoments;
+	Vector<ceRansacPlane> m_vPlanes;
+};
+
+}
@@ -0,0 +1,381 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyePlayback.cpp												*/
+/*																			*/
+/* @brief	Recorded session playback with the CCubeEye read API			*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyePlayback.h"
+
+namespace CUBE_EYE
+{
+
+#define PLAY_MIN_DEPTH	100			//mm
+#define PLAY_MAX_DEPTH	10000		//mm
+
+CCubeEyePlayback::CCubeEyePlayback()
+	: m_stConfig(DefaultConfig()), m_bStarted(false), m_nFrameRate(FPS_30),
+	m_nLoopFrames(0), m_nLoopTime(0), m_nStartIndex(0), m_nDecodeSeq(0), m_nReadSeq(0), m_bStop(false),
+	m_bPaceAnchored(false), m_nPaceBase(0)
+{
+}
+
+CCubeEyePlayback::~CCubeEyePlayback()
+{
+	Disconnect();
+}
+
+cePlaybackConfig CCubeEyePlayback::DefaultConfig()
+{
+	cePlaybackConfig stConfig;
+	stConfig.bRealTime = true;
+	stConfig.fSpeed = 1.0f;
+	stConfig.bLoop = false;
+	stConfig.nReadAhead = 8;
+	return stConfig;
+}
+
+int CCubeEyePlayback::SetConfig(const cePlaybackConfig &stConfig)
+{
+	if (m_bStarted)
+		return CE_FAILED;
+	if (stConfig.fSpeed <= 0.0f || stConfig.nReadAhead < 1)
+		return CE_INVALID_PARAM;
+
+	m_stConfig = stConfig;
+	return CE_SUCCESS;
+}
+
+int CCubeEyePlayback::AddRecording(const char *szPath)
+{
+	if (szPath == NULL || szPath[0] == 0 || strlen(szPath) >= sizeof(((ceDevicePath *)0)->szDevPath))
+		return CE_INVALID_PARAM;
+
+	m_vPaths.push_back(szPath);
+	return CE_SUCCESS;
+}
+
+void CCubeEyePlayback::SetLogStatus(bool bConsolePrintEnable, bool bLogEnable)
+{
+	(void)bConsolePrintEnable;
+	(void)bLogEnable;
+}
+
+Vector<ceDevicePath> CCubeEyePlayback::DeviceSearch()
+{
+	Vector<ceDevicePath> vDevices;
+
+	for (size_t i = 0; i < m_vPaths.size(); i++) {
+		ceDevicePath stPath;
+		memset(&stPath, 0, sizeof(stPath));
+		stPath.szDevNum = (unsigned char)i;
+		snprintf(stPath.szProductName, sizeof(stPath.szProductName), "MR1000-PLAY");
+		snprintf(stPath.szDevPath, sizeof(stPath.szDevPath), "%s", m_vPaths[i].c_str());
+		stPath.data_format = Format_XYZI;
+		vDevices.push_back(stPath);
+	}
+
+	return vDevices;
+}
+
+int CCubeEyePlayback::Connect(ceDevicePath pDevPath)
+{
+	if (m_bConnected)
+		return CE_FAILED;
+	if ((size_t)pDevPath.szDevNum >= m_vPaths.size())
+		return CE_NOT_FOUND;
+
+	int nResult = m_reader.Open(m_vPaths[pDevPath.szDevNum].c_str());
+	if (nResult < 0)
+		return nResult;
+
+	int nWidth = m_reader.getWidth();
+	int nHeight = m_reader.getHeight();
+
+	const ceRecDeviceBlock *pDevice = m_reader.getDeviceBlock();
+	if (pDevice != NULL) {
+		pDevInfo = pDevice->stDevInfo;
+		pIntrinsicParam = pDevice->stIntrinsics;
+		pDistortionParam = pDevice->stDistortion;
+		m_nFrameRate = pDevice->nFrameRate != 0 ? (uint8)pDevice->nFrameRate : (uint8)FPS_30;
+		m_toPCL.Init(pIntrinsicParam, pDistortionParam, nWidth, nHeight);
+	}
+	else {
+		memset(&pDevInfo, 0, sizeof(pDevInfo));
+		snprintf(pDevInfo.szVendorName, sizeof(pDevInfo.szVendorName), "Playback");
+		snprintf(pDevInfo.szDevName, sizeof(pDevInfo.szDevName), "CubeEyePlayback");
+		memset(&pIntrinsicParam, 0, sizeof(pIntrinsicParam));
+		memset(&pDistortionParam, 0, sizeof(pDistortionParam));
+		m_nFrameRate = FPS_30;
+	}
+	pDevInfo.nWidth = (unsigned short)nWidth;
+	pDevInfo.nHeight = (unsigned short)nHeight;
+
+	//one pass of the recording, so that looped frames continue the ID / time line
+	uint64 nCount = m_reader.getFrameCount();
+	if (nCount > 0) {
+		const ceRecIndexEntry &stFirst = m_reader.getIndexEntry(0);
+		const ceRecIndexEntry &stLast = m_reader.getIndexEntry(nCount - 1);
+		m_nLoopFrames = stLast.nFrameID - stFirst.nFrameID + 1;
+		if (m_nLoopFrames < (int64)nCount)
+			m_nLoopFrames = (int64)nCount;
+		uint64 nDuration = stLast.nTimeStamp > stFirst.nTimeStamp ? stLast.nTimeStamp - stFirst.nTimeStamp : 0;
+		//FPS_8 is really 7.5 fps
+		uint64 nPeriodUs = (m_nFrameRate == FPS_8) ? 133333 : 1000000 / m_nFrameRate;
+		m_nLoopTime = nCount > 1 ? nDuration + nDuration / (nCount - 1) : nPeriodUs;
+	}
+
+	m_nStartIndex = 0;
+	m_bPointCloud = false;
+	m_bConnected = true;
+	return CE_SUCCESS;
+}
+
+void CCubeEyePlayback::Disconnect()
+{
+	Stop();
+	m_bConnected = false;
+	m_reader.Close();
+	m_vSlots.clear();
+	m_vDepth.clear();
+	m_vIR.clear();
+}
+
+/*************************************************************************************
+* read ahead
+*/
+
+int CCubeEyePlayback::Start()
+{
+	if (!m_bConnected)
+		return CE_NOT_OPENED;
+	if (m_bStarted)
+		return CE_SUCCESS;
+
+	StartReadAhead(m_nStartIndex);
+	m_bStarted = true;
+	return CE_SUCCESS;
+}
+
+int CCubeEyePlayback::Stop()
+{
+	if (!m_bStarted)
+		return CE_SUCCESS;
+
+	//resume from the first frame not delivered
+	StopReadAhead();
+	m_nStartIndex += m_nReadSeq;
+	m_bStarted = false;
+	return CE_SUCCESS;
+}
+
+int CCubeEyePlayback::Seek(uint64 nIndex)
+{
+	if (!m_bConnected)
+		return CE_NOT_OPENED;
+	if (nIndex >= m_reader.getFrameCount())
+		return CE_OUTOFRANGE;
+
+	if (m_bStarted) {
+		StopReadAhead();
+		StartReadAhead(nIndex);
+	}
+	else {
+		m_nStartIndex = nIndex;
+	}
+	return CE_SUCCESS;
+}
+
+void CCubeEyePlayback::StartReadAhead(uint64 nIndex)
+{
+	size_t nPixel = (size_t)m_reader.getWidth() * m_reader.getHeight();
+	m_vSlots.resize(m_stConfig.nReadAhead);
+	for (size_t i = 0; i < m_vSlots.size(); i++) {
+		m_vSlots[i].vDepth.resize(nPixel);
+		m_vSlots[i].vIR.resize(nPixel);
+		m_vSlots[i].nResult = CE_SUCCESS;
+	}
+
+	m_nStartIndex = nIndex;
+	m_nDecodeSeq = 0;
+	m_nReadSeq = 0;
+	m_bStop = false;
+	m_bPaceAnchored = false;
+	m_readAheadThread = std::thread(&CCubeEyePlayback::ReadAheadThread, this);
+}
+
+void CCubeEyePlayback::StopReadAhead()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStop = true;
+	}
+	m_freeCond.notify_all();
+	m_readyCond.notify_all();
+	if (m_readAheadThread.joinable())
+		m_readAheadThread.join();
+}
+
+void CCubeEyePlayback::ReadAheadThread()
+{
+	uint64 nCount = m_reader.getFrameCount();
+	uint64 nSlots = m_vSlots.size();
+
+	for (;;) {
+		uint64 nSeq;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_freeCond.wait(lock, [this, nSlots] { return m_bStop || m_nDecodeSeq - m_nReadSeq < nSlots; });
+			if (m_bStop)
+				break;
+			nSeq = m_nDecodeSeq;
+		}
+
+		//the slot of nSeq is not visible to the reader until m_nDecodeSeq moves past it
+		Slot &stSlot = m_vSlots[(size_t)(nSeq % nSlots)];
+		uint64 nPosition = m_nStartIndex + nSeq;
+		uint64 nPass = nCount > 0 ? nPosition / nCount : 0;
+		bool bEnd = nCount == 0 || (nPass > 0 && !m_stConfig.bLoop);
+
+		if (bEnd) {
+			stSlot.nResult = CE_OUTOFRANGE;
+		}
+		else {
+			stSlot.nResult = m_reader.ReadFrame(nPosition % nCount, &stSlot.vDepth[0], &stSlot.vIR[0], stSlot.stInfo);
+			stSlot.stInfo.nFrameID += (long)(nPass * m_nLoopFrames);
+			stSlot.stInfo.nTimeStamp += nPass * m_nLoopTime;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_nDecodeSeq++;
+		m_readyCond.notify_one();
+		//the end marker stays in its slot, nothing more to read
+		if (bEnd)
+			break;
+	}
+}
+
+int CCubeEyePlayback::NextFrame(uint16 *pDepth, uint16 *pIR, ceFrameInfo &pFrameInfo)
+{
+	if (!m_bStarted)
+		return CE_GETFRAME_FAILED;
+
+	uint64 nSeq;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_readyCond.wait(lock, [this] { return m_bStop || m_nReadSeq < m_nDecodeSeq; });
+		if (m_bStop)
+			return CE_GETFRAME_FAILED;
+		nSeq = m_nReadSeq;
+	}
+
+	const Slot &stSlot = m_vSlots[(size_t)(nSeq % m_vSlots.size())];
+	if (stSlot.nResult == CE_OUTOFRANGE)
+		return CE_OUTOFRANGE;
+
+	if (stSlot.nResult == CE_SUCCESS) {
+		if (m_stConfig.bRealTime) {
+			//due time relative to the first frame read since Start / Seek
+			std::chrono::steady_clock::time_point tNow = std::chrono::steady_clock::now();
+			if (!m_bPaceAnchored || stSlot.stInfo.nTimeStamp < m_nPaceBase) {
+				m_nPaceBase = stSlot.stInfo.nTimeStamp;
+				m_tPaceBase = tNow;
+				m_bPaceAnchored = true;
+			}
+			int64 nDelayUs = (int64)((stSlot.stInfo.nTimeStamp - m_nPaceBase) / m_stConfig.fSpeed);
+			std::this_thread::sleep_until(m_tPaceBase + std::chrono::microseconds(nDelayUs));
+		}
+
+		size_t nPlane = stSlot.vDepth.size() * sizeof(uint16);
+		memcpy(pDepth, &stSlot.vDepth[0], nPlane);
+		if (pIR != NULL)
+			memcpy(pIR, &stSlot.vIR[0], nPlane);
+		pFrameInfo = stSlot.stInfo;
+	}
+	int nResult = stSlot.nResult;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_nReadSeq++;
+	}
+	m_freeCond.notify_one();
+	return nResult;
+}
+
+/*************************************************************************************
+* read frame
+*/
+
+int CCubeEyePlayback::ReadDepthIRFrame(uint16 *pDepth, uint16 *pIR, ceFrameInfo &pFrameInfo)
+{
+	if (!m_bConnected)
+		return CE_NOT_OPENED;
+	if (m_bPointCloud)
+		return CE_UNSUPPORTED;
+	if (pDepth == NULL)
+		return CE_INVALID_PARAM;
+
+	return NextFrame(pDepth, pIR, pFrameInfo);
+}
+
+int CCubeEyePlayback::ReadPCLFrame(cePointCloud *pPCLFrame, ceFrameInfo &pFrameInfo)
+{
+	if (!m_bConnected)
+		return CE_NOT_OPENED;
+	if (!m_bPointCloud || m_reader.getDeviceBlock() == NULL || !m_toPCL.IsInitialized())
+		return CE_UNSUPPORTED;
+	if (pPCLFrame == NULL)
+		return CE_INVALID_PARAM;
+
+	size_t nSize = (size_t)m_reader.getWidth() * m_reader.getHeight();
+	m_vDepth.resize(nSize);
+	m_vIR.resize(nSize);
+
+	int nResult = NextFrame(&m_vDepth[0], &m_vIR[0], pFrameInfo);
+	if (nResult != CE_SUCCESS)
+		return nResult;
+
+	pFrameInfo.nFrameType = 1;
+	return m_toPCL.Convert(&m_vDepth[0], &m_vIR[0], pPCLFrame);
+}
+
+/*************************************************************************************
+* parameters
+*/
+
+int CCubeEyePlayback::getDepthCameraLensParameter(ceIntrinsicParam &pfIntrinsics, ceDistortionParam &pDistortionCoeff)
+{
+	if (!m_bConnected)
+		return CE_NOT_OPENED;
+	if (m_reader.getDeviceBlock() == NULL)
+		return CE_UNSUPPORTED;
+	pfIntrinsics = pIntrinsicParam;
+	pDistortionCoeff = pDistortionParam;
+	return CE_SUCCESS;
+}
+
+int CCubeEyePlayback::getDepthRange(uint16 &nMaxDepth, uint16 &nMinDepth)
+{
+	nMaxDepth = PLAY_MAX_DEPTH;
+	nMinDepth = PLAY_MIN_DEPTH;
+	return CE_SUCCESS;
+}
+
+int CCubeEyePlayback::setFrameRate(uint8 nFrameRate)
+{
+	//pacing follows the recorded time stamps(cePlaybackConfig::fSpeed)
+	if (nFrameRate != FPS_30 && nFrameRate != FPS_15 && nFrameRate != FPS_8)
+		return CE_INVALID_PARAM;
+	return nFrameRate == m_nFrameRate ? CE_SUCCESS : CE_UNSUPPORTED;
+}
+
+int CCubeEyePlayback::getFrameRate(uint8 &nFrameRate)
+{
+	nFrameRate = m_nFrameRate;
+	return CE_SUCCESS;
+}
+
+}
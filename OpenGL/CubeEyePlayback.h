@@ -0,0 +1,217 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyePlayback.h												*/
+/*																			*/
+/* @brief	Recorded session playback with the CCubeEye read API			*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeRecord.h"
+#include "CubeEyeDeviceBase.h"
+#include "CubeEyeDepthToPCL.h"
+
+namespace CUBE_EYE
+{
+
+///Playback configuration
+typedef struct _cePlaybackConfig
+{
+	///true : frames are paced by their recorded nTimeStamp, false : as fast as they are read
+	bool bRealTime;
+	///Real time speed factor(1.0 : recorded rate)
+	float fSpeed;
+	///Restart from the first frame at the end of the recording
+	bool bLoop;
+	///Number of frames decoded ahead by the background thread(1~)
+	int nReadAhead;
+
+} cePlaybackConfig;
+
+/**
+*
+*@brief		Recorded session playback
+*@details	Exposes the same methods as CCubeEye(like CCubeEyeSim), streaming the frames of
+			recordings made with CCubeEyeRecorder. Each recording registered with AddRecording
+			is one device of DeviceSearch.
+			A background thread reads and decodes up to nReadAhead frames ahead of the reader.
+			Frames are never skipped, so every run delivers the same frame sequence; in real
+			time mode a late reader gets the overdue frames back to back. When looping,
+			nFrameID and nTimeStamp keep increasing across the restart. The parameter setters
+			of CCubeEyeDeviceBase are accepted without effect on the recorded frames.
+*
+*/
+class CCubeEyePlayback : public CCubeEyeDeviceBase {
+
+public:
+
+	/*************************************************************************************
+	* \defgroup Initialization
+	* @{
+	*/
+
+	CCubeEyePlayback();
+	~CCubeEyePlayback();
+
+	/**
+	*
+	* @brief	Default configuration
+	* @details	Real time, speed 1.0, no loop, 8 frames read ahead.
+	* @return	configuration
+	*
+	*/
+	static cePlaybackConfig DefaultConfig();
+
+	/**
+	*
+	* @brief	Set playback configuration
+	* @details	Must be called before Start.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetConfig(const cePlaybackConfig &stConfig);
+
+	const cePlaybackConfig &GetConfig() const { return m_stConfig; }
+
+	/**
+	*
+	* @brief	Register recording
+	* @param	szPath - recording file path.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int AddRecording(const char *szPath);
+
+	void SetLogStatus(bool bConsolePrintEnable = true, bool bLogEnable = false);
+
+	Vector<ceDevicePath> DeviceSearch();
+
+	int Connect(ceDevicePath pDevPath);
+
+	void Disconnect();
+
+	/**@}*/
+
+	/*************************************************************************************
+	* \defgroup Start/Stop Frame
+	* @{
+	*/
+
+	int Start();
+
+	int Stop();
+
+	/**
+	*
+	* @brief	Seek
+	* @details	Next frame read is recording frame nIndex.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Seek(uint64 nIndex);
+
+	uint64 getFrameCount() const { return m_reader.getFrameCount(); }
+
+	/**@}*/
+
+	/*************************************************************************************
+	* \defgroup Read ToF Frame
+	* @{
+	*/
+
+	/**
+	*
+	* @brief	Read Depth/IR Frame.
+	* @details	Copies the next decoded frame. In real time mode the call blocks until the
+				frame is due.
+	* @param	pIR - NULL : IR is skipped.
+	* @return	Success(0)|CE_OUTOFRANGE(end of recording)|Error Code(< 0)
+	*
+	*/
+	int ReadDepthIRFrame(uint16 *pDepth, uint16 *pIR, ceFrameInfo &pFrameInfo);
+
+	/**
+	*
+	* @brief	Read PCL Frame.
+	* @details	Converts the next frame with the recorded lens parameters(available after
+				setDepthToPointCloud, needs a recording with device information).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int ReadPCLFrame(cePointCloud *pPCLFrame, ceFrameInfo &pFrameInfo);
+
+	/**@}*/
+
+	/*************************************************************************************
+	* \defgroup Set/Get ToF Parameters
+	* @{
+	*/
+
+	int getDepthCameraLensParameter(ceIntrinsicParam &pfIntrinsics, ceDistortionParam &pDistortionCoeff);
+	int getDepthRange(uint16 &nMaxDepth, uint16 &nMinDepth);
+
+	/**
+	*
+	* @brief	Set frame rate
+	* @details	Pacing follows the recorded time stamps, so only the recorded rate is accepted.
+	* @return	Success(0)|CE_UNSUPPORTED(any other rate)|Error Code(< 0)
+	*
+	*/
+	int setFrameRate(uint8 nFrameRate);
+	int getFrameRate(uint8 &nFrameRate);
+
+	/**@}*/
+
+private:
+
+	struct Slot
+	{
+		Vector<uint16> vDepth;
+		Vector<uint16> vIR;
+		ceFrameInfo stInfo;
+		int nResult;
+	};
+
+	CCubeEyePlayback(const CCubeEyePlayback &);
+	CCubeEyePlayback &operator=(const CCubeEyePlayback &);
+
+	void StartReadAhead(uint64 nIndex);
+	void StopReadAhead();
+	void ReadAheadThread();
+	int NextFrame(uint16 *pDepth, uint16 *pIR, ceFrameInfo &pFrameInfo);
+
+	cePlaybackConfig m_stConfig;
+	Vector<std::string> m_vPaths;
+
+	CCubeEyeRecordReader m_reader;
+	bool m_bStarted;
+	uint8 m_nFrameRate;				//recorded frame rate
+
+	//loop offsets : one recording pass
+	int64 m_nLoopFrames;
+	uint64 m_nLoopTime;
+
+	//read ahead ring, slot = sequence % size
+	Vector<Slot> m_vSlots;
+	uint64 m_nStartIndex;			//recording index of sequence 0
+	uint64 m_nDecodeSeq;			//next sequence decoded
+	uint64 m_nReadSeq;				//next sequence delivered
+	bool m_bStop;
+	std::mutex m_mutex;
+	std::condition_variable m_readyCond;
+	std::condition_variable m_freeCond;
+	std::thread m_readAheadThread;
+
+	//real time pacing
+	bool m_bPaceAnchored;
+	TimeStampType m_nPaceBase;		//frame time stamp of the anchor
+	std::chrono::steady_clock::time_point m_tPaceBase;
+
+	CCubeEyeDepthToPCL m_toPCL;
+	Vector<uint16> m_vDepth;		//scratch for ReadPCLFrame
+	Vector<uint16> m_vIR;
+};
+
+}
@@ -0,0 +1,436 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyePointCloud.cpp											*/
+/*																			*/
+/* @brief	Structure of arrays point cloud container						*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyePointCloud.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace CUBE_EYE
+{
+
+#define PLANE_BLOCK		8			//plane length is padded to whole AVX2 registers
+#define CHUNK_GRAIN		128			//mask words per band(8192 points)
+
+static inline int BitCount(uint64 n)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	return (int)__popcnt64(n);
+#elif defined(_MSC_VER)
+	return (int)(__popcnt((uint32)n) + __popcnt((uint32)(n >> 32)));
+#else
+	return __builtin_popcountll(n);
+#endif
+}
+
+CCubeEyePointCloud::CCubeEyePointCloud()
+	: m_nWidth(0), m_nHeight(0), m_bOrganized(false), m_pPool(&CCubeEyeThreadPool::Default()),
+	m_pBlock(NULL), m_nBlockPoints(0), m_pMask(NULL), m_nMaskWords(0),
+	m_pX(NULL), m_pY(NULL), m_pZ(NULL), m_pI(NULL)
+{
+}
+
+CCubeEyePointCloud::~CCubeEyePointCloud()
+{
+	Release();
+}
+
+void CCubeEyePointCloud::Release()
+{
+	if (m_pBlock != NULL)
+		ceAlignedFree(m_pBlock);
+	if (m_pMask != NULL)
+		ceAlignedFree(m_pMask);
+	m_pBlock = NULL;
+	m_nBlockPoints = 0;
+	m_pMask = NULL;
+	m_nMaskWords = 0;
+	m_pX = m_pY = m_pZ = m_pI = NULL;
+	m_nWidth = 0;
+	m_nHeight = 0;
+	m_bOrganized = false;
+}
+
+void CCubeEyePointCloud::Clear()
+{
+	if (m_pBlock == NULL)
+		m_pX = m_pY = m_pZ = m_pI = NULL;
+	m_nWidth = 0;
+	m_nHeight = 0;
+	m_bOrganized = false;
+}
+
+/*************************************************************************************
+* allocation
+*/
+
+int CCubeEyePointCloud::AllocatePlanes(int nWidth, int nHeight, bool bOrganized, bool bMask)
+{
+	if (nWidth <= 0 || nHeight <= 0)
+		return CE_INVALID_PARAM;
+
+	size_t nPoints = ((size_t)nWidth * nHeight + PLANE_BLOCK - 1) & ~(size_t)(PLANE_BLOCK - 1);
+	if (m_pBlock == NULL || nPoints > m_nBlockPoints) {
+		float *pBlock = (float *)ceAlignedAlloc(nPoints * 4 * sizeof(float));
+		if (pBlock == NULL)
+			return CE_FAILED;
+		if (m_pBlock != NULL)
+			ceAlignedFree(m_pBlock);
+		m_pBlock = pBlock;
+		m_nBlockPoints = nPoints;
+	}
+
+	m_pX = m_pBlock;
+	m_pY = m_pBlock + m_nBlockPoints;
+	m_pZ = m_pBlock + m_nBlockPoints * 2;
+	m_pI = m_pBlock + m_nBlockPoints * 3;
+	m_nWidth = nWidth;
+	m_nHeight = nHeight;
+	m_bOrganized = bOrganized;
+
+	if (bMask)
+		return EnableMask(true);
+	return EnableMask(false);
+}
+
+int CCubeEyePointCloud::Allocate(int nWidth, int nHeight, bool bMask)
+{
+	return AllocatePlanes(nWidth, nHeight, true, bMask);
+}
+
+int CCubeEyePointCloud::AllocateUnorganized(int nCount, bool bMask)
+{
+	return AllocatePlanes(nCount, 1, false, bMask);
+}
+
+int CCubeEyePointCloud::Attach(float *pX, float *pY, float *pZ, float *pI, int nWidth, int nHeight)
+{
+	if (pX == NULL || pY == NULL || pZ == NULL || nWidth <= 0 || nHeight <= 0)
+		return CE_INVALID_PARAM;
+
+	bool bMask = m_pMask != NULL;
+	Release();
+
+	m_pX = pX;
+	m_pY = pY;
+	m_pZ = pZ;
+	m_pI = pI;
+	m_nWidth = nWidth;
+	m_nHeight = nHeight;
+	m_bOrganized = true;
+	return EnableMask(bMask);
+}
+
+int CCubeEyePointCloud::EnableMask(bool bEnable)
+{
+	if (!bEnable) {
+		if (m_pMask != NULL)
+			ceAlignedFree(m_pMask);
+		m_pMask = NULL;
+		m_nMaskWords = 0;
+		return CE_SUCCESS;
+	}
+	if (m_pX == NULL)
+		return CE_NOT_OPENED;
+
+	size_t nWords = MaskWords();
+	if (m_pMask == NULL || nWords > m_nMaskWords) {
+		uint64 *pMask = (uint64 *)ceAlignedAlloc(nWords * sizeof(uint64));
+		if (pMask == NULL)
+			return CE_FAILED;
+		if (m_pMask != NULL)
+			ceAlignedFree(m_pMask);
+		m_pMask = pMask;
+		m_nMaskWords = nWords;
+	}
+
+	//bits past the last point stay 0 so that CountValid can count whole words
+	memset(m_pMask, 0xFF, nWords * sizeof(uint64));
+	size_t nTail = getCount() % CE_CLOUD_MASK_BITS;
+	if (nTail != 0)
+		m_pMask[nWords - 1] = ((uint64)1 << nTail) - 1;
+	return CE_SUCCESS;
+}
+
+/*************************************************************************************
+* point loops : bands of whole mask words, so bands never share a word
+*/
+
+template <class TFunc>
+void CCubeEyePointCloud::ForPoints(const TFunc &func) const
+{
+	size_t nCount = getCount();
+	int nWords = (int)MaskWords();
+	auto band = [&func, nCount](int nWordBegin, int nWordEnd) {
+		size_t nEnd = (size_t)nWordEnd * CE_CLOUD_MASK_BITS;
+		func((size_t)nWordBegin * CE_CLOUD_MASK_BITS, nEnd < nCount ? nEnd : nCount);
+	};
+
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, nWords, CHUNK_GRAIN, band);
+	else
+		band(0, nWords);
+}
+
+int CCubeEyePointCloud::UpdateMask()
+{
+	int nResult = m_pMask == NULL ? EnableMask(true) : CE_SUCCESS;
+	if (nResult != CE_SUCCESS)
+		return nResult;
+
+	const float *pZ = m_pZ;
+	uint64 *pMask = m_pMask;
+	ForPoints([=](size_t nBegin, size_t nEnd) {
+		size_t i = nBegin;
+
+#if defined(CE_USE_AVX2)
+		const __m256 vZero = _mm256_setzero_ps();
+		for (; i + CE_CLOUD_MASK_BITS <= nEnd; i += CE_CLOUD_MASK_BITS) {
+			uint64 nWord = 0;
+			for (int k = 0; k < CE_CLOUD_MASK_BITS; k += 8)
+				nWord |= (uint64)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(pZ + i + k), vZero, _CMP_GT_OQ)) << k;
+			pMask[i / CE_CLOUD_MASK_BITS] = nWord;
+		}
+#endif
+
+		//partial word(last band) or plain C++
+		for (; i < nEnd; i += CE_CLOUD_MASK_BITS) {
+			size_t nWordEnd = i + CE_CLOUD_MASK_BITS < nEnd ? i + CE_CLOUD_MASK_BITS : nEnd;
+			uint64 nWord = 0;
+			for (size_t k = i; k < nWordEnd; k++)
+				nWord |= (uint64)(pZ[k] > 0.0f) << (k - i);
+			pMask[i / CE_CLOUD_MASK_BITS] = nWord;
+		}
+	});
+
+	return CE_SUCCESS;
+}
+
+size_t CCubeEyePointCloud::CountValid() const
+{
+	if (m_pMask == NULL)
+		return getCount();
+
+	size_t nValid = 0;
+	size_t nWords = MaskWords();
+	for (size_t i = 0; i < nWords; i++)
+		nValid += BitCount(m_pMask[i]);
+	return nValid;
+}
+
+/*************************************************************************************
+* views
+*/
+
+ceCloudView CCubeEyePointCloud::View()
+{
+	ceCloudView view;
+	view.pX = m_pX;
+	view.pY = m_pY;
+	view.pZ = m_pZ;
+	view.pI = m_pI;
+	view.pMask = m_pMask;
+	view.nMaskOffset = 0;
+	view.nWidth = m_nWidth;
+	view.nHeight = m_nHeight;
+	view.nStride = m_nWidth;
+	return view;
+}
+
+int CCubeEyePointCloud::Region(int x, int y, int nWidth, int nHeight, ceCloudView &view)
+{
+	if (m_pX == NULL)
+		return CE_NOT_OPENED;
+	if (!m_bOrganized || x < 0 || y < 0 || nWidth <= 0 || nHeight <= 0 || x + nWidth > m_nWidth || y + nHeight > m_nHeight)
+		return CE_INVALID_PARAM;
+
+	size_t nFirst = (size_t)y * m_nWidth + x;
+	view.pX = m_pX + nFirst;
+	view.pY = m_pY + nFirst;
+	view.pZ = m_pZ + nFirst;
+	view.pI = m_pI != NULL ? m_pI + nFirst : NULL;
+	view.pMask = m_pMask;
+	view.nMaskOffset = nFirst;
+	view.nWidth = nWidth;
+	view.nHeight = nHeight;
+	view.nStride = m_nWidth;
+	return CE_SUCCESS;
+}
+
+/*************************************************************************************
+* conversion
+*/
+
+int CCubeEyePointCloud::FromAoS(const cePointCloud *pPoints, int nWidth, int nHeight)
+{
+	if (pPoints == NULL)
+		return CE_INVALID_PARAM;
+
+	int nResult = Allocate(nWidth, nHeight, m_pMask != NULL);
+	if (nResult != CE_SUCCESS)
+		return nResult;
+
+	float *pX = m_pX, *pY = m_pY, *pZ = m_pZ, *pI = m_pI;
+	ForPoints([=](size_t nBegin, size_t nEnd) {
+		size_t i = nBegin;
+
+#if defined(CE_USE_AVX2)
+		for (; i + 8 <= nEnd; i += 8) {
+			const float *pSrc = (const float *)(pPoints + i);
+			__m256 r0 = _mm256_loadu_ps(pSrc);			//p0 p1
+			__m256 r1 = _mm256_loadu_ps(pSrc + 8);		//p2 p3
+			__m256 r2 = _mm256_loadu_ps(pSrc + 16);		//p4 p5
+			__m256 r3 = _mm256_loadu_ps(pSrc + 24);		//p6 p7
+
+			//lane k of p0..p3 holds points k * 4 + 0..3
+			__m256 p0 = _mm256_permute2f128_ps(r0, r2, 0x20);
+			__m256 p1 = _mm256_permute2f128_ps(r0, r2, 0x31);
+			__m256 p2 = _mm256_permute2f128_ps(r1, r3, 0x20);
+			__m256 p3 = _mm256_permute2f128_ps(r1, r3, 0x31);
+
+			__m256 xy01 = _mm256_unpacklo_ps(p0, p1);
+			__m256 zi01 = _mm256_unpackhi_ps(p0, p1);
+			__m256 xy23 = _mm256_unpacklo_ps(p2, p3);
+			__m256 zi23 = _mm256_unpackhi_ps(p2, p3);
+			_mm256_storeu_ps(pX + i, _mm256_shuffle_ps(xy01, xy23, 0x44));
+			_mm256_storeu_ps(pY + i, _mm256_shuffle_ps(xy01, xy23, 0xEE));
+			_mm256_storeu_ps(pZ + i, _mm256_shuffle_ps(zi01, zi23, 0x44));
+			_mm256_storeu_ps(pI + i, _mm256_shuffle_ps(zi01, zi23, 0xEE));
+		}
+#elif defined(CE_USE_NEON)
+		for (; i + 4 <= nEnd; i += 4) {
+			float32x4x4_t p = vld4q_f32((const float *)(pPoints + i));
+			vst1q_f32(pX + i, p.val[0]);
+			vst1q_f32(pY + i, p.val[1]);
+			vst1q_f32(pZ + i, p.val[2]);
+			vst1q_f32(pI + i, p.val[3]);
+		}
+#endif
+
+		for (; i < nEnd; i++) {
+			pX[i] = pPoints[i].fX;
+			pY[i] = pPoints[i].fY;
+			pZ[i] = pPoints[i].fZ;
+			pI[i] = pPoints[i].fI;
+		}
+	});
+
+	return CE_SUCCESS;
+}
+
+int CCubeEyePointCloud::ToAoS(cePointCloud *pPoints) const
+{
+	if (m_pX == NULL)
+		return CE_NOT_OPENED;
+	if (pPoints == NULL)
+		return CE_INVALID_PARAM;
+
+	const float *pX = m_pX, *pY = m_pY, *pZ = m_pZ, *pI = m_pI;
+	ForPoints([=](size_t nBegin, size_t nEnd) {
+		size_t i = nBegin;
+
+#if defined(CE_USE_AVX2)
+		for (; i + 8 <= nEnd; i += 8) {
+			__m256 x = _mm256_loadu_ps(pX + i);
+			__m256 y = _mm256_loadu_ps(pY + i);
+			__m256 z = _mm256_loadu_ps(pZ + i);
+			__m256 ir = pI ? _mm256_loadu_ps(pI + i) : _mm256_setzero_ps();
+
+			__m256 xy0 = _mm256_unpacklo_ps(x, y);
+			__m256 xy1 = _mm256_unpackhi_ps(x, y);
+			__m256 zi0 = _mm256_unpacklo_ps(z, ir);
+			__m256 zi1 = _mm256_unpackhi_ps(z, ir);
+			__m256 p04 = _mm256_shuffle_ps(xy0, zi0, 0x44);
+			__m256 p15 = _mm256_shuffle_ps(xy0, zi0, 0xEE);
+			__m256 p26 = _mm256_shuffle_ps(xy1, zi1, 0x44);
+			__m256 p37 = _mm256_shuffle_ps(xy1, zi1, 0xEE);
+
+			float *pDst = (float *)(pPoints + i);
+			_mm256_storeu_ps(pDst, _mm256_permute2f128_ps(p04, p15, 0x20));
+			_mm256_storeu_ps(pDst + 8, _mm256_permute2f128_ps(p26, p37, 0x20));
+			_mm256_storeu_ps(pDst + 16, _mm256_permute2f128_ps(p04, p15, 0x31));
+			_mm256_storeu_ps(pDst + 24, _mm256_permute2f128_ps(p26, p37, 0x31));
+		}
+#elif defined(CE_USE_NEON)
+		for (; i + 4 <= nEnd; i += 4) {
+			float32x4x4_t p;
+			p.val[0] = vld1q_f32(pX + i);
+			p.val[1] = vld1q_f32(pY + i);
+			p.val[2] = vld1q_f32(pZ + i);
+			p.val[3] = pI ? vld1q_f32(pI + i) : vdupq_n_f32(0.0f);
+			vst4q_f32((float *)(pPoints + i), p);
+		}
+#endif
+
+		for (; i < nEnd; i++) {
+			pPoints[i].fX = pX[i];
+			pPoints[i].fY = pY[i];
+			pPoints[i].fZ = pZ[i];
+			pPoints[i].fI = pI ? pI[i] : 0.0f;
+		}
+	});
+
+	return CE_SUCCESS;
+}
+
+/*************************************************************************************
+* kernels
+*/
+
+int CCubeEyePointCloud::Transform(const float *pMatrix)
+{
+	if (m_pX == NULL)
+		return CE_NOT_OPENED;
+	if (pMatrix == NULL)
+		return CE_INVALID_PARAM;
+
+	float m[12];
+	memcpy(m, pMatrix, sizeof(m));
+	float *pX = m_pX, *pY = m_pY, *pZ = m_pZ;
+
+	ForPoints([=](size_t nBegin, size_t nEnd) {
+		size_t i = nBegin;
+
+#if defined(CE_USE_AVX2)
+		__m256 r[12];
+		for (int k = 0; k < 12; k++)
+			r[k] = _mm256_set1_ps(m[k]);
+		for (; i + 8 <= nEnd; i += 8) {
+			__m256 x = _mm256_loadu_ps(pX + i);
+			__m256 y = _mm256_loadu_ps(pY + i);
+			__m256 z = _mm256_loadu_ps(pZ + i);
+			_mm256_storeu_ps(pX + i, _mm256_fmadd_ps(r[0], x, _mm256_fmadd_ps(r[1], y, _mm256_fmadd_ps(r[2], z, r[3]))));
+			_mm256_storeu_ps(pY + i, _mm256_fmadd_ps(r[4], x, _mm256_fmadd_ps(r[5], y, _mm256_fmadd_ps(r[6], z, r[7]))));
+			_mm256_storeu_ps(pZ + i, _mm256_fmadd_ps(r[8], x, _mm256_fmadd_ps(r[9], y, _mm256_fmadd_ps(r[10], z, r[11]))));
+		}
+#elif defined(CE_USE_NEON)
+		for (; i + 4 <= nEnd; i += 4) {
+			float32x4_t x = vld1q_f32(pX + i);
+			float32x4_t y = vld1q_f32(pY + i);
+			float32x4_t z = vld1q_f32(pZ + i);
+			vst1q_f32(pX + i, vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(m[3]), x, m[0]), y, m[1]), z, m[2]));
+			vst1q_f32(pY + i, vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(m[7]), x, m[4]), y, m[5]), z, m[6]));
+			vst1q_f32(pZ + i, vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(m[11]), x, m[8]), y, m[9]), z, m[10]));
+		}
+#endif
+
+		for (; i < nEnd; i++) {
+			float x = pX[i], y = pY[i], z = pZ[i];
+			pX[i] = m[0] * x + m[1] * y + m[2] * z + m[3];
+			pY[i] = m[4] * x + m[5] * y + m[6] * z + m[7];
+			pZ[i] = m[8] * x + m[9] * y + m[10] * z + m[11];
+		}
+	});
+
+	return CE_SUCCESS;
+}
+
+}
@@ -0,0 +1,273 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyePointCloud.h												*/
+/*																			*/
+/* @brief	Structure of arrays point cloud container						*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeThreadPool.h"
+
+namespace CUBE_EYE
+{
+
+///Points per validity mask word
+#define CE_CLOUD_MASK_BITS	64
+
+/**
+*
+*@brief		Point cloud view
+*@details	Zero-copy window over the planes of a CCubeEyePointCloud(or of external planes).
+			Point (x, y) is at index y * nStride + x of every plane; pI and pMask may be NULL.
+			Its validity is bit (nMaskOffset + y * nStride + x) of pMask.
+*
+*/
+typedef struct _ceCloudView
+{
+	float *pX;
+	float *pY;
+	float *pZ;
+	float *pI;
+	const uint64 *pMask;
+	size_t nMaskOffset;
+	int nWidth;
+	int nHeight;
+	size_t nStride;
+
+} ceCloudView;
+
+///Validity of point (x, y) of a view(always valid without a mask)
+inline bool ceCloudViewValid(const ceCloudView &view, int x, int y)
+{
+	if (view.pMask == NULL)
+		return true;
+	size_t nBit = view.nMaskOffset + (size_t)y * view.nStride + x;
+	return ((view.pMask[nBit / CE_CLOUD_MASK_BITS] >> (nBit % CE_CLOUD_MASK_BITS)) & 1) != 0;
+}
+
+/**
+*
+*@brief		SoA point cloud
+*@details	Separate X / Y / Z / I planes(unit; m, I = IR value), each aligned to CE_SIMD_ALIGN
+			and padded to a whole SIMD block, plus an optional validity bitmask(1 bit per point).
+			An organized cloud keeps the frame layout(nWidth x nHeight, point = y * nWidth + x);
+			an unorganized one is nCount x 1.
+			Attach wraps planes owned by someone else(CCubeEyeDepthToPCL planar output,
+			CCubeEyePipeline buffers) without copying.
+*
+*/
+class CCubeEyePointCloud {
+
+public:
+
+	CCubeEyePointCloud();
+	~CCubeEyePointCloud();
+
+	/**
+	*
+	* @brief	Allocate
+	* @details	Organized nWidth x nHeight cloud. The memory is kept when the size does not grow.
+				Contents are undefined afterwards.
+	* @param	bMask - allocate the validity mask.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Allocate(int nWidth, int nHeight, bool bMask = false);
+
+	/**
+	*
+	* @brief	Allocate unorganized
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int AllocateUnorganized(int nCount, bool bMask = false);
+
+	/**
+	*
+	* @brief	Attach external planes
+	* @details	pI may be NULL. The planes are not freed and must outlive the cloud; the mask
+				can still be enabled(it is owned by the cloud).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Attach(float *pX, float *pY, float *pZ, float *pI, int nWidth, int nHeight);
+
+	void Release();
+
+	/**
+	*
+	* @brief	Clear
+	* @details	Empty unorganized cloud(getCount() = 0). The memory is kept for the next
+				Allocate; attached planes are dropped.
+	* @return	void
+	*
+	*/
+	void Clear();
+
+	/**
+	*
+	* @brief	Set thread pool
+	* @details	NULL : single threaded. Default is CCubeEyeThreadPool::Default().
+	* @return	void
+	*
+	*/
+	void SetThreadPool(CCubeEyeThreadPool *pPool) { m_pPool = pPool; }
+
+	/*************************************************************************************
+	* \defgroup Access
+	* @{
+	*/
+
+	int getWidth() const { return m_nWidth; }
+	int getHeight() const { return m_nHeight; }
+	size_t getCount() const { return (size_t)m_nWidth * m_nHeight; }
+	bool IsOrganized() const { return m_bOrganized; }
+
+	float *getX() { return m_pX; }
+	float *getY() { return m_pY; }
+	float *getZ() { return m_pZ; }
+	float *getI() { return m_pI; }
+	const float *getX() const { return m_pX; }
+	const float *getY() const { return m_pY; }
+	const float *getZ() const { return m_pZ; }
+	const float *getI() const { return m_pI; }
+
+	/**@}*/
+
+	/*************************************************************************************
+	* \defgroup Validity mask
+	* @{
+	*/
+
+	/**
+	*
+	* @brief	Enable / disable mask
+	* @details	A new mask marks every point valid.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int EnableMask(bool bEnable);
+
+	bool HasMask() const { return m_pMask != NULL; }
+	uint64 *getMask() { return m_pMask; }
+	const uint64 *getMask() const { return m_pMask; }
+
+	bool IsValid(size_t nIndex) const
+	{
+		return m_pMask == NULL || ((m_pMask[nIndex / CE_CLOUD_MASK_BITS] >> (nIndex % CE_CLOUD_MASK_BITS)) & 1) != 0;
+	}
+
+	void SetValid(size_t nIndex, bool bValid)
+	{
+		uint64 nBit = (uint64)1 << (nIndex % CE_CLOUD_MASK_BITS);
+		if (bValid)
+			m_pMask[nIndex / CE_CLOUD_MASK_BITS] |= nBit;
+		else
+			m_pMask[nIndex / CE_CLOUD_MASK_BITS] &= ~nBit;
+	}
+
+	/**
+	*
+	* @brief	Update mask from Z
+	* @details	Valid = Z > 0. Enables the mask if needed.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int UpdateMask();
+
+	/**
+	*
+	* @brief	Count valid points
+	* @return	number of valid points(every point without a mask)
+	*
+	*/
+	size_t CountValid() const;
+
+	/**@}*/
+
+	/*************************************************************************************
+	* \defgroup Views
+	* @{
+	*/
+
+	///Whole cloud
+	ceCloudView View();
+
+	/**
+	*
+	* @brief	Region view
+	* @details	nWidth x nHeight points from (x, y) of an organized cloud, no copy.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Region(int x, int y, int nWidth, int nHeight, ceCloudView &view);
+
+	/**@}*/
+
+	/*************************************************************************************
+	* \defgroup Conversion / kernels
+	* @{
+	*/
+
+	/**
+	*
+	* @brief	From cePointCloud array
+	* @details	Allocates an organized nWidth x nHeight cloud(keeping the mask state) and
+				deinterleaves pPoints into it.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int FromAoS(const cePointCloud *pPoints, int nWidth, int nHeight);
+
+	/**
+	*
+	* @brief	To cePointCloud array
+	* @details	pPoints holds getCount() points. Without I, fI = 0.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int ToAoS(cePointCloud *pPoints) const;
+
+	/**
+	*
+	* @brief	Rigid / affine transform in place
+	* @details	p' = R p + t with pMatrix a row-major 3 x 4 matrix [R | t]. Every point is
+				transformed; validity stays in the mask(call UpdateMask first when the cloud
+				uses Z = 0 for invalid points).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Transform(const float *pMatrix);
+
+	/**@}*/
+
+private:
+
+	CCubeEyePointCloud(const CCubeEyePointCloud &);
+	CCubeEyePointCloud &operator=(const CCubeEyePointCloud &);
+
+	int AllocatePlanes(int nWidth, int nHeight, bool bOrganized, bool bMask);
+	size_t MaskWords() const { return (getCount() + CE_CLOUD_MASK_BITS - 1) / CE_CLOUD_MASK_BITS; }
+	template <class TFunc>
+	void ForPoints(const TFunc &func) const;
+
+	int m_nWidth;
+	int m_nHeight;
+	bool m_bOrganized;
+	CCubeEyeThreadPool *m_pPool;
+
+	float *m_pBlock;				//owned planes : X, Y, Z, I of m_nBlockPoints floats each
+	size_t m_nBlockPoints;			//capacity of m_pBlock per plane
+	uint64 *m_pMask;
+	size_t m_nMaskWords;			//capacity of m_pMask
+
+	float *m_pX;
+	float *m_pY;
+	float *m_pZ;
+	float *m_pI;
+};
+
+}
@@ -0,0 +1,232 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeRateGovernor.cpp											*/
+/*																			*/
+/* @brief	Backlog driven frame rate governor								*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeRateGovernor.h"
+
+namespace CUBE_EYE
+{
+
+//device frame rate of every level, fastest first
+static const uint8 s_nLevelRate[CE_GOVERNOR_LEVELS] = { FPS_30, FPS_15, FPS_8 };
+
+//FPS_8 is really 7.5 fps
+static float RateFps(uint8 nFrameRate)
+{
+	return nFrameRate == FPS_8 ? 7.5f : (float)nFrameRate;
+}
+
+static int RateLevel(float fFps)
+{
+	int nLevel = 0;
+	while (nLevel < CE_GOVERNOR_LEVELS - 1 && fFps < RateFps(s_nLevelRate[nLevel]) * 0.75f)
+		nLevel++;
+	return nLevel;
+}
+
+CCubeEyeRateGovernor::CCubeEyeRateGovernor()
+	: m_stConfig(DefaultConfig()), m_pTelemetry(NULL), m_nFrameRate(FPS_30), m_nDecimation(1), m_bHostFallback(false),
+	m_nMinLevel(0), m_nAdmitCount(0), m_bSmoothed(false), m_fProcessUs(0.0f), m_fQueueDepth(0.0f), m_fLoad(0.0f),
+	m_nBehind(0), m_nKeepUp(0), m_nNextChange(0)
+{
+}
+
+CCubeEyeRateGovernor::~CCubeEyeRateGovernor()
+{
+}
+
+ceGovernorConfig CCubeEyeRateGovernor::DefaultConfig()
+{
+	ceGovernorConfig stConfig;
+	stConfig.eMode = Governor_Auto;
+	stConfig.fHighQueue = 2.0f;
+	stConfig.fLowQueue = 0.5f;
+	stConfig.fHighLoad = 0.9f;
+	stConfig.fLowLoad = 0.7f;
+	stConfig.fSmoothing = 0.1f;
+	stConfig.nDownFrames = 8;
+	stConfig.nUpFrames = 60;
+	stConfig.nDwellMs = 1000;
+	stConfig.nMaxSwitchUs = 20000;
+	return stConfig;
+}
+
+int CCubeEyeRateGovernor::SetConfig(const ceGovernorConfig &stConfig)
+{
+	if (stConfig.eMode != Governor_Device && stConfig.eMode != Governor_Host && stConfig.eMode != Governor_Auto)
+		return CE_INVALID_PARAM;
+	if (stConfig.fLowQueue < 0.0f || stConfig.fHighQueue < stConfig.fLowQueue)
+		return CE_INVALID_PARAM;
+	if (stConfig.fLowLoad <= 0.0f || stConfig.fHighLoad < stConfig.fLowLoad)
+		return CE_INVALID_PARAM;
+	if (!(stConfig.fSmoothing > 0.0f && stConfig.fSmoothing <= 1.0f) || stConfig.nDownFrames < 1 || stConfig.nUpFrames < 1)
+		return CE_INVALID_PARAM;
+
+	m_stConfig = stConfig;
+	m_nMinLevel = (m_stConfig.eMode == Governor_Host || !m_setRateFunc) ? RateLevel(RateFps(getFrameRate())) : 0;
+	m_bSmoothed = false;
+	m_nBehind = 0;
+	m_nKeepUp = 0;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeRateGovernor::SetDevice(SetRateFunc setRateFunc, uint8 nFrameRate)
+{
+	if (nFrameRate != FPS_30 && nFrameRate != FPS_15 && nFrameRate != FPS_8)
+		return CE_INVALID_PARAM;
+
+	m_setRateFunc = setRateFunc;
+	m_nFrameRate.store(nFrameRate, std::memory_order_relaxed);
+	m_nDecimation.store(1, std::memory_order_relaxed);
+	m_bHostFallback.store(false, std::memory_order_relaxed);
+	m_nMinLevel = (m_stConfig.eMode == Governor_Host || !m_setRateFunc) ? RateLevel(RateFps(nFrameRate)) : 0;
+	m_nAdmitCount = 0;
+	m_bSmoothed = false;
+	m_fQueueDepth.store(0.0f, std::memory_order_relaxed);
+	m_fLoad.store(0.0f, std::memory_order_relaxed);
+	m_nBehind = 0;
+	m_nKeepUp = 0;
+	m_nNextChange = 0;
+	return CE_SUCCESS;
+}
+
+float CCubeEyeRateGovernor::getDeliveredRate() const
+{
+	return RateFps(getFrameRate()) / getDecimation();
+}
+
+int CCubeEyeRateGovernor::Level() const
+{
+	return RateLevel(getDeliveredRate());
+}
+
+bool CCubeEyeRateGovernor::Admit()
+{
+	return (m_nAdmitCount++ % (uint64)getDecimation()) == 0;
+}
+
+int CCubeEyeRateGovernor::Update(const CCubeEyeFrameRing &ring, const CCubeEyeFrameRing::CFrameRef &frame, uint32 nProcessUs)
+{
+	if (!frame.IsValid())
+		return CE_INVALID_PARAM;
+
+	uint64 nPublished = ring.getPublishedCount();
+	uint64 nSeq = frame.getSequence();
+	int nQueueDepth = nPublished > nSeq ? (int)(nPublished - nSeq) : 0;
+	return Update(frame.getFrameInfo(), nQueueDepth, nProcessUs);
+}
+
+int CCubeEyeRateGovernor::Update(const ceFrameInfo &stFrameInfo, int nQueueDepth, uint32 nProcessUs)
+{
+	if (nQueueDepth < 0)
+		nQueueDepth = 0;
+
+	float fQueueDepth;
+	if (!m_bSmoothed) {
+		m_fProcessUs = (float)nProcessUs;
+		fQueueDepth = (float)nQueueDepth;
+		m_bSmoothed = true;
+	}
+	else {
+		float fAlpha = m_stConfig.fSmoothing;
+		m_fProcessUs += fAlpha * ((float)nProcessUs - m_fProcessUs);
+		fQueueDepth = getQueueDepth() + fAlpha * ((float)nQueueDepth - getQueueDepth());
+	}
+
+	float fRate = getDeliveredRate();
+	float fLoad = m_fProcessUs * fRate * 1e-6f;
+	m_fQueueDepth.store(fQueueDepth, std::memory_order_relaxed);
+	m_fLoad.store(fLoad, std::memory_order_relaxed);
+
+	int nLevel = Level();
+	bool bBehind = fQueueDepth > m_stConfig.fHighQueue || fLoad > m_stConfig.fHighLoad;
+	bool bKeepUp = false;
+	if (nLevel > m_nMinLevel) {
+		//load the next faster step would give
+		float fFaster = RateFps(s_nLevelRate[nLevel - 1]);
+		bKeepUp = fQueueDepth <= m_stConfig.fLowQueue && fLoad * fFaster / fRate < m_stConfig.fLowLoad;
+	}
+	m_nBehind = bBehind ? m_nBehind + 1 : 0;
+	m_nKeepUp = bKeepUp ? m_nKeepUp + 1 : 0;
+
+	TimeStampType nNow = ceHostTimeStamp();
+	if (nNow < m_nNextChange)
+		return CE_SUCCESS;
+
+	if (m_nBehind >= m_stConfig.nDownFrames && nLevel < CE_GOVERNOR_LEVELS - 1)
+		return Change(stFrameInfo, nLevel + 1, nNow);
+	if (m_nKeepUp >= m_stConfig.nUpFrames)
+		return Change(stFrameInfo, nLevel - 1, nNow);
+	return CE_SUCCESS;
+}
+
+int CCubeEyeRateGovernor::Change(const ceFrameInfo &stFrameInfo, int nLevel, TimeStampType nNow)
+{
+	uint8 nFrameRate = getFrameRate();
+	float fDevice = RateFps(nFrameRate);
+	float fTarget = RateFps(s_nLevelRate[nLevel]);
+
+	ceRateDecision stDecision;
+	stDecision.nTimeStamp = nNow;
+	stDecision.nFrameID = stFrameInfo.nFrameID;
+	stDecision.nFrameRateFrom = nFrameRate;
+	stDecision.nDecimationFrom = (uint8)getDecimation();
+	stDecision.fQueueDepth = getQueueDepth();
+	stDecision.fLoad = getLoad();
+	stDecision.nSwitchUs = 0;
+	stDecision.nResult = CE_SUCCESS;
+
+	//host decimation can only go down from the device rate
+	bool bHost = !m_setRateFunc || m_stConfig.eMode == Governor_Host
+		|| (m_stConfig.eMode == Governor_Auto && IsHostFallback());
+	if (bHost && fTarget > fDevice)
+		bHost = false;
+
+	int nResult = CE_SUCCESS;
+	if (!bHost) {
+		TimeStampType nStart = ceHostTimeStamp();
+		stDecision.nResult = m_setRateFunc(s_nLevelRate[nLevel]);
+		TimeStampType nEnd = ceHostTimeStamp();
+		stDecision.nSwitchUs = nEnd > nStart ? (uint32)(nEnd - nStart) : 0;
+
+		if (stDecision.nResult == CE_SUCCESS) {
+			m_nFrameRate.store(s_nLevelRate[nLevel], std::memory_order_relaxed);
+			m_nDecimation.store(1, std::memory_order_relaxed);
+		}
+
+		if (m_stConfig.eMode == Governor_Auto
+			&& (stDecision.nResult != CE_SUCCESS || stDecision.nSwitchUs > m_stConfig.nMaxSwitchUs))
+			m_bHostFallback.store(true, std::memory_order_relaxed);
+
+		//a failed slower step is still taken on the host in auto mode
+		if (stDecision.nResult != CE_SUCCESS) {
+			if (IsHostFallback() && fTarget < fDevice)
+				bHost = true;
+			else
+				nResult = stDecision.nResult;
+		}
+	}
+	if (bHost) {
+		int nDecimation = (int)(RateFps(getFrameRate()) / fTarget + 0.5f);
+		m_nDecimation.store(nDecimation > 1 ? nDecimation : 1, std::memory_order_relaxed);
+	}
+
+	stDecision.nFrameRateTo = getFrameRate();
+	stDecision.nDecimationTo = (uint8)getDecimation();
+	if (m_pTelemetry != NULL)
+		m_pTelemetry->RecordDecision(stDecision);
+
+	m_nAdmitCount = 0;
+	m_nBehind = 0;
+	m_nKeepUp = 0;
+	m_nNextChange = nNow + (TimeStampType)m_stConfig.nDwellMs * 1000;
+	return nResult;
+}
+
+}
@@ -0,0 +1,216 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeRateGovernor.h											*/
+/*																			*/
+/* @brief	Backlog driven frame rate governor								*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeFrameRing.h"
+#include "CubeEyeTelemetry.h"
+
+namespace CUBE_EYE
+{
+
+///Frame rate steps of the governor : FPS_30, FPS_15, FPS_8(7.5 fps)
+#define CE_GOVERNOR_LEVELS		3
+
+///How the governor lowers the delivered frame rate
+enum governor_mode {
+	///Switch the device frame rate(setFrameRate)
+	Governor_Device = 0,
+	///Keep the device frame rate and skip frames on the host(Admit)
+	Governor_Host,
+	///Device while setFrameRate is cheap; host once a switch failed or took longer than nMaxSwitchUs
+	Governor_Auto
+};
+
+///Governor configuration
+typedef struct _ceGovernorConfig
+{
+	governor_mode eMode;
+	///Smoothed queue depth above which the consumer is behind / at or below which it keeps up(unit; frames)
+	float fHighQueue;
+	float fLowQueue;
+	///Smoothed processing time / frame period above which the consumer is behind
+	float fHighLoad;
+	///The next faster step is taken once the load it would give stays below this
+	float fLowLoad;
+	///Weight of the newest frame in the smoothed queue depth and processing time(0 ~ 1]
+	float fSmoothing;
+	///Consecutive frames behind before a slower step / keeping up before a faster step
+	int nDownFrames;
+	int nUpFrames;
+	///Time after a change before the next one(unit; ms), lets the queue settle
+	uint32 nDwellMs;
+	///Governor_Auto : setFrameRate duration from which switching counts as too expensive(unit; us)
+	uint32 nMaxSwitchUs;
+
+} ceGovernorConfig;
+
+/**
+*
+*@brief		Backlog driven frame rate governor
+*@details	Keeps a slow consumer from silently piling up latency. After every processed frame
+			the consumer reports its queue depth(frames waiting behind this one) and processing
+			time; both are smoothed, the load is processing time / frame period of the rate the
+			consumer is fed at. A consumer that stays behind(queue above fHighQueue or load above
+			fHighLoad) for nDownFrames frames gets the next slower step of 30 / 15 / 7.5 fps; one
+			that keeps up for nUpFrames frames(queue at most fLowQueue and the load at the
+			faster rate below fLowLoad) gets the next faster step. The gap between the
+			thresholds, the frame counts and nDwellMs after each change are the hysteresis.
+
+			A step is taken on the device with setFrameRate(less data on the bus) or, when that
+			is too expensive - a stream restart, a dropped frame burst - by host decimation :
+			Admit then passes every 2nd / 4th frame. Every change is recorded in the
+			telemetry with its inputs and the setFrameRate duration, for tuning the thresholds.
+
+			Update, Admit and the device calls belong to the consumer thread; the getters may be
+			called from any thread.
+*
+*/
+class CCubeEyeRateGovernor {
+
+public:
+
+	///Device frame rate control, same signature as CCubeEye::setFrameRate
+	typedef std::function<int(uint8 nFrameRate)> SetRateFunc;
+
+	CCubeEyeRateGovernor();
+	~CCubeEyeRateGovernor();
+
+	/**
+	*
+	* @brief	Default configuration
+	* @details	Auto mode, queue 2 / 0.5 frames, load 0.9 / 0.7, smoothing 0.1, 8 frames down,
+				60 frames up, 1 s dwell, 20 ms switch limit.
+	* @return	configuration
+	*
+	*/
+	static ceGovernorConfig DefaultConfig();
+
+	/**
+	*
+	* @brief	Set configuration
+	* @details	Keeps the current rate, restarts the smoothing.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetConfig(const ceGovernorConfig &stConfig);
+	const ceGovernorConfig &GetConfig() const { return m_stConfig; }
+
+	/**
+	*
+	* @brief	Set device
+	* @details	Resets the governor to nFrameRate without decimation. Governor_Host never goes
+				faster than nFrameRate. NULL setRateFunc : host decimation only.
+	* @param	setRateFunc - device frame rate control.
+	* @param	nFrameRate - current device frame rate(FPS_30, FPS_15, FPS_8).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetDevice(SetRateFunc setRateFunc, uint8 nFrameRate);
+
+	/**
+	*
+	* @brief	Set device
+	* @details	Any connected device exposing setFrameRate / getFrameRate(CCubeEye, CCubeEyeSim).
+				It must outlive the governor.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	template <class TDevice>
+	int SetDevice(TDevice &device)
+	{
+		uint8 nFrameRate = FPS_30;
+		if (device.getFrameRate(nFrameRate) != CE_SUCCESS)
+			return CE_FAILED;
+
+		TDevice *pDevice = &device;
+		return SetDevice([pDevice](uint8 nRate) { return pDevice->setFrameRate(nRate); }, nFrameRate);
+	}
+
+	/**
+	*
+	* @brief	Set telemetry
+	* @details	Every change is recorded with RecordDecision. NULL : none.
+	* @return	void
+	*
+	*/
+	void SetTelemetry(CCubeEyeTelemetry *pTelemetry) { m_pTelemetry = pTelemetry; }
+
+	/**
+	*
+	* @brief	Host decimation
+	* @details	Call for every frame taken from the queue; a skipped frame is released without
+				processing and not passed to Update.
+	* @return	true : process the frame | false : skip it
+	*
+	*/
+	bool Admit();
+
+	/**
+	*
+	* @brief	Frame processed
+	* @details	Smooths the inputs and changes the rate when the hysteresis allows it.
+	* @param	stFrameInfo - processed frame.
+	* @param	nQueueDepth - frames waiting for the consumer behind this one.
+	* @param	nProcessUs - processing time of the frame(unit; us) : the sum of the stages run
+				one after another, the slowest of stages running in parallel.
+	* @return	Success(0)|Error Code(< 0) - the setFrameRate error of a failed change
+	*
+	*/
+	int Update(const ceFrameInfo &stFrameInfo, int nQueueDepth, uint32 nProcessUs);
+
+	/**
+	*
+	* @brief	Frame processed
+	* @details	Queue depth of a CCubeEyeFrameRing consumer : frames published after frame.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Update(const CCubeEyeFrameRing &ring, const CCubeEyeFrameRing::CFrameRef &frame, uint32 nProcessUs);
+
+	///Device frame rate(FPS_30, FPS_15, FPS_8)
+	uint8 getFrameRate() const { return m_nFrameRate.load(std::memory_order_relaxed); }
+	///Host decimation, 1 : every frame
+	int getDecimation() const { return m_nDecimation.load(std::memory_order_relaxed); }
+	///Frame rate delivered to the consumer(unit; fps)
+	float getDeliveredRate() const;
+	///Smoothed inputs of the last Update
+	float getQueueDepth() const { return m_fQueueDepth.load(std::memory_order_relaxed); }
+	float getLoad() const { return m_fLoad.load(std::memory_order_relaxed); }
+	///Governor_Auto fell back to host decimation
+	bool IsHostFallback() const { return m_bHostFallback.load(std::memory_order_relaxed); }
+
+private:
+
+	CCubeEyeRateGovernor(const CCubeEyeRateGovernor &);
+	CCubeEyeRateGovernor &operator=(const CCubeEyeRateGovernor &);
+
+	int Level() const;
+	int Change(const ceFrameInfo &stFrameInfo, int nLevel, TimeStampType nNow);
+
+	ceGovernorConfig m_stConfig;
+	SetRateFunc m_setRateFunc;
+	CCubeEyeTelemetry *m_pTelemetry;
+
+	std::atomic<uint8> m_nFrameRate;
+	std::atomic<int> m_nDecimation;
+	std::atomic<bool> m_bHostFallback;
+	int m_nMinLevel;						//fastest level host decimation reaches(Governor_Host)
+	uint64 m_nAdmitCount;
+
+	bool m_bSmoothed;						//false : the next Update starts the smoothing
+	float m_fProcessUs;
+	std::atomic<float> m_fQueueDepth;
+	std::atomic<float> m_fLoad;
+	int m_nBehind;							//consecutive frames behind / keeping up
+	int m_nKeepUp;
+	TimeStampType m_nNextChange;			//no change before(host time, unit; us)
+};
+
+}
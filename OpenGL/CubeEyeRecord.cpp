@@ -0,0 +1,652 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeRecord.cpp												*/
+/*																			*/
+/* @brief	Indexed Depth/IR recording container(writer / mapped reader)	*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeRecord.h"
+
+#include <algorithm>
+
+namespace CUBE_EYE
+{
+
+static const char s_szRecMagic[8] = { 'C', 'E', 'R', 'E', 'C', 0, 0, 0 };
+
+static inline size_t RecAlign(size_t nSize)
+{
+	return (nSize + CE_REC_ALIGN - 1) & ~(size_t)(CE_REC_ALIGN - 1);
+}
+
+void ceRecPackFrameInfo(const ceFrameInfo &stInfo, ceRecFrameInfo &stRecInfo)
+{
+	memset(&stRecInfo, 0, sizeof(stRecInfo));
+	stRecInfo.nFrameType = stInfo.nFrameType;
+	stRecInfo.nWidth = stInfo.nWidth;
+	stRecInfo.nHeight = stInfo.nHeight;
+	stRecInfo.nFrameID = stInfo.nFrameID;
+	stRecInfo.nTimeStamp = stInfo.nTimeStamp;
+	stRecInfo.fSensorTemp = stInfo.fSensorTemp;
+	stRecInfo.fLDTemp = stInfo.fLDTemp;
+	stRecInfo.fIntegrationTime = stInfo.fIntegrationTime;
+	memcpy(stRecInfo.nEmbeddedLine, stInfo.nEmbeddedLine, sizeof(stRecInfo.nEmbeddedLine));
+}
+
+void ceRecUnpackFrameInfo(const ceRecFrameInfo &stRecInfo, ceFrameInfo &stInfo)
+{
+	stInfo.nFrameType = stRecInfo.nFrameType;
+	stInfo.nWidth = stRecInfo.nWidth;
+	stInfo.nHeight = stRecInfo.nHeight;
+	stInfo.nFrameID = (long)stRecInfo.nFrameID;
+	stInfo.nTimeStamp = stRecInfo.nTimeStamp;
+	stInfo.fSensorTemp = stRecInfo.fSensorTemp;
+	stInfo.fLDTemp = stRecInfo.fLDTemp;
+	stInfo.fIntegrationTime = stRecInfo.fIntegrationTime;
+	memcpy(stInfo.nEmbeddedLine, stRecInfo.nEmbeddedLine, sizeof(stInfo.nEmbeddedLine));
+}
+
+/*************************************************************************************
+* CCubeEyeRecorder
+*/
+
+CCubeEyeRecorder::CCubeEyeRecorder()
+	: m_pFile(NULL), m_nWidth(0), m_nHeight(0), m_nBlockSize(0), m_nOffset(0),
+	m_bDevice(false), m_nCodec(Codec_Raw), m_nKeyFrameInterval(0), m_nSinceKeyFrame(0), m_bPrevIR(false),
+	m_pCurrent(NULL), m_bStop(false), m_bWriteError(false)
+{
+}
+
+CCubeEyeRecorder::~CCubeEyeRecorder()
+{
+	Close();
+}
+
+int CCubeEyeRecorder::Open(const char *szPath, int nWidth, int nHeight, size_t nBlockSize, int nBlockCount)
+{
+	if (szPath == NULL || nWidth <= 0 || nHeight <= 0 || nBlockCount < 2)
+		return CE_INVALID_PARAM;
+	if (m_pFile != NULL)
+		return CE_FAILED;
+
+	//compressed planes larger than raw are stored raw, so raw is also the compressed worst case
+	size_t nMaxChunk = RecAlign(sizeof(ceRecChunkHeader) + (size_t)nWidth * nHeight * sizeof(uint16) * 2);
+	if (nBlockSize < nMaxChunk + sizeof(ceRecFileHeader) + sizeof(ceRecDeviceBlock))
+		nBlockSize = nMaxChunk + sizeof(ceRecFileHeader) + sizeof(ceRecDeviceBlock);
+
+	m_pFile = fopen(szPath, "wb");
+	if (m_pFile == NULL)
+		return CE_OPEN_FAILED;
+	//the writer thread already writes in large blocks
+	setvbuf(m_pFile, NULL, _IONBF, 0);
+
+	m_nWidth = nWidth;
+	m_nHeight = nHeight;
+	m_nBlockSize = nBlockSize;
+	m_nOffset = 0;
+	m_bStop = false;
+	m_bWriteError = false;
+	m_nSinceKeyFrame = 0;
+	m_bPrevIR = false;
+
+	m_vBlocks.resize(nBlockCount);
+	for (int i = 0; i < nBlockCount; i++) {
+		m_vBlocks[i].pData = (uint8 *)ceAlignedAlloc(nBlockSize, CE_REC_ALIGN);
+		m_vBlocks[i].nUsed = 0;
+		if (m_vBlocks[i].pData == NULL) {
+			Close();
+			return CE_FAILED;
+		}
+		if (i > 0)
+			m_lFree.push_back(&m_vBlocks[i]);
+	}
+	m_pCurrent = &m_vBlocks[0];
+
+	//about one hour at 30 fps before the index has to grow
+	m_vIndex.clear();
+	m_vIndex.reserve(30 * 3600);
+
+	m_writerThread = std::thread(&CCubeEyeRecorder::WriterThread, this);
+
+	size_t nHeaderSize = sizeof(ceRecFileHeader) + (m_bDevice ? sizeof(ceRecDeviceBlock) : 0);
+	ceRecFileHeader *pHeader = (ceRecFileHeader *)Reserve(nHeaderSize);
+	if (pHeader == NULL) {
+		Close();
+		return CE_WRITE_FAILED;
+	}
+	memset(pHeader, 0, sizeof(ceRecFileHeader));
+	memcpy(pHeader->szMagic, s_szRecMagic, sizeof(pHeader->szMagic));
+	pHeader->nVersion = CE_REC_VERSION;
+	pHeader->nHeaderSize = sizeof(ceRecFileHeader);
+	pHeader->nWidth = nWidth;
+	pHeader->nHeight = nHeight;
+	pHeader->nFlags = m_bDevice ? CE_REC_FLAG_DEVICE : 0;
+	pHeader->nDataOffset = (uint32)nHeaderSize;
+	if (m_bDevice)
+		memcpy(pHeader + 1, &m_stDevice, sizeof(ceRecDeviceBlock));
+	Commit(nHeaderSize);
+
+	return CE_SUCCESS;
+}
+
+uint8 *CCubeEyeRecorder::Reserve(size_t nSize)
+{
+	if (m_pCurrent->nUsed + nSize > m_nBlockSize) {
+		if (SubmitBlock(true) != CE_SUCCESS)
+			return NULL;
+	}
+	return m_pCurrent->pData + m_pCurrent->nUsed;
+}
+
+void CCubeEyeRecorder::Commit(size_t nSize)
+{
+	m_pCurrent->nUsed += nSize;
+	m_nOffset += nSize;
+}
+
+int CCubeEyeRecorder::SubmitBlock(bool bTakeNext)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (m_pCurrent != NULL && m_pCurrent->nUsed > 0) {
+		m_lFull.push_back(m_pCurrent);
+		m_pCurrent = NULL;
+		m_fullCond.notify_one();
+	}
+	if (!bTakeNext)
+		return CE_SUCCESS;
+
+	if (m_pCurrent == NULL) {
+		m_freeCond.wait(lock, [this] { return !m_lFree.empty() || m_bWriteError; });
+		if (m_bWriteError)
+			return CE_WRITE_FAILED;
+		m_pCurrent = m_lFree.front();
+		m_lFree.pop_front();
+		m_pCurrent->nUsed = 0;
+	}
+	return CE_SUCCESS;
+}
+
+void CCubeEyeRecorder::WriterThread()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;) {
+		m_fullCond.wait(lock, [this] { return m_bStop || !m_lFull.empty(); });
+		if (m_lFull.empty())
+			break;
+
+		Block *pBlock = m_lFull.front();
+		m_lFull.pop_front();
+		lock.unlock();
+
+		bool bOk = fwrite(pBlock->pData, 1, pBlock->nUsed, m_pFile) == pBlock->nUsed;
+
+		lock.lock();
+		if (!bOk)
+			m_bWriteError = true;
+		pBlock->nUsed = 0;
+		m_lFree.push_back(pBlock);
+		m_freeCond.notify_one();
+	}
+}
+
+int CCubeEyeRecorder::SetDeviceInfo(const ceDeviceInfo &stDevInfo, const ceIntrinsicParam &stIntrinsics,
+	const ceDistortionParam &stDistortion, uint8 nFrameRate)
+{
+	if (m_pFile != NULL)
+		return CE_FAILED;
+
+	memset(&m_stDevice, 0, sizeof(m_stDevice));
+	m_stDevice.stDevInfo = stDevInfo;
+	m_stDevice.stIntrinsics = stIntrinsics;
+	m_stDevice.stDistortion = stDistortion;
+	m_stDevice.nFrameRate = nFrameRate;
+	m_bDevice = true;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeRecorder::SetCodec(rec_codec nCodec, int nKeyFrameInterval)
+{
+	if ((nCodec != Codec_Raw && nCodec != Codec_Lossless) || nKeyFrameInterval < 0)
+		return CE_INVALID_PARAM;
+
+	m_nCodec = nCodec;
+	m_nKeyFrameInterval = nKeyFrameInterval;
+	//next frame is a key frame
+	m_nSinceKeyFrame = 0;
+	return CE_SUCCESS;
+}
+
+uint32 CCubeEyeRecorder::EncodePlane(const uint16 *pPlane, const uint16 *pPrev, uint8 *pDst, uint32 &nCodec)
+{
+	size_t nPlane = (size_t)m_nWidth * m_nHeight * sizeof(uint16);
+
+	if (m_nCodec == Codec_Lossless) {
+		int64 nSize = ceDepthEncode(pPlane, pPrev, m_nWidth, m_nHeight, pDst, nPlane);
+		if (nSize > 0 && (size_t)nSize < nPlane) {
+			nCodec = Codec_Lossless;
+			return (uint32)nSize;
+		}
+	}
+
+	nCodec = Codec_Raw;
+	memcpy(pDst, pPlane, nPlane);
+	return (uint32)nPlane;
+}
+
+int CCubeEyeRecorder::Append(const uint16 *pDepth, const uint16 *pIR, const ceFrameInfo &pFrameInfo)
+{
+	if (m_pFile == NULL)
+		return CE_NOT_OPENED;
+	if (pDepth == NULL)
+		return CE_INVALID_PARAM;
+	if (m_bWriteError)
+		return CE_WRITE_FAILED;
+
+	size_t nPlane = (size_t)m_nWidth * m_nHeight * sizeof(uint16);
+	size_t nMaxChunk = RecAlign(sizeof(ceRecChunkHeader) + nPlane + (pIR ? nPlane : 0));
+
+	uint8 *pChunk = Reserve(nMaxChunk);
+	if (pChunk == NULL)
+		return CE_WRITE_FAILED;
+
+	ceRecChunkHeader *pHeader = (ceRecChunkHeader *)pChunk;
+	memset(pHeader, 0, sizeof(ceRecChunkHeader));
+	pHeader->nMagic = CE_REC_CHUNK_MAGIC;
+	ceRecPackFrameInfo(pFrameInfo, pHeader->stInfo);
+
+	//previous frame prediction between key frames
+	bool bTemporal = m_nCodec == Codec_Lossless && m_nKeyFrameInterval > 0 && m_nSinceKeyFrame > 0;
+	uint8 *pPayload = pChunk + sizeof(ceRecChunkHeader);
+	pHeader->nDepthSize = EncodePlane(pDepth, bTemporal ? &m_vPrevDepth[0] : NULL, pPayload, pHeader->nDepthCodec);
+	if (pIR)
+		pHeader->nIRSize = EncodePlane(pIR, (bTemporal && m_bPrevIR) ? &m_vPrevIR[0] : NULL, pPayload + pHeader->nDepthSize, pHeader->nIRCodec);
+
+	size_t nPayload = sizeof(ceRecChunkHeader) + pHeader->nDepthSize + pHeader->nIRSize;
+	size_t nChunk = RecAlign(nPayload);
+	pHeader->nChunkSize = (uint32)nChunk;
+	memset(pChunk + nPayload, 0, nChunk - nPayload);
+
+	if (m_nCodec == Codec_Lossless && m_nKeyFrameInterval > 0) {
+		size_t nPixel = (size_t)m_nWidth * m_nHeight;
+		m_vPrevDepth.assign(pDepth, pDepth + nPixel);
+		if (pIR)
+			m_vPrevIR.assign(pIR, pIR + nPixel);
+		m_bPrevIR = pIR != NULL;
+		m_nSinceKeyFrame = (m_nSinceKeyFrame + 1) % m_nKeyFrameInterval;
+	}
+
+	ceRecIndexEntry stEntry;
+	stEntry.nFrameID = pFrameInfo.nFrameID;
+	stEntry.nTimeStamp = pFrameInfo.nTimeStamp;
+	stEntry.nOffset = m_nOffset;
+	stEntry.nChunkSize = (uint32)nChunk;
+	stEntry.nReserved = 0;
+	m_vIndex.push_back(stEntry);
+
+	Commit(nChunk);
+	return CE_SUCCESS;
+}
+
+int CCubeEyeRecorder::Close()
+{
+	if (m_pFile == NULL)
+		return CE_SUCCESS;
+
+	if (m_writerThread.joinable()) {
+		SubmitBlock(false);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_bStop = true;
+		}
+		m_fullCond.notify_one();
+		m_writerThread.join();
+	}
+
+	int nResult = m_bWriteError ? CE_WRITE_FAILED : CE_SUCCESS;
+
+	if (nResult == CE_SUCCESS) {
+		//frame ID order for FindFrame, ties kept in append order
+		uint64 nCount = m_vIndex.size();
+		Vector<uint32> vIdOrder((size_t)nCount);
+		for (uint32 i = 0; i < (uint32)nCount; i++)
+			vIdOrder[i] = i;
+		const Vector<ceRecIndexEntry> &vIndex = m_vIndex;
+		std::stable_sort(vIdOrder.begin(), vIdOrder.end(), [&vIndex](uint32 a, uint32 b) {
+			return vIndex[a].nFrameID < vIndex[b].nFrameID;
+		});
+
+		ceRecTrailer stTrailer;
+		memset(&stTrailer, 0, sizeof(stTrailer));
+		stTrailer.nIndexOffset = m_nOffset;
+		stTrailer.nIdOrderOffset = m_nOffset + nCount * sizeof(ceRecIndexEntry);
+		stTrailer.nFrameCount = nCount;
+		stTrailer.nMagic = CE_REC_TRAILER_MAGIC;
+
+		//the id order array ends on a 4 byte boundary; pad so the trailer stays 8 byte aligned
+		uint32 nPad = 0;
+		size_t nPadSize = (nCount & 1) ? sizeof(nPad) : 0;
+
+		bool bOk = (nCount == 0 || fwrite(&m_vIndex[0], sizeof(ceRecIndexEntry), (size_t)nCount, m_pFile) == nCount)
+			&& (nCount == 0 || fwrite(&vIdOrder[0], sizeof(uint32), (size_t)nCount, m_pFile) == nCount)
+			&& (nPadSize == 0 || fwrite(&nPad, nPadSize, 1, m_pFile) == 1)
+			&& fwrite(&stTrailer, sizeof(stTrailer), 1, m_pFile) == 1;
+		if (!bOk)
+			nResult = CE_WRITE_FAILED;
+	}
+
+	if (fclose(m_pFile) != 0)
+		nResult = CE_WRITE_FAILED;
+	m_pFile = NULL;
+
+	for (size_t i = 0; i < m_vBlocks.size(); i++) {
+		if (m_vBlocks[i].pData != NULL)
+			ceAlignedFree(m_vBlocks[i].pData);
+	}
+	m_vBlocks.clear();
+	m_lFree.clear();
+	m_lFull.clear();
+	m_pCurrent = NULL;
+	m_vIndex.clear();
+
+	return nResult;
+}
+
+/*************************************************************************************
+* CCubeEyeRecordReader
+*/
+
+CCubeEyeRecordReader::CCubeEyeRecordReader()
+	: m_nWidth(0), m_nHeight(0), m_nFrameCount(0), m_pIndex(NULL), m_pIdOrder(NULL), m_pDevice(NULL),
+	m_nDataOffset(0), m_nDecodedIndex(-1)
+{
+}
+
+CCubeEyeRecordReader::~CCubeEyeRecordReader()
+{
+	Close();
+}
+
+void CCubeEyeRecordReader::Close()
+{
+	m_file.Close();
+	m_nWidth = 0;
+	m_nHeight = 0;
+	m_nFrameCount = 0;
+	m_pIndex = NULL;
+	m_pIdOrder = NULL;
+	m_pDevice = NULL;
+	m_nDataOffset = 0;
+	m_vIndex.clear();
+	m_vIdOrder.clear();
+	m_nDecodedIndex = -1;
+}
+
+int CCubeEyeRecordReader::Open(const char *szPath)
+{
+	Close();
+
+	int nResult = m_file.Open(szPath);
+	if (nResult != CE_SUCCESS)
+		return nResult;
+
+	const uint8 *pData = m_file.getData();
+	size_t nSize = m_file.getSize();
+	const ceRecFileHeader *pHeader = (const ceRecFileHeader *)pData;
+
+	if (nSize < sizeof(ceRecFileHeader) || memcmp(pHeader->szMagic, s_szRecMagic, sizeof(s_szRecMagic)) != 0
+		|| pHeader->nVersion > CE_REC_VERSION) {
+		Close();
+		return CE_READ_FAILED;
+	}
+	if (pHeader->nWidth <= 0 || pHeader->nHeight <= 0) {
+		Close();
+		return CE_READ_FAILED;
+	}
+	m_nWidth = pHeader->nWidth;
+	m_nHeight = pHeader->nHeight;
+	m_nDataOffset = pHeader->nDataOffset != 0 ? pHeader->nDataOffset : sizeof(ceRecFileHeader);
+	if (m_nDataOffset > nSize) {
+		Close();
+		return CE_READ_FAILED;
+	}
+	if ((pHeader->nFlags & CE_REC_FLAG_DEVICE) && m_nDataOffset >= sizeof(ceRecFileHeader) + sizeof(ceRecDeviceBlock))
+		m_pDevice = (const ceRecDeviceBlock *)(pHeader + 1);
+
+	if (nSize >= sizeof(ceRecFileHeader) + sizeof(ceRecTrailer)) {
+		const ceRecTrailer *pTrailer = (const ceRecTrailer *)(pData + nSize - sizeof(ceRecTrailer));
+		//written as divisions, a damaged trailer must not overflow past the test
+		if (pTrailer->nMagic == CE_REC_TRAILER_MAGIC
+			&& pTrailer->nIndexOffset <= nSize && pTrailer->nIdOrderOffset <= nSize
+			&& pTrailer->nFrameCount <= (nSize - pTrailer->nIndexOffset) / sizeof(ceRecIndexEntry)
+			&& pTrailer->nFrameCount <= (nSize - pTrailer->nIdOrderOffset) / sizeof(uint32)) {
+			m_nFrameCount = pTrailer->nFrameCount;
+			m_pIndex = (const ceRecIndexEntry *)(pData + pTrailer->nIndexOffset);
+			m_pIdOrder = (const uint32 *)(pData + pTrailer->nIdOrderOffset);
+			return CE_SUCCESS;
+		}
+	}
+
+	nResult = RebuildIndex();
+	if (nResult < 0)
+		Close();
+	return nResult;
+}
+
+int CCubeEyeRecordReader::RebuildIndex()
+{
+	const uint8 *pData = m_file.getData();
+	size_t nSize = m_file.getSize();
+	uint64 nOffset = m_nDataOffset;
+
+	//stop at the first incomplete or damaged chunk
+	while (nOffset + sizeof(ceRecChunkHeader) <= nSize) {
+		const ceRecChunkHeader *pChunk = (const ceRecChunkHeader *)(pData + nOffset);
+		if (pChunk->nMagic != CE_REC_CHUNK_MAGIC || pChunk->nChunkSize < sizeof(ceRecChunkHeader)
+			|| pChunk->nChunkSize > nSize - nOffset)
+			break;
+
+		ceRecIndexEntry stEntry;
+		stEntry.nFrameID = pChunk->stInfo.nFrameID;
+		stEntry.nTimeStamp = pChunk->stInfo.nTimeStamp;
+		stEntry.nOffset = nOffset;
+		stEntry.nChunkSize = pChunk->nChunkSize;
+		stEntry.nReserved = 0;
+		m_vIndex.push_back(stEntry);
+
+		nOffset += pChunk->nChunkSize;
+	}
+
+	m_vIdOrder.resize(m_vIndex.size());
+	for (uint32 i = 0; i < (uint32)m_vIdOrder.size(); i++)
+		m_vIdOrder[i] = i;
+	const Vector<ceRecIndexEntry> &vIndex = m_vIndex;
+	std::stable_sort(m_vIdOrder.begin(), m_vIdOrder.end(), [&vIndex](uint32 a, uint32 b) {
+		return vIndex[a].nFrameID < vIndex[b].nFrameID;
+	});
+
+	m_nFrameCount = m_vIndex.size();
+	m_pIndex = m_vIndex.empty() ? NULL : &m_vIndex[0];
+	m_pIdOrder = m_vIdOrder.empty() ? NULL : &m_vIdOrder[0];
+	return CE_WARNING;
+}
+
+int64 CCubeEyeRecordReader::FindFrame(int64 nFrameID) const
+{
+	const ceRecIndexEntry *pIndex = m_pIndex;
+	const uint32 *pBegin = m_pIdOrder;
+	const uint32 *pEnd = m_pIdOrder + m_nFrameCount;
+
+	const uint32 *pFound = std::lower_bound(pBegin, pEnd, nFrameID, [pIndex](uint32 nPos, int64 nID) {
+		return pIndex[nPos].nFrameID < nID;
+	});
+	if (pFound == pEnd || pIndex[*pFound].nFrameID != nFrameID)
+		return CE_NOT_FOUND;
+	return *pFound;
+}
+
+int64 CCubeEyeRecordReader::FindFrameByTime(TimeStampType nTimeStamp) const
+{
+	if (m_nFrameCount == 0)
+		return CE_NOT_FOUND;
+
+	const ceRecIndexEntry *pFound = std::lower_bound(m_pIndex, m_pIndex + m_nFrameCount, nTimeStamp,
+		[](const ceRecIndexEntry &stEntry, TimeStampType nTime) {
+		return stEntry.nTimeStamp < nTime;
+	});
+	if (pFound == m_pIndex + m_nFrameCount)
+		pFound--;
+	return pFound - m_pIndex;
+}
+
+const ceRecChunkHeader *CCubeEyeRecordReader::getChunk(uint64 nIndex) const
+{
+	if (nIndex >= m_nFrameCount)
+		return NULL;
+
+	const ceRecIndexEntry &stEntry = m_pIndex[nIndex];
+	uint64 nSize = m_file.getSize();
+	if (stEntry.nChunkSize < sizeof(ceRecChunkHeader) || stEntry.nOffset > nSize || stEntry.nChunkSize > nSize - stEntry.nOffset)
+		return NULL;
+
+	const ceRecChunkHeader *pChunk = (const ceRecChunkHeader *)(m_file.getData() + stEntry.nOffset);
+	if (pChunk->nMagic != CE_REC_CHUNK_MAGIC || pChunk->nChunkSize > stEntry.nChunkSize
+		|| sizeof(ceRecChunkHeader) + (uint64)pChunk->nDepthSize + pChunk->nIRSize > pChunk->nChunkSize)
+		return NULL;
+	return pChunk;
+}
+
+int CCubeEyeRecordReader::GetFrameView(uint64 nIndex, const uint16 *&pDepth, const uint16 *&pIR, ceFrameInfo &pFrameInfo) const
+{
+	const ceRecChunkHeader *pChunk = getChunk(nIndex);
+	if (pChunk == NULL)
+		return CE_READ_FAILED;
+	if (pChunk->nDepthCodec != Codec_Raw || (pChunk->nIRSize > 0 && pChunk->nIRCodec != Codec_Raw))
+		return CE_UNSUPPORTED;
+
+	//full planes are read straight from the mapping
+	size_t nPlane = (size_t)m_nWidth * m_nHeight * sizeof(uint16);
+	if (pChunk->nDepthSize != nPlane || (pChunk->nIRSize > 0 && pChunk->nIRSize != nPlane))
+		return CE_READ_FAILED;
+
+	const uint8 *pPayload = (const uint8 *)pChunk + sizeof(ceRecChunkHeader);
+	pDepth = (const uint16 *)pPayload;
+	pIR = pChunk->nIRSize > 0 ? (const uint16 *)(pPayload + pChunk->nDepthSize) : NULL;
+	ceRecUnpackFrameInfo(pChunk->stInfo, pFrameInfo);
+	return CE_SUCCESS;
+}
+
+static int DecodePlane(uint32 nCodec, const uint8 *pPayload, uint32 nSize, const uint16 *pPrev, int nWidth, int nHeight, uint16 *pDst)
+{
+	size_t nPlane = (size_t)nWidth * nHeight * sizeof(uint16);
+
+	switch (nCodec) {
+	case Codec_Raw:
+		if (nSize != nPlane)
+			return CE_READ_FAILED;
+		memcpy(pDst, pPayload, nPlane);
+		return CE_SUCCESS;
+	case Codec_Lossless:
+		return ceDepthDecode(pPayload, nSize, pPrev, nWidth, nHeight, pDst);
+	default:
+		return CE_UNSUPPORTED;
+	}
+}
+
+static bool IsTemporalChunk(const ceRecChunkHeader *pChunk)
+{
+	const uint8 *pPayload = (const uint8 *)pChunk + sizeof(ceRecChunkHeader);
+	return (pChunk->nDepthCodec == Codec_Lossless && ceDepthIsTemporal(pPayload, pChunk->nDepthSize))
+		|| (pChunk->nIRCodec == Codec_Lossless && ceDepthIsTemporal(pPayload + pChunk->nDepthSize, pChunk->nIRSize));
+}
+
+int CCubeEyeRecordReader::DecodeFrame(uint64 nIndex) const
+{
+	if (m_nDecodedIndex == (int64)nIndex)
+		return CE_SUCCESS;
+
+	size_t nPixel = (size_t)m_nWidth * m_nHeight;
+	for (int i = 0; i < 2; i++) {
+		m_vDecoded[i].resize(nPixel);
+		m_vScratch[i].resize(nPixel);
+	}
+
+	//walk back to the key frame, unless the cache already holds the previous frame
+	uint64 nStart = nIndex;
+	for (;;) {
+		const ceRecChunkHeader *pChunk = getChunk(nStart);
+		if (pChunk == NULL)
+			return CE_READ_FAILED;
+		if (!IsTemporalChunk(pChunk) || m_nDecodedIndex == (int64)nStart - 1)
+			break;
+		if (nStart == 0)
+			return CE_READ_FAILED;
+		nStart--;
+	}
+
+	for (uint64 n = nStart; n <= nIndex; n++) {
+		const ceRecChunkHeader *pChunk = getChunk(n);
+		const uint8 *pPayload = (const uint8 *)pChunk + sizeof(ceRecChunkHeader);
+
+		int nResult = DecodePlane(pChunk->nDepthCodec, pPayload, pChunk->nDepthSize, &m_vDecoded[0][0],
+			m_nWidth, m_nHeight, &m_vScratch[0][0]);
+		if (nResult == CE_SUCCESS && pChunk->nIRSize > 0)
+			nResult = DecodePlane(pChunk->nIRCodec, pPayload + pChunk->nDepthSize, pChunk->nIRSize, &m_vDecoded[1][0],
+				m_nWidth, m_nHeight, &m_vScratch[1][0]);
+		if (nResult != CE_SUCCESS) {
+			m_nDecodedIndex = -1;
+			return nResult;
+		}
+
+		m_vDecoded[0].swap(m_vScratch[0]);
+		if (pChunk->nIRSize > 0)
+			m_vDecoded[1].swap(m_vScratch[1]);
+		m_nDecodedIndex = n;
+	}
+	return CE_SUCCESS;
+}
+
+int CCubeEyeRecordReader::ReadFrame(uint64 nIndex, uint16 *pDepth, uint16 *pIR, ceFrameInfo &pFrameInfo) const
+{
+	if (pDepth == NULL)
+		return CE_INVALID_PARAM;
+
+	size_t nPlane = (size_t)m_nWidth * m_nHeight * sizeof(uint16);
+	const uint16 *pSrcDepth, *pSrcIR;
+	int nResult = GetFrameView(nIndex, pSrcDepth, pSrcIR, pFrameInfo);
+
+	if (nResult == CE_UNSUPPORTED) {
+		std::lock_guard<std::mutex> lock(m_decodeMutex);
+
+		nResult = DecodeFrame(nIndex);
+		if (nResult != CE_SUCCESS)
+			return nResult;
+
+		const ceRecChunkHeader *pChunk = getChunk(nIndex);
+		ceRecUnpackFrameInfo(pChunk->stInfo, pFrameInfo);
+		memcpy(pDepth, &m_vDecoded[0][0], nPlane);
+		if (pIR != NULL) {
+			if (pChunk->nIRSize > 0)
+				memcpy(pIR, &m_vDecoded[1][0], nPlane);
+			else
+				memset(pIR, 0, nPlane);
+		}
+		return CE_SUCCESS;
+	}
+	if (nResult != CE_SUCCESS)
+		return nResult;
+
+	memcpy(pDepth, pSrcDepth, nPlane);
+	if (pIR != NULL) {
+		if (pSrcIR != NULL)
+			memcpy(pIR, pSrcIR, nPlane);
+		else
+			memset(pIR, 0, nPlane);
+	}
+	return CE_SUCCESS;
+}
+
+}
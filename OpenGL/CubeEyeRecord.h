@@ -0,0 +1,406 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeRecord.h													*/
+/*																			*/
+/* @brief	Indexed Depth/IR recording container(writer / mapped reader)	*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeMappedFile.h"
+#include "CubeEyeDepthCodec.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace CUBE_EYE
+{
+/*
+*	File layout(little endian) :
+*
+*	ceRecFileHeader
+*	ceRecDeviceBlock						(CE_REC_FLAG_DEVICE, source camera description)
+*	frame chunk 0 : ceRecChunkHeader | depth payload | IR payload | padding to CE_REC_ALIGN
+*	frame chunk 1
+*	...
+*	ceRecIndexEntry[nFrameCount]			(append order, nTimeStamp ascending)
+*	uint32[nFrameCount]						(positions of the entries sorted by nFrameID)
+*	ceRecTrailer							(last bytes of the file)
+*
+*	A recording without trailer(writer crashed) is still readable : the reader rebuilds the
+*	index by walking the chunk headers.
+*
+*	Codec_Lossless payloads are ceDepthEncode streams. A temporal payload is predicted from the
+*	same plane of the previous chunk, so the recorder writes a self contained key frame every
+*	nKeyFrameInterval frames to bound the decoding work of a seek.
+*/
+
+#define CE_REC_VERSION			1
+#define CE_REC_ALIGN			64
+#define CE_REC_CHUNK_MAGIC		0x52464543U		//"CEFR"
+#define CE_REC_TRAILER_MAGIC	0x58494543U		//"CEIX"
+
+///ceRecFileHeader::nFlags
+#define CE_REC_FLAG_DEVICE		0x1U
+
+///Payload codec
+enum rec_codec {
+	///uncompressed uint16 plane
+	Codec_Raw = 0,
+	///ceDepthEncode stream(CubeEyeDepthCodec.h)
+	Codec_Lossless = 1,
+};
+
+///Recording file header
+typedef struct _ceRecFileHeader
+{
+	///"CEREC\0\0\0"
+	char szMagic[8];
+	///CE_REC_VERSION
+	uint32 nVersion;
+	///sizeof(ceRecFileHeader)
+	uint32 nHeaderSize;
+	///Frame Width
+	int32 nWidth;
+	///Frame Height
+	int32 nHeight;
+	///CE_REC_FLAG_xxx
+	uint32 nFlags;
+	///Offset of the first frame chunk(0 : sizeof(ceRecFileHeader))
+	uint32 nDataOffset;
+	uint8 nReserved[32];
+
+} ceRecFileHeader;
+
+///Source camera description
+typedef struct _ceRecDeviceBlock
+{
+	ceDeviceInfo stDevInfo;
+	ceIntrinsicParam stIntrinsics;
+	ceDistortionParam stDistortion;
+	///FPS_30, FPS_15, FPS_8(0 : unknown)
+	uint32 nFrameRate;
+	uint8 nReserved[12];
+
+} ceRecDeviceBlock;
+
+///ceFrameInfo with fixed size fields(long is 32 bit on Windows, 64 bit on Linux)
+typedef struct _ceRecFrameInfo
+{
+	int32 nFrameType;
+	int32 nWidth;
+	int32 nHeight;
+	int32 nReserved0;
+	int64 nFrameID;
+	uint64 nTimeStamp;
+	float fSensorTemp;
+	float fLDTemp;
+	float fIntegrationTime;
+	uint8 nEmbeddedLine[80];
+	uint8 nReserved1[4];
+
+} ceRecFrameInfo;
+
+///Frame chunk header
+typedef struct _ceRecChunkHeader
+{
+	///CE_REC_CHUNK_MAGIC
+	uint32 nMagic;
+	///Chunk size including header and padding
+	uint32 nChunkSize;
+	///Depth payload codec(rec_codec) / size(byte)
+	uint32 nDepthCodec;
+	uint32 nDepthSize;
+	///IR payload codec(rec_codec) / size(byte), size 0 : no IR
+	uint32 nIRCodec;
+	uint32 nIRSize;
+	uint8 nReserved[8];
+	ceRecFrameInfo stInfo;
+
+} ceRecChunkHeader;
+
+///Footer index entry
+typedef struct _ceRecIndexEntry
+{
+	int64 nFrameID;
+	uint64 nTimeStamp;
+	///File offset of the frame chunk
+	uint64 nOffset;
+	uint32 nChunkSize;
+	uint32 nReserved;
+
+} ceRecIndexEntry;
+
+///Recording trailer
+typedef struct _ceRecTrailer
+{
+	uint64 nIndexOffset;
+	uint64 nIdOrderOffset;
+	uint64 nFrameCount;
+	uint32 nReserved;
+	///CE_REC_TRAILER_MAGIC
+	uint32 nMagic;
+
+} ceRecTrailer;
+
+/**
+*
+*@brief		Recording writer
+*@details	Append() packs each frame into large preallocated blocks; a background thread writes
+			full blocks with one sequential fwrite each. Append only waits when every block is
+			queued for writing(disk slower than capture). Close() writes the index and trailer.
+*
+*/
+class CCubeEyeRecorder {
+
+public:
+
+	CCubeEyeRecorder();
+	~CCubeEyeRecorder();
+
+	/**
+	*
+	* @brief	Create recording
+	* @param	szPath - file path(overwritten).
+	* @param	nWidth, nHeight - frame size.
+	* @param	nBlockSize - write block size(byte), raised to fit at least one frame.
+	* @param	nBlockCount(2~) - number of write blocks.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Open(const char *szPath, int nWidth, int nHeight, size_t nBlockSize = 16 << 20, int nBlockCount = 4);
+
+	/**
+	*
+	* @brief	Set payload codec
+	* @details	Applies to the frames appended afterwards. With Codec_Lossless, a plane that does not
+				compress below its raw size is stored as Codec_Raw.
+	* @param	nCodec - Codec_Raw(default)|Codec_Lossless.
+	* @param	nKeyFrameInterval - 0 : every frame self contained(spatial prediction only),
+				N : previous frame prediction with a key frame every N frames.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetCodec(rec_codec nCodec, int nKeyFrameInterval = 0);
+
+	/**
+	*
+	* @brief	Set source camera description
+	* @details	Stored in the file header block(playback exposes it as pDevInfo / lens parameters).
+				Must be called before Open.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetDeviceInfo(const ceDeviceInfo &stDevInfo, const ceIntrinsicParam &stIntrinsics,
+		const ceDistortionParam &stDistortion, uint8 nFrameRate = 0);
+
+	template <class TDevice>
+	int SetDeviceInfo(TDevice &device)
+	{
+		uint8 nFrameRate = 0;
+		if (device.getFrameRate(nFrameRate) != CE_SUCCESS)
+			nFrameRate = 0;
+		return SetDeviceInfo(device.pDevInfo, device.pIntrinsicParam, device.pDistortionParam, nFrameRate);
+	}
+
+	/**
+	*
+	* @brief	Append frame
+	* @param	pDepth - depth frame.
+	* @param	pIR - IR frame(NULL : not recorded).
+	* @param	pFrameInfo - frame information.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Append(const uint16 *pDepth, const uint16 *pIR, const ceFrameInfo &pFrameInfo);
+
+	/**
+	*
+	* @brief	Close recording
+	* @details	Flushes the pending blocks and writes the index.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Close();
+
+	bool IsOpened() const { return m_pFile != NULL; }
+	uint64 getFrameCount() const { return m_vIndex.size(); }
+	uint64 getBytesWritten() const { return m_nOffset; }
+
+private:
+
+	struct Block
+	{
+		uint8 *pData;
+		size_t nUsed;
+	};
+
+	CCubeEyeRecorder(const CCubeEyeRecorder &);
+	CCubeEyeRecorder &operator=(const CCubeEyeRecorder &);
+
+	uint8 *Reserve(size_t nSize);
+	void Commit(size_t nSize);
+	uint32 EncodePlane(const uint16 *pPlane, const uint16 *pPrev, uint8 *pDst, uint32 &nCodec);
+	int SubmitBlock(bool bTakeNext);
+	void WriterThread();
+
+	FILE *m_pFile;
+	int m_nWidth;
+	int m_nHeight;
+	size_t m_nBlockSize;
+	uint64 m_nOffset;				//file offset of the next byte appended
+
+	bool m_bDevice;
+	ceRecDeviceBlock m_stDevice;
+
+	rec_codec m_nCodec;
+	int m_nKeyFrameInterval;
+	int m_nSinceKeyFrame;			//frames appended since the last key frame
+	bool m_bPrevIR;					//previous frame recorded IR
+	Vector<uint16> m_vPrevDepth;	//previous frame, temporal prediction reference
+	Vector<uint16> m_vPrevIR;
+
+	Vector<Block> m_vBlocks;
+	Block *m_pCurrent;
+	List<Block *> m_lFree;
+	List<Block *> m_lFull;
+	bool m_bStop;
+	std::atomic<bool> m_bWriteError;
+	std::mutex m_mutex;
+	std::condition_variable m_freeCond;
+	std::condition_variable m_fullCond;
+	std::thread m_writerThread;
+
+	Vector<ceRecIndexEntry> m_vIndex;
+};
+
+/**
+*
+*@brief		Recording reader
+*@details	Maps the recording and reads the footer index in place, so opening an hour long
+			recording touches only the header, trailer and index. Frames are found by nFrameID
+			or nTimeStamp with a binary search and read straight from the mapping.
+*
+*/
+class CCubeEyeRecordReader {
+
+public:
+
+	CCubeEyeRecordReader();
+	~CCubeEyeRecordReader();
+
+	/**
+	*
+	* @brief	Open recording
+	* @details	Rebuilds the index by scanning the chunks when the trailer is missing.
+	* @return	Success(0)|CE_WARNING(index rebuilt)|Error Code(< 0)
+	*
+	*/
+	int Open(const char *szPath);
+
+	void Close();
+
+	bool IsOpened() const { return m_file.IsOpened(); }
+	int getWidth() const { return m_nWidth; }
+	int getHeight() const { return m_nHeight; }
+	uint64 getFrameCount() const { return m_nFrameCount; }
+	const ceRecIndexEntry &getIndexEntry(uint64 nIndex) const { return m_pIndex[nIndex]; }
+
+	/**
+	*
+	* @brief	Source camera description
+	* @return	block|NULL(not recorded)
+	*
+	*/
+	const ceRecDeviceBlock *getDeviceBlock() const { return m_pDevice; }
+
+	/**
+	*
+	* @brief	Find frame by frame ID
+	* @return	frame index(>= 0)|CE_NOT_FOUND
+	*
+	*/
+	int64 FindFrame(int64 nFrameID) const;
+
+	/**
+	*
+	* @brief	Find frame by time stamp
+	* @details	First frame with nTimeStamp >= nTimeStamp(last frame when past the end).
+	* @return	frame index(>= 0)|CE_NOT_FOUND
+	*
+	*/
+	int64 FindFrameByTime(TimeStampType nTimeStamp) const;
+
+	/**
+	*
+	* @brief	Read frame
+	* @details	Copies(decodes) frame nIndex into the output buffers. A temporal frame is decoded
+				from the preceding key frame unless the previous frame was the last one read, so
+				sequential reads decode each frame once.
+	* @param	pIR - NULL : IR is skipped.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int ReadFrame(uint64 nIndex, uint16 *pDepth, uint16 *pIR, ceFrameInfo &pFrameInfo) const;
+
+	/**
+	*
+	* @brief	Frame view
+	* @details	Points into the mapping without copying. Only for Codec_Raw payloads;
+				pIR is NULL when the frame has no IR.
+	* @return	Success(0)|CE_UNSUPPORTED(compressed)|Error Code(< 0)
+	*
+	*/
+	int GetFrameView(uint64 nIndex, const uint16 *&pDepth, const uint16 *&pIR, ceFrameInfo &pFrameInfo) const;
+
+	/**
+	*
+	* @brief	Chunk header
+	* @return	header|NULL
+	*
+	*/
+	const ceRecChunkHeader *getChunk(uint64 nIndex) const;
+
+private:
+
+	CCubeEyeRecordReader(const CCubeEyeRecordReader &);
+	CCubeEyeRecordReader &operator=(const CCubeEyeRecordReader &);
+
+	int RebuildIndex();
+	int DecodeFrame(uint64 nIndex) const;
+
+	CCubeEyeMappedFile m_file;
+	int m_nWidth;
+	int m_nHeight;
+	uint64 m_nFrameCount;
+	const ceRecIndexEntry *m_pIndex;
+	const uint32 *m_pIdOrder;
+	const ceRecDeviceBlock *m_pDevice;
+	uint64 m_nDataOffset;
+
+	//index rebuilt from a recording without trailer
+	Vector<ceRecIndexEntry> m_vIndex;
+	Vector<uint32> m_vIdOrder;
+
+	//decoded frame cache for compressed recordings(previous frame of temporal payloads)
+	mutable std::mutex m_decodeMutex;
+	mutable int64 m_nDecodedIndex;
+	mutable Vector<uint16> m_vDecoded[2];	//depth, IR
+	mutable Vector<uint16> m_vScratch[2];
+};
+
+/**
+*
+* @brief	ceFrameInfo <-> ceRecFrameInfo
+* @return	void
+*
+*/
+void ceRecPackFrameInfo(const ceFrameInfo &stInfo, ceRecFrameInfo &stRecInfo);
+void ceRecUnpackFrameInfo(const ceRecFrameInfo &stRecInfo, ceFrameInfo &stInfo);
+
+}
@@ -0,0 +1,312 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeRegistration.cpp											*/
+/*																			*/
+/* @brief	Depth to color registration										*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeRegistration.h"
+
+#include <math.h>
+
+namespace CUBE_EYE
+{
+
+#define ROW_GRAIN		16
+#define ZBUFFER_EMPTY	0xFFFF
+#define DEPTH_MAX		65534.0f		//below ZBUFFER_EMPTY, so far points still win the z-buffer
+
+CCubeEyeRegistration::CCubeEyeRegistration()
+	: m_nDepthWidth(0), m_nDepthHeight(0), m_nColorWidth(0), m_nColorHeight(0),
+	m_pPool(&CCubeEyeThreadPool::Default()), m_nOcclusionMargin(20), m_fSplatX(0.5f), m_fSplatY(0.5f),
+	m_pTable(NULL), m_pRayX(NULL), m_pRayY(NULL), m_pRayZ(NULL), m_pColorU(NULL), m_pColorV(NULL),
+	m_pColorZ(NULL), m_pAligned(NULL), m_pZBuffer(NULL), m_nOccluded(0)
+{
+	memset(&m_stColorIntr, 0, sizeof(m_stColorIntr));
+	memset(&m_stColorDist, 0, sizeof(m_stColorDist));
+	memset(m_fT, 0, sizeof(m_fT));
+}
+
+CCubeEyeRegistration::~CCubeEyeRegistration()
+{
+	Release();
+}
+
+void CCubeEyeRegistration::Release()
+{
+	if (m_pTable != NULL)
+		ceAlignedFree(m_pTable);
+	if (m_pColorZ != NULL)
+		ceAlignedFree(m_pColorZ);
+	if (m_pAligned != NULL)
+		ceAlignedFree(m_pAligned);
+	delete[] m_pZBuffer;
+
+	m_pTable = NULL;
+	m_pRayX = m_pRayY = m_pRayZ = NULL;
+	m_pColorU = m_pColorV = NULL;
+	m_pColorZ = NULL;
+	m_pAligned = NULL;
+	m_pZBuffer = NULL;
+	m_nDepthWidth = m_nDepthHeight = 0;
+	m_nColorWidth = m_nColorHeight = 0;
+}
+
+int CCubeEyeRegistration::Init(const ceIntrinsicParam &stDepthIntr, const ceDistortionParam &stDepthDist, int nDepthWidth, int nDepthHeight,
+	const ceIntrinsicParam &stColorIntr, const ceDistortionParam &stColorDist, int nColorWidth, int nColorHeight,
+	const ceExtrinsicParam &stExtrinsics, float fTranslationToMm)
+{
+	if (nDepthWidth <= 0 || nDepthHeight <= 0 || nColorWidth <= 0 || nColorHeight <= 0)
+		return CE_INVALID_PARAM;
+	if (stDepthIntr.fFx <= 0.0f || stDepthIntr.fFy <= 0.0f || stColorIntr.fFx <= 0.0f || stColorIntr.fFy <= 0.0f)
+		return CE_INVALID_PARAM;
+
+	Release();
+
+	size_t nDepthSize = (size_t)nDepthWidth * nDepthHeight;
+	size_t nColorSize = (size_t)nColorWidth * nColorHeight;
+	m_pTable = (float *)ceAlignedAlloc(nDepthSize * 5 * sizeof(float));
+	m_pColorZ = (uint16 *)ceAlignedAlloc(nDepthSize * sizeof(uint16));
+	m_pAligned = (uint16 *)ceAlignedAlloc(nColorSize * sizeof(uint16));
+	m_pZBuffer = new (std::nothrow) std::atomic<uint16>[nColorSize];
+	if (m_pTable == NULL || m_pColorZ == NULL || m_pAligned == NULL || m_pZBuffer == NULL) {
+		Release();
+		return CE_FAILED;
+	}
+
+	float *pRayX = m_pTable;
+	float *pRayY = m_pTable + nDepthSize;
+	float *pRayZ = m_pTable + nDepthSize * 2;
+	m_pColorU = m_pTable + nDepthSize * 3;
+	m_pColorV = m_pTable + nDepthSize * 4;
+
+	//rotate the undistorted rays once : a frame only scales them by depth
+	ceBuildRayTable(stDepthIntr, stDepthDist, nDepthWidth, nDepthHeight, pRayX, pRayY);
+	for (size_t i = 0; i < nDepthSize; i++) {
+		float x = pRayX[i], y = pRayY[i];
+		pRayX[i] = stExtrinsics.fR11 * x + stExtrinsics.fR12 * y + stExtrinsics.fR13;
+		pRayY[i] = stExtrinsics.fR21 * x + stExtrinsics.fR22 * y + stExtrinsics.fR23;
+		pRayZ[i] = stExtrinsics.fR31 * x + stExtrinsics.fR32 * y + stExtrinsics.fR33;
+	}
+	m_pRayX = pRayX;
+	m_pRayY = pRayY;
+	m_pRayZ = pRayZ;
+
+	for (size_t i = 0; i < nColorSize; i++)
+		m_pZBuffer[i].store(ZBUFFER_EMPTY, std::memory_order_relaxed);
+
+	m_stColorIntr = stColorIntr;
+	m_stColorDist = stColorDist;
+	m_fT[0] = stExtrinsics.fTx * fTranslationToMm;
+	m_fT[1] = stExtrinsics.fTy * fTranslationToMm;
+	m_fT[2] = stExtrinsics.fTz * fTranslationToMm;
+
+	//a depth pixel covers about Fcolor / Fdepth color pixels(depth ~ color depth)
+	m_fSplatX = 0.5f * stColorIntr.fFx / stDepthIntr.fFx;
+	m_fSplatY = 0.5f * stColorIntr.fFy / stDepthIntr.fFy;
+
+	m_nDepthWidth = nDepthWidth;
+	m_nDepthHeight = nDepthHeight;
+	m_nColorWidth = nColorWidth;
+	m_nColorHeight = nColorHeight;
+	return CE_SUCCESS;
+}
+
+template <class TFunc>
+void CCubeEyeRegistration::ForRows(int nRows, const TFunc &func)
+{
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, nRows, ROW_GRAIN, func);
+	else
+		func(0, nRows);
+}
+
+/*************************************************************************************
+* kernels : depth pixels [nBegin, nEnd)
+*/
+
+void CCubeEyeRegistration::Project(const uint16 *pDepth, size_t nBegin, size_t nEnd)
+{
+	const ceIntrinsicParam &K = m_stColorIntr;
+	const ceDistortionParam &D = m_stColorDist;
+	//valid u in [-0.5, W - 0.5) so that the nearest pixel is inside the image
+	const float fMaxU = m_nColorWidth - 0.5f;
+	const float fMaxV = m_nColorHeight - 0.5f;
+	size_t i = nBegin;
+
+#if defined(CE_USE_AVX2)
+	const __m256 vTx = _mm256_set1_ps(m_fT[0]), vTy = _mm256_set1_ps(m_fT[1]), vTz = _mm256_set1_ps(m_fT[2]);
+	const __m256 vK1 = _mm256_set1_ps(D.fK1), vK2 = _mm256_set1_ps(D.fK2), vK3 = _mm256_set1_ps(D.fK3);
+	const __m256 vP1 = _mm256_set1_ps(D.fP1), vP2 = _mm256_set1_ps(D.fP2), vSkew = _mm256_set1_ps(D.fSkew);
+	const __m256 vFx = _mm256_set1_ps(K.fFx), vFy = _mm256_set1_ps(K.fFy), vCx = _mm256_set1_ps(K.fCx), vCy = _mm256_set1_ps(K.fCy);
+	const __m256 vOne = _mm256_set1_ps(1.0f), vTwo = _mm256_set1_ps(2.0f), vMinus = _mm256_set1_ps(-1.0f);
+	const __m256 vLow = _mm256_set1_ps(-0.5f), vMaxU = _mm256_set1_ps(fMaxU), vMaxV = _mm256_set1_ps(fMaxV);
+	const __m256 vHalf = _mm256_set1_ps(0.5f), vDepthMax = _mm256_set1_ps(DEPTH_MAX);
+
+	for (; i + 8 <= nEnd; i += 8) {
+		__m256 d = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(pDepth + i))));
+		__m256 X = _mm256_fmadd_ps(d, _mm256_loadu_ps(m_pRayX + i), vTx);
+		__m256 Y = _mm256_fmadd_ps(d, _mm256_loadu_ps(m_pRayY + i), vTy);
+		__m256 Z = _mm256_fmadd_ps(d, _mm256_loadu_ps(m_pRayZ + i), vTz);
+		__m256 vValid = _mm256_and_ps(_mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_GT_OQ), _mm256_cmp_ps(Z, vOne, _CMP_GE_OQ));
+
+		__m256 fInvZ = _mm256_div_ps(vOne, _mm256_max_ps(Z, vOne));
+		__m256 x = _mm256_mul_ps(X, fInvZ);
+		__m256 y = _mm256_mul_ps(Y, fInvZ);
+		__m256 xy = _mm256_mul_ps(x, y);
+		__m256 r2 = _mm256_fmadd_ps(x, x, _mm256_mul_ps(y, y));
+		__m256 fRadial = _mm256_fmadd_ps(r2, _mm256_fmadd_ps(r2, _mm256_fmadd_ps(r2, vK3, vK2), vK1), vOne);
+		__m256 xd = _mm256_fmadd_ps(x, fRadial, _mm256_fmadd_ps(_mm256_mul_ps(vTwo, vP1), xy, _mm256_mul_ps(vP2, _mm256_fmadd_ps(vTwo, _mm256_mul_ps(x, x), r2))));
+		__m256 yd = _mm256_fmadd_ps(y, fRadial, _mm256_fmadd_ps(_mm256_mul_ps(vTwo, vP2), xy, _mm256_mul_ps(vP1, _mm256_fmadd_ps(vTwo, _mm256_mul_ps(y, y), r2))));
+		__m256 u = _mm256_fmadd_ps(vFx, _mm256_fmadd_ps(vSkew, yd, xd), vCx);
+		__m256 v = _mm256_fmadd_ps(vFy, yd, vCy);
+
+		vValid = _mm256_and_ps(vValid, _mm256_and_ps(_mm256_cmp_ps(u, vLow, _CMP_GE_OQ), _mm256_cmp_ps(u, vMaxU, _CMP_LT_OQ)));
+		vValid = _mm256_and_ps(vValid, _mm256_and_ps(_mm256_cmp_ps(v, vLow, _CMP_GE_OQ), _mm256_cmp_ps(v, vMaxV, _CMP_LT_OQ)));
+
+		_mm256_storeu_ps(m_pColorU + i, _mm256_blendv_ps(vMinus, u, vValid));
+		_mm256_storeu_ps(m_pColorV + i, _mm256_blendv_ps(vMinus, v, vValid));
+		//rounded half up like the scalar tail
+		__m256i z = _mm256_cvttps_epi32(_mm256_and_ps(_mm256_min_ps(_mm256_add_ps(Z, vHalf), vDepthMax), vValid));
+		_mm_storeu_si128((__m128i *)(m_pColorZ + i), _mm_packus_epi32(_mm256_castsi256_si128(z), _mm256_extracti128_si256(z, 1)));
+	}
+#endif
+
+	for (; i < nEnd; i++) {
+		float d = (float)pDepth[i];
+		float Z = d * m_pRayZ[i] + m_fT[2];
+		float u = -1.0f, v = -1.0f;
+		if (pDepth[i] != 0 && Z >= 1.0f) {
+			float X = d * m_pRayX[i] + m_fT[0];
+			float Y = d * m_pRayY[i] + m_fT[1];
+			ceProjectPoint(K, D, X / Z, Y / Z, u, v);
+			if (!(u >= -0.5f && u < fMaxU && v >= -0.5f && v < fMaxV))
+				u = v = -1.0f;
+		}
+		m_pColorU[i] = u;
+		m_pColorV[i] = v;
+		m_pColorZ[i] = u < -0.5f ? 0 : (uint16)(Z + 0.5f > DEPTH_MAX ? DEPTH_MAX : Z + 0.5f);
+	}
+}
+
+void CCubeEyeRegistration::Splat(size_t nBegin, size_t nEnd)
+{
+	int nColorWidth = m_nColorWidth;
+	int nColorHeight = m_nColorHeight;
+
+	for (size_t i = nBegin; i < nEnd; i++) {
+		uint16 z = m_pColorZ[i];
+		if (z == 0)
+			continue;
+
+		//color pixels whose center lies in [u - splat, u + splat) x [v - splat, v + splat), at least the nearest one
+		float u = m_pColorU[i], v = m_pColorV[i];
+		int x0 = (int)ceilf(u - m_fSplatX), x1 = (int)ceilf(u + m_fSplatX) - 1;
+		int y0 = (int)ceilf(v - m_fSplatY), y1 = (int)ceilf(v + m_fSplatY) - 1;
+		if (x1 < x0)
+			x0 = x1 = (int)(u + 0.5f);
+		if (y1 < y0)
+			y0 = y1 = (int)(v + 0.5f);
+		x0 = x0 < 0 ? 0 : x0;
+		y0 = y0 < 0 ? 0 : y0;
+		x1 = x1 >= nColorWidth ? nColorWidth - 1 : x1;
+		y1 = y1 >= nColorHeight ? nColorHeight - 1 : y1;
+
+		for (int y = y0; y <= y1; y++) {
+			std::atomic<uint16> *pRow = m_pZBuffer + (size_t)y * nColorWidth;
+			for (int x = x0; x <= x1; x++) {
+				uint16 nOld = pRow[x].load(std::memory_order_relaxed);
+				while (z < nOld && !pRow[x].compare_exchange_weak(nOld, z, std::memory_order_relaxed)) {
+				}
+			}
+		}
+	}
+}
+
+void CCubeEyeRegistration::Occlusion(size_t nBegin, size_t nEnd)
+{
+	uint32 nOccluded = 0;
+
+	for (size_t i = nBegin; i < nEnd; i++) {
+		uint16 z = m_pColorZ[i];
+		if (z == 0)
+			continue;
+
+		size_t nPixel = (size_t)(int)(m_pColorV[i] + 0.5f) * m_nColorWidth + (int)(m_pColorU[i] + 0.5f);
+		uint16 nFront = m_pZBuffer[nPixel].load(std::memory_order_relaxed);
+		if ((int)z - (int)nFront > (int)m_nOcclusionMargin) {
+			m_pColorU[i] = -1.0f;
+			m_pColorV[i] = -1.0f;
+			nOccluded++;
+		}
+	}
+
+	m_nOccluded.fetch_add(nOccluded, std::memory_order_relaxed);
+}
+
+/*************************************************************************************
+* frame
+*/
+
+int CCubeEyeRegistration::Process(const uint16 *pDepth)
+{
+	if (m_pTable == NULL)
+		return CE_NOT_OPENED;
+	if (pDepth == NULL)
+		return CE_INVALID_PARAM;
+
+	size_t nDepthWidth = m_nDepthWidth;
+	size_t nColorWidth = m_nColorWidth;
+	m_nOccluded.store(0);
+
+	ForRows(m_nDepthHeight, [this, pDepth, nDepthWidth](int nRowBegin, int nRowEnd) {
+		Project(pDepth, nRowBegin * nDepthWidth, nRowEnd * nDepthWidth);
+	});
+	ForRows(m_nDepthHeight, [this, nDepthWidth](int nRowBegin, int nRowEnd) {
+		Splat(nRowBegin * nDepthWidth, nRowEnd * nDepthWidth);
+	});
+	ForRows(m_nDepthHeight, [this, nDepthWidth](int nRowBegin, int nRowEnd) {
+		Occlusion(nRowBegin * nDepthWidth, nRowEnd * nDepthWidth);
+	});
+
+	//aligned depth out of the z-buffer, which is cleared for the next frame on the way
+	ForRows(m_nColorHeight, [this, nColorWidth](int nRowBegin, int nRowEnd) {
+		for (size_t i = nRowBegin * nColorWidth; i < nRowEnd * nColorWidth; i++) {
+			uint16 z = m_pZBuffer[i].load(std::memory_order_relaxed);
+			m_pAligned[i] = z == ZBUFFER_EMPTY ? 0 : z;
+			m_pZBuffer[i].store(ZBUFFER_EMPTY, std::memory_order_relaxed);
+		}
+	});
+
+	return CE_SUCCESS;
+}
+
+int CCubeEyeRegistration::RegisterColor(const uint8 *pColor, int nChannels, uint8 *pOut)
+{
+	if (m_pTable == NULL)
+		return CE_NOT_OPENED;
+	if (pColor == NULL || pOut == NULL || nChannels < 1 || nChannels > 4)
+		return CE_INVALID_PARAM;
+
+	size_t nDepthWidth = m_nDepthWidth;
+	size_t nColorWidth = m_nColorWidth;
+	ForRows(m_nDepthHeight, [=](int nRowBegin, int nRowEnd) {
+		for (size_t i = nRowBegin * nDepthWidth; i < nRowEnd * nDepthWidth; i++) {
+			uint8 *pDst = pOut + i * nChannels;
+			//-1 : no color, valid positions start at -0.5
+			if (m_pColorU[i] < -0.5f) {
+				memset(pDst, 0, nChannels);
+				continue;
+			}
+			size_t nPixel = (size_t)(int)(m_pColorV[i] + 0.5f) * nColorWidth + (int)(m_pColorU[i] + 0.5f);
+			memcpy(pDst, pColor + nPixel * nChannels, nChannels);
+		}
+	});
+
+	return CE_SUCCESS;
+}
+
+}
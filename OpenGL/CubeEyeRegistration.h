@@ -0,0 +1,183 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeRegistration.h											*/
+/*																			*/
+/* @brief	Depth to color registration										*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeLens.h"
+#include "CubeEyeThreadPool.h"
+
+namespace CUBE_EYE
+{
+/**
+*
+*@brief		Depth to color registration
+*@details	Maps every depth pixel into the color image with the extrinsic parameters
+			(Pcolor = R * Pdepth + T) and the lens models of both cameras, and builds the
+			color-aligned depth image.
+			Init precomputes R * ray(u, v) of every depth pixel(undistorted once), so a frame
+			costs one multiply-add per axis, the color lens projection and the splat, with AVX2 /
+			NEON kernels where the build enables them, split over the thread pool.
+
+			Occlusion : each depth pixel is splatted into the color pixels its footprint covers
+			with a z-buffer(nearest wins). A depth pixel whose color position is held by a
+			surface nearer than its own depth minus the occlusion margin is hidden from the
+			color camera and gets no color coordinates.
+*
+*/
+class CCubeEyeRegistration {
+
+public:
+
+	CCubeEyeRegistration();
+	~CCubeEyeRegistration();
+
+	/**
+	*
+	* @brief	Initialize
+	* @param	stDepthIntr, stDepthDist, nDepthWidth, nDepthHeight - depth camera.
+	* @param	stColorIntr, stColorDist, nColorWidth, nColorHeight - color camera.
+	* @param	stExtrinsics - depth to color rotation / translation.
+	* @param	fTranslationToMm - scale of fTx / fTy / fTz to mm(1.0 : already in mm, 1000.0 : in m).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Init(const ceIntrinsicParam &stDepthIntr, const ceDistortionParam &stDepthDist, int nDepthWidth, int nDepthHeight,
+		const ceIntrinsicParam &stColorIntr, const ceDistortionParam &stColorDist, int nColorWidth, int nColorHeight,
+		const ceExtrinsicParam &stExtrinsics, float fTranslationToMm = 1.0f);
+
+	/**
+	*
+	* @brief	Initialize from a connected color model
+	* @details	Reads the color lens and extrinsic parameters from the device. The SDK does not
+				report the color resolution, so it is given here.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	template <class TDevice>
+	int Init(TDevice &device, int nColorWidth, int nColorHeight, float fTranslationToMm = 1.0f)
+	{
+		ceIntrinsicParam stColorIntr;
+		ceDistortionParam stColorDist;
+		ceExtrinsicParam stExtrinsics;
+		int nResult = device.getColorCameraLensParameter(stColorIntr, stColorDist);
+		if (nResult == CE_SUCCESS)
+			nResult = device.getDepthColorExtrinsicParameter(stExtrinsics);
+		if (nResult != CE_SUCCESS)
+			return nResult;
+		return Init(device.pIntrinsicParam, device.pDistortionParam, device.pDevInfo.nWidth, device.pDevInfo.nHeight,
+			stColorIntr, stColorDist, nColorWidth, nColorHeight, stExtrinsics, fTranslationToMm);
+	}
+
+	/**
+	*
+	* @brief	Set thread pool
+	* @details	NULL : single threaded. Default is CCubeEyeThreadPool::Default().
+	* @return	void
+	*
+	*/
+	void SetThreadPool(CCubeEyeThreadPool *pPool) { m_pPool = pPool; }
+
+	/**
+	*
+	* @brief	Occlusion margin
+	* @details	Depth difference tolerated before a depth pixel counts as hidden(unit; mm, default 20).
+	* @return	void
+	*
+	*/
+	void SetOcclusionMargin(uint16 nMarginMm) { m_nOcclusionMargin = nMarginMm; }
+
+	/**
+	*
+	* @brief	Register depth frame
+	* @details	Computes the depth to color map and the color-aligned depth of pDepth.
+	* @param	pDepth - depth frame(unit; mm).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Process(const uint16 *pDepth);
+
+	/*************************************************************************************
+	* \defgroup Results of the last Process
+	* @{
+	*/
+
+	/**
+	*
+	* @brief	Depth to color map
+	* @details	Color image position(u, v) of every depth pixel, -1 where the depth is invalid,
+				the point falls outside the color image or is occluded.
+	*
+	*/
+	const float *getColorU() const { return m_pColorU; }
+	const float *getColorV() const { return m_pColorV; }
+
+	///Color-aligned depth : nColorWidth x nColorHeight, depth along the color camera axis(unit; mm), 0 : none
+	const uint16 *getAlignedDepth() const { return m_pAligned; }
+
+	/**
+	*
+	* @brief	Registered color
+	* @details	Samples the color image at every depth pixel(nearest pixel); 0 where there is no
+				color position.
+	* @param	pColor - nColorWidth x nColorHeight interleaved image of nChannels bytes per pixel.
+	* @param	pOut - nDepthWidth x nDepthHeight x nChannels bytes.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int RegisterColor(const uint8 *pColor, int nChannels, uint8 *pOut);
+
+	///Depth pixels found occluded in the last Process
+	uint32 getOccludedCount() const { return m_nOccluded.load(); }
+
+	/**@}*/
+
+	int getDepthWidth() const { return m_nDepthWidth; }
+	int getDepthHeight() const { return m_nDepthHeight; }
+	int getColorWidth() const { return m_nColorWidth; }
+	int getColorHeight() const { return m_nColorHeight; }
+
+private:
+
+	CCubeEyeRegistration(const CCubeEyeRegistration &);
+	CCubeEyeRegistration &operator=(const CCubeEyeRegistration &);
+
+	void Release();
+	template <class TFunc>
+	void ForRows(int nRows, const TFunc &func);
+
+	void Project(const uint16 *pDepth, size_t nBegin, size_t nEnd);
+	void Splat(size_t nBegin, size_t nEnd);
+	void Occlusion(size_t nBegin, size_t nEnd);
+
+	int m_nDepthWidth;
+	int m_nDepthHeight;
+	int m_nColorWidth;
+	int m_nColorHeight;
+	CCubeEyeThreadPool *m_pPool;
+	uint16 m_nOcclusionMargin;
+
+	ceIntrinsicParam m_stColorIntr;
+	ceDistortionParam m_stColorDist;
+	float m_fT[3];					//translation(unit; mm)
+	float m_fSplatX;				//half footprint of a depth pixel in color pixels
+	float m_fSplatY;
+
+	float *m_pTable;				//owned block : ray planes, then per frame planes
+	const float *m_pRayX;			//R * (x/z, y/z, 1) of every depth pixel
+	const float *m_pRayY;
+	const float *m_pRayZ;
+	float *m_pColorU;
+	float *m_pColorV;
+	uint16 *m_pColorZ;				//depth along the color axis of every depth pixel, 0 : none
+	uint16 *m_pAligned;
+	std::atomic<uint16> *m_pZBuffer;
+	std::atomic<uint32> m_nOccluded;
+};
+
+}
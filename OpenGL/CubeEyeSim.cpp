@@ -0,0 +1,473 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeSim.cpp													*/
+/*																			*/
+/* @brief	Simulated CubeEye device for hardware-free testing				*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeSim.h"
+#include "CubeEyeEmbeddedLine.h"
+
+#include <thread>
+
+namespace CUBE_EYE
+{
+
+#define SIM_MIN_DEPTH	100			//mm
+#define SIM_MAX_DEPTH	5000		//mm
+#define SIM_EDGE_GAP	100			//mm, depth step treated as an object edge
+
+/*************************************************************************************
+* counter based random numbers : value only depends on (seed, frame, pixel, stream)
+*/
+
+static inline uint64 SimHash(uint64 x)
+{
+	//splitmix64 finalizer
+	x += 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+static inline float SimUniform16(uint64 nBits)
+{
+	return (float)(nBits & 0xFFFF) * (1.0f / 65536.0f);
+}
+
+static inline float SimGaussian(uint64 nBits)
+{
+	//sum of four 16 bit uniforms(Irwin-Hall), scaled to unit variance
+	float fSum = (float)((nBits & 0xFFFF) + ((nBits >> 16) & 0xFFFF) + ((nBits >> 32) & 0xFFFF) + (nBits >> 48));
+	return (fSum * (1.0f / 65536.0f) - 2.0f) * 1.7320508f;
+}
+
+/*************************************************************************************
+* scene
+*/
+
+typedef struct _SimScene
+{
+	float fSphereX, fSphereY, fSphereZ, fSphereR;
+
+} SimScene;
+
+static void SimSceneAt(float fTime, SimScene &stScene)
+{
+	//sphere moving left/right in front of the wall
+	stScene.fSphereX = 0.6f * sinf(fTime * 0.8f);
+	stScene.fSphereY = 0.2f;
+	stScene.fSphereZ = 1.8f + 0.3f * cosf(fTime * 0.5f);
+	stScene.fSphereR = 0.35f;
+}
+
+//ray (x, y, 1) against the scene, returns z(unit; m) and reflectivity, z <= 0 : no hit
+static float SimTrace(const SimScene &stScene, float x, float y, float &fReflect)
+{
+	float fZ = 0.0f;
+	fReflect = 0.0f;
+
+	//back wall, slightly tilted : z = 3.2 + 0.15 * X
+	{
+		float t = 3.2f / (1.0f - 0.15f * x);
+		if (t > 0.0f) {
+			fZ = t;
+			fReflect = 0.55f;
+		}
+	}
+
+	//floor : Y = 1.1(camera y axis points down)
+	if (y > 1e-4f) {
+		float t = 1.1f / y;
+		if (fZ <= 0.0f || t < fZ) {
+			fZ = t;
+			fReflect = 0.35f;
+		}
+	}
+
+	//box : [-1.0, -0.5] x [0.4, 1.1] x [2.0, 2.5]
+	{
+		float pMin[3] = { -1.0f, 0.4f, 2.0f };
+		float pMax[3] = { -0.5f, 1.1f, 2.5f };
+		float pDir[3] = { x, y, 1.0f };
+		float tNear = 0.0f, tFar = 1e9f;
+		bool bHit = true;
+		for (int a = 0; a < 3 && bHit; a++) {
+			if (fabsf(pDir[a]) < 1e-9f) {
+				if (0.0f < pMin[a] || 0.0f > pMax[a])
+					bHit = false;
+				continue;
+			}
+			float t0 = pMin[a] / pDir[a];
+			float t1 = pMax[a] / pDir[a];
+			if (t0 > t1) { float tmp = t0; t0 = t1; t1 = tmp; }
+			if (t0 > tNear) tNear = t0;
+			if (t1 < tFar) tFar = t1;
+			if (tNear > tFar)
+				bHit = false;
+		}
+		if (bHit && tNear > 0.0f && (fZ <= 0.0f || tNear < fZ)) {
+			fZ = tNear;
+			fReflect = 0.7f;
+		}
+	}
+
+	//sphere
+	{
+		float cx = stScene.fSphereX;
+		float cy = stScene.fSphereY;
+		float cz = stScene.fSphereZ;
+		float r = stScene.fSphereR;
+		//|t*d - c|^2 = r^2
+		float a = x * x + y * y + 1.0f;
+		float b = -2.0f * (x * cx + y * cy + cz);
+		float c = cx * cx + cy * cy + cz * cz - r * r;
+		float fDisc = b * b - 4.0f * a * c;
+		if (fDisc >= 0.0f) {
+			float t = (-b - sqrtf(fDisc)) / (2.0f * a);
+			if (t > 0.0f && (fZ <= 0.0f || t < fZ)) {
+				fZ = t;
+				fReflect = 0.9f;
+			}
+		}
+	}
+
+	return fZ;
+}
+
+/*************************************************************************************
+* CCubeEyeSim
+*/
+
+CCubeEyeSim::CCubeEyeSim()
+	: m_stConfig(DefaultConfig()), m_bLensSet(false), m_bStarted(false), m_nDeviceNum(0), m_nDataFormat(Format_XYZI),
+	m_nFrameID(0), m_nFrameRate(m_stConfig.nFrameRate)
+{
+}
+
+CCubeEyeSim::~CCubeEyeSim()
+{
+	Disconnect();
+}
+
+ceSimConfig CCubeEyeSim::DefaultConfig()
+{
+	ceSimConfig stConfig;
+	stConfig.nWidth = 640;
+	stConfig.nHeight = 480;
+	stConfig.nFrameRate = FPS_30;
+	stConfig.bRealTime = true;
+	stConfig.fNoiseStdDev = 8.0f;
+	stConfig.fFlyingPixelRate = 0.05f;
+	stConfig.fInvalidPixelRate = 0.005f;
+	stConfig.nSeed = 1;
+	stConfig.nDeviceCount = 1;
+	return stConfig;
+}
+
+int CCubeEyeSim::SetConfig(const ceSimConfig &stConfig)
+{
+	if (m_bConnected)
+		return CE_FAILED;
+	if (stConfig.nWidth <= 0 || stConfig.nHeight <= 0 || stConfig.nDeviceCount < 0)
+		return CE_INVALID_PARAM;
+	if (stConfig.nFrameRate != FPS_30 && stConfig.nFrameRate != FPS_15 && stConfig.nFrameRate != FPS_8)
+		return CE_INVALID_PARAM;
+
+	m_stConfig = stConfig;
+	m_nFrameRate.store(stConfig.nFrameRate, std::memory_order_relaxed);
+	return CE_SUCCESS;
+}
+
+int CCubeEyeSim::SetLensParameter(const ceIntrinsicParam &stIntrinsics, const ceDistortionParam &stDistortion)
+{
+	if (m_bConnected)
+		return CE_FAILED;
+	if (stIntrinsics.fFx <= 0.0f || stIntrinsics.fFy <= 0.0f)
+		return CE_INVALID_PARAM;
+
+	pIntrinsicParam = stIntrinsics;
+	pDistortionParam = stDistortion;
+	m_bLensSet = true;
+	return CE_SUCCESS;
+}
+
+void CCubeEyeSim::SetLogStatus(bool bConsolePrintEnable, bool bLogEnable)
+{
+	(void)bConsolePrintEnable;
+	(void)bLogEnable;
+}
+
+Vector<ceDevicePath> CCubeEyeSim::DeviceSearch()
+{
+	Vector<ceDevicePath> vDevices;
+
+	for (int i = 0; i < m_stConfig.nDeviceCount; i++) {
+		ceDevicePath stPath;
+		memset(&stPath, 0, sizeof(stPath));
+		stPath.szDevNum = (unsigned char)i;
+		snprintf(stPath.szProductName, sizeof(stPath.szProductName), "MR1000-SIM");
+		snprintf(stPath.szDevPath, sizeof(stPath.szDevPath), "sim://%d", i);
+		stPath.data_format = Format_XYZI;
+		vDevices.push_back(stPath);
+	}
+
+	return vDevices;
+}
+
+int CCubeEyeSim::Connect(ceDevicePath pDevPath)
+{
+	if (m_bConnected)
+		return CE_FAILED;
+	if ((int)pDevPath.szDevNum >= m_stConfig.nDeviceCount)
+		return CE_NOT_FOUND;
+	if (pDevPath.data_format > Format_Z)
+		return CE_INVALID_PARAM;
+
+	int nWidth = m_stConfig.nWidth;
+	int nHeight = m_stConfig.nHeight;
+
+	m_nDeviceNum = pDevPath.szDevNum;
+	m_nDataFormat = pDevPath.data_format;
+
+	memset(&pDevInfo, 0, sizeof(pDevInfo));
+	snprintf(pDevInfo.szVendorName, sizeof(pDevInfo.szVendorName), "Simulator");
+	snprintf(pDevInfo.szDevName, sizeof(pDevInfo.szDevName), "CubeEyeSim");
+	memcpy(pDevInfo.szProductName, "MR1000S", 8);
+	snprintf(pDevInfo.szSerialNumber, sizeof(pDevInfo.szSerialNumber), "SIM%08X%02d", m_stConfig.nSeed, m_nDeviceNum);
+	pDevInfo.unFWVersion[0] = 5;
+	pDevInfo.nProductId = (unsigned short)MR1000_PRODUCT_ID;
+	pDevInfo.nDeviceType = 0;
+	pDevInfo.nWidth = (unsigned short)nWidth;
+	pDevInfo.nHeight = (unsigned short)nHeight;
+
+	if (!m_bLensSet) {
+		//about 70 x 55 deg field of view
+		pIntrinsicParam.fFx = nWidth * 0.714f;
+		pIntrinsicParam.fFy = nWidth * 0.714f;
+		pIntrinsicParam.fCx = (nWidth - 1) * 0.5f;
+		pIntrinsicParam.fCy = (nHeight - 1) * 0.5f;
+		memset(&pDistortionParam, 0, sizeof(pDistortionParam));
+	}
+
+	m_vRayX.resize((size_t)nWidth * nHeight);
+	m_vRayY.resize((size_t)nWidth * nHeight);
+	ceBuildRayTable(pIntrinsicParam, pDistortionParam, nWidth, nHeight, &m_vRayX[0], &m_vRayY[0]);
+
+	m_nFrameID = 0;
+	m_bPointCloud = false;
+	m_bConnected = true;
+	return CE_SUCCESS;
+}
+
+void CCubeEyeSim::Disconnect()
+{
+	Stop();
+	m_bConnected = false;
+	m_vRayX.clear();
+	m_vRayY.clear();
+}
+
+int CCubeEyeSim::Start()
+{
+	if (!m_bConnected)
+		return CE_NOT_OPENED;
+
+	m_bStarted = true;
+	m_tNextFrame = std::chrono::steady_clock::now();
+	return CE_SUCCESS;
+}
+
+int CCubeEyeSim::Stop()
+{
+	m_bStarted = false;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeSim::WaitNextFrame(ceFrameInfo &pFrameInfo)
+{
+	if (!m_bStarted)
+		return CE_GETFRAME_FAILED;
+
+	if (m_stConfig.bRealTime) {
+		//FPS_8 is really 7.5 fps
+		uint8 nFrameRate = m_nFrameRate.load(std::memory_order_relaxed);
+		int64 nPeriodUs = (nFrameRate == FPS_8) ? 133333 : 1000000 / nFrameRate;
+		std::this_thread::sleep_until(m_tNextFrame);
+		m_tNextFrame += std::chrono::microseconds(nPeriodUs);
+		//do not try to catch up after a long stall
+		if (m_tNextFrame < std::chrono::steady_clock::now())
+			m_tNextFrame = std::chrono::steady_clock::now();
+	}
+
+	float fTime = m_nFrameID / 30.0f;
+
+	pFrameInfo.nFrameType = m_bPointCloud ? 1 : 0;
+	pFrameInfo.nWidth = m_stConfig.nWidth;
+	pFrameInfo.nHeight = m_stConfig.nHeight;
+	pFrameInfo.nFrameID = m_nFrameID;
+	pFrameInfo.nTimeStamp = ceHostTimeStamp();
+	pFrameInfo.fSensorTemp = 38.0f + 4.0f * (1.0f - expf(-fTime / 120.0f));
+	pFrameInfo.fLDTemp = pFrameInfo.fSensorTemp + 3.5f;
+	pFrameInfo.fIntegrationTime = 0.5f;
+
+	//ceSimEmbeddedLayout
+	typedef ceSimEmbeddedLayout L;
+	uint8 *pLine = pFrameInfo.nEmbeddedLine;
+	memset(pLine, 0, sizeof(pFrameInfo.nEmbeddedLine));
+	L::Magic::Write(pLine, L::MAGIC);
+	L::FrameCounter::Write(pLine, (uint32)m_nFrameID);
+	L::SensorTemp::Write(pLine, pFrameInfo.fSensorTemp);
+	L::LDTemp::Write(pLine, pFrameInfo.fLDTemp);
+	L::IntegrationTime::Write(pLine, (uint16)(pFrameInfo.fIntegrationTime * 1000.0f + 0.5f));
+	L::FrameRate::Write(pLine, m_nFrameRate.load(std::memory_order_relaxed));
+	L::Illumination::Write(pLine, m_bIllumination ? 1 : 0);
+	L::PointCloud::Write(pLine, m_bPointCloud ? 1 : 0);
+	L::Checksum::Write(pLine, ceEmbeddedChecksum(pLine, CE_EMBEDDED_LINE_SIZE - 1));
+
+	return CE_SUCCESS;
+}
+
+void CCubeEyeSim::RenderFrame(long nFrameID, uint16 *pDepth, uint16 *pIR)
+{
+	int nWidth = m_stConfig.nWidth;
+	int nHeight = m_stConfig.nHeight;
+	uint64 nFrameKey = SimHash(((uint64)m_stConfig.nSeed << 32) ^ ((uint64)m_nDeviceNum << 56) ^ (uint64)nFrameID);
+
+	SimScene stScene;
+	SimSceneAt(nFrameID / 30.0f, stScene);
+
+	for (int v = 0; v < nHeight; v++) {
+		for (int u = 0; u < nWidth; u++) {
+			size_t i = (size_t)v * nWidth + u;
+			uint64 nKey = nFrameKey ^ ((uint64)i << 2);
+
+			float fReflect;
+			float fZ = m_bIllumination ? SimTrace(stScene, m_vRayX[i], m_vRayY[i], fReflect) : 0.0f;
+
+			if (fZ <= 0.0f) {
+				pDepth[i] = 0;
+				if (pIR)
+					pIR[i] = 0;
+				continue;
+			}
+
+			uint64 nBits0 = SimHash(nKey);
+			uint64 nBits1 = SimHash(nKey + 1);
+			//IR noise : two 16 bit uniforms(triangular), bits 48~63 : invalid pixel draw
+			float fAmp = fReflect * 1800.0f / (fZ * fZ) + 2.0f * (SimUniform16(nBits1) + SimUniform16(nBits1 >> 16) - 1.0f) * 2.449f;
+			float fDepth = fZ * 1000.0f + m_stConfig.fNoiseStdDev * SimGaussian(nBits0) + m_nDepthOffset;
+
+			fAmp = fAmp < 0.0f ? 0.0f : (fAmp > 4095.0f ? 4095.0f : fAmp);
+			if (pIR)
+				pIR[i] = (uint16)fAmp;
+
+			if (fDepth < SIM_MIN_DEPTH || fDepth > SIM_MAX_DEPTH || fAmp < m_nAmplitudeThreshold
+				|| SimUniform16(nBits1 >> 48) < m_stConfig.fInvalidPixelRate)
+				pDepth[i] = 0;
+			else
+				pDepth[i] = (uint16)(fDepth + 0.5f);
+		}
+	}
+
+	//flying pixels : mix of foreground and background across depth edges
+	if (m_stConfig.fFlyingPixelRate > 0.0f) {
+		for (int v = 0; v < nHeight - 1; v++) {
+			for (int u = 0; u < nWidth - 1; u++) {
+				size_t i = (size_t)v * nWidth + u;
+				int a = pDepth[i], b = pDepth[i + 1], c = pDepth[i + nWidth];
+				int n = (abs(a - b) > abs(a - c)) ? b : c;
+				if (a == 0 || n == 0 || abs(a - n) < SIM_EDGE_GAP)
+					continue;
+
+				uint64 nKey = nFrameKey ^ ((uint64)i << 2);
+				uint64 nBits = SimHash(nKey + 3);
+				if (SimUniform16(nBits) < m_stConfig.fFlyingPixelRate) {
+					float fMix = SimUniform16(nBits >> 16);
+					pDepth[i] = (uint16)(a + (n - a) * fMix);
+				}
+			}
+		}
+	}
+}
+
+int CCubeEyeSim::ReadDepthIRFrame(uint16 *pDepth, uint16 *pIR, ceFrameInfo &pFrameInfo)
+{
+	if (!m_bConnected)
+		return CE_NOT_OPENED;
+	if (m_bPointCloud)
+		return CE_UNSUPPORTED;
+	if (pDepth == NULL || (pIR == NULL && m_nDataFormat != Format_Z))
+		return CE_INVALID_PARAM;
+
+	int nResult = WaitNextFrame(pFrameInfo);
+	if (nResult != CE_SUCCESS)
+		return nResult;
+
+	//Format_Z : no IR on the bus, pIR is left as it is
+	RenderFrame(m_nFrameID++, pDepth, m_nDataFormat == Format_Z ? NULL : pIR);
+	return CE_SUCCESS;
+}
+
+int CCubeEyeSim::ReadPCLFrame(cePointCloud *pPCLFrame, ceFrameInfo &pFrameInfo)
+{
+	if (!m_bConnected)
+		return CE_NOT_OPENED;
+	if (!m_bPointCloud || m_nDataFormat != Format_XYZI)
+		return CE_UNSUPPORTED;
+	if (pPCLFrame == NULL)
+		return CE_INVALID_PARAM;
+
+	int nResult = WaitNextFrame(pFrameInfo);
+	if (nResult != CE_SUCCESS)
+		return nResult;
+
+	size_t nSize = (size_t)m_stConfig.nWidth * m_stConfig.nHeight;
+	m_vDepth.resize(nSize);
+	m_vIR.resize(nSize);
+	RenderFrame(m_nFrameID++, &m_vDepth[0], &m_vIR[0]);
+
+	for (size_t i = 0; i < nSize; i++) {
+		float fZ = m_vDepth[i] * 0.001f;
+		pPCLFrame[i].fX = m_vRayX[i] * fZ;
+		pPCLFrame[i].fY = m_vRayY[i] * fZ;
+		pPCLFrame[i].fZ = fZ;
+		pPCLFrame[i].fI = m_vIR[i];
+	}
+	return CE_SUCCESS;
+}
+
+int CCubeEyeSim::getDepthCameraLensParameter(ceIntrinsicParam &pfIntrinsics, ceDistortionParam &pDistortionCoeff)
+{
+	if (!m_bConnected)
+		return CE_NOT_OPENED;
+	pfIntrinsics = pIntrinsicParam;
+	pDistortionCoeff = pDistortionParam;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeSim::getDepthRange(uint16 &nMaxDepth, uint16 &nMinDepth)
+{
+	nMaxDepth = SIM_MAX_DEPTH;
+	nMinDepth = SIM_MIN_DEPTH;
+	return CE_SUCCESS;
+}
+
+int CCubeEyeSim::setFrameRate(uint8 nFrameRate)
+{
+	if (nFrameRate != FPS_30 && nFrameRate != FPS_15 && nFrameRate != FPS_8)
+		return CE_INVALID_PARAM;
+	m_nFrameRate.store(nFrameRate, std::memory_order_relaxed);
+	return CE_SUCCESS;
+}
+
+int CCubeEyeSim::getFrameRate(uint8 &nFrameRate)
+{
+	nFrameRate = m_nFrameRate.load(std::memory_order_relaxed);
+	return CE_SUCCESS;
+}
+
+}
@@ -0,0 +1,184 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeSim.h													*/
+/*																			*/
+/* @brief	Simulated CubeEye device for hardware-free testing				*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeLens.h"
+#include "CubeEyeDeviceBase.h"
+
+#include <atomic>
+#include <chrono>
+
+namespace CUBE_EYE
+{
+
+///Simulated scene / device configuration
+typedef struct _ceSimConfig
+{
+	///Frame Width
+	int nWidth;
+	///Frame Height
+	int nHeight;
+	///FPS_30, FPS_15, FPS_8 at Connect(setFrameRate changes it while streaming)
+	uint8 nFrameRate;
+	///false : frames are returned as fast as they are read(benchmark mode)
+	bool bRealTime;
+	///Depth noise standard deviation(unit; mm)
+	float fNoiseStdDev;
+	///Ratio(0 ~ 1) of depth edge pixels turned into flying pixels
+	float fFlyingPixelRate;
+	///Ratio(0 ~ 1) of pixels dropped to 0(invalid)
+	float fInvalidPixelRate;
+	///Random seed - same seed, same frame sequence
+	uint32 nSeed;
+	///Number of simulated devices returned by DeviceSearch
+	int nDeviceCount;
+
+} ceSimConfig;
+
+/**
+*
+*@brief		Simulated CubeEye device
+*@details	Exposes the same methods as CCubeEye so that processing code written against
+			CCubeEye can be compiled against this class instead(directly or as a template
+			parameter, e.g. CCubeEyeFrameRing::StartCapture).
+			Frames are a synthetic room(back wall, floor, a moving sphere and a box) with
+			gaussian depth noise, flying pixels and invalid pixels. The frame content only
+			depends on nSeed and the frame number, so runs are repeatable.
+*
+*/
+class CCubeEyeSim : public CCubeEyeDeviceBase {
+
+public:
+
+	/*************************************************************************************
+	* \defgroup Initialization
+	* @{
+	*/
+
+	CCubeEyeSim();
+	~CCubeEyeSim();
+
+	/**
+	*
+	* @brief	Default configuration
+	* @details	640x480, 30 fps, real time, 8mm noise, 5% flying pixels, 0.5% invalid pixels.
+	* @return	configuration
+	*
+	*/
+	static ceSimConfig DefaultConfig();
+
+	/**
+	*
+	* @brief	Set simulation configuration
+	* @details	Must be called before Connect.
+	* @param	stConfig - simulation configuration.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetConfig(const ceSimConfig &stConfig);
+
+	const ceSimConfig &GetConfig() const { return m_stConfig; }
+
+	/**
+	*
+	* @brief	Set simulated lens parameters
+	* @details	Overrides the default pinhole lens(no distortion). Must be called before Connect.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetLensParameter(const ceIntrinsicParam &stIntrinsics, const ceDistortionParam &stDistortion);
+
+	void SetLogStatus(bool bConsolePrintEnable = true, bool bLogEnable = false);
+
+	Vector<ceDevicePath> DeviceSearch();
+
+	int Connect(ceDevicePath pDevPath);
+
+	void Disconnect();
+
+	/**@}*/
+
+	/*************************************************************************************
+	* \defgroup Start/Stop Frame
+	* @{
+	*/
+
+	int Start();
+
+	int Stop();
+
+	/**@}*/
+
+	/*************************************************************************************
+	* \defgroup Read ToF Frame
+	* @{
+	*/
+
+	/**
+	*
+	* @brief	Read Depth/IR Frame.
+	* @details	Renders the next frame into pDepth / pIR. In real time mode the call blocks
+				until the frame is due. nTimeStamp is the host steady clock(unit; us). Connected
+				in Format_Z, pIR is not written and may be NULL.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int ReadDepthIRFrame(uint16 *pDepth, uint16 *pIR, ceFrameInfo &pFrameInfo);
+
+	/**
+	*
+	* @brief	Read PCL Frame.
+	* @details	Renders the next frame as a point cloud(available after setDepthToPointCloud,
+				connected in Format_XYZI).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int ReadPCLFrame(cePointCloud *pPCLFrame, ceFrameInfo &pFrameInfo);
+
+	/**@}*/
+
+	/*************************************************************************************
+	* \defgroup Set/Get ToF Parameters
+	* @{
+	*/
+
+	int getDepthCameraLensParameter(ceIntrinsicParam &pfIntrinsics, ceDistortionParam &pDistortionCoeff);
+	int getDepthRange(uint16 &nMaxDepth, uint16 &nMinDepth);
+	int setFrameRate(uint8 nFrameRate);
+	int getFrameRate(uint8 &nFrameRate);
+
+	/**@}*/
+
+private:
+
+	CCubeEyeSim(const CCubeEyeSim &);
+	CCubeEyeSim &operator=(const CCubeEyeSim &);
+
+	int WaitNextFrame(ceFrameInfo &pFrameInfo);
+	void RenderFrame(long nFrameID, uint16 *pDepth, uint16 *pIR);
+
+	ceSimConfig m_stConfig;
+	bool m_bLensSet;
+
+	bool m_bStarted;
+	int m_nDeviceNum;
+	uint8 m_nDataFormat;			//data_format of the ceDevicePath given to Connect
+	long m_nFrameID;
+	std::atomic<uint8> m_nFrameRate;		//setFrameRate may run beside the capture thread
+
+	std::chrono::steady_clock::time_point m_tNextFrame;
+
+	Vector<float> m_vRayX;			//normalized ray per pixel(x/z, y/z)
+	Vector<float> m_vRayY;
+	Vector<uint16> m_vDepth;		//scratch for ReadPCLFrame
+	Vector<uint16> m_vIR;
+};
+
+}
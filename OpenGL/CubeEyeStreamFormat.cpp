@@ -0,0 +1,194 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeStreamFormat.cpp											*/
+/*																			*/
+/* @brief	Lightest data_format for the consumers, host XYZ on demand		*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeStreamFormat.h"
+
+namespace CUBE_EYE
+{
+
+#define NEED_MASK		(Need_Depth | Need_IR | Need_XYZ | Need_DeviceXYZ)
+
+/*************************************************************************************
+* CCubeEyeStreamFormat
+*/
+
+CCubeEyeStreamFormat::CCubeEyeStreamFormat()
+	: m_nNeeds(0), m_nConnectedFormat(Format_XYZI)
+{
+}
+
+CCubeEyeStreamFormat::~CCubeEyeStreamFormat()
+{
+}
+
+int CCubeEyeStreamFormat::Require(uint32 nNeeds)
+{
+	if (nNeeds & ~(uint32)NEED_MASK)
+		return CE_INVALID_PARAM;
+
+	m_nNeeds |= nNeeds;
+	return CE_SUCCESS;
+}
+
+data_format CCubeEyeStreamFormat::SelectFormat() const
+{
+	if (m_nNeeds & Need_DeviceXYZ)
+		return Format_XYZI;
+	if (m_nNeeds & Need_IR)
+		return Format_ZI;
+	return Format_Z;
+}
+
+size_t CCubeEyeStreamFormat::getFrameBytes(data_format nFormat, int nWidth, int nHeight)
+{
+	size_t nPlanes;
+	switch (nFormat) {
+	case Format_XYZI: nPlanes = 4; break;
+	case Format_ZI: nPlanes = 2; break;
+	case Format_Z: nPlanes = 1; break;
+	default: return 0;
+	}
+	return nPlanes * nWidth * nHeight * sizeof(uint16);
+}
+
+int CCubeEyeStreamFormat::SetCamera(const ceIntrinsicParam &stIntr, const ceDistortionParam &stDist, int nWidth, int nHeight)
+{
+	return m_converter.Init(stIntr, stDist, nWidth, nHeight);
+}
+
+/*************************************************************************************
+* CCubeEyeHostFrame
+*/
+
+CCubeEyeHostFrame::CCubeEyeHostFrame()
+	: m_pConverter(NULL), m_pDepth(NULL), m_pIR(NULL), m_nWidth(0), m_nHeight(0),
+	m_nCapacity(0), m_pPlanes(NULL), m_pPoints(NULL), m_bPlanes(false), m_bPoints(false)
+{
+	memset(&m_stFrameInfo, 0, sizeof(m_stFrameInfo));
+}
+
+CCubeEyeHostFrame::~CCubeEyeHostFrame()
+{
+	Release();
+}
+
+void CCubeEyeHostFrame::Release()
+{
+	ceAlignedFree(m_pPlanes);
+	ceAlignedFree(m_pPoints);
+	m_pPlanes = NULL;
+	m_pPoints = NULL;
+	m_nCapacity = 0;
+}
+
+int CCubeEyeHostFrame::Bind(const CCubeEyeStreamFormat &format, const uint16 *pDepth, const uint16 *pIR, const ceFrameInfo &stFrameInfo)
+{
+	if (pDepth == NULL || stFrameInfo.nWidth <= 0 || stFrameInfo.nHeight <= 0)
+		return CE_INVALID_PARAM;
+
+	const CCubeEyeDepthToPCL &converter = format.getConverter();
+	if (converter.IsInitialized() && (converter.getWidth() != stFrameInfo.nWidth || converter.getHeight() != stFrameInfo.nHeight))
+		return CE_INVALID_PARAM;
+
+	size_t nPixels = (size_t)stFrameInfo.nWidth * stFrameInfo.nHeight;
+	if (nPixels > m_nCapacity) {
+		//the conversions allocate on first use
+		Release();
+		m_nCapacity = nPixels;
+	}
+
+	m_pConverter = converter.IsInitialized() ? &converter : NULL;
+	m_pDepth = pDepth;
+	m_pIR = CCubeEyeStreamFormat::HasIR(format.getConnectedFormat()) ? pIR : NULL;
+	m_stFrameInfo = stFrameInfo;
+	m_nWidth = stFrameInfo.nWidth;
+	m_nHeight = stFrameInfo.nHeight;
+	m_bPlanes.store(false, std::memory_order_relaxed);
+	m_bPoints.store(false, std::memory_order_relaxed);
+	return CE_SUCCESS;
+}
+
+int CCubeEyeHostFrame::Bind(const CCubeEyeStreamFormat &format, const CCubeEyeFrameRing::CFrameRef &frame)
+{
+	if (!frame.IsValid())
+		return CE_INVALID_PARAM;
+	return Bind(format, frame.getDepth(), frame.getIR(), frame.getFrameInfo());
+}
+
+bool CCubeEyeHostFrame::BuildPlanes()
+{
+	if (m_bPlanes.load(std::memory_order_acquire))
+		return true;
+	if (m_pConverter == NULL)
+		return false;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_bPlanes.load(std::memory_order_relaxed))
+		return true;
+
+	if (m_pPlanes == NULL) {
+		m_pPlanes = (float *)ceAlignedAlloc(m_nCapacity * 3 * sizeof(float));
+		if (m_pPlanes == NULL)
+			return false;
+	}
+
+	size_t nPixels = (size_t)m_nWidth * m_nHeight;
+	if (m_pConverter->Convert(m_pDepth, NULL, m_pPlanes, m_pPlanes + nPixels, m_pPlanes + 2 * nPixels, NULL) != CE_SUCCESS)
+		return false;
+
+	m_bPlanes.store(true, std::memory_order_release);
+	return true;
+}
+
+bool CCubeEyeHostFrame::BuildPointCloud()
+{
+	if (m_bPoints.load(std::memory_order_acquire))
+		return true;
+	if (m_pConverter == NULL)
+		return false;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_bPoints.load(std::memory_order_relaxed))
+		return true;
+
+	if (m_pPoints == NULL) {
+		m_pPoints = (cePointCloud *)ceAlignedAlloc(m_nCapacity * sizeof(cePointCloud));
+		if (m_pPoints == NULL)
+			return false;
+	}
+
+	if (m_pConverter->Convert(m_pDepth, m_pIR, m_pPoints) != CE_SUCCESS)
+		return false;
+
+	m_bPoints.store(true, std::memory_order_release);
+	return true;
+}
+
+const float *CCubeEyeHostFrame::getX()
+{
+	return BuildPlanes() ? m_pPlanes : NULL;
+}
+
+const float *CCubeEyeHostFrame::getY()
+{
+	return BuildPlanes() ? m_pPlanes + (size_t)m_nWidth * m_nHeight : NULL;
+}
+
+const float *CCubeEyeHostFrame::getZ()
+{
+	return BuildPlanes() ? m_pPlanes + 2 * (size_t)m_nWidth * m_nHeight : NULL;
+}
+
+const cePointCloud *CCubeEyeHostFrame::getPointCloud()
+{
+	return BuildPointCloud() ? m_pPoints : NULL;
+}
+
+}
@@ -0,0 +1,256 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeStreamFormat.h											*/
+/*																			*/
+/* @brief	Lightest data_format for the consumers, host XYZ on demand		*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeDepthToPCL.h"
+#include "CubeEyeFrameRing.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace CUBE_EYE
+{
+
+///Data a consumer reads from the stream(flags)
+enum stream_need {
+	///Depth(unit; mm)
+	Need_Depth = 0x01,
+	///IR / amplitude
+	Need_IR = 0x02,
+	///X, Y, Z, reconstructed on the host from depth and the lens rays
+	Need_XYZ = 0x04,
+	///X, Y, Z computed by the device(ReadPCLFrame); forces Format_XYZI
+	Need_DeviceXYZ = 0x08,
+};
+
+/**
+*
+*@brief		Stream format selection
+*@details	Every consumer stage states what it reads with Require; SelectFormat then gives
+			the lightest data_format that carries it and Connect requests it from the device :
+				Format_Z	: depth only, also enough for host XYZ(1 plane),
+				Format_ZI	: depth and IR(2 planes),
+				Format_XYZI	: only when a consumer needs the device point cloud(4 planes).
+			The frame on the bus and every SDK copy shrink with it, by 2x(ZI) or 4x(Z) against
+			Format_XYZI, which matters when several cameras share a USB hub.
+
+			X, Y, Z are rebuilt on the host by a CCubeEyeHostFrame, only when a stage asks for
+			them, with the ray table of the CCubeEyeDepthToPCL owned here. In Format_Z the
+			device does not send IR : ReadDepthIRFrame leaves pIR unchanged and
+			CCubeEyeHostFrame::getIR returns NULL.
+*
+*/
+class CCubeEyeStreamFormat {
+
+public:
+
+	CCubeEyeStreamFormat();
+	~CCubeEyeStreamFormat();
+
+	/**
+	*
+	* @brief	Add consumer needs
+	* @details	Called once per consumer stage before Connect; the needs add up. Needs added
+				after Connect only apply to the next Connect; frames are bound with the
+				connected format until then.
+	* @param	nNeeds - stream_need flags.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Require(uint32 nNeeds);
+
+	///Drops every need(depth only)
+	void Clear() { m_nNeeds = 0; }
+
+	uint32 getNeeds() const { return m_nNeeds; }
+
+	/**
+	*
+	* @brief	Select format
+	* @details	Lightest data_format carrying every need.
+	* @return	Format_Z | Format_ZI | Format_XYZI
+	*
+	*/
+	data_format SelectFormat() const;
+
+	/**
+	*
+	* @brief	Connected format
+	* @details	data_format of the last successful Connect, which the device streams and
+				CCubeEyeHostFrame::Bind reads. Format_XYZI(device default) before any Connect.
+	* @return	Format_Z | Format_ZI | Format_XYZI
+	*
+	*/
+	data_format getConnectedFormat() const { return m_nConnectedFormat; }
+
+	///Whether frames of nFormat carry IR
+	static bool HasIR(data_format nFormat) { return nFormat != Format_Z; }
+
+	/**
+	*
+	* @brief	Bytes per frame on the bus
+	* @details	Depth / IR / X / Y planes of 2 byte samples sent by the device for nFormat.
+	* @return	bytes | 0 : unknown format
+	*
+	*/
+	static size_t getFrameBytes(data_format nFormat, int nWidth, int nHeight);
+
+	/**
+	*
+	* @brief	Set depth camera
+	* @details	Builds the ray table used for host XYZ. Connect does it from the device.
+	* @param	stIntr, stDist - lens parameters(pIntrinsicParam / pDistortionParam).
+	* @param	nWidth, nHeight - frame size.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetCamera(const ceIntrinsicParam &stIntr, const ceDistortionParam &stDist, int nWidth, int nHeight);
+
+	template <class TDevice>
+	int SetCamera(const TDevice &device)
+	{
+		return SetCamera(device.pIntrinsicParam, device.pDistortionParam, device.pDevInfo.nWidth, device.pDevInfo.nHeight);
+	}
+
+	/**
+	*
+	* @brief	Connect device in the selected format
+	* @details	Sets data_format of stPath to SelectFormat, connects the device(CCubeEye,
+				CCubeEyeSim), records the format as the connected one and, when a consumer
+				needs host XYZ, builds the ray table from it.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	template <class TDevice>
+	int Connect(TDevice &device, ceDevicePath stPath)
+	{
+		data_format nFormat = SelectFormat();
+		stPath.data_format = (uint8)nFormat;
+
+		int nResult = device.Connect(stPath);
+		if (nResult != CE_SUCCESS)
+			return nResult;
+		m_nConnectedFormat = nFormat;
+		if (m_nNeeds & Need_XYZ)
+			return SetCamera(device);
+		return CE_SUCCESS;
+	}
+
+	/**
+	*
+	* @brief	Set thread pool
+	* @details	Used for host XYZ. NULL : single threaded. Default is CCubeEyeThreadPool::Default().
+	* @return	void
+	*
+	*/
+	void SetThreadPool(CCubeEyeThreadPool *pPool) { m_converter.SetThreadPool(pPool); }
+
+	const CCubeEyeDepthToPCL &getConverter() const { return m_converter; }
+
+private:
+
+	CCubeEyeStreamFormat(const CCubeEyeStreamFormat &);
+	CCubeEyeStreamFormat &operator=(const CCubeEyeStreamFormat &);
+
+	uint32 m_nNeeds;
+	data_format m_nConnectedFormat;		//format the device streams
+	CCubeEyeDepthToPCL m_converter;
+};
+
+/**
+*
+*@brief		Frame with host XYZ on demand
+*@details	Wraps a Depth(/IR) frame of a CCubeEyeStreamFormat stream. X, Y, Z planes and the
+			cePointCloud layout of ReadPCLFrame are each built on the first call that asks for
+			them and kept until the next Bind, so stages that never touch XYZ cost nothing and
+			stages that share a frame convert it once. The getters may be called from several
+			threads; Bind may not run concurrently with them. Buffers are allocated once and
+			reused for every frame.
+*
+*/
+class CCubeEyeHostFrame {
+
+public:
+
+	CCubeEyeHostFrame();
+	~CCubeEyeHostFrame();
+
+	/**
+	*
+	* @brief	Bind frame
+	* @details	The frame buffers are referenced, not copied, and must stay valid until the
+				next Bind. pIR is ignored when the connected format has no IR.
+	* @param	format - stream the frame comes from; must outlive the frame.
+	* @param	pDepth - depth frame(unit; mm).
+	* @param	pIR - IR frame.
+	* @param	stFrameInfo - frame information.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Bind(const CCubeEyeStreamFormat &format, const uint16 *pDepth, const uint16 *pIR, const ceFrameInfo &stFrameInfo);
+
+	///Binds a borrowed ring slot, which must stay borrowed until the next Bind
+	int Bind(const CCubeEyeStreamFormat &format, const CCubeEyeFrameRing::CFrameRef &frame);
+
+	const uint16 *getDepth() const { return m_pDepth; }
+	///IR frame, NULL : Format_Z
+	const uint16 *getIR() const { return m_pIR; }
+	const ceFrameInfo &getFrameInfo() const { return m_stFrameInfo; }
+
+	/**
+	*
+	* @brief	Host X / Y / Z planes
+	* @details	Converted on the first call for the bound frame(unit; m, depth 0 : (0, 0, 0)).
+	* @return	plane | NULL : no frame bound, no ray table(Need_XYZ was not required) or
+				out of memory
+	*
+	*/
+	const float *getX();
+	const float *getY();
+	const float *getZ();
+
+	/**
+	*
+	* @brief	Host point cloud
+	* @details	Same layout as ReadPCLFrame(fI = 0 without IR), converted on the first call.
+	* @return	nWidth x nHeight points | NULL : see getX
+	*
+	*/
+	const cePointCloud *getPointCloud();
+
+	int getWidth() const { return m_nWidth; }
+	int getHeight() const { return m_nHeight; }
+
+private:
+
+	CCubeEyeHostFrame(const CCubeEyeHostFrame &);
+	CCubeEyeHostFrame &operator=(const CCubeEyeHostFrame &);
+
+	bool BuildPlanes();
+	bool BuildPointCloud();
+	void Release();
+
+	const CCubeEyeDepthToPCL *m_pConverter;
+	const uint16 *m_pDepth;
+	const uint16 *m_pIR;
+	ceFrameInfo m_stFrameInfo;
+	int m_nWidth;
+	int m_nHeight;
+
+	size_t m_nCapacity;				//pixels of the buffers below
+	float *m_pPlanes;				//X, Y, Z planes
+	cePointCloud *m_pPoints;
+
+	std::mutex m_mutex;				//serializes the conversions
+	std::atomic<bool> m_bPlanes;
+	std::atomic<bool> m_bPoints;
+};
+
+}
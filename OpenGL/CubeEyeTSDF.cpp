@@ -0,0 +1,306 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeTSDF.cpp													*/
+/*																			*/
+/* @brief	Truncated signed distance volume fusion							*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeTSDF.h"
+
+#include <math.h>
+
+namespace CUBE_EYE
+{
+
+#define MIN_VOXEL_Z		0.01f		//voxels nearer than this(unit; m) are not projected
+#define FRUSTUM_MARGIN	0.25f		//row clipping margin(fraction of the image size) for the lens distortion
+
+CCubeEyeTSDF::CCubeEyeTSDF()
+	: m_stConfig(DefaultConfig()), m_pPool(&CCubeEyeThreadPool::Default()), m_tsdf(1, 1, 1), m_weight(1, 1, 1),
+	m_nWidth(0), m_nHeight(0), m_pDepth(NULL), m_nUpdated(0), m_nFrames(0)
+{
+	memset(&m_stIntr, 0, sizeof(m_stIntr));
+	memset(&m_stDist, 0, sizeof(m_stDist));
+	memset(m_fWorldToCam, 0, sizeof(m_fWorldToCam));
+}
+
+CCubeEyeTSDF::~CCubeEyeTSDF()
+{
+	if (m_pDepth != NULL)
+		ceAlignedFree(m_pDepth);
+}
+
+ceTSDFConfig CCubeEyeTSDF::DefaultConfig()
+{
+	ceTSDFConfig stConfig;
+	stConfig.nSizeX = 256;
+	stConfig.nSizeY = 256;
+	stConfig.nSizeZ = 256;
+	stConfig.fVoxelSize = 0.004f;
+	stConfig.fOrigin[0] = -0.512f;
+	stConfig.fOrigin[1] = -0.512f;
+	stConfig.fOrigin[2] = 0.5f;
+	stConfig.fTruncation = 0.016f;
+	stConfig.fMaxWeight = 64.0f;
+	stConfig.fMinDepth = 0.1f;
+	stConfig.fMaxDepth = 4.0f;
+	return stConfig;
+}
+
+int CCubeEyeTSDF::Init(const ceTSDFConfig &stConfig)
+{
+	if (stConfig.nSizeX <= 0 || stConfig.nSizeY <= 0 || stConfig.nSizeZ <= 0)
+		return CE_INVALID_PARAM;
+	if (!(stConfig.fVoxelSize > 0.0f) || !(stConfig.fTruncation > 0.0f) || !(stConfig.fMaxWeight >= 1.0f))
+		return CE_INVALID_PARAM;
+	if (!(stConfig.fMinDepth >= 0.0f) || !(stConfig.fMaxDepth > stConfig.fMinDepth))
+		return CE_INVALID_PARAM;
+	//glh::array3 indexes with int
+	if ((int64)stConfig.nSizeX * stConfig.nSizeY * stConfig.nSizeZ > 0x7FFFFFFF)
+		return CE_OUTOFRANGE;
+
+	m_stConfig = stConfig;
+	m_tsdf.set_size(stConfig.nSizeX, stConfig.nSizeY, stConfig.nSizeZ);
+	m_weight.set_size(stConfig.nSizeX, stConfig.nSizeY, stConfig.nSizeZ);
+	Reset();
+	return CE_SUCCESS;
+}
+
+int CCubeEyeTSDF::SetCamera(const ceIntrinsicParam &stIntr, const ceDistortionParam &stDist, int nWidth, int nHeight)
+{
+	if (nWidth <= 0 || nHeight <= 0 || !(stIntr.fFx > 0.0f) || !(stIntr.fFy > 0.0f))
+		return CE_INVALID_PARAM;
+
+	if (m_pDepth == NULL || nWidth * nHeight > m_nWidth * m_nHeight) {
+		float *pDepth = (float *)ceAlignedAlloc((size_t)nWidth * nHeight * sizeof(float));
+		if (pDepth == NULL)
+			return CE_FAILED;
+		if (m_pDepth != NULL)
+			ceAlignedFree(m_pDepth);
+		m_pDepth = pDepth;
+	}
+
+	m_stIntr = stIntr;
+	m_stDist = stDist;
+	m_nWidth = nWidth;
+	m_nHeight = nHeight;
+	return CE_SUCCESS;
+}
+
+void CCubeEyeTSDF::Reset()
+{
+	m_tsdf.clear(1.0f);
+	m_weight.clear(0.0f);
+	m_nUpdated.store(0);
+	m_nFrames = 0;
+}
+
+int CCubeEyeTSDF::Integrate(const uint16 *pDepth, const glh::matrix4f &pose)
+{
+	if (pDepth == NULL)
+		return CE_INVALID_PARAM;
+	if (m_pDepth == NULL)
+		return CE_NOT_OPENED;
+
+	glh::matrix4f worldToCam = pose.inverse();
+	for (int r = 0; r < 3; r++) {
+		for (int c = 0; c < 4; c++)
+			m_fWorldToCam[r * 4 + c] = worldToCam(r, c);
+	}
+
+	//depth in m, out of range pixels cleared
+	const uint16 nMin = (uint16)ceilf(m_stConfig.fMinDepth * 1000.0f);
+	const uint16 nMax = (uint16)(m_stConfig.fMaxDepth * 1000.0f < 65535.0f ? m_stConfig.fMaxDepth * 1000.0f : 65535.0f);
+	size_t nPixels = (size_t)m_nWidth * m_nHeight;
+	for (size_t i = 0; i < nPixels; i++)
+		m_pDepth[i] = (pDepth[i] >= nMin && pDepth[i] <= nMax) ? pDepth[i] * 0.001f : 0.0f;
+
+	m_nUpdated.store(0);
+	auto slabs = [this](int nBegin, int nEnd) {
+		for (int k = nBegin; k < nEnd; k++)
+			IntegrateSlab(k);
+	};
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, m_stConfig.nSizeZ, 1, slabs);
+	else
+		slabs(0, m_stConfig.nSizeZ);
+
+	m_nFrames++;
+	return CE_SUCCESS;
+}
+
+/*************************************************************************************
+* slab / row kernels
+*/
+
+void CCubeEyeTSDF::IntegrateSlab(int k)
+{
+	const float *M = m_fWorldToCam;
+	const float fVoxel = m_stConfig.fVoxelSize;
+	const int nSizeX = m_stConfig.nSizeX;
+	float fStep[3] = { M[0] * fVoxel, M[4] * fVoxel, M[8] * fVoxel };
+	float fWorld[3];
+	fWorld[0] = m_stConfig.fOrigin[0] + 0.5f * fVoxel;
+	fWorld[2] = m_stConfig.fOrigin[2] + (k + 0.5f) * fVoxel;
+	uint64 nUpdated = 0;
+
+	for (int j = 0; j < m_stConfig.nSizeY; j++) {
+		fWorld[1] = m_stConfig.fOrigin[1] + (j + 0.5f) * fVoxel;
+		float fP0[3];
+		for (int r = 0; r < 3; r++)
+			fP0[r] = M[r * 4] * fWorld[0] + M[r * 4 + 1] * fWorld[1] + M[r * 4 + 2] * fWorld[2] + M[r * 4 + 3];
+
+		int nBegin = 0, nEnd = nSizeX;
+		if (!ClipRow(fP0, fStep, nBegin, nEnd))
+			continue;
+		nUpdated += UpdateRow(&m_tsdf(0, j, k), &m_weight(0, j, k), fP0, fStep, nBegin, nEnd);
+	}
+
+	m_nUpdated.fetch_add(nUpdated, std::memory_order_relaxed);
+}
+
+bool CCubeEyeTSDF::ClipRow(const float *pP0, const float *pStep, int &nBegin, int &nEnd) const
+{
+	//every frustum plane is a + b * i >= 0 along the row
+	const ceIntrinsicParam &K = m_stIntr;
+	const float fMarginU = FRUSTUM_MARGIN * m_nWidth, fMarginV = FRUSTUM_MARGIN * m_nHeight;
+	const float fMaxZ = m_stConfig.fMaxDepth + m_stConfig.fTruncation;
+	const float fLeft = K.fCx + fMarginU, fRight = m_nWidth - 1 + fMarginU - K.fCx;
+	const float fTop = K.fCy + fMarginV, fBottom = m_nHeight - 1 + fMarginV - K.fCy;
+	const float fPlane[6][4] = {
+		{ 0.0f, 0.0f, 1.0f, -MIN_VOXEL_Z },
+		{ 0.0f, 0.0f, -1.0f, fMaxZ },
+		{ K.fFx, 0.0f, fLeft, 0.0f },
+		{ -K.fFx, 0.0f, fRight, 0.0f },
+		{ 0.0f, K.fFy, fTop, 0.0f },
+		{ 0.0f, -K.fFy, fBottom, 0.0f },
+	};
+	double fLow = 0.0, fHigh = nEnd - 1;
+
+	for (int p = 0; p < 6; p++) {
+		float a = fPlane[p][0] * pP0[0] + fPlane[p][1] * pP0[1] + fPlane[p][2] * pP0[2] + fPlane[p][3];
+		float b = fPlane[p][0] * pStep[0] + fPlane[p][1] * pStep[1] + fPlane[p][2] * pStep[2];
+
+		if (b == 0.0f) {
+			if (a < 0.0f)
+				return false;
+		}
+		else if (b > 0.0f) {
+			double fBound = -(double)a / b;
+			if (fBound > fLow)
+				fLow = fBound;
+		}
+		else {
+			double fBound = -(double)a / b;
+			if (fBound < fHigh)
+				fHigh = fBound;
+		}
+	}
+
+	if (fLow > fHigh)
+		return false;
+	nBegin = (int)ceil(fLow);
+	nEnd = (int)floor(fHigh) + 1;
+	return nBegin < nEnd;
+}
+
+int CCubeEyeTSDF::UpdateRow(float *pTSDF, float *pWeight, const float *pP0, const float *pStep, int nBegin, int nEnd) const
+{
+	const ceIntrinsicParam &K = m_stIntr;
+	const ceDistortionParam &D = m_stDist;
+	const float fMaxU = m_nWidth - 0.5f, fMaxV = m_nHeight - 0.5f;
+	const float fTrunc = m_stConfig.fTruncation, fInvTrunc = 1.0f / m_stConfig.fTruncation;
+	const float fMaxWeight = m_stConfig.fMaxWeight;
+	const float *pDepth = m_pDepth;
+	int nUpdated = 0;
+	int i = nBegin;
+
+#if defined(CE_USE_AVX2)
+	const __m256 vIndex = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+	const __m256 vP0x = _mm256_set1_ps(pP0[0]), vP0y = _mm256_set1_ps(pP0[1]), vP0z = _mm256_set1_ps(pP0[2]);
+	const __m256 vSx = _mm256_set1_ps(pStep[0]), vSy = _mm256_set1_ps(pStep[1]), vSz = _mm256_set1_ps(pStep[2]);
+	const __m256 vK1 = _mm256_set1_ps(D.fK1), vK2 = _mm256_set1_ps(D.fK2), vK3 = _mm256_set1_ps(D.fK3);
+	const __m256 vP1 = _mm256_set1_ps(D.fP1), vP2 = _mm256_set1_ps(D.fP2), vSkew = _mm256_set1_ps(D.fSkew);
+	const __m256 vFx = _mm256_set1_ps(K.fFx), vFy = _mm256_set1_ps(K.fFy), vCx = _mm256_set1_ps(K.fCx), vCy = _mm256_set1_ps(K.fCy);
+	const __m256 vOne = _mm256_set1_ps(1.0f), vTwo = _mm256_set1_ps(2.0f), vHalf = _mm256_set1_ps(0.5f), vZero = _mm256_setzero_ps();
+	const __m256 vLow = _mm256_set1_ps(-0.5f), vMaxU = _mm256_set1_ps(fMaxU), vMaxV = _mm256_set1_ps(fMaxV);
+	const __m256 vMinZ = _mm256_set1_ps(MIN_VOXEL_Z), vTrunc = _mm256_set1_ps(-fTrunc), vInvTrunc = _mm256_set1_ps(fInvTrunc);
+	const __m256 vMaxWeight = _mm256_set1_ps(fMaxWeight);
+	const __m256i vWidth = _mm256_set1_epi32(m_nWidth);
+
+	for (; i + 8 <= nEnd; i += 8) {
+		__m256 fi = _mm256_add_ps(_mm256_set1_ps((float)i), vIndex);
+		__m256 X = _mm256_fmadd_ps(fi, vSx, vP0x);
+		__m256 Y = _mm256_fmadd_ps(fi, vSy, vP0y);
+		__m256 Z = _mm256_fmadd_ps(fi, vSz, vP0z);
+		__m256 vValid = _mm256_cmp_ps(Z, vMinZ, _CMP_GE_OQ);
+
+		__m256 fInvZ = _mm256_div_ps(vOne, _mm256_max_ps(Z, vMinZ));
+		__m256 x = _mm256_mul_ps(X, fInvZ);
+		__m256 y = _mm256_mul_ps(Y, fInvZ);
+		__m256 xy = _mm256_mul_ps(x, y);
+		__m256 r2 = _mm256_fmadd_ps(x, x, _mm256_mul_ps(y, y));
+		__m256 fRadial = _mm256_fmadd_ps(r2, _mm256_fmadd_ps(r2, _mm256_fmadd_ps(r2, vK3, vK2), vK1), vOne);
+		__m256 xd = _mm256_fmadd_ps(x, fRadial, _mm256_fmadd_ps(_mm256_mul_ps(vTwo, vP1), xy, _mm256_mul_ps(vP2, _mm256_fmadd_ps(vTwo, _mm256_mul_ps(x, x), r2))));
+		__m256 yd = _mm256_fmadd_ps(y, fRadial, _mm256_fmadd_ps(_mm256_mul_ps(vTwo, vP2), xy, _mm256_mul_ps(vP1, _mm256_fmadd_ps(vTwo, _mm256_mul_ps(y, y), r2))));
+		__m256 u = _mm256_fmadd_ps(vFx, _mm256_fmadd_ps(vSkew, yd, xd), vCx);
+		__m256 v = _mm256_fmadd_ps(vFy, yd, vCy);
+
+		vValid = _mm256_and_ps(vValid, _mm256_and_ps(_mm256_cmp_ps(u, vLow, _CMP_GE_OQ), _mm256_cmp_ps(u, vMaxU, _CMP_LT_OQ)));
+		vValid = _mm256_and_ps(vValid, _mm256_and_ps(_mm256_cmp_ps(v, vLow, _CMP_GE_OQ), _mm256_cmp_ps(v, vMaxV, _CMP_LT_OQ)));
+		if (_mm256_movemask_ps(vValid) == 0)
+			continue;
+
+		//invalid lanes are not loaded by the masked gather
+		__m256i px = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_and_ps(u, vValid), vHalf));
+		__m256i py = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_and_ps(v, vValid), vHalf));
+		__m256i idx = _mm256_add_epi32(_mm256_mullo_epi32(py, vWidth), px);
+		__m256 d = _mm256_mask_i32gather_ps(vZero, pDepth, idx, vValid, 4);
+
+		__m256 sdf = _mm256_sub_ps(d, Z);
+		vValid = _mm256_and_ps(vValid, _mm256_and_ps(_mm256_cmp_ps(d, vZero, _CMP_GT_OQ), _mm256_cmp_ps(sdf, vTrunc, _CMP_GE_OQ)));
+		int nMask = _mm256_movemask_ps(vValid);
+		if (nMask == 0)
+			continue;
+
+		__m256 t = _mm256_min_ps(_mm256_mul_ps(sdf, vInvTrunc), vOne);
+		__m256 T = _mm256_loadu_ps(pTSDF + i);
+		__m256 W = _mm256_loadu_ps(pWeight + i);
+		__m256 W1 = _mm256_add_ps(W, vOne);
+		__m256 T1 = _mm256_div_ps(_mm256_fmadd_ps(T, W, t), W1);
+		_mm256_storeu_ps(pTSDF + i, _mm256_blendv_ps(T, T1, vValid));
+		_mm256_storeu_ps(pWeight + i, _mm256_blendv_ps(W, _mm256_min_ps(W1, vMaxWeight), vValid));
+		for (; nMask != 0; nMask &= nMask - 1)
+			nUpdated++;
+	}
+#endif
+
+	for (; i < nEnd; i++) {
+		float Z = pP0[2] + i * pStep[2];
+		if (Z < MIN_VOXEL_Z)
+			continue;
+		float X = pP0[0] + i * pStep[0];
+		float Y = pP0[1] + i * pStep[1];
+		float u, v;
+		ceProjectPoint(K, D, X / Z, Y / Z, u, v);
+		if (!(u >= -0.5f && u < fMaxU && v >= -0.5f && v < fMaxV))
+			continue;
+
+		float d = pDepth[(int)(v + 0.5f) * m_nWidth + (int)(u + 0.5f)];
+		float sdf = d - Z;
+		if (d <= 0.0f || sdf < -fTrunc)
+			continue;
+
+		float t = sdf * fInvTrunc < 1.0f ? sdf * fInvTrunc : 1.0f;
+		float W = pWeight[i];
+		pTSDF[i] = (pTSDF[i] * W + t) / (W + 1.0f);
+		pWeight[i] = W + 1.0f < fMaxWeight ? W + 1.0f : fMaxWeight;
+		nUpdated++;
+	}
+	return nUpdated;
+}
+
+}
@@ -0,0 +1,171 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeTSDF.h													*/
+/*																			*/
+/* @brief	Truncated signed distance volume fusion							*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeLens.h"
+#include "CubeEyeThreadPool.h"
+
+#include <GL/glh_linear.h>
+#include <GL/glh_array.h>
+
+namespace CUBE_EYE
+{
+
+///TSDF volume configuration
+typedef struct _ceTSDFConfig
+{
+	///Voxels along x / y / z
+	int nSizeX;
+	int nSizeY;
+	int nSizeZ;
+	///Voxel edge(unit; m)
+	float fVoxelSize;
+	///World position of the corner of voxel (0, 0, 0)(unit; m)
+	float fOrigin[3];
+	///Truncation distance(unit; m), a few voxels
+	float fTruncation;
+	///Weight limit : older frames fade out once it is reached
+	float fMaxWeight;
+	///Depth range used for integration(unit; m)
+	float fMinDepth;
+	float fMaxDepth;
+
+} ceTSDFConfig;
+
+/**
+*
+*@brief		TSDF volumetric fusion
+*@details	Integrates depth frames into a truncated signed distance volume(KinectFusion style
+			running weighted average). Voxel (i, j, k) of the glh::array3 volumes has its center at
+			fOrigin + (i + 0.5, j + 0.5, k + 0.5) * fVoxelSize; the distance is stored normalized
+			by fTruncation in [-1, 1](1 : free space or never seen) with its weight alongside.
+
+			Integrate runs the z slabs of the volume on the thread pool. Along a row the camera
+			coordinates of the voxels are linear in i, so the frustum(image bounds and depth
+			range) clips every row to an interval of i before any voxel is touched; the
+			remaining voxels are projected with the lens model and updated 8 at a time with AVX2
+			where the build enables it.
+*
+*/
+class CCubeEyeTSDF {
+
+public:
+
+	CCubeEyeTSDF();
+	~CCubeEyeTSDF();
+
+	/**
+	*
+	* @brief	Default configuration
+	* @details	256^3 voxels of 4 mm centered in front of the camera at 0.5 ~ 1.5 m,
+				16 mm truncation, max weight 64, depth range 0.1 ~ 4 m.
+	* @return	configuration
+	*
+	*/
+	static ceTSDFConfig DefaultConfig();
+
+	/**
+	*
+	* @brief	Initialize volume
+	* @details	Allocates and resets the volumes.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Init(const ceTSDFConfig &stConfig);
+
+	/**
+	*
+	* @brief	Set depth camera
+	* @param	stIntr, stDist - lens parameters(pIntrinsicParam / pDistortionParam).
+	* @param	nWidth, nHeight - depth frame size.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetCamera(const ceIntrinsicParam &stIntr, const ceDistortionParam &stDist, int nWidth, int nHeight);
+
+	template <class TDevice>
+	int SetCamera(const TDevice &device)
+	{
+		return SetCamera(device.pIntrinsicParam, device.pDistortionParam, device.pDevInfo.nWidth, device.pDevInfo.nHeight);
+	}
+
+	/**
+	*
+	* @brief	Set thread pool
+	* @details	NULL : single threaded. Default is CCubeEyeThreadPool::Default().
+	* @return	void
+	*
+	*/
+	void SetThreadPool(CCubeEyeThreadPool *pPool) { m_pPool = pPool; }
+
+	/**
+	*
+	* @brief	Reset volume
+	* @details	Every voxel back to distance 1, weight 0.
+	* @return	void
+	*
+	*/
+	void Reset();
+
+	/**
+	*
+	* @brief	Integrate depth frame
+	* @param	pDepth - depth frame of the camera(unit; mm, 0 : invalid).
+	* @param	pose - camera to world transform(column vectors, unit; m).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Integrate(const uint16 *pDepth, const glh::matrix4f &pose);
+
+	/*************************************************************************************
+	* \defgroup Volume
+	* @{
+	*/
+
+	const ceTSDFConfig &GetConfig() const { return m_stConfig; }
+
+	///Normalized distance, 1 : free space or never seen
+	const glh::array3<float> &getTSDF() const { return m_tsdf; }
+	///Accumulated weight, 0 : never seen
+	const glh::array3<float> &getWeight() const { return m_weight; }
+
+	///Voxels updated by the last Integrate
+	uint64 getUpdatedCount() const { return m_nUpdated.load(); }
+	///Integrate count since Init / Reset
+	int getFrameCount() const { return m_nFrames; }
+
+	/**@}*/
+
+private:
+
+	CCubeEyeTSDF(const CCubeEyeTSDF &);
+	CCubeEyeTSDF &operator=(const CCubeEyeTSDF &);
+
+	void IntegrateSlab(int k);
+	bool ClipRow(const float *pP0, const float *pStep, int &nBegin, int &nEnd) const;
+	int UpdateRow(float *pTSDF, float *pWeight, const float *pP0, const float *pStep, int nBegin, int nEnd) const;
+
+	ceTSDFConfig m_stConfig;
+	CCubeEyeThreadPool *m_pPool;
+	glh::array3<float> m_tsdf;
+	glh::array3<float> m_weight;
+
+	ceIntrinsicParam m_stIntr;
+	ceDistortionParam m_stDist;
+	int m_nWidth;
+	int m_nHeight;
+	float *m_pDepth;				//frame depth(unit; m), 0 : invalid
+
+	float m_fWorldToCam[12];		//row-major 3 x 4 of the frame being integrated
+	std::atomic<uint64> m_nUpdated;
+	int m_nFrames;
+};
+
+}
@@ -0,0 +1,386 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeTelemetry.cpp											*/
+/*																			*/
+/* @brief	Capture latency, frame drop and sensor telemetry				*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeTelemetry.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace CUBE_EYE
+{
+
+#define SUB_COUNT		(1 << CE_HISTOGRAM_SUB_BITS)
+
+static inline int HighBit(uint64 n)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long nIndex;
+	_BitScanReverse64(&nIndex, n);
+	return (int)nIndex;
+#elif defined(_MSC_VER)
+	unsigned long nIndex;
+	if (_BitScanReverse(&nIndex, (unsigned long)(n >> 32)))
+		return (int)nIndex + 32;
+	_BitScanReverse(&nIndex, (unsigned long)n);
+	return (int)nIndex;
+#else
+	return 63 - __builtin_clzll(n);
+#endif
+}
+
+/*************************************************************************************
+* CCubeEyeHistogram
+*/
+
+CCubeEyeHistogram::CCubeEyeHistogram()
+{
+	Reset();
+}
+
+int CCubeEyeHistogram::BucketIndex(uint64 nValue)
+{
+	if (nValue < 2 * SUB_COUNT)
+		return (int)nValue;
+
+	int nBit = HighBit(nValue);
+	if (nBit >= CE_HISTOGRAM_MAX_BITS)
+		return CE_HISTOGRAM_BUCKETS - 1;
+
+	int nShift = nBit - CE_HISTOGRAM_SUB_BITS;
+	return ((nShift + 1) << CE_HISTOGRAM_SUB_BITS) + (int)(nValue >> nShift) - SUB_COUNT;
+}
+
+uint64 CCubeEyeHistogram::BucketHigh(int nIndex)
+{
+	if (nIndex < 2 * SUB_COUNT)
+		return (uint64)nIndex;
+
+	int nShift = (nIndex >> CE_HISTOGRAM_SUB_BITS) - 1;
+	uint64 nSub = (uint64)(nIndex & (SUB_COUNT - 1)) + SUB_COUNT;
+	return ((nSub + 1) << nShift) - 1;
+}
+
+void CCubeEyeHistogram::Record(uint64 nValue)
+{
+	m_nBuckets[BucketIndex(nValue)].fetch_add(1, std::memory_order_relaxed);
+	m_nCount.fetch_add(1, std::memory_order_relaxed);
+	m_nSum.fetch_add(nValue, std::memory_order_relaxed);
+
+	uint64 nMin = m_nMin.load(std::memory_order_relaxed);
+	while (nValue < nMin && !m_nMin.compare_exchange_weak(nMin, nValue, std::memory_order_relaxed)) {}
+	uint64 nMax = m_nMax.load(std::memory_order_relaxed);
+	while (nValue > nMax && !m_nMax.compare_exchange_weak(nMax, nValue, std::memory_order_relaxed)) {}
+}
+
+void CCubeEyeHistogram::Reset()
+{
+	for (int i = 0; i < CE_HISTOGRAM_BUCKETS; i++)
+		m_nBuckets[i].store(0, std::memory_order_relaxed);
+	m_nCount.store(0, std::memory_order_relaxed);
+	m_nSum.store(0, std::memory_order_relaxed);
+	m_nMin.store(~(uint64)0, std::memory_order_relaxed);
+	m_nMax.store(0, std::memory_order_relaxed);
+}
+
+uint64 CCubeEyeHistogram::getMin() const
+{
+	uint64 nMin = m_nMin.load(std::memory_order_relaxed);
+	return nMin == ~(uint64)0 ? 0 : nMin;
+}
+
+double CCubeEyeHistogram::getMean() const
+{
+	uint64 nCount = m_nCount.load(std::memory_order_relaxed);
+	return nCount ? (double)m_nSum.load(std::memory_order_relaxed) / nCount : 0.0;
+}
+
+uint64 CCubeEyeHistogram::getPercentile(double fPercentile) const
+{
+	//count from the buckets themselves so a concurrent Record can not push the rank past the end
+	uint64 nTotal = 0;
+	for (int i = 0; i < CE_HISTOGRAM_BUCKETS; i++)
+		nTotal += m_nBuckets[i].load(std::memory_order_relaxed);
+	if (nTotal == 0)
+		return 0;
+
+	if (fPercentile < 0.0)
+		fPercentile = 0.0;
+	if (fPercentile > 100.0)
+		fPercentile = 100.0;
+	uint64 nRank = (uint64)(fPercentile / 100.0 * nTotal + 0.5);
+	if (nRank < 1)
+		nRank = 1;
+
+	uint64 nMax = m_nMax.load(std::memory_order_relaxed);
+	uint64 nSeen = 0;
+	for (int i = 0; i < CE_HISTOGRAM_BUCKETS; i++) {
+		nSeen += m_nBuckets[i].load(std::memory_order_relaxed);
+		if (nSeen >= nRank) {
+			uint64 nHigh = BucketHigh(i);
+			return nHigh < nMax ? nHigh : nMax;
+		}
+	}
+	return nMax;
+}
+
+/*************************************************************************************
+* CCubeEyeTelemetry
+*/
+
+CCubeEyeTelemetry::CCubeEyeTelemetry()
+	: m_stConfig(DefaultConfig()), m_nStageCount(0)
+{
+	Reset();
+}
+
+CCubeEyeTelemetry::~CCubeEyeTelemetry()
+{
+}
+
+ceTelemetryConfig CCubeEyeTelemetry::DefaultConfig()
+{
+	ceTelemetryConfig stConfig;
+	stConfig.bDeviceClock = false;
+	stConfig.nSampleIntervalMs = 1000;
+	stConfig.nMaxSamples = 3600;
+	stConfig.nMaxDecisions = 1024;
+	return stConfig;
+}
+
+int CCubeEyeTelemetry::SetConfig(const ceTelemetryConfig &stConfig)
+{
+	if (stConfig.nMaxSamples < 1 || stConfig.nMaxDecisions < 1)
+		return CE_INVALID_PARAM;
+
+	m_stConfig = stConfig;
+	Reset();
+	return CE_SUCCESS;
+}
+
+int CCubeEyeTelemetry::AddStage(const char *szName)
+{
+	if (szName == NULL)
+		return CE_INVALID_PARAM;
+	if (m_nStageCount >= CE_TELEMETRY_MAX_STAGES)
+		return CE_OUTOFRANGE;
+
+	m_strStageNames[m_nStageCount] = szName;
+	m_stages[m_nStageCount].Reset();
+	return m_nStageCount++;
+}
+
+const char *CCubeEyeTelemetry::getStageName(int nStage) const
+{
+	if (nStage < 0 || nStage >= m_nStageCount)
+		return NULL;
+	return m_strStageNames[nStage].c_str();
+}
+
+void CCubeEyeTelemetry::Reset()
+{
+	m_receipt.Reset();
+	m_read.Reset();
+	for (int i = 0; i < CE_TELEMETRY_MAX_STAGES; i++)
+		m_stages[i].Reset();
+
+	m_nFrames.store(0);
+	m_nDropped.store(0);
+	m_nDropEvents.store(0);
+	m_nRestarts.store(0);
+	m_nLastFrameID.store(-1);
+	m_nClockOffset.store(0);
+	m_bClockOffset.store(false);
+
+	{
+		std::lock_guard<std::mutex> lock(m_sampleMutex);
+		m_vSamples.resize(m_stConfig.nMaxSamples);
+		m_nSampleNext = 0;
+		m_nSampleCount = 0;
+		m_nNextSampleTime = 0;
+		memset(&m_stLast, 0, sizeof(m_stLast));
+	}
+
+	std::lock_guard<std::mutex> lock(m_decisionMutex);
+	m_vDecisions.resize(m_stConfig.nMaxDecisions);
+	m_nDecisionNext = 0;
+	m_nDecisions.store(0);
+}
+
+/*************************************************************************************
+* recording
+*/
+
+uint64 CCubeEyeTelemetry::Latency(TimeStampType nNow, TimeStampType nFrameTimeStamp) const
+{
+	int64 nLatency = (int64)nNow - (int64)nFrameTimeStamp;
+	if (m_stConfig.bDeviceClock)
+		nLatency -= m_nClockOffset.load(std::memory_order_relaxed);
+	//host clock adjustments can make it negative
+	return nLatency > 0 ? (uint64)nLatency : 0;
+}
+
+void CCubeEyeTelemetry::OnFrame(const ceFrameInfo &stFrameInfo, TimeStampType nReadStart, TimeStampType nReceipt)
+{
+	//the smallest receipt delay seen stands for the fixed offset between the clocks
+	if (m_stConfig.bDeviceClock) {
+		int64 nDelay = (int64)nReceipt - (int64)stFrameInfo.nTimeStamp;
+		if (!m_bClockOffset.load(std::memory_order_relaxed) || nDelay < m_nClockOffset.load(std::memory_order_relaxed)) {
+			m_nClockOffset.store(nDelay, std::memory_order_relaxed);
+			m_bClockOffset.store(true, std::memory_order_relaxed);
+		}
+	}
+
+	m_receipt.Record(Latency(nReceipt, stFrameInfo.nTimeStamp));
+	if (nReadStart != 0 && nReceipt >= nReadStart)
+		m_read.Record(nReceipt - nReadStart);
+	m_nFrames.fetch_add(1, std::memory_order_relaxed);
+
+	int64 nFrameID = (int64)stFrameInfo.nFrameID;
+	int64 nLast = m_nLastFrameID.exchange(nFrameID, std::memory_order_relaxed);
+	if (nLast >= 0) {
+		if (nFrameID > nLast + 1) {
+			m_nDropped.fetch_add((uint64)(nFrameID - nLast - 1), std::memory_order_relaxed);
+			m_nDropEvents.fetch_add(1, std::memory_order_relaxed);
+		}
+		else if (nFrameID <= nLast) {
+			m_nRestarts.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	ceTelemetrySample stSample;
+	stSample.nTimeStamp = nReceipt;
+	stSample.nFrameID = stFrameInfo.nFrameID;
+	stSample.fSensorTemp = stFrameInfo.fSensorTemp;
+	stSample.fLDTemp = stFrameInfo.fLDTemp;
+	stSample.fIntegrationTime = stFrameInfo.fIntegrationTime;
+
+	std::lock_guard<std::mutex> lock(m_sampleMutex);
+	m_stLast = stSample;
+	if (nReceipt >= m_nNextSampleTime) {
+		m_vSamples[m_nSampleNext] = stSample;
+		m_nSampleNext = (m_nSampleNext + 1) % m_vSamples.size();
+		if (m_nSampleCount < m_vSamples.size())
+			m_nSampleCount++;
+		m_nNextSampleTime = nReceipt + (TimeStampType)m_stConfig.nSampleIntervalMs * 1000;
+	}
+}
+
+void CCubeEyeTelemetry::RecordStage(int nStage, TimeStampType nFrameTimeStamp)
+{
+	if (nStage < 0 || nStage >= m_nStageCount)
+		return;
+	m_stages[nStage].Record(Latency(ceHostTimeStamp(), nFrameTimeStamp));
+}
+
+void CCubeEyeTelemetry::RecordStage(int nStage, const ceFrameInfo &stFrameInfo)
+{
+	RecordStage(nStage, stFrameInfo.nTimeStamp);
+}
+
+void CCubeEyeTelemetry::RecordDecision(const ceRateDecision &stDecision)
+{
+	std::lock_guard<std::mutex> lock(m_decisionMutex);
+	m_vDecisions[m_nDecisionNext] = stDecision;
+	m_nDecisionNext = (m_nDecisionNext + 1) % m_vDecisions.size();
+	m_nDecisions.fetch_add(1, std::memory_order_relaxed);
+}
+
+/*************************************************************************************
+* queries
+*/
+
+void CCubeEyeTelemetry::GetSamples(Vector<ceTelemetrySample> &vSamples)
+{
+	std::lock_guard<std::mutex> lock(m_sampleMutex);
+	vSamples.resize(m_nSampleCount);
+	size_t nFirst = (m_nSampleNext + m_vSamples.size() - m_nSampleCount) % m_vSamples.size();
+	for (size_t i = 0; i < m_nSampleCount; i++)
+		vSamples[i] = m_vSamples[(nFirst + i) % m_vSamples.size()];
+}
+
+ceTelemetrySample CCubeEyeTelemetry::getLastSample()
+{
+	std::lock_guard<std::mutex> lock(m_sampleMutex);
+	return m_stLast;
+}
+
+void CCubeEyeTelemetry::GetDecisions(Vector<ceRateDecision> &vDecisions)
+{
+	std::lock_guard<std::mutex> lock(m_decisionMutex);
+	uint64 nTotal = m_nDecisions.load(std::memory_order_relaxed);
+	size_t nCount = nTotal < m_vDecisions.size() ? (size_t)nTotal : m_vDecisions.size();
+	size_t nFirst = (m_nDecisionNext + m_vDecisions.size() - nCount) % m_vDecisions.size();
+	vDecisions.resize(nCount);
+	for (size_t i = 0; i < nCount; i++)
+		vDecisions[i] = m_vDecisions[(nFirst + i) % m_vDecisions.size()];
+}
+
+static void DumpHistogram(FILE *pFile, const char *szName, const CCubeEyeHistogram &histogram)
+{
+	fprintf(pFile, "%s,%llu,%llu,%.1f,%llu,%llu,%llu,%llu,%llu\n", szName,
+		(unsigned long long)histogram.getCount(), (unsigned long long)histogram.getMin(), histogram.getMean(),
+		(unsigned long long)histogram.getPercentile(50.0), (unsigned long long)histogram.getPercentile(90.0),
+		(unsigned long long)histogram.getPercentile(99.0), (unsigned long long)histogram.getPercentile(99.9),
+		(unsigned long long)histogram.getMax());
+}
+
+int CCubeEyeTelemetry::Dump(const char *szPath)
+{
+	if (szPath == NULL)
+		return CE_INVALID_PARAM;
+
+	FILE *pFile = fopen(szPath, "w");
+	if (pFile == NULL)
+		return CE_OPEN_FAILED;
+
+	fprintf(pFile, "# CubeEye telemetry, host time %llu us\n", (unsigned long long)ceHostTimeStamp());
+	fprintf(pFile, "frames,%llu\n", (unsigned long long)getFrameCount());
+	fprintf(pFile, "dropped,%llu\n", (unsigned long long)getDroppedCount());
+	fprintf(pFile, "drop_events,%llu\n", (unsigned long long)getDropEventCount());
+	fprintf(pFile, "restarts,%llu\n", (unsigned long long)getRestartCount());
+	if (m_stConfig.bDeviceClock)
+		fprintf(pFile, "clock_offset_us,%lld\n", (long long)getClockOffset());
+
+	fprintf(pFile, "\nseries,count,min_us,mean_us,p50_us,p90_us,p99_us,p99.9_us,max_us\n");
+	DumpHistogram(pFile, "receipt", m_receipt);
+	DumpHistogram(pFile, "read", m_read);
+	for (int i = 0; i < m_nStageCount; i++) {
+		std::string strName = "stage:" + m_strStageNames[i];
+		DumpHistogram(pFile, strName.c_str(), m_stages[i]);
+	}
+
+	Vector<ceTelemetrySample> vSamples;
+	GetSamples(vSamples);
+	fprintf(pFile, "\ntime_us,frame_id,sensor_temp,ld_temp,integration_time\n");
+	for (size_t i = 0; i < vSamples.size(); i++) {
+		fprintf(pFile, "%llu,%ld,%.2f,%.2f,%.3f\n", (unsigned long long)vSamples[i].nTimeStamp, vSamples[i].nFrameID,
+			vSamples[i].fSensorTemp, vSamples[i].fLDTemp, vSamples[i].fIntegrationTime);
+	}
+
+	Vector<ceRateDecision> vDecisions;
+	GetDecisions(vDecisions);
+	fprintf(pFile, "\ntime_us,frame_id,fps_from,fps_to,decimation_from,decimation_to,queue_depth,load,switch_us,result\n");
+	for (size_t i = 0; i < vDecisions.size(); i++) {
+		const ceRateDecision &d = vDecisions[i];
+		fprintf(pFile, "%llu,%ld,%d,%d,%d,%d,%.2f,%.3f,%u,%d\n", (unsigned long long)d.nTimeStamp, d.nFrameID,
+			d.nFrameRateFrom, d.nFrameRateTo, d.nDecimationFrom, d.nDecimationTo, d.fQueueDepth, d.fLoad, d.nSwitchUs, d.nResult);
+	}
+
+	bool bError = ferror(pFile) != 0;
+	if (fclose(pFile) != 0 || bError)
+		return CE_WRITE_FAILED;
+	return CE_SUCCESS;
+}
+
+}
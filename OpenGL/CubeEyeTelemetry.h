@@ -0,0 +1,315 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeTelemetry.h												*/
+/*																			*/
+/* @brief	Capture latency, frame drop and sensor telemetry				*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeHostDef.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+namespace CUBE_EYE
+{
+
+///Pipeline stages a telemetry can track
+#define CE_TELEMETRY_MAX_STAGES		16
+
+///Histogram sub-buckets per power of two(relative precision 1 / 64)
+#define CE_HISTOGRAM_SUB_BITS		6
+///Largest value a histogram resolves, larger values go to the last bucket(2^40 us ~ 12 days)
+#define CE_HISTOGRAM_MAX_BITS		40
+#define CE_HISTOGRAM_BUCKETS		((CE_HISTOGRAM_MAX_BITS - CE_HISTOGRAM_SUB_BITS + 1) << CE_HISTOGRAM_SUB_BITS)
+
+/**
+*
+*@brief		Lock-free log-linear histogram
+*@details	HDR histogram layout : values below 2^(SUB_BITS + 1) have their own bucket, above
+			that every power of two is split into 2^SUB_BITS buckets, so any value is known to
+			about 1.6% over the whole range with a fixed 18 KB table. Record is one relaxed
+			atomic add(plus min / max updates) and may be called from any thread; queries read
+			a consistent-enough snapshot while recording goes on.
+*
+*/
+class CCubeEyeHistogram {
+
+public:
+
+	CCubeEyeHistogram();
+
+	void Record(uint64 nValue);
+	void Reset();
+
+	uint64 getCount() const { return m_nCount.load(std::memory_order_relaxed); }
+	uint64 getMin() const;
+	uint64 getMax() const { return m_nMax.load(std::memory_order_relaxed); }
+	double getMean() const;
+
+	/**
+	*
+	* @brief	Percentile
+	* @param	fPercentile - 0 ~ 100.
+	* @return	highest value equivalent to the percentile bucket(0 when empty)
+	*
+	*/
+	uint64 getPercentile(double fPercentile) const;
+
+private:
+
+	CCubeEyeHistogram(const CCubeEyeHistogram &);
+	CCubeEyeHistogram &operator=(const CCubeEyeHistogram &);
+
+	static int BucketIndex(uint64 nValue);
+	static uint64 BucketHigh(int nIndex);
+
+	std::atomic<uint64> m_nBuckets[CE_HISTOGRAM_BUCKETS];
+	std::atomic<uint64> m_nCount;
+	std::atomic<uint64> m_nSum;
+	std::atomic<uint64> m_nMin;
+	std::atomic<uint64> m_nMax;
+};
+
+///Telemetry configuration
+typedef struct _ceTelemetryConfig
+{
+	///nTimeStamp comes from the device clock : latencies are measured against the smallest
+	///receipt delay seen(clock offset estimate) instead of the host clock
+	bool bDeviceClock;
+	///Sensor sample period(unit; ms)
+	uint32 nSampleIntervalMs;
+	///Sensor samples kept, the oldest is overwritten
+	int nMaxSamples;
+	///Frame rate decisions kept, the oldest is overwritten
+	int nMaxDecisions;
+
+} ceTelemetryConfig;
+
+///Sensor sample
+typedef struct _ceTelemetrySample
+{
+	///Host time of the sample(unit; us)
+	TimeStampType nTimeStamp;
+	long nFrameID;
+	float fSensorTemp;
+	float fLDTemp;
+	float fIntegrationTime;
+
+} ceTelemetrySample;
+
+///Frame rate decision(CCubeEyeRateGovernor)
+typedef struct _ceRateDecision
+{
+	///Host time of the decision(unit; us)
+	TimeStampType nTimeStamp;
+	///Frame that triggered it
+	long nFrameID;
+	///Device frame rate(FPS_30, FPS_15, FPS_8) and host decimation(1 : every frame) before / after
+	uint8 nFrameRateFrom;
+	uint8 nFrameRateTo;
+	uint8 nDecimationFrom;
+	uint8 nDecimationTo;
+	///Smoothed consumer queue depth(unit; frames)
+	float fQueueDepth;
+	///Smoothed processing time / frame period of the delivered rate
+	float fLoad;
+	///Duration of the setFrameRate call(unit; us), 0 : host decimation only
+	uint32 nSwitchUs;
+	///setFrameRate result, CE_SUCCESS for host decimation
+	int nResult;
+
+} ceRateDecision;
+
+/**
+*
+*@brief		Capture path telemetry
+*@details	Separates where time goes on the way from the sensor to the application :
+			Receipt - nTimeStamp to the host getting the frame(USB + SDK),
+			Read    - duration of the ReadDepthIRFrame call(time the capture thread blocks in the SDK),
+			Stage n - nTimeStamp to the end of pipeline stage n(host processing).
+			Frames missing from the nFrameID sequence are counted as dropped, and fSensorTemp,
+			fLDTemp and fIntegrationTime are sampled every nSampleIntervalMs. Frame rate
+			decisions of a CCubeEyeRateGovernor are kept with the inputs that caused them.
+
+			OnFrame belongs to the capture thread(CCubeEyeFrameRing::SetTelemetry calls it);
+			RecordStage and every query may be called from any thread. Stages are added
+			during setup.
+*
+*/
+class CCubeEyeTelemetry {
+
+public:
+
+	CCubeEyeTelemetry();
+	~CCubeEyeTelemetry();
+
+	/**
+	*
+	* @brief	Default configuration
+	* @details	Host clock time stamps, 1 s sensor samples, 1 hour kept, 1024 decisions.
+	* @return	configuration
+	*
+	*/
+	static ceTelemetryConfig DefaultConfig();
+
+	/**
+	*
+	* @brief	Set configuration
+	* @details	Resets the telemetry.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetConfig(const ceTelemetryConfig &stConfig);
+	const ceTelemetryConfig &GetConfig() const { return m_stConfig; }
+
+	/**
+	*
+	* @brief	Add stage
+	* @return	stage index(>= 0)|Error Code(< 0)
+	*
+	*/
+	int AddStage(const char *szName);
+
+	int getStageCount() const { return m_nStageCount; }
+	const char *getStageName(int nStage) const;
+
+	/*************************************************************************************
+	* \defgroup Recording
+	* @{
+	*/
+
+	/**
+	*
+	* @brief	Frame received
+	* @param	stFrameInfo - frame information returned by ReadDepthIRFrame.
+	* @param	nReadStart - host time the read call started(unit; us), 0 : unknown.
+	* @param	nReceipt - host time the read call returned(unit; us).
+	* @return	void
+	*
+	*/
+	void OnFrame(const ceFrameInfo &stFrameInfo, TimeStampType nReadStart, TimeStampType nReceipt);
+	void OnFrame(const ceFrameInfo &stFrameInfo) { OnFrame(stFrameInfo, 0, ceHostTimeStamp()); }
+
+	/**
+	*
+	* @brief	Stage finished
+	* @details	Records now - nTimeStamp of the frame for nStage.
+	* @return	void
+	*
+	*/
+	void RecordStage(int nStage, const ceFrameInfo &stFrameInfo);
+	void RecordStage(int nStage, TimeStampType nFrameTimeStamp);
+
+	/**
+	*
+	* @brief	Frame rate decision
+	* @details	Called by CCubeEyeRateGovernor for every change it makes.
+	* @return	void
+	*
+	*/
+	void RecordDecision(const ceRateDecision &stDecision);
+
+	void Reset();
+
+	/**@}*/
+
+	/*************************************************************************************
+	* \defgroup Queries
+	* @{
+	*/
+
+	const CCubeEyeHistogram &getReceiptLatency() const { return m_receipt; }
+	const CCubeEyeHistogram &getReadDuration() const { return m_read; }
+	const CCubeEyeHistogram &getStageLatency(int nStage) const { return m_stages[nStage]; }
+
+	///Frames seen by OnFrame
+	uint64 getFrameCount() const { return m_nFrames.load(std::memory_order_relaxed); }
+	///Frames missing from the nFrameID sequence
+	uint64 getDroppedCount() const { return m_nDropped.load(std::memory_order_relaxed); }
+	///Gaps in the nFrameID sequence(one gap may drop several frames)
+	uint64 getDropEventCount() const { return m_nDropEvents.load(std::memory_order_relaxed); }
+	///nFrameID going backwards(device restart)
+	uint64 getRestartCount() const { return m_nRestarts.load(std::memory_order_relaxed); }
+	///Estimated device - host clock offset(unit; us, bDeviceClock only)
+	int64 getClockOffset() const { return m_nClockOffset.load(std::memory_order_relaxed); }
+
+	/**
+	*
+	* @brief	Sensor samples
+	* @param	vSamples - receives the kept samples, oldest first.
+	* @return	void
+	*
+	*/
+	void GetSamples(Vector<ceTelemetrySample> &vSamples);
+
+	///Last frame's sensor values
+	ceTelemetrySample getLastSample();
+
+	///Frame rate decisions recorded(including those no longer kept)
+	uint64 getDecisionCount() const { return m_nDecisions.load(std::memory_order_relaxed); }
+
+	/**
+	*
+	* @brief	Frame rate decisions
+	* @param	vDecisions - receives the kept decisions, oldest first.
+	* @return	void
+	*
+	*/
+	void GetDecisions(Vector<ceRateDecision> &vDecisions);
+
+	/**
+	*
+	* @brief	Dump to file
+	* @details	Text report : counters, one line of percentiles per histogram(unit; us), the
+				sensor samples and the frame rate decisions as CSV.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Dump(const char *szPath);
+
+	/**@}*/
+
+private:
+
+	CCubeEyeTelemetry(const CCubeEyeTelemetry &);
+	CCubeEyeTelemetry &operator=(const CCubeEyeTelemetry &);
+
+	uint64 Latency(TimeStampType nNow, TimeStampType nFrameTimeStamp) const;
+
+	ceTelemetryConfig m_stConfig;
+
+	CCubeEyeHistogram m_receipt;
+	CCubeEyeHistogram m_read;
+	CCubeEyeHistogram m_stages[CE_TELEMETRY_MAX_STAGES];
+	std::string m_strStageNames[CE_TELEMETRY_MAX_STAGES];
+	int m_nStageCount;
+
+	std::atomic<uint64> m_nFrames;
+	std::atomic<uint64> m_nDropped;
+	std::atomic<uint64> m_nDropEvents;
+	std::atomic<uint64> m_nRestarts;
+	std::atomic<int64> m_nLastFrameID;		//-1 : none yet
+	std::atomic<int64> m_nClockOffset;
+	std::atomic<bool> m_bClockOffset;
+	std::atomic<uint64> m_nDecisions;
+
+	//sensor samples : written once per interval(m_sampleMutex)
+	std::mutex m_sampleMutex;
+	Vector<ceTelemetrySample> m_vSamples;
+	size_t m_nSampleNext;
+	size_t m_nSampleCount;
+	TimeStampType m_nNextSampleTime;
+	ceTelemetrySample m_stLast;
+
+	//frame rate decisions(m_decisionMutex)
+	std::mutex m_decisionMutex;
+	Vector<ceRateDecision> m_vDecisions;
+	size_t m_nDecisionNext;
+};
+
+}
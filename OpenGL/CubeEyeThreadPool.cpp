@@ -0,0 +1,161 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeThreadPool.cpp											*/
+/*																			*/
+/* @brief	Worker thread pool for host-side frame processing				*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeThreadPool.h"
+
+namespace CUBE_EYE
+{
+
+static thread_local const CCubeEyeThreadPool *t_pWorkerPool = NULL;
+
+CCubeEyeThreadPool::CCubeEyeThreadPool(int nThreads)
+	: m_nThreadCount(nThreads), m_bStop(false), m_pJob(NULL), m_nJobGeneration(0), m_nJobWorkers(0)
+{
+	if (m_nThreadCount <= 0)
+		m_nThreadCount = (int)std::thread::hardware_concurrency();
+	if (m_nThreadCount <= 0)
+		m_nThreadCount = 1;
+
+	for (int i = 1; i < m_nThreadCount; i++)
+		m_vWorkers.push_back(std::thread(&CCubeEyeThreadPool::WorkerThread, this));
+}
+
+CCubeEyeThreadPool::~CCubeEyeThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStop = true;
+	}
+	m_wakeCond.notify_all();
+
+	for (size_t i = 0; i < m_vWorkers.size(); i++)
+		m_vWorkers[i].join();
+}
+
+CCubeEyeThreadPool &CCubeEyeThreadPool::Default()
+{
+	static CCubeEyeThreadPool s_pool;
+	return s_pool;
+}
+
+bool CCubeEyeThreadPool::IsWorkerThread() const
+{
+	return t_pWorkerPool == this;
+}
+
+void CCubeEyeThreadPool::Submit(std::function<void()> task)
+{
+	if (m_vWorkers.empty()) {
+		task();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_qTasks.push_back(std::move(task));
+	}
+	m_wakeCond.notify_one();
+}
+
+void CCubeEyeThreadPool::RunBands(Job &stJob)
+{
+	int nBand;
+	while ((nBand = stJob.nNextBand.fetch_add(1, std::memory_order_relaxed)) < stJob.nBandCount) {
+		int nBegin = stJob.nBegin + nBand * stJob.nBand;
+		int nEnd = nBegin + stJob.nBand;
+		if (nEnd > stJob.nEnd)
+			nEnd = stJob.nEnd;
+		stJob.pfnRun(stJob.pContext, nBegin, nEnd);
+	}
+}
+
+void CCubeEyeThreadPool::Run(Job &stJob, int nBegin, int nEnd, int nGrain)
+{
+	if (nEnd <= nBegin)
+		return;
+	if (nGrain < 1)
+		nGrain = 1;
+
+	int nCount = nEnd - nBegin;
+
+	//one band per thread, more if the range allows it so a slow band does not stall the rest
+	int nBandCount = m_nThreadCount * 2;
+	if (nBandCount > nCount / nGrain)
+		nBandCount = nCount / nGrain;
+
+	std::unique_lock<std::mutex> owner(m_jobOwner, std::try_to_lock);
+	if (nBandCount <= 1 || m_vWorkers.empty() || IsWorkerThread() || !owner.owns_lock()) {
+		stJob.pfnRun(stJob.pContext, nBegin, nEnd);
+		return;
+	}
+
+	stJob.nBegin = nBegin;
+	stJob.nEnd = nEnd;
+	stJob.nBand = (nCount + nBandCount - 1) / nBandCount;
+	stJob.nBandCount = (nCount + stJob.nBand - 1) / stJob.nBand;
+	stJob.nNextBand.store(0, std::memory_order_relaxed);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pJob = &stJob;
+		m_nJobGeneration++;
+	}
+	m_wakeCond.notify_all();
+
+	RunBands(stJob);
+
+	//every band is taken; wait for the workers still running one
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_pJob = NULL;
+	m_doneCond.wait(lock, [this] { return m_nJobWorkers == 0; });
+}
+
+void CCubeEyeThreadPool::WorkerThread()
+{
+	t_pWorkerPool = this;
+	uint64 nSeenGeneration = 0;
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;) {
+		m_wakeCond.wait(lock, [this, &nSeenGeneration] {
+			return m_bStop || !m_qTasks.empty() || (m_pJob != NULL && m_nJobGeneration != nSeenGeneration);
+		});
+
+		if (m_pJob != NULL && m_nJobGeneration != nSeenGeneration) {
+			nSeenGeneration = m_nJobGeneration;
+			Job *pJob = m_pJob;
+			m_nJobWorkers++;
+			lock.unlock();
+
+			RunBands(*pJob);
+
+			lock.lock();
+			if (--m_nJobWorkers == 0)
+				m_doneCond.notify_all();
+			continue;
+		}
+
+		if (!m_qTasks.empty()) {
+			std::function<void()> task = std::move(m_qTasks.front());
+			m_qTasks.pop_front();
+			lock.unlock();
+
+			task();
+
+			lock.lock();
+			continue;
+		}
+
+		if (m_bStop)
+			break;
+	}
+}
+
+}
@@ -0,0 +1,131 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeThreadPool.h												*/
+/*																			*/
+/* @brief	Worker thread pool for host-side frame processing				*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyeHostDef.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace CUBE_EYE
+{
+/**
+*
+*@brief		Worker thread pool
+*@details	ParallelFor splits a range(usually frame rows) into bands and runs them on the
+			workers and the calling thread; it does not allocate. Submit queues independent
+			tasks. ParallelFor called from a worker, or while another thread owns the pool's
+			workers, runs inline on the calling thread, so nesting never deadlocks.
+*
+*/
+class CCubeEyeThreadPool {
+
+public:
+
+	/**
+	*
+	* @brief	Construction
+	* @param	nThreads - total threads including the caller(0 : number of cores).
+	*
+	*/
+	explicit CCubeEyeThreadPool(int nThreads = 0);
+	~CCubeEyeThreadPool();
+
+	/**
+	*
+	* @brief	Shared pool
+	* @details	Process wide pool sized to the number of cores, created on first use.
+	* @return	pool
+	*
+	*/
+	static CCubeEyeThreadPool &Default();
+
+	///Number of threads taking part in ParallelFor(workers + caller)
+	int getThreadCount() const { return m_nThreadCount; }
+
+	/**
+	*
+	* @brief	Parallel loop
+	* @details	Calls func(nBandBegin, nBandEnd) over [nBegin, nEnd) in bands of at least
+				nGrain items and returns when every band is done.
+	* @param	nBegin, nEnd - range.
+	* @param	nGrain - minimum band size.
+	* @param	func - void(int nBandBegin, int nBandEnd).
+	* @return	void
+	*
+	*/
+	template <class TFunc>
+	void ParallelFor(int nBegin, int nEnd, int nGrain, const TFunc &func)
+	{
+		Job stJob;
+		stJob.pfnRun = &RunBand<TFunc>;
+		stJob.pContext = &func;
+		Run(stJob, nBegin, nEnd, nGrain);
+	}
+
+	/**
+	*
+	* @brief	Queue task
+	* @details	Runs task on a worker thread. With a single thread pool the task runs inline.
+	* @return	void
+	*
+	*/
+	void Submit(std::function<void()> task);
+
+	///true on one of this pool's worker threads
+	bool IsWorkerThread() const;
+
+private:
+
+	struct Job
+	{
+		void (*pfnRun)(const void *pContext, int nBegin, int nEnd);
+		const void *pContext;
+		int nBegin;
+		int nEnd;
+		int nBand;
+		int nBandCount;
+		std::atomic<int> nNextBand;
+	};
+
+	template <class TFunc>
+	static void RunBand(const void *pContext, int nBegin, int nEnd)
+	{
+		(*(const TFunc *)pContext)(nBegin, nEnd);
+	}
+
+	CCubeEyeThreadPool(const CCubeEyeThreadPool &);
+	CCubeEyeThreadPool &operator=(const CCubeEyeThreadPool &);
+
+	void Run(Job &stJob, int nBegin, int nEnd, int nGrain);
+	static void RunBands(Job &stJob);
+	void WorkerThread();
+
+	int m_nThreadCount;
+	std::vector<std::thread> m_vWorkers;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wakeCond;
+	std::condition_variable m_doneCond;
+	bool m_bStop;
+
+	std::deque<std::function<void()> > m_qTasks;
+
+	std::mutex m_jobOwner;
+	Job *m_pJob;
+	uint64 m_nJobGeneration;
+	int m_nJobWorkers;
+};
+
+}
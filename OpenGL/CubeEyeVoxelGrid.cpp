@@ -0,0 +1,291 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeVoxelGrid.cpp											*/
+/*																			*/
+/* @brief	Hash grid voxel downsampling									*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#include "CubeEyeVoxelGrid.h"
+
+#include <math.h>
+
+namespace CUBE_EYE
+{
+
+#define VOXEL_NONE		(~(uint64)0)
+#define KEY_BITS		21					//bits per quantized axis
+#define KEY_RANGE		(1 << (KEY_BITS - 1))	//quantized coordinates in [-KEY_RANGE, KEY_RANGE)
+#define PART_BITS		6
+#define PART_COUNT		(1 << PART_BITS)
+#define CHUNK_POINTS	4096
+#define MIN_SLOTS		16
+
+static inline uint64 HashKey(uint64 nKey)
+{
+	nKey *= 0x9E3779B97F4A7C15ull;
+	return nKey ^ (nKey >> 29);
+}
+
+static inline size_t TableSize(size_t nPoints)
+{
+	//load factor <= 0.5 even when every point is its own voxel
+	size_t nSize = MIN_SLOTS;
+	while (nSize < nPoints * 2)
+		nSize <<= 1;
+	return nSize;
+}
+
+CCubeEyeVoxelGrid::CCubeEyeVoxelGrid()
+	: m_fLeafSize(0.01f), m_ePolicy(Voxel_Centroid), m_pPool(&CCubeEyeThreadPool::Default()),
+	m_nInputCount(0), m_nVoxelCount(0)
+{
+}
+
+CCubeEyeVoxelGrid::~CCubeEyeVoxelGrid()
+{
+}
+
+int CCubeEyeVoxelGrid::SetLeafSize(float fLeafSize)
+{
+	if (!(fLeafSize > 0.0f))
+		return CE_INVALID_PARAM;
+
+	m_fLeafSize = fLeafSize;
+	return CE_SUCCESS;
+}
+
+template <class TFunc>
+void CCubeEyeVoxelGrid::ForRange(int nCount, const TFunc &func)
+{
+	auto band = [&func](int nBegin, int nEnd) {
+		for (int n = nBegin; n < nEnd; n++)
+			func(n);
+	};
+
+	if (m_pPool != NULL)
+		m_pPool->ParallelFor(0, nCount, 1, band);
+	else
+		band(0, nCount);
+}
+
+int CCubeEyeVoxelGrid::Filter(const CCubeEyePointCloud &in, CCubeEyePointCloud &out)
+{
+	if (&in == &out)
+		return CE_INVALID_PARAM;
+	if (in.getZ() == NULL)
+		return CE_NOT_OPENED;
+
+	Source src;
+	src.pX = in.getX();
+	src.pY = in.getY();
+	src.pZ = in.getZ();
+	src.pI = in.getI();
+	src.pMask = in.getMask();
+	src.pPoints = NULL;
+	src.nCount = in.getCount();
+	return Run(src, out);
+}
+
+int CCubeEyeVoxelGrid::Filter(const cePointCloud *pPoints, size_t nCount, CCubeEyePointCloud &out)
+{
+	if (pPoints == NULL || nCount == 0)
+		return CE_INVALID_PARAM;
+
+	Source src;
+	src.pX = src.pY = src.pZ = src.pI = NULL;
+	src.pMask = NULL;
+	src.pPoints = pPoints;
+	src.nCount = nCount;
+	return Run(src, out);
+}
+
+/*************************************************************************************
+* passes
+*/
+
+void CCubeEyeVoxelGrid::KeyChunk(const Source &src, int nChunk)
+{
+	size_t nBegin = (size_t)nChunk * CHUNK_POINTS;
+	size_t nEnd = nBegin + CHUNK_POINTS < src.nCount ? nBegin + CHUNK_POINTS : src.nCount;
+	uint32 *pCount = &m_vChunkCount[(size_t)nChunk * PART_COUNT];
+	uint64 *pKeys = m_vKeys.data();
+	const float fInv = 1.0f / m_fLeafSize;
+	const float fRange = (float)KEY_RANGE;
+
+	memset(pCount, 0, PART_COUNT * sizeof(uint32));
+	for (size_t i = nBegin; i < nEnd; i++) {
+		float x, y, z;
+		if (src.pPoints != NULL) {
+			x = src.pPoints[i].fX;
+			y = src.pPoints[i].fY;
+			z = src.pPoints[i].fZ;
+		}
+		else {
+			x = src.pX[i];
+			y = src.pY[i];
+			z = src.pZ[i];
+			if (src.pMask != NULL && ((src.pMask[i / CE_CLOUD_MASK_BITS] >> (i % CE_CLOUD_MASK_BITS)) & 1) == 0)
+				z = 0.0f;
+		}
+
+		float qx = floorf(x * fInv), qy = floorf(y * fInv), qz = floorf(z * fInv);
+		//also rejects NaN
+		if (!(z > 0.0f) || !(qx >= -fRange && qx < fRange) || !(qy >= -fRange && qy < fRange) || !(qz < fRange)) {
+			pKeys[i] = VOXEL_NONE;
+			continue;
+		}
+
+		uint64 nKey = ((uint64)((int)qx + KEY_RANGE) << (KEY_BITS * 2)) | ((uint64)((int)qy + KEY_RANGE) << KEY_BITS) |
+			(uint64)((int)qz + KEY_RANGE);
+		pKeys[i] = nKey;
+		pCount[HashKey(nKey) >> (64 - PART_BITS)]++;
+	}
+}
+
+void CCubeEyeVoxelGrid::ReducePartition(const Source &src, int nPart)
+{
+	size_t nBegin = m_vPartBegin[nPart], nEnd = m_vPartBegin[nPart + 1];
+	Slot *pSlots = m_vSlots.data() + m_vSlotBegin[nPart];
+	size_t nMask = m_vSlotBegin[nPart + 1] - m_vSlotBegin[nPart] - 1;
+	Voxel *pVoxels = m_vVoxels.data() + nBegin;
+	const uint64 *pKeys = m_vKeys.data();
+	const uint32 *pOrder = m_vOrder.data();
+	bool bCentroid = m_ePolicy == Voxel_Centroid;
+	uint32 nVoxels = 0;
+
+	for (size_t s = 0; s <= nMask; s++)
+		pSlots[s].nKey = VOXEL_NONE;
+
+	for (size_t n = nBegin; n < nEnd; n++) {
+		uint32 i = pOrder[n];
+		uint64 nKey = pKeys[i];
+		size_t s = HashKey(nKey) & nMask;
+		while (pSlots[s].nKey != nKey && pSlots[s].nKey != VOXEL_NONE)
+			s = (s + 1) & nMask;
+
+		float fX, fY, fZ, fI;
+		if (src.pPoints != NULL) {
+			fX = src.pPoints[i].fX;
+			fY = src.pPoints[i].fY;
+			fZ = src.pPoints[i].fZ;
+			fI = src.pPoints[i].fI;
+		}
+		else {
+			fX = src.pX[i];
+			fY = src.pY[i];
+			fZ = src.pZ[i];
+			fI = src.pI != NULL ? src.pI[i] : 0.0f;
+		}
+
+		if (pSlots[s].nKey == VOXEL_NONE) {
+			pSlots[s].nKey = nKey;
+			pSlots[s].nVoxel = nVoxels;
+			Voxel &voxel = pVoxels[nVoxels++];
+			voxel.fSum[0] = fX;
+			voxel.fSum[1] = fY;
+			voxel.fSum[2] = fZ;
+			voxel.fSum[3] = fI;
+			voxel.nFirst = i;
+			voxel.nCount = 1;
+		}
+		else if (bCentroid) {
+			Voxel &voxel = pVoxels[pSlots[s].nVoxel];
+			voxel.fSum[0] += fX;
+			voxel.fSum[1] += fY;
+			voxel.fSum[2] += fZ;
+			voxel.fSum[3] += fI;
+			voxel.nCount++;
+		}
+	}
+	m_vPartVoxels[nPart] = nVoxels;
+}
+
+int CCubeEyeVoxelGrid::Run(const Source &src, CCubeEyePointCloud &out)
+{
+	if (src.nCount > 0xFFFFFFFFu)
+		return CE_OUTOFRANGE;
+
+	int nChunks = (int)((src.nCount + CHUNK_POINTS - 1) / CHUNK_POINTS);
+	m_vKeys.resize(src.nCount);
+	m_vChunkCount.resize((size_t)nChunks * PART_COUNT);
+	m_vPartBegin.resize(PART_COUNT + 1);
+	m_vSlotBegin.resize(PART_COUNT + 1);
+	m_vPartVoxels.resize(PART_COUNT);
+	m_vOutBegin.resize(PART_COUNT + 1);
+
+	//1. keys and partition counts
+	ForRange(nChunks, [&](int c) { KeyChunk(src, c); });
+
+	//2. partition ranges; chunk counts become scatter offsets(chunk order keeps input order)
+	size_t nOffset = 0, nSlots = 0;
+	for (int p = 0; p < PART_COUNT; p++) {
+		m_vPartBegin[p] = nOffset;
+		m_vSlotBegin[p] = nSlots;
+		for (int c = 0; c < nChunks; c++) {
+			uint32 &nCount = m_vChunkCount[(size_t)c * PART_COUNT + p];
+			uint32 nChunkCount = nCount;
+			nCount = (uint32)nOffset;
+			nOffset += nChunkCount;
+		}
+		nSlots += TableSize(nOffset - m_vPartBegin[p]);
+	}
+	m_vPartBegin[PART_COUNT] = nOffset;
+	m_vSlotBegin[PART_COUNT] = nSlots;
+	m_nInputCount = nOffset;
+
+	m_vOrder.resize(nOffset);
+	m_vVoxels.resize(nOffset);
+	m_vSlots.resize(nSlots);
+
+	ForRange(nChunks, [&](int c) {
+		size_t nBegin = (size_t)c * CHUNK_POINTS;
+		size_t nEnd = nBegin + CHUNK_POINTS < src.nCount ? nBegin + CHUNK_POINTS : src.nCount;
+		uint32 *pOffset = &m_vChunkCount[(size_t)c * PART_COUNT];
+		for (size_t i = nBegin; i < nEnd; i++) {
+			if (m_vKeys[i] != VOXEL_NONE)
+				m_vOrder[pOffset[HashKey(m_vKeys[i]) >> (64 - PART_BITS)]++] = (uint32)i;
+		}
+	});
+
+	//3. reduce the partitions independently
+	ForRange(PART_COUNT, [&](int p) { ReducePartition(src, p); });
+
+	size_t nVoxels = 0;
+	for (int p = 0; p < PART_COUNT; p++) {
+		m_vOutBegin[p] = nVoxels;
+		nVoxels += m_vPartVoxels[p];
+	}
+	m_vOutBegin[PART_COUNT] = nVoxels;
+	m_nVoxelCount = nVoxels;
+
+	if (nVoxels == 0) {
+		out.Clear();
+		return CE_SUCCESS;
+	}
+
+	//4. output
+	int nResult = out.AllocateUnorganized((int)nVoxels);
+	if (nResult != CE_SUCCESS)
+		return nResult;
+
+	float *pX = out.getX(), *pY = out.getY(), *pZ = out.getZ(), *pI = out.getI();
+	bool bCentroid = m_ePolicy == Voxel_Centroid;
+	ForRange(PART_COUNT, [&](int p) {
+		const Voxel *pVoxels = m_vVoxels.data() + m_vPartBegin[p];
+		size_t o = m_vOutBegin[p];
+		for (uint32 v = 0; v < m_vPartVoxels[p]; v++, o++) {
+			const Voxel &voxel = pVoxels[v];
+			float fScale = bCentroid ? 1.0f / voxel.nCount : 1.0f;
+			pX[o] = voxel.fSum[0] * fScale;
+			pY[o] = voxel.fSum[1] * fScale;
+			pZ[o] = voxel.fSum[2] * fScale;
+			pI[o] = voxel.fSum[3] * fScale;
+		}
+	});
+	return CE_SUCCESS;
+}
+
+}
@@ -0,0 +1,148 @@
+/****************************************************************************/
+/*																			*/
+/* @file	CubeEyeVoxelGrid.h												*/
+/*																			*/
+/* @brief	Hash grid voxel downsampling									*/
+/*                                                                          */
+/* @date    Oct 17, 2026                                                    */
+/*																			*/
+/****************************************************************************/
+
+#pragma once
+#include "CubeEyePointCloud.h"
+
+namespace CUBE_EYE
+{
+
+///Point kept for each voxel
+enum voxel_policy {
+	///Mean of the points of the voxel(X, Y, Z and I)
+	Voxel_Centroid = 0,
+	///First point of the voxel in input order
+	Voxel_First
+};
+
+/**
+*
+*@brief		Voxel grid downsampler
+*@details	Quantizes every valid point(Z > 0, mask bit set) to a cube of fLeafSize and keeps
+			one point per occupied cube. The quantized coordinates are packed into a 63 bit key
+			and hashed into open-addressing tables(linear probing, 16 byte entries) :
+			1. points are keyed in chunks and counted per partition(high hash bits),
+			2. point indices are scattered partition by partition,
+			3. every partition is reduced in its own table, in parallel and without locks,
+			4. the voxels are written to an unorganized cloud.
+			Output order is deterministic : partitions in order, voxels in order of first point.
+			Every buffer is kept between frames and only grows. One instance per stream; the
+			instances of several cameras can share the thread pool.
+*
+*/
+class CCubeEyeVoxelGrid {
+
+public:
+
+	CCubeEyeVoxelGrid();
+	~CCubeEyeVoxelGrid();
+
+	/**
+	*
+	* @brief	Set leaf size
+	* @param	fLeafSize - voxel edge(unit; m, default 0.01).
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int SetLeafSize(float fLeafSize);
+	float getLeafSize() const { return m_fLeafSize; }
+
+	void SetPolicy(voxel_policy ePolicy) { m_ePolicy = ePolicy; }
+	voxel_policy getPolicy() const { return m_ePolicy; }
+
+	/**
+	*
+	* @brief	Set thread pool
+	* @details	NULL : single threaded. Default is CCubeEyeThreadPool::Default().
+	* @return	void
+	*
+	*/
+	void SetThreadPool(CCubeEyeThreadPool *pPool) { m_pPool = pPool; }
+
+	/**
+	*
+	* @brief	Downsample a cloud
+	* @details	pOut becomes an unorganized cloud of one point per voxel(empty when no point is
+				valid). Without an I plane in the input, I = 0. in and out must differ.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Filter(const CCubeEyePointCloud &in, CCubeEyePointCloud &out);
+
+	/**
+	*
+	* @brief	Downsample a cePointCloud array
+	* @details	Output of ReadPCLFrame / CCubeEyeDepthToPCL; points with fZ <= 0 are skipped.
+	* @return	Success(0)|Error Code(< 0)
+	*
+	*/
+	int Filter(const cePointCloud *pPoints, size_t nCount, CCubeEyePointCloud &out);
+
+	///Valid input points of the last Filter
+	size_t getInputCount() const { return m_nInputCount; }
+	///Voxels(output points) of the last Filter
+	size_t getVoxelCount() const { return m_nVoxelCount; }
+
+private:
+
+	struct Source
+	{
+		const float *pX;
+		const float *pY;
+		const float *pZ;
+		const float *pI;
+		const uint64 *pMask;
+		const cePointCloud *pPoints;
+		size_t nCount;
+	};
+
+	struct Slot
+	{
+		uint64 nKey;
+		uint32 nVoxel;				//index in m_vVoxels
+		uint32 nReserved;
+	};
+
+	struct Voxel
+	{
+		float fSum[4];				//X, Y, Z, I
+		uint32 nFirst;				//first point index
+		uint32 nCount;
+	};
+
+	CCubeEyeVoxelGrid(const CCubeEyeVoxelGrid &);
+	CCubeEyeVoxelGrid &operator=(const CCubeEyeVoxelGrid &);
+
+	template <class TFunc>
+	void ForRange(int nCount, const TFunc &func);
+
+	int Run(const Source &src, CCubeEyePointCloud &out);
+	void KeyChunk(const Source &src, int nChunk);
+	void ReducePartition(const Source &src, int nPart);
+
+	float m_fLeafSize;
+	voxel_policy m_ePolicy;
+	CCubeEyeThreadPool *m_pPool;
+
+	Vector<uint64> m_vKeys;			//per point, VOXEL_NONE : skipped
+	Vector<uint32> m_vChunkCount;	//chunk x partition counts, then scatter offsets
+	Vector<uint32> m_vOrder;		//point indices grouped by partition
+	Vector<size_t> m_vPartBegin;	//partition ranges in m_vOrder / m_vVoxels
+	Vector<size_t> m_vSlotBegin;	//partition tables in m_vSlots
+	Vector<uint32> m_vPartVoxels;	//voxels found per partition
+	Vector<size_t> m_vOutBegin;		//partition ranges in the output
+	Vector<Slot> m_vSlots;
+	Vector<Voxel> m_vVoxels;
+
+	size_t m_nInputCount;
+	size_t m_nVoxelCount;
+};
+
+}